@@ -0,0 +1,111 @@
+/** @file assemblyPlan.cpp
+
+    @brief Re-assembles a Poisson problem with the assembly plan and
+    checks that a deformed geometry is not assembled from the stored
+    element data, and that refresh() keeps the plan.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+#include <gsAssembler/gsVisitorPoisson.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    int deg    = 2;
+    int numRef = 3;
+
+    gsCmdLine cmd("Re-assembly with the assembly plan.");
+    cmd.addInt("p", "degree", "Degree of the basis", deg);
+    cmd.addInt("r", "refine", "Number of uniform refinement steps", numRef);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    gsMultiPatch<> patches( *safe(gsNurbsCreator<>::BSplineSquare(2)) );
+    gsFunctionExpr<> f("1", 2);
+    gsFunctionExpr<> g("0", 2);
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator bit = patches.bBegin(); bit != patches.bEnd(); ++bit)
+        bc.addCondition( *bit, condition_type::dirichlet, &g );
+    gsPoissonPde<> pde(patches, bc, f);
+
+    gsMultiBasis<> bases(patches);
+    bases.setDegree(deg);
+    for (int i = 0; i < numRef; ++i)
+        bases.uniformRefine();
+
+    bool passed = true;
+
+    gsPoissonAssembler<> planned;
+    planned.setAssemblyPlan(true);
+    planned.initialize(pde, bases);
+    planned.assemble();
+    const gsMatrix<> A1 = planned.matrix().toDense();
+    const gsMatrix<> b1 = planned.rhs();
+    const size_t bytes = planned.assemblyPlan().bytesUsed();
+    gsInfo << "Assembly plan: " << bytes << " bytes\n";
+    passed = passed && 0 != bytes;
+
+    // A second pass on the same geometry uses the stored data and
+    // adds the same contributions
+    planned.push<gsVisitorPoisson<real_t> >();
+    passed = passed && (planned.matrix().toDense() - 2 * A1).norm() < 1e-12 * A1.norm()
+        && planned.assemblyPlan().bytesUsed() == bytes;
+
+    // After deforming the geometry, the next pass adds the
+    // contributions of the deformed geometry
+    gsMatrix<> & coefs = pde.domain().patch(0).coefs();
+    coefs.col(0).array() += 0.2 * coefs.col(1).array().square();
+    planned.push<gsVisitorPoisson<real_t> >();
+    const gsMatrix<> A2 = planned.matrix().toDense() - 2 * A1;
+    const gsMatrix<> b2 = planned.rhs() - 2 * b1;
+
+    gsPoissonAssembler<> fresh;
+    fresh.initialize(pde, bases);
+    fresh.assemble();
+    const gsMatrix<> A  = fresh.matrix().toDense();
+    const real_t errMat = (A2 - A).norm() / A.norm();
+    const real_t errRhs = (b2 - fresh.rhs()).norm() / fresh.rhs().norm();
+    const real_t change = (A - A1).norm() / A1.norm();
+    gsInfo << "Deformed geometry: relative change " << change << ", difference to "
+           << "a fresh assembly " << errMat << " (matrix), " << errRhs << " (rhs)\n";
+    passed = passed && change > 1e-3 && errMat < 1e-12 && errRhs < 1e-12;
+
+    // refresh() keeps the plan, refresh() and assemble() reuse it
+    const size_t bytes2 = planned.assemblyPlan().bytesUsed();
+    for (int k = 0; k != 2; ++k)
+    {
+        planned.refresh();
+        passed = passed && planned.assemblyPlan().bytesUsed() == bytes2;
+        planned.assemble();
+        const real_t err = (planned.matrix().toDense() - A).norm() / A.norm();
+        gsInfo << "Re-assembly " << k << ": " << planned.assemblyPlan().bytesUsed()
+               << " bytes, difference to a fresh assembly " << err << "\n";
+        passed = passed && planned.assemblyPlan().bytesUsed() == bytes2 && err < 1e-12;
+    }
+
+    // New bases clear the plan
+    bases.uniformRefine();
+    planned.initialize(pde, bases);
+    passed = passed && 0 == planned.assemblyPlan().bytesUsed();
+
+    if ( !passed )
+    {
+        gsWarn << "The assembly plan gave wrong systems.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+/** @file binaryContainer.cpp
+
+    @brief Writes a multipatch geometry to an XML file and to a binary
+    container file, reads single patches from the binary file on
+    demand and converts it back to XML. Malformed base64 data must
+    survive the conversion as text.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Size of the file fn in bytes
+long fileSize(const std::string & fn)
+{
+    std::ifstream f(fn.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+    return f.is_open() ? static_cast<long>(f.tellg()) : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    int numPatches = 10;
+    int numRefine  = 4;
+
+    gsCmdLine cmd("Binary container files of gsFileData.");
+    cmd.addInt("m", "patches", "Number of patches per direction", numPatches);
+    cmd.addInt("r", "refine", "Number of uniform refinements of the patches", numRefine);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    // Grid of refined patches with perturbed coefficients
+    gsMultiPatch<> * mp = gsNurbsCreator<>::BSplineSquareGrid(numPatches, numPatches);
+    for (size_t k = 0; k != mp->nPatches(); ++k)
+    {
+        for (int r = 0; r != numRefine; ++r)
+            mp->patch(k).uniformRefine();
+        mp->patch(k).coefs() += 0.01 * gsMatrix<>::Random(mp->patch(k).coefs().rows(), 2);
+    }
+
+    // A hierarchical basis with a refined box
+    gsTensorBSplineBasis<2> tb( gsKnotVector<>(0, 1, 15, 3), gsKnotVector<>(0, 1, 15, 3) );
+    gsTHBSplineBasis<2> thb(tb);
+    std::vector<unsigned> box(5);
+    box[0] = 1; box[1] = 4; box[2] = 4; box[3] = 20; box[4] = 20;
+    thb.refineElements(box);
+
+    gsFileData<> fd;
+    fd << *mp;
+    fd << thb;
+
+    gsStopwatch time;
+    fd.save("binaryContainer");
+    const real_t tx = time.stop();
+    time.restart();
+    fd.saveBinary("binaryContainer");
+    const real_t tb0 = time.stop();
+
+    gsInfo << mp->nPatches() << " patches with " << mp->patch(0).coefs().rows()
+           << " coefficients each:\n";
+    gsInfo << "  xml: " << tx  << " s, " << fileSize("binaryContainer.xml") << " bytes\n";
+    gsInfo << "  gsb: " << tb0 << " s, " << fileSize("binaryContainer.gsb") << " bytes\n";
+
+    // Read one patch, only its chunk is read
+    time.restart();
+    gsFileData<> fdx("binaryContainer.xml");
+    memory::auto_ptr<gsGeometry<> > px( fdx.getId<gsGeometry<> >(numPatches) );
+    const real_t trx = time.stop();
+    time.restart();
+    gsFileData<> fdb("binaryContainer.gsb");
+    memory::auto_ptr<gsGeometry<> > pb( fdb.getId<gsGeometry<> >(numPatches) );
+    const real_t trb = time.stop();
+    gsInfo << "Reading patch " << numPatches << ": xml " << trx << " s, gsb " << trb << " s\n";
+
+    bool same = ( px->coefs() == pb->coefs() );
+    same = same && ( (pb->coefs() - mp->patch(numPatches).coefs()).cwiseAbs().maxCoeff() < 1e-14 );
+
+    // Convert back to XML and read everything
+    fdb.save("binaryContainer_converted");
+    gsFileData<> fdc("binaryContainer_converted.xml");
+    memory::auto_ptr<gsMultiPatch<> > mpc( fdc.getFirst<gsMultiPatch<> >() );
+    memory::auto_ptr<gsMultiPatch<> > mpx( fdx.getFirst<gsMultiPatch<> >() );
+    memory::auto_ptr<gsTHBSplineBasis<2> > thbc( fdc.getFirst<gsTHBSplineBasis<2> >() );
+    same = same && ( mpc->nPatches() == mp->nPatches() ) &&
+        ( mpc->nInterfaces() == mp->nInterfaces() ) && ( thbc->size() == thb.size() );
+    for (size_t k = 0; same && k != mp->nPatches(); ++k)
+        same = ( mpc->patch(k).coefs() == mpx->patch(k).coefs() );
+    delete mp;
+
+    // A malformed base64 value is kept as text
+    const std::string bad = "not*base64*data";
+    {
+        std::ofstream f("binaryContainer_bad.xml");
+        f << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<xml>\n"
+          << "<Matrix rows=\"1\" cols=\"1\" id=\"0\" encoding=\"base64\">"
+          << bad << "</Matrix>\n</xml>\n";
+    }
+    gsFileData<> fbad("binaryContainer_bad.xml");
+    fbad.saveBinary("binaryContainer_bad");
+    gsFileData<> fbadb("binaryContainer_bad.gsb");
+    fbadb.save("binaryContainer_bad_converted");
+    {
+        std::ifstream f("binaryContainer_bad_converted.xml");
+        const std::string text( (std::istreambuf_iterator<char>(f)),
+                                std::istreambuf_iterator<char>() );
+        same = same && std::string::npos != text.find(bad);
+    }
+
+    if ( !same )
+    {
+        gsWarn << "The binary container was not read back correctly.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+/** @file distributedAssembly.cpp
+
+    @brief Assembles a Poisson problem on a multipatch domain part by
+    part, as the processes of a distributed assembly do, and checks
+    that the sum of the parts is the global system.
+
+    With Trilinos (GISMO_WITH_TRILINOS), every MPI process assembles
+    one part and the parts are summed in a distributed Trilinos
+    matrix, eg. run with: mpirun -np 4 ./distributedAssembly
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+#ifdef GISMO_WITH_TRILINOS
+#include <gsTrilinos/gsTrilinos.h>
+#endif
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+#ifdef GISMO_WITH_TRILINOS
+    trilinos::Session session(argc, argv);
+#endif
+
+    int numPatches = 3;
+    int numRefine  = 3;
+    int numParts   = 4;
+
+    gsCmdLine cmd("Assembly of a Poisson problem part by part.");
+    cmd.addInt("m", "patches", "Number of patches per direction", numPatches);
+    cmd.addInt("r", "uniformRefine", "Number of uniform refinement steps", numRefine);
+    cmd.addInt("n", "parts", "Number of parts (without MPI)", numParts);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    gsMultiPatch<> * mp = gsNurbsCreator<>::BSplineSquareGrid(numPatches, numPatches);
+
+    // Dirichlet conditions on the left and bottom sides of the
+    // domain, Neumann conditions on the other ones
+    gsFunctionExpr<> f("2*pi^2*sin(pi*x)*sin(pi*y)", 2);
+    gsFunctionExpr<> g("0", 2);
+    gsFunctionExpr<> hx("pi*cos(pi*x)*sin(pi*y)", 2);
+    gsFunctionExpr<> hy("pi*sin(pi*x)*cos(pi*y)", 2);
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator bit = mp->bBegin(); bit != mp->bEnd(); ++bit)
+    {
+        if ( boundary::west == bit->side() || boundary::south == bit->side() )
+            bc.addCondition( *bit, condition_type::dirichlet, &g );
+        else
+            bc.addCondition( *bit, condition_type::neumann,
+                             boundary::east == bit->side() ? &hx : &hy );
+    }
+    gsPoissonPde<> pde(*mp, bc, f);
+
+    gsMultiBasis<> bases(*mp);
+    bases.degreeElevate(1);
+    for (int i = 0; i < numRefine; ++i)
+        bases.uniformRefine();
+
+    // The global system
+    gsPoissonAssembler<> assembler;
+    assembler.initialize(pde, bases);
+    assembler.assemble();
+    const gsSparseMatrix<> K = assembler.matrix();
+    const gsMatrix<> rhs     = assembler.rhs();
+    const gsDofMapper mapper = assembler.system().colMapper(0);
+
+    index_t rank = 0, numRanks = 1;
+#ifdef GISMO_WITH_TRILINOS
+    rank     = trilinos::Session::rank();
+    numRanks = trilinos::Session::size();
+    if ( 1 < numRanks )
+        numParts = numRanks;
+#endif
+
+    gsDomainPartition<> partition(bases, numParts);
+    if ( 0 == rank )
+        gsInfo << mapper.freeSize() << " free dofs\n" << partition;
+
+    // Assemble the parts of this process and sum them
+    gsSparseMatrix<> Ksum(K.rows(), K.cols());
+    gsMatrix<> rhsSum;
+    rhsSum.setZero(rhs.rows(), rhs.cols());
+    std::vector<index_t> owned, ghost;
+    index_t numOwned = 0;
+    bool ownedOk = true;
+    for (index_t p = rank; p < numParts; p += numRanks)
+    {
+        assembler.setPartition(&partition, p);
+        assembler.refresh();
+        assembler.assemble();
+        Ksum   += assembler.matrix();
+        rhsSum += assembler.rhs();
+
+        partition.dofs(bases, mapper, p, owned, ghost);
+        gsInfo << "Part " << p << ": " << partition.numElements(p) << " elements, "
+               << owned.size() << " owned and " << ghost.size() << " ghost dofs\n";
+        numOwned += owned.size();
+
+        // The sparsity pattern of the part has no entries outside
+        // the rows and columns of the owned and the ghost dofs
+        std::vector<bool> active(K.rows(), false);
+        for (size_t i = 0; i != owned.size(); ++i) active[owned[i]] = true;
+        for (size_t i = 0; i != ghost.size(); ++i) active[ghost[i]] = true;
+        for (index_t c = 0; c != assembler.matrix().outerSize(); ++c)
+            for (gsSparseMatrix<>::InnerIterator it(assembler.matrix(), c); it; ++it)
+                ownedOk = ownedOk && active[it.row()] && active[it.col()];
+        gsInfo << "Part " << p << ": " << assembler.matrix().nonZeros() << " of "
+               << K.nonZeros() << " matrix entries\n";
+    }
+
+    bool same = true;
+    if ( 1 == numRanks )
+    {
+        // The parts sum to the global system and own every dof once
+        const real_t errK   = (K - Ksum).norm() / K.norm();
+        const real_t errRhs = (rhs - rhsSum).norm() / rhs.norm();
+        gsInfo << "Relative error of the sum of the parts: matrix " << errK
+               << ", rhs " << errRhs << "\n";
+        same = errK < 1e-12 && errRhs < 1e-12 && numOwned == mapper.freeSize();
+    }
+
+#ifdef GISMO_WITH_TRILINOS
+    if ( 1 < numRanks )
+    {
+        // Sum the parts of the processes in a distributed matrix
+        trilinos::SparseMatrix A(assembler.matrix(), owned);
+        trilinos::Vector       b(assembler.rhs(), owned);
+        gsSparseMatrix<> Aowned;
+        gsMatrix<> bowned;
+        A.ownedRows(Aowned);
+        b.ownedValues(bowned);
+
+        gsSparseMatrix<> Kowned(K.rows(), K.cols());
+        gsMatrix<> rhsOwned;
+        rhsOwned.setZero(rhs.rows(), 1);
+        gsSparseEntries<real_t> entries;
+        for (index_t c = 0; c != K.outerSize(); ++c)
+            for (gsSparseMatrix<>::InnerIterator it(K, c); it; ++it)
+                if ( std::binary_search(owned.begin(), owned.end(), it.row()) )
+                    entries.add(it.row(), it.col(), it.value());
+        Kowned.setFrom(entries);
+        for (size_t i = 0; i != owned.size(); ++i)
+            rhsOwned(owned[i], 0) = rhs(owned[i], 0);
+
+        const real_t errK   = (Kowned - Aowned).norm() / K.norm();
+        const real_t errRhs = (rhsOwned - bowned).norm() / rhs.norm();
+        gsInfo << "Process " << rank << ": relative error of the owned rows: matrix "
+               << errK << ", rhs " << errRhs << "\n";
+        same = errK < 1e-12 && errRhs < 1e-12;
+    }
+    same = trilinos::Session::all(same && ownedOk);
+#endif
+
+    delete mp;
+
+    if ( !same || !ownedOk )
+    {
+        gsWarn << "The parts do not sum to the global system.\n";
+        return 1;
+    }
+    return 0;
+}
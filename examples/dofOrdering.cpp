@@ -0,0 +1,110 @@
+/** @file dofOrdering.cpp
+
+    @brief Compares the numberings of the degrees of freedom of a
+    multipatch domain by the bandwidth and the profile of the matrix.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Checks that the numbering of mapper is the numbering of mapper0
+// up to a permutation of the free dofs which keeps the coupled dofs
+bool samePartition(const gsDofMapper & mapper0, const gsDofMapper & mapper)
+{
+    std::vector<index_t> perm(mapper0.freeSize(), -1);
+    std::vector<bool> used(mapper0.freeSize(), false);
+    for (size_t k = 0; k != mapper0.mapSize(); ++k)
+    {
+        const index_t i0 = mapper0.mapIndex(k), i = mapper.mapIndex(k);
+        if ( mapper0.is_free_index(i0) != mapper.is_free_index(i) )
+            return false;
+        if ( !mapper0.is_free_index(i0) )
+        {
+            if ( i0 != i ) return false;
+            continue;
+        }
+        if ( mapper0.is_coupled_index(i0) != mapper.is_coupled_index(i) )
+            return false;
+        if ( -1 == perm[i0] )
+        {
+            if ( used[i] ) return false;
+            perm[i0] = i;
+            used[i] = true;
+        }
+        else if ( perm[i0] != i )
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int numPatches = 3;
+    int numRefine  = 4;
+    int degree     = 2;
+
+    gsCmdLine cmd("Numberings of the degrees of freedom of a multipatch domain.");
+    cmd.addInt("m", "patches", "Number of patches per direction", numPatches);
+    cmd.addInt("r", "uniformRefine", "Number of uniform refinement steps", numRefine);
+    cmd.addInt("p", "degree", "Degree of the bases", degree);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    gsMultiPatch<> * mp = gsNurbsCreator<>::BSplineSquareGrid(numPatches, numPatches);
+    gsMultiBasis<> bases(*mp);
+    bases.degreeElevate(degree - 1);
+    for (int i = 0; i < numRefine; ++i)
+        bases.uniformRefine();
+
+    // Eliminate the dofs of the outer boundary
+    gsConstantFunction<> zero(0.0, 2);
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator it = mp->bBegin(); it != mp->bEnd(); ++it)
+        bc.addCondition(it->patch, it->side(), condition_type::dirichlet, &zero);
+
+    gsDofMapper mapper0;
+    bases.getMapper(true, bc, mapper0);
+    gsInfo << bases.totalSize() << " dofs, " << mapper0.freeSize() << " free, "
+           << mapper0.coupledSize() << " coupled\n";
+
+    const char * name[4] = {"natural", "rcm", "nested dissection", "space filling curve"};
+    bool same = true;
+    index_t profiles[4];
+    for (int o = 0; o != 4; ++o)
+    {
+        gsDofMapper mapper = mapper0;
+        mapper.reorder(bases, static_cast<dofOrdering::type>(o));
+        index_t bandwidth, profile;
+        mapper.matrixProfile(bases, bandwidth, profile);
+        gsInfo << name[o] << ": bandwidth " << bandwidth << ", profile " << profile << "\n";
+        same = same && samePartition(mapper0, mapper);
+        profiles[o] = profile;
+    }
+    delete mp;
+
+    if ( !same )
+    {
+        gsWarn << "The renumbering changed the partition of the dofs.\n";
+        return 1;
+    }
+    if ( profiles[dofOrdering::rcm] > profiles[dofOrdering::natural] )
+    {
+        gsWarn << "The rcm numbering increased the profile.\n";
+        return 1;
+    }
+    return 0;
+}
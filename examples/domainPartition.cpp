@@ -0,0 +1,114 @@
+/** @file domainPartition.cpp
+
+    @brief Partitions the elements of multipatch domains and checks
+    that every element belongs to exactly one part and that every
+    free dof is owned by exactly one part.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Checks the partition of bases into numParts parts, returns the
+// number of errors
+index_t checkPartition(const gsMultiPatch<> & mp, const gsMultiBasis<> & bases,
+                       index_t numParts)
+{
+    gsDomainPartition<> partition(bases, numParts);
+    index_t errors = 0;
+
+    // Every element is in exactly one range, and partOf agrees
+    std::vector<std::vector<index_t> > count(bases.nBases());
+    for (size_t k = 0; k != bases.nBases(); ++k)
+        count[k].resize(bases[k].numElements(), 0);
+    index_t total = 0;
+    for (index_t p = 0; p != partition.numParts(); ++p)
+    {
+        const std::vector<gsDomainPartition<>::range> & r = partition.ranges(p);
+        for (size_t i = 0; i != r.size(); ++i)
+            for (index_t el = r[i].first; el != r[i].last; ++el)
+            {
+                ++count[r[i].patch][el];
+                if ( partition.partOf(r[i].patch, el) != p )
+                    ++errors;
+            }
+        total += partition.numElements(p);
+    }
+    for (size_t k = 0; k != count.size(); ++k)
+        for (size_t el = 0; el != count[k].size(); ++el)
+            if ( 1 != count[k][el] )
+                ++errors;
+    if ( total != static_cast<index_t>(bases.totalElements()) )
+        ++errors;
+
+    // Every free dof is owned by exactly one part, and is a ghost
+    // only of parts which do not own it
+    gsConstantFunction<> zero(0.0, 2);
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator it = mp.bBegin(); it != mp.bEnd(); ++it)
+        bc.addCondition(it->patch, it->side(), condition_type::dirichlet, &zero);
+    gsDofMapper mapper;
+    bases.getMapper(true, bc, mapper);
+
+    std::vector<index_t> owners(mapper.freeSize(), 0);
+    std::vector<index_t> owned, ghost;
+    for (index_t p = 0; p != partition.numParts(); ++p)
+    {
+        partition.dofs(bases, mapper, p, owned, ghost);
+        for (size_t i = 0; i != owned.size(); ++i)
+            ++owners[owned[i]];
+        for (size_t i = 0; i != ghost.size(); ++i)
+            if ( std::binary_search(owned.begin(), owned.end(), ghost[i]) )
+                ++errors;
+    }
+    for (size_t i = 0; i != owners.size(); ++i)
+        if ( 1 != owners[i] )
+            ++errors;
+
+    gsInfo << partition;
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int numPatches = 3;
+    int numRefine  = 2;
+
+    gsCmdLine cmd("Partition of the elements of multipatch domains.");
+    cmd.addInt("m", "patches", "Number of patches per direction", numPatches);
+    cmd.addInt("r", "uniformRefine", "Number of uniform refinement steps", numRefine);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    gsMultiPatch<> * mp = gsNurbsCreator<>::BSplineSquareGrid(numPatches, numPatches);
+    gsMultiBasis<> bases(*mp);
+    bases.degreeElevate(1);
+    for (int i = 0; i < numRefine; ++i)
+        bases.uniformRefine();
+
+    index_t errors = 0;
+    const index_t parts[5] = {1, 2, 4, 7, 50};
+    for (int i = 0; i != 5; ++i)
+        errors += checkPartition(*mp, bases, parts[i]);
+    delete mp;
+
+    if ( 0 != errors )
+    {
+        gsWarn << errors << " errors in the partitions.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+/** @file fileDataOnDemand.cpp
+
+    @brief Reads a few patches of a large XML file, reading the whole
+    file and reading only the requested objects.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    int numPatches = 30;
+
+    gsCmdLine cmd("Reading objects of XML files on demand.");
+    cmd.addInt("m", "patches", "Number of patches per direction", numPatches);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    gsMultiPatch<> * mp = gsNurbsCreator<>::BSplineSquareGrid(numPatches, numPatches);
+    for (size_t k = 0; k != mp->nPatches(); ++k)
+    {
+        mp->patch(k).uniformRefine(7);
+        mp->patch(k).coefs() += 0.01 * gsMatrix<>::Random(mp->patch(k).coefs().rows(), 2);
+    }
+    {
+        gsFileData<> fd;
+        fd << *mp;
+        fd.addComment("Patches of a square grid");
+        fd.save("fileDataOnDemand");
+    }
+
+    const index_t n  = mp->nPatches();
+    const index_t ids[3] = {0, n / 2, n - 1};
+
+    gsStopwatch time;
+    gsFileData<> fdw("fileDataOnDemand.xml");
+    memory::auto_ptr<gsGeometry<> > gw[3];
+    for (int k = 0; k != 3; ++k)
+        gw[k].reset( fdw.getId<gsGeometry<> >(ids[k]) );
+    const real_t tw = time.stop();
+
+    time.restart();
+    gsFileData<> fdd;
+    fdd.read("fileDataOnDemand.xml", true);
+    memory::auto_ptr<gsGeometry<> > gd[3];
+    for (int k = 0; k != 3; ++k)
+        gd[k].reset( fdd.getId<gsGeometry<> >(ids[k]) );
+    const real_t td = time.stop();
+
+    gsInfo << "Reading 3 of " << n << " patches:\n";
+    gsInfo << "  whole file: " << tw << " s, " << fdw.bufferSize() << " bytes kept\n";
+    gsInfo << "  on demand : " << td << " s\n";
+
+    bool same = ( fdd.numTags() == fdw.numTags() );
+    for (int k = 0; same && k != 3; ++k)
+        same = ( gd[k]->coefs() == gw[k]->coefs() );
+
+    // Objects which refer to other objects, and the whole contents
+    memory::auto_ptr<gsMultiPatch<> > mpd( fdd.getFirst<gsMultiPatch<> >() );
+    same = same && ( mpd->nPatches() == mp->nPatches() ) &&
+        ( mpd->nInterfaces() == mp->nInterfaces() );
+    fdd.save("fileDataOnDemand_copy");
+    gsFileData<> fdc("fileDataOnDemand_copy.xml");
+    same = same && ( fdc.numTags() == fdw.numTags() );
+    delete mp;
+
+    if ( !same )
+    {
+        gsWarn << "The objects were not read correctly.\n";
+        return 1;
+    }
+    return 0;
+}
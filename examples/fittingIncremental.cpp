@@ -0,0 +1,93 @@
+/** @file fittingIncremental.cpp
+
+    @brief Fits a large point cloud by a tensor B-spline surface, all
+    points at once and in batches of points which are added to the
+    assembled system, and re-fits with new parameter values.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    int numPoints  = 200000;
+    int numBatches = 4;
+    int numURef    = 4;
+    int deg        = 3;
+
+    gsCmdLine cmd("Fitting of large point clouds, at once and incrementally.");
+    cmd.addInt("n", "points", "Number of points", numPoints);
+    cmd.addInt("b", "batches", "Number of batches of points", numBatches);
+    cmd.addInt("r", "urefine", "Number of uniform refinement steps", numURef);
+    cmd.addInt("p", "degree", "Degree of the basis", deg);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok || numBatches < 1)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    // Samples of a surface at random parameters
+    gsMatrix<> uv = 0.5 * ( gsMatrix<>::Random(2, numPoints).array() + 1 );
+    gsMatrix<> xyz(3, numPoints);
+    xyz.topRows(2) = uv;
+    xyz.row(2) = ( 3 * uv.row(0) ).array().sin() * ( 2 * uv.row(1) ).array().cos();
+
+    gsKnotVector<> kv(0, 1, (1 << numURef) - 1, deg + 1);
+    gsTensorBSplineBasis<2> basis(kv, kv);
+
+    gsStopwatch time;
+    gsFitting<> fitAll(uv, xyz, basis);
+    fitAll.compute();
+    const real_t t0 = time.stop();
+
+    // The first batch is fitted, the others are added to its system
+    const index_t n0 = numPoints / numBatches;
+    time.restart();
+    gsFitting<> fitInc(uv.leftCols(n0), xyz.leftCols(n0), basis);
+    fitInc.compute();
+    for (index_t first = n0; first < numPoints; first += n0)
+    {
+        const index_t n = math::min(n0, numPoints - first);
+        fitInc.addPoints(uv.middleCols(first, n), xyz.middleCols(first, n));
+        fitInc.compute();
+    }
+    const real_t t1 = time.stop();
+
+    fitAll.computeMaxNormErrors();
+    gsInfo << numPoints << " points, " << basis.size() << " basis functions\n";
+    gsInfo << "All points at once: " << t0 << " s, max. error " << fitAll.maxPointError() << "\n";
+    gsInfo << numBatches << " batches        : " << t1 << " s\n";
+
+    const real_t diff = ( fitAll.result()->coefs() - fitInc.result()->coefs() ).norm();
+    if ( diff > 1e-6 )
+    {
+        gsWarn << "The fits differ by " << diff << ".\n";
+        return 1;
+    }
+
+    // New parameters (eg. parameter correction) are not fitted with
+    // the system of the old ones
+    const gsMatrix<> uv2 = uv.array().square();
+    fitAll.setParamValues(uv2);
+    fitAll.compute();
+    gsFitting<> fitNew(uv2, xyz, basis);
+    fitNew.compute();
+    const real_t diff2 = ( fitAll.result()->coefs() - fitNew.result()->coefs() ).norm();
+    if ( diff2 > 1e-10 )
+    {
+        gsWarn << "The fit with new parameters differs by " << diff2 << ".\n";
+        return 1;
+    }
+    return 0;
+}
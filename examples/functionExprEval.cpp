@@ -0,0 +1,91 @@
+/** @file functionExprEval.cpp
+
+    @brief Evaluates a gsFunctionExpr and its derivatives, serially and
+    by several threads, and compares them to the exact values.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    int numPoints = 10000;
+
+    gsCmdLine cmd("Evaluation of function expressions.");
+    cmd.addInt("n", "points", "Number of evaluation points", numPoints);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    // f = ( sin(x)*exp(y), x^2*y^3 )
+    gsFunctionExpr<> f("sin(x)*exp(y)", "x^2*y^3", 2);
+    gsMatrix<> u = gsMatrix<>::Random(2, numPoints);
+
+    // Exact values and derivatives
+    gsMatrix<> ev(2, numPoints), ed(4, numPoints), ed2(6, numPoints);
+    for (index_t p = 0; p != numPoints; ++p)
+    {
+        const real_t x = u(0,p), y = u(1,p);
+        const real_t s = math::sin(x), c = math::cos(x), e = math::exp(y);
+        ev.col(p) << s*e, x*x*y*y*y;
+        ed.col(p) << c*e, s*e, 2*x*y*y*y, 3*x*x*y*y;
+        ed2.col(p) << -s*e, s*e, c*e, 2*y*y*y, 6*x*x*y, 6*x*y*y;
+    }
+
+    gsStopwatch time;
+    gsMatrix<> v, d, d2;
+    f.eval_into  (u, v );
+    f.deriv_into (u, d );
+    f.deriv2_into(u, d2);
+    const real_t t0 = time.stop();
+
+    real_t err = math::max( (v  - ev ).cwiseAbs().maxCoeff(),
+                 math::max( (d  - ed ).cwiseAbs().maxCoeff(),
+                            (d2 - ed2).cwiseAbs().maxCoeff() ) );
+
+    // Every thread evaluates blocks of points on the same function
+    const index_t bs = 64;
+    gsMatrix<> pv(2, numPoints), pd(4, numPoints), pd2(6, numPoints);
+    time.restart();
+#   pragma omp parallel for private(v, d, d2)
+    for (index_t b = 0; b < numPoints; b += bs)
+    {
+        const index_t nc = math::min(bs, numPoints - b);
+        f.eval_into  (u.middleCols(b, nc), v );
+        f.deriv_into (u.middleCols(b, nc), d );
+        f.deriv2_into(u.middleCols(b, nc), d2);
+        pv .middleCols(b, nc) = v;
+        pd .middleCols(b, nc) = d;
+        pd2.middleCols(b, nc) = d2;
+    }
+    const real_t t1 = time.stop();
+
+    err = math::max(err, math::max( (pv  - ev ).cwiseAbs().maxCoeff(),
+                         math::max( (pd  - ed ).cwiseAbs().maxCoeff(),
+                                    (pd2 - ed2).cwiseAbs().maxCoeff() ) ) );
+
+    gsInfo << "Function " << f << " on " << numPoints << " points\n";
+    gsInfo << "serial  : " << t0 << " s\n";
+    gsInfo << "threads : " << t1 << " s\n";
+    gsInfo << "Maximum error: " << err << "\n";
+
+    if ( err > 1e-10 )
+    {
+        gsWarn << "The evaluation of the expression is wrong.\n";
+        return 1;
+    }
+    return 0;
+}
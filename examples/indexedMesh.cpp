@@ -0,0 +1,174 @@
+/** @file indexedMesh.cpp
+
+    @brief Converts meshes between gsMesh and gsIndexedMesh, and
+    checks the half-edge adjacency of indexed meshes.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <fstream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// The surface of the unit cube, as 12 triangles
+void cube(gsMesh<> & m)
+{
+    for (int i = 0; i != 8; ++i)
+        m.addVertex(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+    const int tri[12][3] = { {0,2,1}, {1,2,3}, {4,5,6}, {5,7,6},   // z = 0, 1
+                             {0,1,4}, {1,5,4}, {2,6,3}, {3,6,7},   // y = 0, 1
+                             {0,4,2}, {2,4,6}, {1,3,5}, {3,7,5} }; // x = 0, 1
+    for (int f = 0; f != 12; ++f)
+        m.addFace(tri[f][0], tri[f][1], tri[f][2]);
+}
+
+// Checks the half-edges of m, returns the number of boundary
+// half-edges, or -1 if the adjacency is inconsistent
+index_t checkHalfEdges(gsIndexedMesh<> & m)
+{
+    m.computeHalfEdges();
+    index_t boundary = 0;
+    for (index_t h = 0; h != m.numHalfEdges(); ++h)
+    {
+        const index_t t = m.twin(h);
+        if ( -1 == t )
+        {
+            ++boundary;
+            continue;
+        }
+        if ( m.twin(t) != h || m.origin(t) != m.origin(m.next(h)) ||
+             m.origin(m.next(t)) != m.origin(h) || m.face(t) == m.face(h) )
+            return -1;
+    }
+    return boundary;
+}
+
+bool sameArrays(const gsIndexedMesh<> & a, const gsIndexedMesh<> & b)
+{
+    return a.coordinates() == b.coordinates() && a.faceOffsets() == b.faceOffsets()
+        && a.faceIndices() == b.faceIndices() && a.edges() == b.edges();
+}
+
+// Compares the features of gsTriMeshToSolid computed from the
+// vertices and from the half-edges of m
+bool sameFeatures(const gsIndexedMesh<> & m)
+{
+    gsMesh<> a, b;
+    m.toMesh(a);
+    m.toMesh(b);
+    gsTriMeshToSolid<> ta(&a), tb(&b);
+    bool nonManifold, borders;
+    ta.getFeatures(20, nonManifold, borders);
+    tb.getFeatures(m, 20, nonManifold, borders);
+    if ( a.edge.size() != b.edge.size() )
+        return false;
+    for (size_t e = 0; e != a.edge.size(); ++e)
+    {
+        if ( a.edge[e] != b.edge[e] || a.edge[e].sharp != b.edge[e].sharp ||
+             a.edge[e].nFaces.size() != b.edge[e].nFaces.size() )
+            return false;
+        for (size_t f = 0; f != a.edge[e].nFaces.size(); ++f)
+            if ( a.edge[e].nFaces[f]->getId() != b.edge[e].nFaces[f]->getId() )
+                return false;
+    }
+    for (size_t f = 0; f != a.face.size(); ++f)
+        for (size_t k = 0; k != a.face[f]->nEdges.size(); ++k)
+            if ( a.face[f]->nEdges[k]->getId() != b.face[f]->nEdges[k]->getId() )
+                return false;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 10;
+
+    gsCmdLine cmd("Conversion of meshes to flat arrays.");
+    cmd.addInt("n", "size", "Number of grid cells per direction", n);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    bool passed = true;
+
+    // A closed surface has no boundary half-edges
+    gsMesh<> m;
+    cube(m);
+    m.addEdge(0, 7);
+    gsIndexedMesh<> im(m);
+    gsInfo << im;
+    passed = passed && im.numVertices() == 8 && im.numFaces() == 12
+        && im.numEdges() == 1 && im.numHalfEdges() == 36
+        && 0 == checkHalfEdges(im) && im.vertices().col(7) == m.vertex[7]->coords;
+
+    // Back to gsMesh and again to arrays
+    gsMesh<> m2;
+    im.toMesh(m2);
+    passed = passed && sameArrays(im, gsIndexedMesh<>(m2));
+
+    // A grid has 4n boundary half-edges
+    gsIndexedMesh<> grid;
+    for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i)
+            grid.addVertex(i, j, 0);
+    for (int j = 0; j != n; ++j)
+        for (int i = 0; i != n; ++i)
+        {
+            const index_t v = j * (n + 1) + i;
+            const index_t quad[4] = {v, v + 1, v + n + 2, v + n + 1};
+            grid.addFace(quad, 4);
+        }
+    passed = passed && checkHalfEdges(grid) == 4 * n;
+
+    // Written to Paraview like gsMesh
+    gsWriteParaview(grid, "indexedMesh_grid", false, vtkFormat::ascii);
+    std::ifstream file("indexedMesh_grid.vtp");
+    passed = passed && file.good();
+    file.close();
+    std::remove("indexedMesh_grid.vtp");
+
+    // Read from an STL file, welded
+    {
+        std::ofstream stl("indexedMesh_cube.stl");
+        stl << "solid cube\n";
+        for (size_t f = 0; f != m.face.size(); ++f)
+        {
+            stl << "facet normal 0 0 0\nouter loop\n";
+            for (int k = 0; k != 3; ++k)
+                stl << "vertex " << m.face[f]->vertices[k]->coords.transpose() << "\n";
+            stl << "endloop\nendfacet\n";
+        }
+        stl << "endsolid cube\n";
+    }
+    gsIndexedMesh<> sm;
+    passed = passed && gsReadStl("indexedMesh_cube.stl", sm)
+        && sm.numVertices() == 8 && sm.numFaces() == 12 && 0 == checkHalfEdges(sm);
+
+    // Feature detection from the half-edges, a closed and an open mesh
+    passed = passed && sameFeatures(sm);
+    gsIndexedMesh<> open;
+    for (index_t v = 0; v != sm.numVertices(); ++v)
+        open.addVertex(sm.coord(v,0), sm.coord(v,1), sm.coord(v,2));
+    for (index_t f = 0; f != sm.numFaces() - 2; ++f)
+        open.addFace(sm.faceVertices(f), 3);
+    open.computeHalfEdges();
+    passed = passed && sameFeatures(open);
+    std::remove("indexedMesh_cube.stl");
+
+    if ( !passed )
+    {
+        gsWarn << "The indexed meshes are not consistent.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+/** @file invertPoints.cpp
+
+    @brief Inverts points on planar and surface patches, with the
+    batched gsGeometry::invertPoints and with a Newton iteration per
+    point started from the parameter center.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Inverts random points of geo; returns the maximum parametric error
+// of the batched inversion
+real_t testInversion(const gsGeometry<> & geo, int numPoints)
+{
+    const gsMatrix<> supp = geo.support();
+    gsMatrix<> pars = gsMatrix<>::Random(geo.parDim(), numPoints);
+    for (index_t i = 0; i != pars.rows(); ++i)
+        pars.row(i) = ( (pars.row(i).array() + 1) / 2 ) * (supp(i,1) - supp(i,0))
+            + supp(i,0);
+    gsMatrix<> pts, res0(geo.parDim(), numPoints), res1;
+    geo.eval_into(pars, pts);
+
+    gsStopwatch time;
+    gsVector<> arg;
+    index_t failed0 = 0;
+    for (index_t i = 0; i != numPoints; ++i)
+    {
+        arg = geo.parameterCenter();
+        if ( -1 == geo.newtonRaphson(pts.col(i), arg, true, 1e-10, 100) )
+            ++failed0;
+        res0.col(i) = arg;
+    }
+    const real_t t0 = time.stop();
+
+    time.restart();
+    gsVector<index_t> status;
+    geo.invertPoints(pts, res1, status, 1e-10);
+    const real_t t1 = time.stop();
+    const index_t failed1 = (status.array() == -1).count();
+
+    const real_t err0 = (res0 - pars).cwiseAbs().maxCoeff();
+    const real_t err1 = (res1 - pars).cwiseAbs().maxCoeff();
+
+    gsInfo << "  per point: " << t0 << " s, " << failed0 << " not converged, error " << err0 << "\n";
+    gsInfo << "  batched  : " << t1 << " s, " << failed1 << " not converged, error " << err1
+           << " (" << status.maxCoeff() << " iterations at most)\n";
+    return err1;
+}
+
+int main(int argc, char *argv[])
+{
+    int numPoints = 10000;
+
+    gsCmdLine cmd("Inversion of points on geometries.");
+    cmd.addInt("n", "points", "Number of points to invert", numPoints);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    real_t err = 0;
+
+    // Planar patch
+    gsTensorNurbs<2> * annulus = gsNurbsCreator<>::NurbsQuarterAnnulus();
+    gsInfo << "Quarter annulus:\n";
+    err = math::max(err, testInversion(*annulus, numPoints));
+    delete annulus;
+
+    // Wavy surface in 3D
+    gsTensorBSpline<2> * surf = gsNurbsCreator<>::BSplineSquare(3);
+    surf->uniformRefine(3);
+    gsMatrix<> & coefs = surf->coefs();
+    coefs.conservativeResize(Eigen::NoChange, 3);
+    coefs.col(2) = 0.2 * ( coefs.col(0).array() * 6 ).sin() * ( coefs.col(1).array() * 4 ).cos();
+    gsInfo << "Surface:\n";
+    err = math::max(err, testInversion(*surf, numPoints));
+    delete surf;
+
+    // A few points on a fine patch, the sampling is cheap
+    annulus = gsNurbsCreator<>::NurbsQuarterAnnulus();
+    annulus->uniformRefine(127);
+    gsInfo << "Refined quarter annulus, " << annulus->coefsSize() << " coefficients:\n";
+    err = math::max(err, testInversion(*annulus, 5));
+    delete annulus;
+
+    // A square flattened to a segment has singular Jacobians, the
+    // inversions fail instead of giving invalid parameters
+    gsTensorBSpline<2> * flat = gsNurbsCreator<>::BSplineSquare(2);
+    flat->coefs().col(1).setZero();
+    gsMatrix<> fpts = gsMatrix<>::Random(2, 100), fres;
+    fpts.row(1).setZero();
+    gsVector<index_t> fstatus;
+    flat->invertPoints(fpts, fres, fstatus, 1e-10);
+    delete flat;
+    const bool flatFailed = (fstatus.array() == -1).all() && fres.allFinite();
+    gsInfo << "Flat square: " << (fstatus.array() == -1).count() << " of "
+           << fpts.cols() << " points failed\n";
+
+    if ( err > 1e-6 || !flatFailed )
+    {
+        gsWarn << "The batched inversion failed.\n";
+        return 1;
+    }
+    return 0;
+}
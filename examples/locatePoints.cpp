@@ -0,0 +1,118 @@
+/** @file locatePoints.cpp
+
+    @brief Finds the patches and the parameters of physical points on
+    a multipatch domain, with gsMultiPatch::locatePoints and by
+    inverting every point on every patch.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    int numPatches = 4;
+    int numPoints  = 1000;
+
+    gsCmdLine cmd("Point location on multipatch domains.");
+    cmd.addInt("m", "patches", "Number of patches per direction", numPatches);
+    cmd.addInt("n", "points", "Number of points to locate", numPoints);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    // Grid of curved patches on [0,m]^2
+    gsMultiPatch<> * grid = gsNurbsCreator<>::BSplineSquareGrid(numPatches, numPatches);
+    gsMultiPatch<> mp;
+    for (size_t p = 0; p != grid->nPatches(); ++p)
+    {
+        gsGeometry<> & g = grid->patch(p);
+        g.degreeElevate(1);
+        g.uniformRefine(1);
+        gsMatrix<> & cc = g.coefs();
+        // Smooth perturbation which keeps the interfaces conforming
+        cc.col(0).array() += 0.1 * ( cc.col(1).array() * 2 ).sin();
+        cc.col(1).array() += 0.1 * ( cc.col(0).array() * 3 ).sin();
+        mp.addPatch(g);
+    }
+    delete grid;
+    mp.computeTopology();
+
+    // Random parameters on random patches, and points outside
+    gsMatrix<> pars = ( gsMatrix<>::Random(2, numPoints).array() + 1 ) / 2;
+    gsMatrix<> pts(2, numPoints), tmp;
+    gsVector<index_t> patch(numPoints);
+    for (index_t i = 0; i != numPoints; ++i)
+    {
+        patch[i] = std::rand() % mp.nPatches();
+        mp.patch(patch[i]).eval_into(pars.col(i), tmp);
+        pts.col(i) = tmp;
+    }
+    for (index_t i = 0; i < numPoints; i += 10)
+    {
+        pts(0, i) = -1;   // outside of the domain
+        patch[i]  = -1;
+    }
+
+    // Inversion on every patch
+    gsStopwatch time;
+    gsVector<index_t> pids0(numPoints), status;
+    pids0.setConstant(-1);
+    gsMatrix<> vals;
+    for (size_t p = 0; p != mp.nPatches(); ++p)
+    {
+        mp.patch(p).invertPoints(pts, tmp, status, 1e-10);
+        mp.patch(p).eval_into(tmp, vals);
+        for (index_t i = 0; i != numPoints; ++i)
+            if ( -1 == pids0[i] && (vals.col(i) - pts.col(i)).norm() < 1e-8 )
+                pids0[i] = p;
+    }
+    const real_t t0 = time.stop();
+
+    // Located by the bounding volume hierarchy
+    time.restart();
+    gsVector<index_t> pids1;
+    gsMatrix<> preim;
+    mp.locatePoints(pts, pids1, preim, 1e-8);
+    const real_t t1 = time.stop();
+
+    // Check the result
+    index_t wrong = 0;
+    real_t err = 0;
+    for (index_t i = 0; i != numPoints; ++i)
+    {
+        if ( pids1[i] != pids0[i] )
+            ++wrong;
+        if ( -1 == pids1[i] )
+        {
+            if ( -1 != patch[i] ) ++wrong;
+            continue;
+        }
+        mp.patch(pids1[i]).eval_into(preim.col(i), tmp);
+        err = math::max(err, (tmp - pts.col(i)).norm() );
+    }
+
+    gsInfo << mp.nPatches() << " patches, " << numPoints << " points\n";
+    gsInfo << "Inversion on every patch: " << t0 << " s\n";
+    gsInfo << "locatePoints            : " << t1 << " s\n";
+    gsInfo << "Differences: " << wrong << ", maximum distance: " << err << "\n";
+
+    if ( wrong != 0 || err > 1e-8 )
+    {
+        gsWarn << "The point location failed.\n";
+        return 1;
+    }
+    return 0;
+}
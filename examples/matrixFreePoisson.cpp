@@ -0,0 +1,175 @@
+/** @file matrixFreePoisson.cpp
+
+    @brief Solves a Poisson problem by conjugate gradients, once with
+    the assembled matrix and once with the matrix-free operator, and
+    compares memory usage and throughput of the operator application.
+    With OpenMP, the threaded matrix-free application is compared with
+    the serial one.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+#include <gsAssembler/gsMatrixFreeOp.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    int dim      = 2;
+    int deg      = 3;
+    int numRef   = 3;
+    int numApply = 10;
+    bool parallel = false;
+
+    gsCmdLine cmd("Matrix-free versus assembled Poisson operator.");
+    cmd.addInt("d", "dim", "Parametric dimension (2 or 3)", dim);
+    cmd.addInt("p", "degree", "Degree of the basis", deg);
+    cmd.addInt("r", "refine", "Number of uniform refinement steps", numRef);
+    cmd.addInt("n", "apply", "Number of operator applications to time", numApply);
+    cmd.addSwitch("parallel", "Use threading::parallel for the assembly and the matrix-free operator", parallel);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    if ( dim != 2 && dim != 3 )
+    {
+        gsWarn << "Dimension must be 2 or 3.\n";
+        return 0;
+    }
+
+    gsGeometry<> * geo;
+    if ( dim == 2 )
+    {
+        gsTensorBSpline<2> * sq = gsNurbsCreator<>::BSplineSquare(2);
+        sq->coefs().col(0).array() += 0.2 * sq->coefs().col(1).array().square();
+        geo = sq;
+    }
+    else
+    {
+        gsTensorBSpline<3> * cb = gsNurbsCreator<>::BSplineCube(2);
+        cb->coefs().col(0).array() += 0.2 * cb->coefs().col(2).array().square();
+        geo = cb;
+    }
+    gsMultiPatch<> patches(*geo);
+    delete geo;
+
+    // Dirichlet conditions, and a Neumann condition on the east side
+    gsFunctionExpr<> f("1", dim);
+    gsFunctionExpr<> g("0", dim);
+    gsFunctionExpr<> h("1", dim);
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator bit = patches.bBegin(); bit != patches.bEnd(); ++bit)
+    {
+        if ( boundary::east == bit->side() )
+            bc.addCondition( *bit, condition_type::neumann, &h );
+        else
+            bc.addCondition( *bit, condition_type::dirichlet, &g );
+    }
+    gsPoissonPde<> pde(patches, bc, f);
+
+    gsMultiBasis<> bases(patches);
+    bases.setDegree(deg);
+    for (int i = 0; i < numRef; ++i)
+        bases.uniformRefine();
+
+    gsAssemblerOptions opt;
+    if ( parallel )
+        opt.thStrategy = threading::parallel;
+
+    // Assembled matrix
+    gsPoissonAssembler<> assembler;
+    assembler.initialize(pde, bases, opt);
+    gsStopwatch time;
+    assembler.assemble();
+    const real_t tAssemble = time.stop();
+    const gsSparseMatrix<> & K = assembler.matrix();
+    gsMatrixOp<gsSparseMatrix<> > matOp(K, true);
+
+    // Matrix-free operator
+    gsPoissonAssembler<> mfAssembler;
+    mfAssembler.initialize(pde, bases, opt);
+    time.restart();
+    gsMatrixFreeOp<gsVisitorPoisson<real_t> > mfOp(mfAssembler);
+    const real_t tSetup = time.stop();
+
+    const size_t matBytes = K.nonZeros() * (sizeof(real_t) + sizeof(index_t))
+        + (K.cols() + 1) * sizeof(index_t);
+
+    gsInfo << "Degrees of freedom: " << K.cols() << ", stored non-zeros: "
+           << K.nonZeros() << "\n";
+    gsInfo << "Memory    assembled: " << matBytes    << " bytes, matrix-free: "
+           << mfOp.bytes() << " bytes\n";
+    gsInfo << "Setup     assembled: " << tAssemble   << " s, matrix-free: "
+           << tSetup << " s\n";
+
+    // Throughput of the operator application
+    gsMatrix<> x = gsMatrix<>::Random(K.cols(), 1), y0, y1;
+    time.restart();
+    for (int i = 0; i < numApply; ++i)
+        matOp.apply(x, y0);
+    const real_t tMat = time.stop() / numApply;
+    time.restart();
+    for (int i = 0; i < numApply; ++i)
+        mfOp.apply(x, y1);
+    const real_t tMf = time.stop() / numApply;
+
+    const real_t errApply = (y0 - y1).norm() / y0.norm();
+    const real_t errRhs   = (assembler.rhs() - mfOp.rhs()).norm() / assembler.rhs().norm();
+    gsInfo << "Apply     assembled: " << tMat << " s, matrix-free: " << tMf
+           << " s (relative difference " << errApply << ")\n";
+
+    real_t errThreads = 0;
+#   ifdef _OPENMP
+    // Threaded matrix-free application, against the serial one
+    gsAssemblerOptions optTh = opt;
+    optTh.thStrategy = threading::deterministic;
+    gsPoissonAssembler<> thAssembler;
+    thAssembler.initialize(pde, bases, optTh);
+    gsMatrixFreeOp<gsVisitorPoisson<real_t> > thOp(thAssembler);
+    gsMatrix<> y2;
+    time.restart();
+    for (int i = 0; i < numApply; ++i)
+        thOp.apply(x, y2);
+    const real_t tTh = time.stop() / numApply;
+    errThreads = (y2 - y1).norm() / y1.norm();
+    gsInfo << "Apply     matrix-free, " << omp_get_max_threads() << " threads: " << tTh
+           << " s (relative difference " << errThreads << ")\n";
+#   endif
+
+    // Conjugate gradients with both operators
+    gsMatrix<> sol0, sol1;
+    sol0.setZero(K.cols(), 1);
+    sol1.setZero(K.cols(), 1);
+    gsConjugateGradient cg0(matOp, 1000, 1e-8);
+    gsConjugateGradient cg1(mfOp , 1000, 1e-8);
+    time.restart();
+    cg0.solve(assembler.rhs(), sol0);
+    const real_t tCg0 = time.stop();
+    time.restart();
+    cg1.solve(mfOp.rhs(), sol1);
+    const real_t tCg1 = time.stop();
+
+    const real_t errSol = (sol0 - sol1).norm() / sol0.norm();
+    gsInfo << "CG        assembled: " << cg0.iterations() << " it. in " << tCg0
+           << " s, matrix-free: " << cg1.iterations() << " it. in " << tCg1
+           << " s (relative difference " << errSol << ")\n";
+
+    if ( errApply > 1e-10 || errRhs > 1e-10 || errSol > 1e-6 || errThreads > 1e-12 )
+    {
+        gsWarn << "The matrix-free result differs from the assembled one.\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+/** @file parallelAssembly.cpp
+
+    @brief Assembles a Poisson problem with every threading strategy
+    and compares the systems to the serial assembly.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    int deg    = 3;
+    int numRef = 4;
+
+    gsCmdLine cmd("Parallel versus serial assembly.");
+    cmd.addInt("p", "degree", "Degree of the basis", deg);
+    cmd.addInt("r", "refine", "Number of uniform refinement steps", numRef);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    gsMultiPatch<> patches( *safe(gsNurbsCreator<>::BSplineSquare(2)) );
+    patches.patch(0).coefs().col(0).array() += 0.2 * patches.patch(0).coefs().col(1).array().square();
+    gsFunctionExpr<> f("sin(x)*y", 2);
+    gsFunctionExpr<> g("x", 2);
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator bit = patches.bBegin(); bit != patches.bEnd(); ++bit)
+        bc.addCondition( *bit, condition_type::dirichlet, &g );
+    gsPoissonPde<> pde(patches, bc, f);
+
+    gsMultiBasis<> bases(patches);
+    bases.setDegree(deg);
+    for (int i = 0; i < numRef; ++i)
+        bases.uniformRefine();
+
+#   ifdef _OPENMP
+    gsInfo << "Threads: " << omp_get_max_threads() << "\n";
+#   else
+    gsInfo << "G+Smo was compiled without OpenMP, all strategies are serial.\n";
+#   endif
+
+    gsAssemblerOptions opt;
+    opt.thStrategy = threading::serial;
+    gsPoissonAssembler<> serial;
+    serial.initialize(pde, bases, opt);
+    serial.assemble();
+    const gsMatrix<> A = serial.matrix().toDense();
+    const gsMatrix<> b = serial.rhs();
+
+    bool passed = true;
+    for (int s = 0; s != 2; ++s)
+    {
+        opt.thStrategy = ( 0 == s ? threading::parallel : threading::deterministic );
+        gsPoissonAssembler<> par;
+        par.initialize(pde, bases, opt);
+        par.assemble();
+
+        // The deterministic strategy pushes in serial order, the
+        // parallel one only up to round-off
+        const gsMatrix<> dA = par.matrix().toDense() - A;
+        const real_t errMat = dA.norm() / A.norm();
+        const real_t errRhs = (par.rhs() - b).norm() / b.norm();
+        gsInfo << ( 0 == s ? "parallel     " : "deterministic" ) << ": relative difference "
+               << errMat << " (matrix), " << errRhs << " (rhs)\n";
+        if ( 0 == s )
+            passed = passed && errMat < 1e-12 && errRhs < 1e-12;
+        else
+            passed = passed && 0 == errMat && 0 == errRhs;
+    }
+
+    if ( !passed )
+    {
+        gsWarn << "The parallel assembly differs from the serial one.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+/** @file paraviewFormats.cpp
+
+    @brief Writes a field to Paraview files in ascii, raw binary and
+    compressed binary format, compares the write times and the file
+    sizes, and checks the 64 bit headers of the appended data.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Size of the file fn in bytes
+long fileSize(const std::string & fn)
+{
+    std::ifstream f(fn.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+    return f.is_open() ? static_cast<long>(f.tellg()) : -1;
+}
+
+// Reads the 64 bit integer at position pos of buf
+unsigned long long getUInt64(const std::string & buf, size_t pos)
+{
+    unsigned long long v = 0;
+    if ( pos + 8 <= buf.size() )
+        std::memcpy(&v, buf.data() + pos, 8);
+    return v;
+}
+
+// Walks the appended data of the file fn, array by array, and
+// returns true if the headers end exactly at the end of the section
+bool checkAppended(const std::string & fn, bool compressed)
+{
+    std::ifstream f(fn.c_str(), std::ios::in | std::ios::binary);
+    const std::string buf( (std::istreambuf_iterator<char>(f)),
+                           std::istreambuf_iterator<char>() );
+    if ( std::string::npos == buf.find("header_type=\"UInt64\"") )
+        return false;
+    const std::string tag = "<AppendedData encoding=\"raw\">\n_";
+    const size_t first = buf.find(tag);
+    const size_t last  = buf.rfind("\n</AppendedData>");
+    if ( std::string::npos == first || std::string::npos == last )
+        return false;
+
+    size_t pos = first + tag.size();
+    while ( pos < last )
+    {
+        if ( !compressed )
+        {
+            pos += 8 + getUInt64(buf, pos);
+            continue;
+        }
+        // Number of blocks, block size, last block size, then the
+        // compressed sizes of the blocks
+        const unsigned long long nb = getUInt64(buf, pos);
+        size_t data = pos + 8 * (3 + nb);
+        for (unsigned long long k = 0; k != nb; ++k)
+            data += getUInt64(buf, pos + 8 * (3 + k));
+        pos = data;
+    }
+    return pos == last;
+}
+
+int main(int argc, char *argv[])
+{
+    int numSamples = 100000;
+
+    gsCmdLine cmd("Paraview output in ascii and binary formats.");
+    cmd.addInt("s", "samples", "Number of sampling points per patch", numSamples);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    gsTensorNurbs<2> * annulus = gsNurbsCreator<>::NurbsQuarterAnnulus();
+    gsMultiPatch<> mp(*annulus);
+    delete annulus;
+    gsFunctionExpr<> f("sin(3*x)*cos(2*y)", "x*y", 2);
+    gsField<> field(mp, f, false);
+
+    const char * names[3] = {"ascii", "binary", "compressed"};
+    const vtkFormat::type fmts[3] = {vtkFormat::ascii, vtkFormat::binary, vtkFormat::compressed};
+
+    gsInfo << "Field with " << numSamples << " points:\n";
+    gsStopwatch time;
+    long sizes[3];
+    for (int k = 0; k != 3; ++k)
+    {
+        const std::string fn = std::string("paraviewFormats_") + names[k];
+        time.restart();
+        gsWriteParaview(field, fn, numSamples, false, fmts[k]);
+        const real_t t = time.stop();
+        sizes[k] = fileSize(fn + "0.vts");
+        gsInfo << "  " << names[k] << ": " << t << " s, " << sizes[k] << " bytes\n";
+    }
+
+    // The global default applies to calls without a format
+    gsWriteParaviewSetFormat(vtkFormat::compressed);
+    gsWriteParaview(field, "paraviewFormats_default", numSamples);
+    gsWriteParaviewSetFormat(vtkFormat::ascii);
+    const long defSize = fileSize("paraviewFormats_default0.vts");
+
+    if ( sizes[0] <= 0 || sizes[1] <= 0 || sizes[2] <= 0 ||
+         sizes[1] >= sizes[0] || defSize != sizes[2] )
+    {
+        gsWarn << "Unexpected file sizes.\n";
+        return 1;
+    }
+
+    if ( !checkAppended("paraviewFormats_binary0.vts", false) ||
+         !checkAppended("paraviewFormats_compressed0.vts", true) )
+    {
+        gsWarn << "Invalid headers of the appended data.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+/** @file paraviewParallel.cpp
+
+    @brief Writes a field on a multipatch domain to Paraview files,
+    with one thread and with all threads, checks that the files are
+    the same and that exceptions of the threads reach the caller.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Contents of the file fn
+std::string fileContents(const std::string & fn)
+{
+    std::ifstream f(fn.c_str(), std::ios::in | std::ios::binary);
+    std::ostringstream res;
+    res << f.rdbuf();
+    return res.str();
+}
+
+// A function which cannot be evaluated right of x = 1
+class gsFailingFunction : public gsFunction<real_t>
+{
+public:
+    int domainDim() const { return 2; }
+
+    void eval_into(const gsMatrix<real_t> & u, gsMatrix<real_t> & result) const
+    {
+        if ( (u.row(0).array() > 1).any() )
+            throw std::runtime_error("evaluation failed");
+        result = u.row(0);
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    int numPatches = 6;
+    int numSamples = 10000;
+
+    gsCmdLine cmd("Parallel Paraview output of multipatch fields.");
+    cmd.addInt("m", "patches", "Number of patches per direction", numPatches);
+    cmd.addInt("s", "samples", "Number of sampling points per patch", numSamples);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    gsMultiPatch<> * mp = gsNurbsCreator<>::BSplineSquareGrid(numPatches, numPatches);
+    gsFunctionExpr<> f("sin(3*x)*cos(2*y)", 2);
+    gsField<> field(*mp, f, false);
+
+    int numThreads = 1;
+#   ifdef _OPENMP
+    numThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#   endif
+    gsStopwatch time;
+    gsWriteParaview(field, "paraviewParallel_serial", numSamples, false, vtkFormat::binary);
+    const real_t t0 = time.stop();
+
+#   ifdef _OPENMP
+    omp_set_num_threads(numThreads);
+#   endif
+    time.restart();
+    gsWriteParaview(field, "paraviewParallel_threads", numSamples, false, vtkFormat::binary);
+    const real_t t1 = time.stop();
+
+    gsInfo << mp->nPatches() << " patches, " << numSamples << " points per patch\n";
+    gsInfo << "1 thread  : " << t0 << " s\n";
+    gsInfo << numThreads << " threads : " << t1 << " s\n";
+
+    index_t diff = 0;
+    for (size_t i = 0; i != mp->nPatches(); ++i)
+    {
+        const std::string k = internal::toString(i) + ".vts";
+        if ( fileContents("paraviewParallel_serial"  + k) !=
+             fileContents("paraviewParallel_threads" + k) )
+            ++diff;
+    }
+
+    // An exception in one of the threads reaches the caller
+    gsFailingFunction g;
+    gsField<> failing(*mp, g, false);
+    bool caught = false;
+    try
+    {
+        gsWriteParaview(failing, "paraviewParallel_failing", 100, false, vtkFormat::binary);
+    }
+    catch (std::exception & e)
+    {
+        caught = ( std::string(e.what()) == "evaluation failed" );
+    }
+    delete mp;
+
+    if ( diff != 0 )
+    {
+        gsWarn << diff << " files differ.\n";
+        return 1;
+    }
+    if ( !caught )
+    {
+        gsWarn << "The exception of the writer was lost.\n";
+        return 1;
+    }
+    return 0;
+}
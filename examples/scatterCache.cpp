@@ -0,0 +1,109 @@
+/** @file scatterCache.cpp
+
+    @brief Re-assembles a Poisson problem on a changing geometry with
+    the scatter cache of the sparse system, and compares the systems
+    to fresh assemblies.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    int deg     = 2;
+    int numRef  = 3;
+    int numStep = 4;
+
+    gsCmdLine cmd("Re-assembly with the scatter cache.");
+    cmd.addInt("p", "degree", "Degree of the basis", deg);
+    cmd.addInt("r", "refine", "Number of uniform refinement steps", numRef);
+    cmd.addInt("s", "steps", "Number of re-assemblies", numStep);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    gsMultiPatch<> patches( *safe(gsNurbsCreator<>::BSplineSquare(2)) );
+    gsFunctionExpr<> f("1", 2);
+    gsFunctionExpr<> g("0", 2);
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator bit = patches.bBegin(); bit != patches.bEnd(); ++bit)
+        bc.addCondition( *bit, condition_type::dirichlet, &g );
+    gsPoissonPde<> pde(patches, bc, f);
+
+    gsMultiBasis<> bases(patches);
+    bases.setDegree(deg);
+    for (int i = 0; i < numRef; ++i)
+        bases.uniformRefine();
+
+    bool passed = true;
+
+    // The cached assembler is refreshed and re-assembled on a
+    // geometry which changes in every step
+    gsPoissonAssembler<> cached;
+    cached.setScatterCache(true);
+    cached.initialize(pde, bases);
+    gsMatrix<> & coefs = pde.domain().patch(0).coefs();
+    for (int s = 0; s <= numStep; ++s)
+    {
+        coefs.col(0).array() += 0.05 * coefs.col(1).array().square();
+
+        if ( 0 != s )
+            cached.refresh();
+        cached.assemble();
+
+        gsPoissonAssembler<> fresh;
+        fresh.initialize(pde, bases);
+        fresh.assemble();
+
+        const real_t errMat = (cached.matrix() - fresh.matrix()).norm() / fresh.matrix().norm();
+        const real_t errRhs = (cached.rhs() - fresh.rhs()).norm() / fresh.rhs().norm();
+        gsInfo << "Step " << s << ": relative difference " << errMat
+               << " (matrix), " << errRhs << " (rhs)\n";
+        passed = passed && errMat < 1e-12 && errRhs < 1e-12
+            && cached.system().scatterCached();
+    }
+
+    // Pushes which do not match the recorded ones switch the cache
+    // off, the values are added by search instead
+    gsDofMapper mapper;
+    bases.getMapper(dirichlet::elimination, iFace::glue, bc, mapper, 0);
+    gsSparseSystem<> sys(mapper);
+    sys.computePattern(std::vector<gsMultiBasis<> >(1, bases));
+    sys.setScatterCache(true);
+    const index_t n = sys.matrix().cols();
+    gsMatrix<> one(1,1);
+    gsMatrix<unsigned> act(1,1);
+    for (int pass = 0; pass != 3; ++pass)
+    {
+        sys.setValuesZero();
+        one(0,0) = pass + 1;
+        for (index_t i = 0; i != n; ++i)
+        {
+            act(0,0) = ( 2 == pass ? n - 1 - i : i ); // reversed in the last pass
+            sys.pushToMatrixAllFree(one, act);
+        }
+        passed = passed && sys.scatterCached() == (2 != pass);
+    }
+    const gsMatrix<> A = sys.matrix().toDense();
+    passed = passed && A == 3 * gsMatrix<>::Identity(n, n);
+
+    if ( !passed )
+    {
+        gsWarn << "The re-assembled systems differ from fresh assemblies.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+/** @file stlReader.cpp
+
+    @brief Writes a triangle mesh as ASCII and as binary STL file,
+    reads both back and checks that they give the same mesh.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <gismo.h>
+
+using namespace gismo;
+
+// The triangles of a wavy n x n grid, with coordinates which are
+// exact in single precision
+std::vector<gsVector3d<real_t> > triangles(int n)
+{
+    std::vector<gsVector3d<real_t> > tri;
+    for (int i = 0; i != n; ++i)
+        for (int j = 0; j != n; ++j)
+        {
+            const int c[6][2] = { {i,j}, {i+1,j}, {i+1,j+1},
+                                  {i,j}, {i+1,j+1}, {i,j+1} };
+            for (int k = 0; k != 6; ++k)
+                tri.push_back( gsVector3d<real_t>(
+                        c[k][0] / 4.0, c[k][1] / 4.0, ((c[k][0] * c[k][1]) % 7) / 8.0 ) );
+        }
+    return tri;
+}
+
+void writeAscii(const std::string & fn, const std::vector<gsVector3d<real_t> > & tri)
+{
+    std::ofstream file(fn.c_str());
+    file << "solid grid\n";
+    for (size_t t = 0; t != tri.size(); t += 3)
+    {
+        // Keywords are not case sensitive
+        file << "  FACET NORMAL 0 0 1\n    OUTER LOOP\n";
+        for (int k = 0; k != 3; ++k)
+            file << "      VERTEX " << tri[t+k].x() << " " << tri[t+k].y() << " "
+                 << tri[t+k].z() << "\n";
+        file << "    ENDLOOP\n  ENDFACET\n";
+    }
+    file << "endsolid grid\n";
+}
+
+void putU32(std::ofstream & file, unsigned v)
+{
+    char b[4];
+    for (int k = 0; k != 4; ++k, v >>= 8)
+        b[k] = static_cast<char>(v & 255);
+    file.write(b, 4);
+}
+
+void writeBinary(const std::string & fn, const std::vector<gsVector3d<real_t> > & tri)
+{
+    std::ofstream file(fn.c_str(), std::ios::binary);
+    // The header may start with "solid" as well
+    char header[80] = "solid grid, binary";
+    file.write(header, 80);
+    putU32(file, tri.size() / 3);
+    for (size_t t = 0; t != tri.size(); t += 3)
+    {
+        for (int k = 0; k != 3; ++k)  // normal
+            putU32(file, 0);
+        for (int k = 0; k != 3; ++k)
+            for (int i = 0; i != 3; ++i)
+            {
+                const float f = static_cast<float>(tri[t+k][i]);
+                unsigned v;
+                std::memcpy(&v, &f, 4);
+                putU32(file, v);
+            }
+        file.write("\0\0", 2);         // attribute
+    }
+}
+
+// Returns true if the faces of a and b have the same vertices
+bool sameMesh(const gsMesh<> & a, const gsMesh<> & b)
+{
+    if ( a.vertex.size() != b.vertex.size() || a.face.size() != b.face.size() )
+        return false;
+    for (size_t i = 0; i != a.face.size(); ++i)
+    {
+        if ( a.face[i]->vertices.size() != b.face[i]->vertices.size() )
+            return false;
+        for (size_t j = 0; j != a.face[i]->vertices.size(); ++j)
+            if ( a.face[i]->vertices[j]->getId() != b.face[i]->vertices[j]->getId() ||
+                 !( *a.face[i]->vertices[j] == *b.face[i]->vertices[j] ) )
+                return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 20;
+
+    gsCmdLine cmd("Reading of ASCII and binary STL files.");
+    cmd.addInt("n", "size", "Number of grid cells per direction", n);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    const std::vector<gsVector3d<real_t> > tri = triangles(n);
+    const std::string ascii  = "stlReader_ascii.stl";
+    const std::string binary = "stlReader_binary.stl";
+    writeAscii (ascii , tri);
+    writeBinary(binary, tri);
+
+    bool passed = true;
+
+    // Welded during loading
+    gsMesh<> ma, mb;
+    passed = passed && gsReadStl(ascii, ma) && gsReadStl(binary, mb);
+    gsInfo << "ASCII: " << ma << "Binary: " << mb;
+    passed = passed && sameMesh(ma, mb)
+        && static_cast<int>(ma.vertex.size()) == (n + 1) * (n + 1)
+        && static_cast<int>(ma.face.size())   == 2 * n * n;
+    for (size_t i = 0; passed && i != ma.face.size(); ++i)
+        for (int k = 0; k != 3; ++k)
+            passed = passed && ma.face[i]->vertices[k]->coords == tri[3*i+k];
+
+    // Without welding
+    gsMesh<> ua;
+    passed = passed && gsReadStl(ascii, ua, false)
+        && ua.vertex.size() == tri.size();
+
+    // Through gsFileData, and welded after reading
+    gsFileData<> fa(ascii), fb(binary);
+    gsMesh<> * xa = fa.getFirst< gsMesh<> >();
+    gsMesh<> * xb = fb.getFirst< gsMesh<> >();
+    passed = passed && xa && xb;
+    if ( passed )
+    {
+        xa->cleanStlMesh(0, true);
+        xb->cleanStlMesh(0, true);
+        passed = sameMesh(*xa, ma) && sameMesh(*xb, ma);
+    }
+    delete xa;
+    delete xb;
+
+    std::remove(ascii.c_str());
+    std::remove(binary.c_str());
+
+    if ( !passed )
+    {
+        gsWarn << "The STL files were not read back correctly.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+/** @file stlWelding.cpp
+
+    @brief Welds the duplicate vertices of a triangle soup, as read
+    from an STL file, and compares with a quadratic time search.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// A triangle soup of a wavy n x n grid: every triangle has its own
+// three vertices, perturbed by at most eps
+gsMesh<> * triangleSoup(int n, real_t eps)
+{
+    gsMesh<> * m = new gsMesh<>;
+    gsMatrix<> jitter;
+    for (int i = 0; i != n; ++i)
+        for (int j = 0; j != n; ++j)
+        {
+            const int c[6][2] = { {i,j}, {i+1,j}, {i+1,j+1},
+                                  {i,j}, {i+1,j+1}, {i,j+1} };
+            jitter.setRandom(3, 6);
+            jitter *= eps;
+            for (int t = 0; t != 2; ++t)
+            {
+                gsMesh<>::VertexHandle v[3];
+                for (int k = 0; k != 3; ++k)
+                {
+                    const real_t x = c[3*t+k][0], y = c[3*t+k][1];
+                    v[k] = m->addVertex(x + jitter(0,3*t+k), y + jitter(1,3*t+k),
+                                        math::sin(x) * math::cos(y) + jitter(2,3*t+k));
+                }
+                m->addFace(v[0], v[1], v[2]);
+            }
+        }
+    return m;
+}
+
+// The number of distinct vertices found by comparing every vertex
+// to all previous ones, as cleanStlMesh did
+int quadraticCount(const gsMesh<> & m)
+{
+    int count = 0;
+    for (size_t i = 0; i < m.vertex.size(); ++i)
+    {
+        size_t buddy = i;
+        for (size_t j = 0; j < i; ++j)
+            if ( *m.vertex[i] == *m.vertex[j] )
+            {
+                buddy = j;
+                break;
+            }
+        if ( buddy == i )
+            ++count;
+    }
+    return count;
+}
+
+// The number of distinct vertices used by the faces
+int usedCount(const gsMesh<> & m)
+{
+    std::vector<gsMesh<>::VertexHandle> used;
+    for (size_t i = 0; i != m.face.size(); ++i)
+        used.insert(used.end(), m.face[i]->vertices.begin(), m.face[i]->vertices.end());
+    std::sort(used.begin(), used.end());
+    return std::unique(used.begin(), used.end()) - used.begin();
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 30;
+
+    gsCmdLine cmd("Welding of the vertices of a triangle soup.");
+    cmd.addInt("n", "size", "Number of grid cells per direction", n);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    const int numFaces = 2 * n * n;
+    const int expected = (n + 1) * (n + 1);
+    bool passed = true;
+
+    // Exact welding, against the quadratic search
+    gsMesh<> * m = triangleSoup(n, 0);
+    const int reference = quadraticCount(*m);
+    m->cleanStlMesh();
+    gsInfo << "Exact welding: " << usedCount(*m) << " vertices (reference "
+           << reference << "), " << m->face.size() << " faces\n";
+    passed = passed && usedCount(*m) == reference && reference == expected
+        && static_cast<int>(m->face.size()) == numFaces;
+    delete m;
+
+    // Compacting deletes the duplicates and renumbers the vertices
+    m = triangleSoup(n, 0);
+    m->cleanStlMesh(0, true);
+    bool consistent = static_cast<int>(m->vertex.size()) == m->numVertices;
+    for (size_t i = 0; i != m->vertex.size(); ++i)
+        consistent = consistent && m->vertex[i]->getId() == static_cast<int>(i);
+    for (size_t i = 0; i != m->face.size(); ++i)
+        for (size_t j = 0; j != m->face[i]->vertices.size(); ++j)
+        {
+            const gsMesh<>::VertexHandle v = m->face[i]->vertices[j];
+            consistent = consistent && m->vertex[v->getId()] == v;
+        }
+    gsInfo << "Compacted: " << m->numVertices << " vertices, "
+           << m->face.size() << " faces\n";
+    passed = passed && consistent && m->numVertices == expected
+        && usedCount(*m) == expected && static_cast<int>(m->face.size()) == numFaces;
+    delete m;
+
+    // Welding with a tolerance the vertices of a perturbed soup
+    m = triangleSoup(n, 1e-9);
+    m->cleanStlMesh(1e-6, true);
+    gsInfo << "Welding with tolerance: " << m->numVertices << " vertices\n";
+    passed = passed && m->numVertices == expected && usedCount(*m) == expected;
+    delete m;
+
+    if ( !passed )
+    {
+        gsWarn << "Welding gave wrong vertex or face counts.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+/** @file sumFactorization.cpp
+
+    @brief Compares the standard and the sum-factorization assembly of
+    the mass and stiffness matrices of tensor-product B-spline bases.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+#include <gsAssembler/gsVisitorTPpoisson.h>
+
+using namespace gismo;
+
+// Assembles the Poisson system using the volume visitor Visitor and
+// returns the time spent in the volume integrals
+template<class Visitor>
+real_t assemblePoisson(const gsPoissonPde<> & pde, const gsMultiBasis<> & bases,
+                       gsSparseMatrix<> & mat, gsMatrix<> & rhs)
+{
+    gsPoissonAssembler<> assembler;
+    assembler.initialize(pde, bases);
+
+    assembler.computeDirichletDofs();
+    gsStopwatch time;
+    assembler.template push<Visitor>();
+    assembler.finalize();
+    const real_t elapsed = time.stop();
+
+    mat = assembler.matrix();
+    rhs = assembler.rhs();
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    int dim    = 2;
+    int maxDeg = 4;
+    int numRef = 2;
+
+    gsCmdLine cmd("Benchmark of the sum-factorization assembly for tensor-product B-splines.");
+    cmd.addInt("d", "dim", "Parametric dimension (2 or 3)", dim);
+    cmd.addInt("p", "degree", "Maximum degree of the basis", maxDeg);
+    cmd.addInt("r", "refine", "Number of uniform refinement steps", numRef);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    if ( dim != 2 && dim != 3 )
+    {
+        gsWarn << "Dimension must be 2 or 3.\n";
+        return 0;
+    }
+
+    // A curved domain, so that the geometry enters the integrals
+    gsGeometry<> * geo;
+    if ( dim == 2 )
+    {
+        gsTensorBSpline<2> * sq = gsNurbsCreator<>::BSplineSquare(2);
+        sq->coefs().col(0).array() += 0.2 * sq->coefs().col(1).array().square();
+        geo = sq;
+    }
+    else
+    {
+        gsTensorBSpline<3> * cb = gsNurbsCreator<>::BSplineCube(2);
+        cb->coefs().col(0).array() += 0.2 * cb->coefs().col(2).array().square();
+        geo = cb;
+    }
+    gsMultiPatch<> patches(*geo);
+    delete geo;
+
+    gsFunctionExpr<> f("1", dim);
+    gsFunctionExpr<> g("0", dim);
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator bit = patches.bBegin(); bit != patches.bEnd(); ++bit)
+        bc.addCondition( *bit, condition_type::dirichlet, &g );
+    gsPoissonPde<> pde(patches, bc, f);
+
+    gsInfo << "Degree |  Mass: standard  sum-fact.  |  Poisson: standard  sum-fact.  | max. difference\n";
+
+    int crossover = -1;
+    for (int p = 1; p <= maxDeg; ++p)
+    {
+        gsMultiBasis<> bases(patches);
+        bases.setDegree(p);
+        for (int i = 0; i < numRef; ++i)
+            bases.uniformRefine();
+
+        // Mass matrix
+        gsGenericAssembler<real_t> massAssembler(patches, bases, gsAssemblerOptions(), &bc);
+        gsStopwatch time;
+        gsSparseMatrix<> M0 = massAssembler.assembleMass();
+        const real_t tm0 = time.stop();
+        time.restart();
+        gsSparseMatrix<> M1 = massAssembler.assembleMass2();
+        const real_t tm1 = time.stop();
+
+        // Poisson system
+        gsSparseMatrix<> K0, K1;
+        gsMatrix<>       b0, b1;
+        const real_t tk0 = assemblePoisson<gsVisitorPoisson<real_t> >  (pde, bases, K0, b0);
+        const real_t tk1 = assemblePoisson<gsVisitorTPpoisson<real_t> >(pde, bases, K1, b1);
+
+        const real_t err = math::max( math::max( (M0-M1).norm() / M0.norm(),
+                                                 (K0-K1).norm() / K0.norm() ),
+                                      (b0-b1).norm() / b0.norm() );
+
+        gsInfo << "  " << p << "    |  " << tm0 << "  " << tm1
+               << "  |  " << tk0 << "  " << tk1 << "  | " << err << "\n";
+
+        // Smallest degree from which on sum-factorization is faster
+        if ( tk1 >= tk0 )
+            crossover = -1;
+        else if ( crossover == -1 )
+            crossover = p;
+
+        if ( err > 1e-10 )
+        {
+            gsWarn << "The sum-factorization result differs from the standard one.\n";
+            return 1;
+        }
+    }
+
+    if ( crossover != -1 )
+        gsInfo << "Sum-factorization is faster for the Poisson system from degree "
+               << crossover << " on.\n";
+    else
+        gsInfo << "Sum-factorization was not faster up to degree " << maxDeg << ".\n";
+
+    return 0;
+}
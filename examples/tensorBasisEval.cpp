@@ -0,0 +1,154 @@
+/** @file tensorBasisEval.cpp
+
+    @brief Benchmark of the evaluation of tensor-product B-spline
+    bases (values, gradients and Hessians) at the quadrature nodes of
+    all elements.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Row-wise evaluation of the tensor functions and their first and
+// second derivatives, as done by gsTensorBasis before the fused kernel
+template<unsigned d>
+void rowWise(const gsTensorBasis<d,real_t> & basis, const gsMatrix<> & u,
+             std::vector<gsMatrix<> > & result)
+{
+    std::vector< gsMatrix<> > values[d];
+    gsVector<unsigned, d> v, nb_cwise;
+    for (unsigned i = 0; i < d; ++i)
+    {
+        basis.component(i).evalAllDers_into( u.row(i), 2, values[i] );
+        nb_cwise[i] = values[i].front().rows();
+    }
+    const index_t nb = nb_cwise.prod();
+    const index_t stride = d + d*(d-1)/2;
+    result.resize(3);
+    result[0].resize(nb, u.cols());
+    result[1].resize(d*nb, u.cols());
+    result[2].resize(stride*nb, u.cols());
+
+    v.setZero();
+    index_t r = 0;
+    do
+    {
+        result[0].row(r) = values[0][0].row(v[0]);
+        for (unsigned i = 1; i != d; ++i)
+            result[0].row(r).array() *= values[i][0].row(v[i]).array();
+
+        index_t m = d;
+        for (unsigned k = 0; k != d; ++k)
+        {
+            result[1].row(r*d+k) = values[k][1].row(v[k]);
+            result[2].row(r*stride+k) = values[k][2].row(v[k]);
+            for (unsigned i = 0; i != d; ++i)
+                if ( i != k )
+                {
+                    result[1].row(r*d+k).array()      *= values[i][0].row(v[i]).array();
+                    result[2].row(r*stride+k).array() *= values[i][0].row(v[i]).array();
+                }
+
+            for (unsigned l = k+1; l < d; ++l, ++m)
+            {
+                result[2].row(r*stride+m) =
+                    values[k][1].row(v[k]).cwiseProduct(values[l][1].row(v[l]));
+                for (unsigned i = 0; i != d; ++i)
+                    if ( i != k && i != l )
+                        result[2].row(r*stride+m).array() *= values[i][0].row(v[i]).array();
+            }
+        }
+        ++r;
+    } while (nextLexicographic(v, nb_cwise));
+}
+
+// Evaluates on all elements, returns the time for the row-wise, the
+// fused points-major and the fused functions-major evaluation and the
+// maximum difference of the results
+template<unsigned d>
+void benchmark(int deg, int numElem, real_t times[3], real_t & err)
+{
+    gsKnotVector<> kv(0, 1, numElem - 1, deg + 1);
+    std::vector<gsKnotVector<> > kvs(d, kv);
+    gsTensorBSplineBasis<d,real_t> basis(kvs);
+
+    gsVector<index_t> numNodes(d);
+    numNodes.setConstant(deg + 1);
+    gsGaussRule<> rule(numNodes);
+    gsMatrix<> nodes;
+    gsVector<> weights;
+
+    std::vector<gsMatrix<> > r0, r1, r2;
+    times[0] = times[1] = times[2] = 0;
+    err = 0;
+
+    typename gsBasis<>::domainIter domIt = basis.makeDomainIterator();
+    for (; domIt->good(); domIt->next() )
+    {
+        rule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), nodes, weights);
+
+        gsStopwatch time;
+        rowWise<d>(basis, nodes, r0);
+        times[0] += time.stop();
+        time.restart();
+        basis.evalAllDersFused_into(nodes, 2, r1);
+        times[1] += time.stop();
+        time.restart();
+        basis.evalAllDersFused_into(nodes, 2, r2, true);
+        times[2] += time.stop();
+
+        for (int k = 0; k <= 2; ++k)
+            err = math::max(err, math::max( (r0[k] - r1[k]).cwiseAbs().maxCoeff(),
+                                            (r0[k].transpose() - r2[k]).cwiseAbs().maxCoeff() ) );
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int maxDeg  = 6;
+    int numElem = 8;
+
+    gsCmdLine cmd("Benchmark of the fused evaluation of tensor-product B-spline bases.");
+    cmd.addInt("p", "degree", "Maximum degree of the basis", maxDeg);
+    cmd.addInt("e", "elements", "Number of elements per direction", numElem);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    real_t times[3], err, maxErr = 0;
+    gsInfo << "Dim. Degree |  row-wise  fused  fused (functions-major)\n";
+    for (int p = 1; p <= maxDeg; ++p)
+    {
+        benchmark<2>(p, numElem, times, err);
+        maxErr = math::max(maxErr, err);
+        gsInfo << "  2     " << p << "   |  " << times[0] << "  " << times[1]
+               << "  " << times[2] << "\n";
+    }
+    for (int p = 1; p <= maxDeg; ++p)
+    {
+        benchmark<3>(p, numElem, times, err);
+        maxErr = math::max(maxErr, err);
+        gsInfo << "  3     " << p << "   |  " << times[0] << "  " << times[1]
+               << "  " << times[2] << "\n";
+    }
+
+    gsInfo << "Maximum difference: " << maxErr << "\n";
+    if ( maxErr > 1e-8 )
+    {
+        gsWarn << "The fused evaluation differs from the row-wise one.\n";
+        return 1;
+    }
+    return 0;
+}
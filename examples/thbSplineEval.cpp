@@ -0,0 +1,120 @@
+/** @file thbSplineEval.cpp
+
+    @brief Benchmark of the evaluation of THB-spline bases (values,
+    gradients and Hessians) at the quadrature nodes of all elements,
+    compared to the evaluation of every active function on its own.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Function-by-function evaluation of the derivatives of order n, as
+// done by gsTHBSplineBasis before the level-wise evaluation
+void singleWise(const gsTHBSplineBasis<2,real_t> & basis, const gsMatrix<> & u,
+                int n, gsMatrix<> & result)
+{
+    gsMatrix<unsigned> indices;
+    basis.active_into(u, indices);
+    const index_t nc = ( n==0 ? 1 : ( n==1 ? 2 : 3 ) );
+    gsMatrix<> res;
+    result.setZero(indices.rows() * nc, u.cols());
+    for (index_t i = 0; i < indices.cols(); i++)
+        for (index_t j = 0; j < indices.rows(); j++)
+        {
+            const unsigned index = indices(j, i);
+            if (j != 0 && index == 0)
+                break;
+            switch (n)
+            {
+            case 0 : basis.evalSingle_into  (index, u.col(i), res); break;
+            case 1 : basis.derivSingle_into (index, u.col(i), res); break;
+            default: basis.deriv2Single_into(index, u.col(i), res); break;
+            }
+            result.block(j * nc, i, nc, 1) = res;
+        }
+}
+
+int main(int argc, char *argv[])
+{
+    int deg       = 3;
+    int numLevels = 4;
+    int numElem   = 8;
+
+    gsCmdLine cmd("Benchmark of the evaluation of THB-spline bases.");
+    cmd.addInt("p", "degree", "Degree of the basis", deg);
+    cmd.addInt("l", "levels", "Number of refinement levels", numLevels);
+    cmd.addInt("e", "elements", "Number of elements per direction on level 0", numElem);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    // Refine towards the corner (0,0), one level per step
+    gsKnotVector<> kv(0, 1, numElem - 1, deg + 1);
+    gsTensorBSplineBasis<2,real_t> tens(kv, kv);
+    gsTHBSplineBasis<2,real_t> thb(tens);
+    gsMatrix<> box(2,2);
+    for (int l = 1; l < numLevels; ++l)
+    {
+        box.col(0).setZero();
+        box.col(1).setConstant( math::pow(real_t(0.5), l) );
+        thb.refine(box);
+    }
+    gsInfo << "THB-spline basis with " << thb.size() << " functions and "
+           << thb.numTruncated() << " truncated ones.\n";
+
+    gsVector<index_t> numNodes(2);
+    numNodes.setConstant(deg + 1);
+    gsGaussRule<> rule(numNodes);
+    gsMatrix<> nodes, r0, r1;
+    gsVector<> weights;
+
+    real_t times[2][3] = { {0,0,0}, {0,0,0} }, err = 0;
+    gsStopwatch time;
+    typename gsBasis<>::domainIter domIt = thb.makeDomainIterator();
+    for (; domIt->good(); domIt->next() )
+    {
+        rule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), nodes, weights);
+
+        for (int n = 0; n <= 2; ++n)
+        {
+            time.restart();
+            singleWise(thb, nodes, n, r0);
+            times[0][n] += time.stop();
+            time.restart();
+            switch (n)
+            {
+            case 0 : thb.eval_into  (nodes, r1); break;
+            case 1 : thb.deriv_into (nodes, r1); break;
+            default: thb.deriv2_into(nodes, r1); break;
+            }
+            times[1][n] += time.stop();
+            err = math::max(err, (r0 - r1).cwiseAbs().maxCoeff() );
+        }
+    }
+
+    gsInfo << "               function-wise  level-wise\n";
+    gsInfo << "values      :  " << times[0][0] << "  " << times[1][0] << "\n";
+    gsInfo << "gradients   :  " << times[0][1] << "  " << times[1][1] << "\n";
+    gsInfo << "Hessians    :  " << times[0][2] << "  " << times[1][2] << "\n";
+    gsInfo << "Maximum difference: " << err << "\n";
+
+    if ( err > 1e-8 )
+    {
+        gsWarn << "The level-wise evaluation differs from the function-wise one.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+/** @file xmlReadWrite.cpp
+
+    @brief Writes a large geometry to XML files as text and as binary
+    data, reads it back and compares the timings and the results.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    int numCoefs = 300;
+
+    gsCmdLine cmd("Reading and writing large geometries in XML files.");
+    cmd.addInt("n", "coefs", "Number of coefficients per direction", numCoefs);
+    bool ok = cmd.getValues(argc,argv);
+    if (!ok)
+    {
+        gsWarn << "Error during parsing the command line!\n";
+        return 0;
+    }
+
+    // Surface with random coefficients
+    gsKnotVector<> kv(0, 1, numCoefs - 4, 4);
+    gsTensorBSplineBasis<2> basis(kv, kv);
+    gsTensorBSpline<2> surf(basis, gsMatrix<>::Random(basis.size(), 3));
+
+    const char * names[2] = {"text", "binary"};
+    real_t err[2];
+    gsStopwatch time;
+    gsInfo << "Surface with " << surf.coefs().size() << " coordinates:\n";
+    for (int k = 0; k != 2; ++k)
+    {
+        const std::string fn = std::string("xmlReadWrite_") + names[k];
+
+        time.restart();
+        gsXmlSetBinary( 1 == k );
+        {
+            gsFileData<> fd;
+            fd << surf;
+            fd.save(fn);
+        }
+        gsXmlSetBinary(false);
+        const real_t tw = time.stop();
+
+        time.restart();
+        gsFileData<> fd(fn + ".xml");
+        memory::auto_ptr<gsTensorBSpline<2> > res(fd.getFirst<gsTensorBSpline<2> >());
+        const real_t tr = time.stop();
+
+        err[k] = (res->coefs() - surf.coefs()).cwiseAbs().maxCoeff();
+        for (int d = 0; d != 2; ++d)
+            err[k] = math::max(err[k],
+              ( gsAsConstVector<>(res->knots(d).data(), res->knots(d).size())
+              - gsAsConstVector<>(surf.knots(d).data(), surf.knots(d).size()) )
+                .cwiseAbs().maxCoeff() );
+
+        gsInfo << "  " << names[k] << ": write " << tw << " s, read " << tr
+               << " s, error " << err[k] << "\n";
+    }
+
+    // Binary data is exact, text has FILE_PRECISION digits
+    if ( err[0] > 1e-14 || err[1] != 0 )
+    {
+        gsWarn << "The geometry was not read back correctly.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+/** @file Session.cpp
+
+    @brief Initialization of the (MPI) processes which use the
+    Trilinos objects
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include "gsTrilinosHeaders.h"
+#include "Session.h"
+
+#include <gsCore/gsDebug.h>
+
+namespace gismo
+{
+
+namespace trilinos
+{
+
+Session::Session(int & argc, char **& argv)
+{
+#ifdef HAVE_MPI
+    MPI_Init(&argc, &argv);
+#else
+    GISMO_UNUSED(argc); GISMO_UNUSED(argv);
+#endif
+}
+
+Session::~Session()
+{
+#ifdef HAVE_MPI
+    MPI_Finalize();
+#endif
+}
+
+const Epetra_Comm & Session::comm()
+{
+#ifdef HAVE_MPI
+    static Epetra_MpiComm c(MPI_COMM_WORLD);
+#else
+    static Epetra_SerialComm c;
+#endif
+    return c;
+}
+
+int Session::rank() { return comm().MyPID(); }
+
+int Session::size() { return comm().NumProc(); }
+
+bool Session::all(bool value)
+{
+    int mine = value ? 1 : 0, res = 0;
+    comm().MinAll(&mine, &res, 1);
+    return 1 == res;
+}
+
+}//namespace trilinos
+
+}// namespace gismo
@@ -0,0 +1,62 @@
+/** @file Session.h
+
+    @brief Initialization of the (MPI) processes which use the
+    Trilinos objects
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsCore/gsExport.h>
+
+class Epetra_Comm;
+
+namespace gismo
+{
+
+namespace trilinos
+{
+
+/**
+   @brief Initializes MPI (if Epetra is built with MPI) when created
+   and finalizes it when destroyed. Create one Session at the
+   beginning of main(), before any other Trilinos object.
+
+   Without MPI, there is a single process.
+*/
+class GISMO_EXPORT Session
+{
+public:
+
+    Session(int & argc, char **& argv);
+
+    ~Session();
+
+    /// Rank of the current process
+    static int rank();
+
+    /// Number of processes
+    static int size();
+
+    /// True if \a value is true on all processes
+    static bool all(bool value);
+
+    /// The communicator of all processes
+    static const Epetra_Comm & comm();
+
+private:
+    Session(const Session &);
+    Session & operator=(const Session &);
+};
+
+
+}//namespace trilinos
+
+}// namespace gismo
@@ -1,7 +1,22 @@
+/** @file SparseMatrix.cpp
 
+    @brief Wrapper for the distributed sparse matrices of Trilinos
+    (Epetra)
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
 
 #include "gsTrilinosHeaders.h"
 #include "SparseMatrix.h"
+#include "Session.h"
+
+#include <gsCore/gsLinearAlgebra.h>
 
 namespace gismo
 {
@@ -13,36 +28,100 @@ namespace trilinos
 class SparseMatrixPrivate
 {
     friend class SparseMatrix;
-    
+
     SparseMatrixPrivate()
-    : column_space_map (new Epetra_Map (0, 0, comm) ),
-      matrix (new Epetra_FECrsMatrix(View, *column_space_map, *column_space_map, 0))
+    : row_map (new Epetra_Map (0, 0, Session::comm()) ),
+      matrix (new Epetra_FECrsMatrix(Copy, *row_map, 0))
     { }
 
-    // for testing
-    Epetra_SerialComm comm;
-
-    /// Epetra Trilinos mapping of the matrix columns that assigns
+    /// Epetra Trilinos mapping of the matrix rows that assigns
     /// parts of the matrix to the individual processes.
-    memory::shared_ptr<Epetra_Map> column_space_map;
-    
-    /// A sparse matrix object in Trilinos 
-    memory::shared_ptr<Epetra_FECrsMatrix> matrix;    
+    memory::shared_ptr<Epetra_Map> row_map;
+
+    /// A sparse matrix object in Trilinos
+    memory::shared_ptr<Epetra_FECrsMatrix> matrix;
+
+    // Inserts the rows of sp for which insert(row) is true and
+    // assembles the matrix
+    void fill(const gsSparseMatrix<> & sp, bool allRows)
+    {
+        const gsSparseMatrix<real_t,RowMajor> rm = sp;
+        std::vector<int>    cols;
+        std::vector<double> vals;
+        for (index_t i = 0; i != rm.outerSize(); ++i)
+        {
+            if ( !allRows && !row_map->MyGID(static_cast<int>(i)) )
+                continue;
+            cols.clear();
+            vals.clear();
+            for (gsSparseMatrix<real_t,RowMajor>::InnerIterator it(rm, i); it; ++it)
+            {
+                cols.push_back(static_cast<int>(it.col()));
+                vals.push_back(static_cast<double>(it.value()));
+            }
+            if ( cols.empty() ) continue;
+            const int row = static_cast<int>(i);
+            matrix->InsertGlobalValues(1, &row, static_cast<int>(cols.size()),
+                                       &cols[0], &vals[0]);
+        }
+        // Sends the entries of the rows of the other processes
+        matrix->GlobalAssemble();
+    }
 };
 
 SparseMatrix::SparseMatrix() : my(new SparseMatrixPrivate)
 { }
-    
+
 SparseMatrix::SparseMatrix(const gsSparseMatrix<> & sp)
 : my(new SparseMatrixPrivate)
 {
-    // fill in
-    my->matrix->FillComplete();
+    my->row_map.reset( new Epetra_Map(static_cast<int>(sp.rows()), 0, Session::comm()) );
+    my->matrix .reset( new Epetra_FECrsMatrix(Copy, *my->row_map, 0) );
+    my->fill(sp, false);
+}
+
+SparseMatrix::SparseMatrix(const gsSparseMatrix<> & local,
+                           const std::vector<index_t> & owned)
+: my(new SparseMatrixPrivate)
+{
+    GISMO_ASSERT( local.rows() == local.cols(), "SparseMatrix: the matrix must be square");
+    const std::vector<int> gids(owned.begin(), owned.end());
+    my->row_map.reset( new Epetra_Map(static_cast<int>(local.rows()),
+                                      static_cast<int>(gids.size()),
+                                      gids.empty() ? NULL : &gids[0], 0, Session::comm()) );
+    my->matrix .reset( new Epetra_FECrsMatrix(Copy, *my->row_map, 0) );
+    my->fill(local, true);
 }
 
-    
 SparseMatrix::~SparseMatrix() { delete my; }
 
+index_t SparseMatrix::rows() const { return my->matrix->NumGlobalRows(); }
+
+index_t SparseMatrix::cols() const { return my->matrix->NumGlobalCols(); }
+
+void SparseMatrix::ownedRows(gsSparseMatrix<> & result) const
+{
+    const Epetra_FECrsMatrix & A = *my->matrix;
+    result.resize(A.NumGlobalRows(), A.NumGlobalCols());
+    gsSparseEntries<real_t> entries;
+    entries.reserve(A.NumMyNonzeros());
+
+    std::vector<int>    cols(A.MaxNumEntries());
+    std::vector<double> vals(A.MaxNumEntries());
+    for (int i = 0; i != A.NumMyRows(); ++i)
+    {
+        const int row = A.GRID(i);
+        int n = 0;
+        A.ExtractGlobalRowCopy(row, static_cast<int>(cols.size()), n,
+                               vals.empty() ? NULL : &vals[0],
+                               cols.empty() ? NULL : &cols[0]);
+        for (int j = 0; j != n; ++j)
+            entries.add(row, cols[j], static_cast<real_t>(vals[j]));
+    }
+    result.setFrom(entries);
+    result.makeCompressed();
+}
+
 
 }//namespace trilinos
 
@@ -1,4 +1,16 @@
+/** @file SparseMatrix.h
 
+    @brief Wrapper for the distributed sparse matrices of Trilinos
+    (Epetra)
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
 
 #pragma once
 
@@ -14,16 +26,44 @@ namespace trilinos
 
 class SparseMatrixPrivate;
 
+/**
+   @brief Sparse matrix whose rows are distributed over the processes
+   of the Session.
+*/
 class GISMO_EXPORT SparseMatrix
 {
 public:
 
     SparseMatrix();
-    
+
+    /// Distributes the rows of \a sp, which is the same on all
+    /// processes, evenly over the processes
     SparseMatrix(const gsSparseMatrix<> & sp);
 
+    /// Sums the matrices \a local of all processes, eg. the systems
+    /// of the parts of a distributed assembly (see
+    /// gsAssembler::setPartition). Every process holds the rows \a
+    /// owned (global indices, the same size on all processes, each row
+    /// owned by one process); the entries of the other rows of \a
+    /// local are sent to their owners.
+    SparseMatrix(const gsSparseMatrix<> & local, const std::vector<index_t> & owned);
+
     ~SparseMatrix();
 
+    /// Global number of rows
+    index_t rows() const;
+
+    /// Global number of columns
+    index_t cols() const;
+
+    /// Copies the rows held by this process to \a result, which gets
+    /// the global size; the other rows are zero
+    void ownedRows(gsSparseMatrix<> & result) const;
+
+private:
+    SparseMatrix(const SparseMatrix &);
+    SparseMatrix & operator=(const SparseMatrix &);
+
 private:
 
     SparseMatrixPrivate * my;
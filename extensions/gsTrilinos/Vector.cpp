@@ -1,7 +1,21 @@
+/** @file Vector.cpp
 
+    @brief Wrapper for the distributed vectors of Trilinos (Epetra)
 
-//#include "gsTrilinosHeaders.h"
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include "gsTrilinosHeaders.h"
 #include "Vector.h"
+#include "Session.h"
+
+#include <gsCore/gsLinearAlgebra.h>
 
 namespace gismo
 {
@@ -9,7 +23,62 @@ namespace gismo
 namespace trilinos
 {
 
-Vector::Vector() { }
+
+class VectorPrivate
+{
+    friend class Vector;
+
+    VectorPrivate()
+    : map (new Epetra_Map (0, 0, Session::comm()) ),
+      vec (new Epetra_FEVector(*map))
+    { }
+
+    /// Epetra Trilinos mapping of the entries to the processes
+    memory::shared_ptr<Epetra_Map> map;
+
+    /// A vector object in Trilinos
+    memory::shared_ptr<Epetra_FEVector> vec;
+};
+
+Vector::Vector() : my(new VectorPrivate)
+{ }
+
+Vector::Vector(const gsMatrix<> & local, const std::vector<index_t> & owned)
+: my(new VectorPrivate)
+{
+    GISMO_ASSERT( 1 == local.cols(), "Vector: expected a column vector");
+    const std::vector<int> gids(owned.begin(), owned.end());
+    my->map.reset( new Epetra_Map(static_cast<int>(local.rows()),
+                                  static_cast<int>(gids.size()),
+                                  gids.empty() ? NULL : &gids[0], 0, Session::comm()) );
+    my->vec.reset( new Epetra_FEVector(*my->map) );
+
+    std::vector<int>    ind;
+    std::vector<double> vals;
+    for (index_t i = 0; i != local.rows(); ++i)
+        if ( 0 != local(i,0) )
+        {
+            ind .push_back(static_cast<int>(i));
+            vals.push_back(static_cast<double>(local(i,0)));
+        }
+    if ( !ind.empty() )
+        my->vec->SumIntoGlobalValues(static_cast<int>(ind.size()), &ind[0], &vals[0]);
+    // Sends the entries of the other processes
+    my->vec->GlobalAssemble();
+}
+
+Vector::~Vector() { delete my; }
+
+index_t Vector::size() const { return my->vec->GlobalLength(); }
+
+void Vector::ownedValues(gsMatrix<> & result) const
+{
+    const Epetra_FEVector & v = *my->vec;
+    result.setZero(v.GlobalLength(), 1);
+    for (int i = 0; i != v.MyLength(); ++i)
+        result(v.Map().GID(i), 0) = static_cast<real_t>(v[0][i]);
+}
+
 
 }//namespace trilinos
 
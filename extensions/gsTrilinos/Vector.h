@@ -1,7 +1,21 @@
+/** @file Vector.h
 
+    @brief Wrapper for the distributed vectors of Trilinos (Epetra)
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
 
 #pragma once
 
+#include <gsCore/gsExport.h>
+#include <gsCore/gsForwardDeclarations.h>
+
 namespace gismo
 {
 
@@ -9,12 +23,41 @@ namespace trilinos
 {
 
 
-class Vector
+class VectorPrivate;
+
+/**
+   @brief Vector whose entries are distributed over the processes of
+   the Session.
+*/
+class GISMO_EXPORT Vector
 {
 public:
-    
+
     Vector();
 
+    /// Sums the (global size) vectors \a local of all processes, eg.
+    /// the right-hand sides of the parts of a distributed assembly.
+    /// Every process holds the entries \a owned (global indices, each
+    /// entry owned by one process); the other entries of \a local
+    /// are sent to their owners.
+    Vector(const gsMatrix<> & local, const std::vector<index_t> & owned);
+
+    ~Vector();
+
+    /// Global size
+    index_t size() const;
+
+    /// Copies the entries held by this process to \a result, which
+    /// gets the global size; the other entries are zero
+    void ownedValues(gsMatrix<> & result) const;
+
+private:
+    Vector(const Vector &);
+    Vector & operator=(const Vector &);
+
+private:
+
+    VectorPrivate * my;
 };
 
 
@@ -28,5 +28,6 @@ namespace trilinos { }
 
 } // namespace gismo
 
+#include "Session.h"
 #include "SparseMatrix.h"
 #include "Vector.h"
@@ -36,4 +36,5 @@
 #include "Epetra_Vector.h"
 #include "Epetra_CrsMatrix.h"
 #include "Epetra_FECrsMatrix.h"
+#include "Epetra_FEVector.h"
 
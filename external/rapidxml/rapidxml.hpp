@@ -1358,12 +1358,28 @@ namespace rapidxml
     //! which are inherited from memory_pool.
     //! To access root node of the document, use the document itself, as if it was an xml_node.
     //! \param Ch Character type to use.
+    //G+Smo
+    //! Interface of the sources of nodes whose contents are read on demand,
+    //! see xml_document::load()
+    template<class Ch = char>
+    class xml_node_loader
+    {
+    public:
+        virtual ~xml_node_loader() { }
+
+        //! Reads the value and the children of \a node, if it is a node of
+        //! this source which is not read yet
+        virtual void load(xml_node<Ch> * node) = 0;
+    };
+    //end G+Smo
+
     template<class Ch = char>
     class xml_document: public xml_node<Ch>, public memory_pool<Ch>
     {
         //G+Smo
     protected:
         int max_Id;
+        xml_node_loader<Ch> * m_loader;
 
     public:
         xml_node<Ch> * makeRoot() 
@@ -1380,9 +1396,16 @@ namespace rapidxml
         
         inline int numNodes() const {return max_Id+1;} 
 
+        //! Sets the source of the nodes which are read on demand (not owned)
+        void setLoader(xml_node_loader<Ch> * loader) { m_loader = loader; }
+
+        //! Reads the contents of \a node, if it is read on demand
+        void load(xml_node<Ch> * node) const
+        { if (m_loader) m_loader->load(node); }
+
         void appendToRoot(xml_node<Ch> * node)
         { 
-            char tmp[4];
+            char tmp[16];
             sprintf(tmp,"%d", ++max_Id);
             node->append_attribute(this->allocate_attribute(
             this->allocate_string("id"), this->allocate_string(tmp) ) );
@@ -1397,6 +1420,7 @@ namespace rapidxml
         {
             //G+Smo
             max_Id = -1;
+            m_loader = 0;
             //end G+Smo
         }
 
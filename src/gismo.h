@@ -104,6 +104,7 @@ namespace internal
 #include <gsModeling/gsPlanarDomain.h>
 #include <gsModeling/gsSolid.h> 
 #include <gsUtils/gsMesh/gsMesh.h>
+#include <gsUtils/gsMesh/gsIndexedMesh.h>
 #include <gsModeling/gsTriMeshToSolid.h>
 //#include <gsSegment/gsVolumeSegment.h> 
 #include <gsModeling/gsFitting.h>
@@ -128,6 +129,7 @@ namespace internal
 #include <gsAssembler/gsGaussRule.h>
 
 /* ----------- Assembler ----------- */
+#include <gsAssembler/gsDomainPartition.h>
 #include <gsAssembler/gsAssembler.h>
 #include <gsAssembler/gsGenericAssembler.h>
 #include <gsAssembler/gsPoissonAssembler.h>
@@ -146,12 +148,14 @@ namespace internal
 #include <gsIO/gsWriteParaview.h>
 #include <gsIO/gsParaviewCollection.h>
 #include <gsIO/gsReadFile.h>
+#include <gsIO/gsReadStl.h>
 #include <gsUtils/gsPointGrid.h>
 #include <gsIO/gsXmlUtils.h>
 
 /* ----------- Utilities ----------- */
 #include <gsUtils/gsNorms.h>
 #include <gsUtils/gsStopwatch.h>
+#include <gsUtils/gsKdTree.h>
 #include <gsUtils/gsFunctionWithDerivatives.h>
 
 /* ----------- Extension ----------- */
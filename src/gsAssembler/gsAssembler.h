@@ -25,9 +25,15 @@
 #include <gsAssembler/gsAssemblerOptions.h>
 
 #include <gsAssembler/gsSparseSystem.h>
+#include <gsAssembler/gsAssemblyPlan.h>
+#include <gsAssembler/gsDomainPartition.h>
 
 #include <gsPde/gsPde.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace gismo
 {
 
@@ -70,12 +76,24 @@ protected: // *** Output data members ***
     /// must fit m_system.colBlocks().
     std::vector<gsMatrix<T> > m_ddof;
 
+    /// Cached element data, reused by repeated calls of apply()
+    gsAssemblyPlan<T> m_plan;
+
+    /// Partition of the elements (if any) and the part which is
+    /// assembled, see setPartition()
+    const gsDomainPartition<T> * m_partition;
+    index_t m_part;
+
+    /// Whether the system keeps its scatter cache over refresh(),
+    /// see setScatterCache()
+    bool m_scatterCache;
+
 public: /* Constructors and initializers */
 
     /// @brief default constructor
     /// \note none of the data fields are inititalized, use
     /// additionally an appropriate initialize function
-    gsAssembler() { }
+    gsAssembler() : m_partition(NULL), m_part(0), m_scatterCache(false) { }
 
     virtual ~gsAssembler()
     { }
@@ -98,6 +116,7 @@ public: /* Constructors and initializers */
         m_pde_ptr = &pde;
         m_bases = bases;
         m_options = opt;
+        m_plan.clear(); // the bases are new copies
         refresh(); // virtual call to derived
         GISMO_ASSERT( check(), "Something went wrong in assembler initialization");
     }
@@ -112,6 +131,7 @@ public: /* Constructors and initializers */
         m_bases.clear();
         m_bases.push_back(bases);
         m_options = opt;
+        m_plan.clear(); // the bases are new copies
         refresh(); // virtual call to derived
         GISMO_ASSERT( check(), "Something went wrong in assembler initialization");
     }
@@ -134,6 +154,7 @@ public: /* Constructors and initializers */
             m_bases.push_back(gsMultiBasis<T>(basis[c]));
 
         m_options = opt;
+        m_plan.clear(); // the bases are new copies
         refresh(); // virtual call to derived
         GISMO_ASSERT( check(), "Something went wrong in assembler initialization");
     }
@@ -343,6 +364,57 @@ public: // *** Accessors ***
     /// @brief Returns the options of the assembler
     const gsAssemblerOptions & options() const { return m_options; }
 
+    /// @brief Enables (or disables) the assembly plan: the basis and
+    /// geometry evaluations of every element are kept after the first
+    /// assembly and reused by the following ones, eg. in Newton
+    /// iterations or time stepping. \a memBudget bounds the memory
+    /// used (in bytes, zero means no limit). The plan is kept by
+    /// refresh(), so that refresh() and assemble() reuse it, unless
+    /// the bases changed (eg. refinement); the records of a patch are
+    /// dropped when its geometry changes. initialize() clears it.
+    /// \note The plan is used by the serial assembly only:
+    /// applyParallel() neither reads nor records it.
+    void setAssemblyPlan(bool on, size_t memBudget = 0)
+    { m_plan.setEnabled(on, memBudget); }
+
+    /// @brief Returns the assembly plan
+    const gsAssemblyPlan<T> & assemblyPlan() const { return m_plan; }
+
+    /// @brief Enables (or disables) the scatter cache of the system
+    /// (see gsSparseSystem::setScatterCache), starting with the next
+    /// refresh(): the first assembly records the positions of the
+    /// matrix entries, and every following refresh() which gives the
+    /// same dof mapper only zeroes the values of the system, so that
+    /// the next assembly writes to the recorded positions. This suits
+    /// repeated refresh() and assemble() calls with a fixed
+    /// discretization, eg. for a changing geometry or coefficients.
+    /// \note Used by assemblers which refresh with
+    /// scalarProblemGalerkinRefresh(), and not for iFace::dg.
+    void setScatterCache(bool on) { m_scatterCache = on; }
+
+    /// @brief Restricts the assembly to the elements of part \a part
+    /// of \a partition, eg. the part of the current process in a
+    /// distributed assembly; the other elements are skipped. The
+    /// system keeps its global size and the sum of the systems of
+    /// all parts is the global system. A NULL \a partition restores
+    /// the assembly of all elements. The partition is not copied and
+    /// must have been computed for the bases of the assembler. The
+    /// sparsity pattern of the system has entries only in the rows of
+    /// the owned and ghost dofs of the part.
+    /// \note Call refresh() to reset the system before assembling
+    /// another part in the same assembler. Contributions which are not
+    /// computed element-wise (eg. the penalties of
+    /// dirichlet::penalize) are added by every part.
+    void setPartition(const gsDomainPartition<T> * partition, index_t part = 0)
+    {
+        GISMO_ASSERT( !partition || (0 <= part && part < partition->numParts()),
+                      "gsAssembler: invalid part "<< part );
+        if ( partition != m_partition || part != m_part )
+            m_system.setScatterCache(false); // the pattern changes
+        m_partition = partition;
+        m_part      = part;
+    }
+
 protected:
 
     /// @brief A prototype of the refresh function for a "standard" scalar problem.
@@ -361,6 +433,65 @@ protected:
                int patchIndex = 0,
                boxSide side = boundary::none);
 
+    /// @brief Multi-threaded version of apply(), used when the
+    /// threading strategy in the options is not threading::serial.
+    /// Every thread works with its own copy of \a visitor, quadrature
+    /// rule, geometry evaluator and domain iterator. The assembly plan
+    /// is not used.
+    ///
+    /// Only the element computations run in parallel: every thread
+    /// walks over all elements of the patch to find its own ones, and
+    /// the local contributions are pushed to the (shared) system one
+    /// at a time, in a critical section for threading::parallel and by
+    /// a single thread per batch for threading::deterministic. The
+    /// speed-up is therefore bounded by the ratio of the element
+    /// computations to the pushes, which is large for higher degrees
+    /// and small for low degrees. An exception thrown by a thread is
+    /// thrown again, as std::runtime_error with its message, after
+    /// the parallel region.
+    /// \param[in] visitor The visitor for the boundary or volume integral
+    /// \param[in] patchIndex The considered patch
+    /// \param[in] side The considered boundary side, only necessary for boundary
+    /// integrals.
+    template<class ElementVisitor>
+    void applyParallel(ElementVisitor & visitor,
+                       int patchIndex = 0,
+                       boxSide side = boundary::none);
+
+#ifdef _OPENMP
+    // Keeps the message of the first exception thrown by a thread of
+    // applyParallel()
+    static void keepError(const std::exception & e, bool & failed, std::string & error)
+    {
+#       pragma omp critical (gsAssembler_error)
+        {
+            if ( !failed )
+                error = e.what();
+#           pragma omp atomic write
+            failed = true;
+        }
+    }
+
+    // True if a thread of applyParallel() failed
+    static bool hasError(const bool & failed)
+    {
+        bool res;
+#       pragma omp atomic read
+        res = failed;
+        return res;
+    }
+#endif
+
+    /// @brief Version of apply() which uses the element data stored
+    /// in the assembly plan, and records them on the first call.
+    /// \param[in] visitor The visitor for the boundary or volume integral
+    /// \param[in] patchIndex The considered patch
+    /// \param[in] side The considered boundary side, only necessary for boundary
+    /// integrals.
+    template<class ElementVisitor>
+    void applyPlanned(ElementVisitor & visitor,
+                      int patchIndex = 0,
+                      boxSide side = boundary::none);
 };
 
 template <class T>
@@ -370,7 +501,21 @@ void gsAssembler<T>::apply(ElementVisitor & visitor,
                            boxSide side)
 {
     //gsDebug<< "Apply to patch "<< patchIndex <<"("<< side <<")\n";
-    
+
+#ifdef _OPENMP
+    if ( threading::serial != m_options.thStrategy && 1 < omp_get_max_threads() )
+    {
+        applyParallel(visitor, patchIndex, side);
+        return;
+    }
+#endif
+
+    if ( m_plan.enabled() )
+    {
+        applyPlanned(visitor, patchIndex, side);
+        return;
+    }
+
     const gsBasisRefs<T> bases(m_bases, patchIndex   );
     
     gsQuadRule<T> QuRule ; // Quadrature rule
@@ -390,8 +535,11 @@ void gsAssembler<T>::apply(ElementVisitor & visitor,
     typename gsBasis<T>::domainIter domIt = bases[0].makeDomainIterator(side);
     
     // Start iteration over elements
-    for (; domIt->good(); domIt->next() )
+    for (index_t k = 0; domIt->good(); domIt->next(), ++k )
     {
+        if ( m_partition && !m_partition->contains(m_part, patchIndex, k, side) )
+            continue;
+
         // Map the Quadrature rule to the element
         QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
         
@@ -407,6 +555,200 @@ void gsAssembler<T>::apply(ElementVisitor & visitor,
     }
 }
 
+template <class T>
+template<class ElementVisitor>
+void gsAssembler<T>::applyPlanned(ElementVisitor & visitor,
+                                  int patchIndex,
+                                  boxSide side)
+{
+    const gsBasisRefs<T> bases(m_bases, patchIndex);
+
+    gsQuadRule<T> QuRule ; // Quadrature rule
+    gsMatrix<T> quNodes  ; // Temp variable for mapped nodes
+    gsVector<T> quWeights; // Temp variable for mapped weights
+    unsigned evFlags(0);
+
+    // Initialize reference quadrature rule and visitor data
+    visitor.initialize(bases, patchIndex, m_options, QuRule, evFlags);
+
+    // Views of the bases which read from (or write to) the plan
+    const size_t nb = bases.size();
+    std::vector<gsCachedBasis<T> > cbases;
+    cbases.reserve(nb);
+    std::vector<const gsBasis<T>*> cptr(nb);
+    for (size_t c = 0; c != nb; ++c)
+    {
+        cbases.push_back( gsCachedBasis<T>(bases[c]) );
+        cptr[c] = &cbases.back();
+    }
+    const gsBasisRefs<T> cachedBases(cptr);
+
+    // Initialize geometry evaluator
+    typename gsGeometry<T>::Evaluator geoEval(
+                m_pde_ptr->patches()[patchIndex].evaluator(evFlags));
+
+    typename gsAssemblyPlan<T>::Pass & pass = m_plan.pass(patchIndex, side, evFlags, QuRule,
+                                                          m_pde_ptr->patches()[patchIndex], bases);
+
+    // Initialize domain element iterator -- using unknown 0
+    typename gsBasis<T>::domainIter domIt = bases[0].makeDomainIterator(side);
+
+    // Start iteration over elements
+    for (size_t k = 0; domIt->good(); domIt->next(), ++k )
+    {
+        if ( m_partition && !m_partition->contains(m_part, patchIndex, k, side) )
+            continue;
+
+        typename gsAssemblyPlan<T>::Element * rec = m_plan.element(pass, k, nb);
+
+        // Attach the element record (if any) to the views
+        for (size_t c = 0; c != nb; ++c)
+            cbases[c].setRecord( rec ? &rec->basis[c] : NULL );
+        geoEval->setCacheRecord( rec ? &rec->geo : NULL );
+
+        // Map the Quadrature rule to the element
+        QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
+
+        // Perform required evaluations on the quadrature nodes
+        visitor.evaluate(cachedBases, *geoEval, quNodes);
+
+        if ( rec )
+            m_plan.commit(*rec);
+
+        // Assemble on element
+        visitor.assemble(*domIt, *geoEval, quWeights);
+
+        // Push to global matrix and right-hand side vector
+        visitor.localToGlobal(patchIndex, m_ddof, m_system);
+    }
+
+    geoEval->setCacheRecord(NULL);
+}
+
+template <class T>
+template<class ElementVisitor>
+void gsAssembler<T>::applyParallel(ElementVisitor & visitor,
+                                   int patchIndex,
+                                   boxSide side)
+{
+#ifdef _OPENMP
+    const gsBasisRefs<T> bases(m_bases, patchIndex);
+    // The scatter cache of the system requires the same push order
+    // as serial assembly
+    const bool ordered = (threading::deterministic == m_options.thStrategy)
+        || m_system.scatterCached();
+
+    // In deterministic mode, every element of a batch gets its own
+    // visitor, so that the local contributions can be pushed in
+    // element order once the whole batch is computed
+    const int batchSize = ordered ? 16 * omp_get_max_threads() : 0;
+    std::vector<ElementVisitor> elVisitors(batchSize, visitor);
+    {
+        gsQuadRule<T> rule;
+        unsigned flags(0);
+        for (int k = 0; k != batchSize; ++k)
+            elVisitors[k].initialize(bases, patchIndex, m_options, rule, flags);
+    }
+
+    // Exceptions must not leave the parallel region: the message of
+    // the first one is kept and thrown again after the region, and
+    // the threads skip their remaining elements
+    bool failed = false;
+    std::string error;
+
+#pragma omp parallel
+    {
+        const int tid = omp_get_thread_num();
+        const int nt  = omp_get_num_threads();
+
+        ElementVisitor thVisitor = visitor; // thread-local visitor
+
+        gsQuadRule<T> QuRule ; // Quadrature rule
+        gsMatrix<T> quNodes  ; // Temp variable for mapped nodes
+        gsVector<T> quWeights; // Temp variable for mapped weights
+        unsigned evFlags(0);
+
+        // Every thread walks over all elements and works on the ones
+        // assigned to it (round robin)
+        typename gsBasis<T>::domainIter domIt = bases[0].makeDomainIterator(side);
+
+        typename gsGeometry<T>::Evaluator geoEval;
+        try
+        {
+            // Initialize reference quadrature rule and visitor data
+            thVisitor.initialize(bases, patchIndex, m_options, QuRule, evFlags);
+
+            // Initialize geometry evaluator
+            geoEval.reset( m_pde_ptr->patches()[patchIndex].evaluator(evFlags) );
+        }
+        catch (std::exception & e) { keepError(e, failed, error); }
+
+        if ( ordered )
+        {
+            int count = batchSize;
+            index_t first = 0; // index of the first element of the batch
+            for (; count == batchSize; first += count)
+            {
+                for (count = 0; count != batchSize && domIt->good(); ++count, domIt->next() )
+                {
+                    if ( count % nt != tid || hasError(failed) ) continue;
+                    if ( m_partition && !m_partition->contains(m_part, patchIndex, first + count, side) )
+                        continue;
+
+                    try
+                    {
+                        ElementVisitor & elVisitor = elVisitors[count];
+                        QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
+                        elVisitor.evaluate(bases, *geoEval, quNodes);
+                        elVisitor.assemble(*domIt, *geoEval, quWeights);
+                    }
+                    catch (std::exception & e) { keepError(e, failed, error); }
+                }
+
+                // All threads have the same value of count here
+#pragma omp barrier
+#pragma omp single
+                {
+                    try
+                    {
+                        for (int k = 0; k != count && !hasError(failed); ++k)
+                            if ( !m_partition || m_partition->contains(m_part, patchIndex, first + k, side) )
+                                elVisitors[k].localToGlobal(patchIndex, m_ddof, m_system);
+                    }
+                    catch (std::exception & e) { keepError(e, failed, error); }
+                }// implicit barrier
+            }
+        }
+        else
+        {
+            for (int count = 0; domIt->good() && !hasError(failed); domIt->next(), ++count )
+            {
+                if ( count % nt != tid ) continue;
+                if ( m_partition && !m_partition->contains(m_part, patchIndex, count, side) )
+                    continue;
+
+                try
+                {
+                    QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
+                    thVisitor.evaluate(bases, *geoEval, quNodes);
+                    thVisitor.assemble(*domIt, *geoEval, quWeights);
+
+#pragma omp critical (gsAssembler_localToGlobal)
+                    thVisitor.localToGlobal(patchIndex, m_ddof, m_system);
+                }
+                catch (std::exception & e) { keepError(e, failed, error); }
+            }
+        }
+    }//omp parallel
+
+    if ( failed )
+        throw std::runtime_error(error);
+#else
+    GISMO_UNUSED(visitor); GISMO_UNUSED(patchIndex); GISMO_UNUSED(side);
+    GISMO_ERROR("G+Smo was compiled without OpenMP support (GISMO_WITH_OPENMP).");
+#endif
+}
+
 } // namespace gismo
 
 #ifndef GISMO_BUILD_LIB
@@ -87,6 +87,9 @@ void gsAssembler<T>::scalarProblemGalerkinRefresh()
     GISMO_ASSERT(1==m_bases.size(), "Expecting a single discrete space "
                                     "for standard scalar Galerkin");
 
+    // The element data are kept unless the bases changed
+    m_plan.setBases(m_bases);
+
     // 1. Obtain a map from basis functions to matrix columns and rows
     gsDofMapper mapper;
     m_bases.front().getMapper(m_options.dirStrategy, m_options.intStrategy,
@@ -95,10 +98,42 @@ void gsAssembler<T>::scalarProblemGalerkinRefresh()
     if ( 0 == mapper.freeSize() ) // Are there any interior dofs ?
         gsWarn << " No internal DOFs, zero sized system.\n";
 
-    // 2. Create the sparse system
+    // 2. With the scatter cache, keep the system if the dofs did
+    // not change, and re-use the recorded positions
+    if ( m_scatterCache && m_system.scatterCached() &&
+         m_system.rhs().cols() == this->pde().numRhs() )
+    {
+        const gsDofMapper & cur = m_system.colMapper(0);
+        bool same = cur.size() == mapper.size() && cur.freeSize() == mapper.freeSize()
+            && cur.numPatches() == mapper.numPatches() && cur.mapSize() == mapper.mapSize();
+        for (size_t k = 0; same && k != mapper.numPatches(); ++k)
+            same = cur.offset(k) == mapper.offset(k);
+        for (size_t i = 0; same && i != mapper.mapSize(); ++i)
+            same = cur.mapIndex(i) == mapper.mapIndex(i);
+        if ( same )
+        {
+            m_system.setValuesZero();
+            return;
+        }
+    }
+
+    // 3. Create the sparse system
     m_system = gsSparseSystem<T>(mapper);//1,1
-    const index_t nz = m_options.numColNz(m_bases[0][0]);
-    m_system.reserve(nz, this->pde().numRhs());
+    if ( m_options.intStrategy == iFace::dg )
+    {
+        // DG couplings are not element-local, reserve memory instead
+        const index_t nz = m_options.numColNz(m_bases[0][0]);
+        m_system.reserve(nz, this->pde().numRhs());
+    }
+    else
+    {
+        // Allocate the exact sparsity pattern of the matrix, only
+        // for the elements of the part if a partition is set
+        m_system.computePattern(m_bases, m_partition, m_part);
+        m_system.rhs().setZero(m_system.cols(), this->pde().numRhs());
+        if ( m_scatterCache )
+            m_system.setScatterCache(true);
+    }
 }
 
 template<class T>
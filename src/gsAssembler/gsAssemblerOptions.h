@@ -68,6 +68,26 @@ struct iFace
 
 };
 
+struct threading
+{
+    enum strategy
+    {
+        /// Visit the elements of a patch one after the other
+        serial        = 0,
+
+        /// Distribute the elements of a patch over the available
+        /// threads. Local contributions are added to the global
+        /// system as soon as they are ready, therefore the summation
+        /// order (and the rounding) may differ from run to run.
+        parallel      = 1,
+
+        /// Compute the local contributions of batches of elements in
+        /// parallel and add them to the global system in element
+        /// order. The result is bit-identical to serial assembly.
+        deterministic = 2
+    };
+};
+
 /*
     enum iFaceTopology
     {
@@ -250,6 +270,7 @@ public:
           intStrategy  (iFace    ::conforming   ),
           transformType(transform::Hgrad        ),
           spaceType    (space    ::taylorHood   ),
+          thStrategy   (threading::serial       ),
 
           bdA(2.0),
           bdB(1  ),
@@ -270,6 +291,11 @@ public:
     transform::type      transformType;
     space::type          spaceType;
 
+    // Element loop strategy, effective only if G+Smo is compiled
+    // with OpenMP (GISMO_WITH_OPENMP). The coefficient functions of
+    // the PDE must be safe to evaluate concurrently.
+    threading::strategy  thStrategy;
+
     // If set to a value different than zero, it controls the
     // allocation of the sparse matrix, ie. the maximum number of
     // non-zero entries per column (set to: A * p + B)
@@ -0,0 +1,412 @@
+/** @file gsAssemblyPlan.h
+
+    @brief Cache of element data (basis and geometry evaluations at
+    the quadrature nodes) which is reused by repeated assembly passes
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsCore/gsBasis.h>
+#include <gsCore/gsBasisRefs.h>
+#include <gsCore/gsMultiBasis.h>
+#include <gsCore/gsGeometry.h>
+#include <gsCore/gsFuncData.h>
+
+namespace gismo
+{
+
+/**
+    @brief Evaluations of one basis on one element, as requested by
+    an element visitor: the active functions at the first quadrature
+    node, and the values and derivatives at all quadrature nodes.
+
+    \ingroup Assembler
+*/
+template <class T>
+struct gsBasisData
+{
+    gsMatrix<T>               point;   ///< Point at which \a actives were computed
+    gsMatrix<unsigned>        actives; ///< Active functions at \a point
+    gsMatrix<T>               points;  ///< Points at which \a ders were computed
+    std::vector<gsMatrix<T> > ders;    ///< Values and derivatives at \a points
+
+    /// Returns the memory occupied by the data (in bytes)
+    size_t bytes() const
+    {
+        size_t res = sizeof(T) * (point.size() + points.size())
+            + sizeof(unsigned) * actives.size();
+        for (size_t i = 0; i != ders.size(); ++i)
+            res += sizeof(T) * ders[i].size();
+        return res;
+    }
+};
+
+/**
+    @brief A view of a basis which returns the evaluations stored in
+    a gsBasisData record, if these were computed for the same points,
+    and stores new evaluations in the record otherwise.
+
+    Only the functions which are needed by the element visitors are
+    forwarded to the underlying basis.
+
+    \ingroup Assembler
+*/
+template <class T>
+class gsCachedBasis : public gsBasis<T>
+{
+public:
+    typedef typename gsBasis<T>::domainIter domainIter;
+
+public:
+
+    explicit gsCachedBasis(const gsBasis<T> & basis)
+    : m_basis(&basis), m_rec(NULL)
+    { }
+
+    /// Sets the record used for the next evaluations (NULL for none)
+    void setRecord(gsBasisData<T> * rec) { m_rec = rec; }
+
+    /// Returns the underlying basis
+    const gsBasis<T> & source() const { return *m_basis; }
+
+public:
+
+    int dim()  const { return m_basis->dim();  }
+
+    int size() const { return m_basis->size(); }
+
+    int degree(int i)  const { return m_basis->degree(i);  }
+
+    int maxDegree()    const { return m_basis->maxDegree();   }
+
+    int minDegree()    const { return m_basis->minDegree();   }
+
+    int totalDegree()  const { return m_basis->totalDegree(); }
+
+    int numElements()  const { return m_basis->numElements(); }
+
+    gsMatrix<T> support() const { return m_basis->support(); }
+
+    int elementIndex(const gsVector<T> & u ) const
+    { return m_basis->elementIndex(u); }
+
+    domainIter makeDomainIterator() const
+    { return m_basis->makeDomainIterator(); }
+
+    domainIter makeDomainIterator(const boxSide & s) const
+    { return m_basis->makeDomainIterator(s); }
+
+    gsCachedBasis * clone() const { return new gsCachedBasis(*this); }
+
+    gsGeometry<T> * makeGeometry( const gsMatrix<T> & coefs ) const
+    { return m_basis->makeGeometry(coefs); }
+
+    gsGeometry<T> * makeGeometry( gsMovable< gsMatrix<T> > coefs ) const
+    { return m_basis->makeGeometry(coefs); }
+
+    std::ostream &print(std::ostream &os) const
+    { os << "Cached view of: "; return m_basis->print(os); }
+
+public:
+
+    void active_into(const gsMatrix<T> & u, gsMatrix<unsigned>& result) const
+    {
+        if ( m_rec && 1 == u.cols() && samePoints(m_rec->point, u) )
+        {
+            result = m_rec->actives;
+            return;
+        }
+
+        m_basis->active_into(u, result);
+        if ( m_rec && 1 == u.cols() )
+        {
+            m_rec->point   = u;
+            m_rec->actives = result;
+        }
+    }
+
+    void evalAllDers_into(const gsMatrix<T> & u, int n,
+                          std::vector<gsMatrix<T> >& result) const
+    {
+        if ( m_rec && n < static_cast<int>(m_rec->ders.size()) &&
+             samePoints(m_rec->points, u) )
+        {
+            result.resize(n+1);
+            for (int i = 0; i <= n; ++i)
+                result[i] = m_rec->ders[i];
+            return;
+        }
+
+        m_basis->evalAllDers_into(u, n, result);
+        if ( m_rec )
+        {
+            m_rec->points = u;
+            m_rec->ders   = result;
+        }
+    }
+
+    void eval_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
+    { derivative_into(u, 0, result); }
+
+    void deriv_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
+    { derivative_into(u, 1, result); }
+
+    void deriv2_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
+    { derivative_into(u, 2, result); }
+
+private:
+
+    // Derivatives of order k, through evalAllDers_into when a record is used
+    void derivative_into(const gsMatrix<T> & u, int k, gsMatrix<T>& result) const
+    {
+        if ( m_rec )
+        {
+            evalAllDers_into(u, k, m_tmp);
+            result.swap(m_tmp[k]);
+            return;
+        }
+
+        switch (k)
+        {
+        case 0 : m_basis->eval_into  (u, result); break;
+        case 1 : m_basis->deriv_into (u, result); break;
+        default: m_basis->deriv2_into(u, result); break;
+        }
+    }
+
+    static bool samePoints(const gsMatrix<T> & a, const gsMatrix<T> & b)
+    {
+        return a.rows() == b.rows() && a.cols() == b.cols() && a == b;
+    }
+
+private:
+
+    const gsBasis<T> * m_basis;
+
+    gsBasisData<T>   * m_rec;
+
+    mutable std::vector<gsMatrix<T> > m_tmp;
+};
+
+/**
+    @brief The assembly plan is a cache of element data, which are
+    independent of the coefficients of the PDE and of the current
+    solution: the evaluations of the discretization bases and of the
+    geometry map at the quadrature nodes of every element.
+
+    The data of an element are recorded the first time the element is
+    visited and are reused by all following assembly passes, so that
+    re-assembly (eg. in Newton iterations or time stepping) only
+    evaluates the coefficient dependent terms. The records are
+    organized in passes, one for each patch, side, geometry flags and
+    quadrature size used by gsAssembler::apply(). A pass keeps the
+    identity of the bases and of the geometry it was recorded for,
+    together with a copy of the geometry coefficients; if any of these
+    changed (eg. a deformed geometry, or new bases after refinement),
+    the records of the pass are dropped and recorded again. Moreover,
+    every record checks the evaluation points.
+
+    The memory used for the records can be bounded; elements which do
+    not fit in the budget are evaluated every time.
+
+    \ingroup Assembler
+*/
+template <class T>
+class gsAssemblyPlan
+{
+public:
+
+    /// @brief The cached data of one element
+    struct Element
+    {
+        Element() : stored(false) { }
+
+        /// Evaluations of every basis (one per unknown)
+        std::vector<gsBasisData<T> > basis;
+
+        /// Evaluations of the geometry map
+        gsMapData<T> geo;
+
+        /// True if the data of the element are kept in the plan
+        bool stored;
+
+        size_t bytes() const
+        {
+            size_t res = sizeof(T) * (geo.points.size() + geo.measures.size()
+                                      + geo.fundForms.size());
+            for (size_t i = 0; i != geo.values.size(); ++i)
+                res += sizeof(T) * geo.values[i].size();
+            for (size_t i = 0; i != basis.size(); ++i)
+                res += basis[i].bytes();
+            return res;
+        }
+    };
+
+    /// @brief The element records of one pass of gsAssembler::apply()
+    struct Pass
+    {
+        Pass() : geo(NULL) { }
+
+        std::vector<Element> elements;
+
+        /// The geometry and the bases the records were computed for
+        const gsGeometry<T> *          geo;
+        gsMatrix<T>                    coefs;
+        std::vector<const gsBasis<T>*> bases;
+        std::vector<index_t>           sizes;
+
+        /// Returns true if the records were computed for \a g and \a b
+        bool recordedFor(const gsGeometry<T> & g, const gsBasisRefs<T> & b) const
+        {
+            if ( geo != &g || bases.size() != b.size() ||
+                 coefs.rows() != g.coefs().rows() || coefs.cols() != g.coefs().cols() ||
+                 coefs != g.coefs() )
+                return false;
+            for (size_t c = 0; c != bases.size(); ++c)
+                if ( bases[c] != &b[c] || sizes[c] != b[c].size() )
+                    return false;
+            return true;
+        }
+    };
+
+public:
+
+    gsAssemblyPlan() : m_enabled(false), m_budget(0), m_bytes(0)
+    { }
+
+    /// @brief Enables or disables the plan. Disabling releases the
+    /// memory. \a memBudget is the maximum number of bytes used for
+    /// the records, zero means no limit.
+    void setEnabled(bool on, size_t memBudget = 0)
+    {
+        if ( !on ) clear();
+        m_enabled = on;
+        m_budget  = memBudget;
+    }
+
+    /// @brief Returns true if the plan is used by the assembler
+    bool enabled() const { return m_enabled; }
+
+    /// @brief Removes all records
+    void clear()
+    {
+        m_passes.clear();
+        m_bases.clear();
+        m_bytes = 0;
+    }
+
+    /// @brief Removes all records if \a bases are not the bases of
+    /// the previous call (identity and sizes of the patch bases), eg.
+    /// after refinement. Otherwise the records are kept, the records
+    /// of a pass are still checked against its geometry by pass().
+    void setBases(const std::vector<gsMultiBasis<T> > & bases)
+    {
+        std::vector<std::pair<const gsBasis<T>*, index_t> > cur;
+        for (size_t c = 0; c != bases.size(); ++c)
+            for (size_t p = 0; p != bases[c].nBases(); ++p)
+                cur.push_back( std::make_pair(&bases[c].basis(p),
+                                              static_cast<index_t>(bases[c].basis(p).size())) );
+        if ( cur != m_bases )
+        {
+            clear();
+            m_bases.swap(cur);
+        }
+    }
+
+    /// @brief Returns the memory used by the records (in bytes)
+    size_t bytesUsed() const { return m_bytes; }
+
+    /// @brief Returns the memory budget (in bytes, zero means no limit)
+    size_t memoryBudget() const { return m_budget; }
+
+    /// @brief Returns the records of the pass over patch \a patch
+    /// (or its side \a side), with geometry flags \a evFlags and
+    /// quadrature rule \a rule, for the geometry \a geo and the bases
+    /// \a bases. The records are dropped if they were computed for
+    /// another geometry or other bases.
+    Pass & pass(const index_t patch, const boxSide side,
+                const unsigned evFlags, const gsQuadRule<T> & rule,
+                const gsGeometry<T> & geo, const gsBasisRefs<T> & bases)
+    {
+        std::vector<index_t> key(4);
+        key[0] = patch;
+        key[1] = side.index();
+        key[2] = static_cast<index_t>(evFlags);
+        key[3] = rule.numNodes();
+        Pass & res = m_passes[key];
+
+        if ( !res.recordedFor(geo, bases) )
+        {
+            for (size_t k = 0; k != res.elements.size(); ++k)
+                if ( res.elements[k].stored )
+                    m_bytes -= math::min(m_bytes, res.elements[k].bytes());
+            res.elements.clear();
+            res.geo   = &geo;
+            res.coefs = geo.coefs();
+            res.bases.resize(bases.size());
+            res.sizes.resize(bases.size());
+            for (size_t c = 0; c != bases.size(); ++c)
+            {
+                res.bases[c] = &bases[c];
+                res.sizes[c] = bases[c].size();
+            }
+        }
+        return res;
+    }
+
+    /// @brief Returns the record of element \a k of \a pass for \a
+    /// nBases bases, or NULL if the record is not kept (memory budget)
+    Element * element(Pass & pass, const size_t k, const size_t nBases)
+    {
+        std::vector<Element> & el = pass.elements;
+        if ( k < el.size() && el[k].stored )
+            return &el[k];
+
+        if ( 0 != m_budget && m_bytes >= m_budget )
+            return NULL;
+
+        if ( k >= el.size() )
+            el.resize(k+1);
+        el[k].basis.resize(nBases);
+        return &el[k];
+    }
+
+    /// @brief Accounts the memory of record \a el after its first
+    /// evaluation; the record is dropped if it exceeds the budget
+    void commit(Element & el)
+    {
+        if ( el.stored ) return;
+
+        const size_t b = el.bytes();
+        if ( 0 != m_budget && m_bytes + b > m_budget )
+        {
+            Element empty;
+            std::swap(el, empty);
+            m_bytes = m_budget; // do not try to store more elements
+            return;
+        }
+        m_bytes  += b;
+        el.stored = true;
+    }
+
+private:
+
+    bool   m_enabled;
+    size_t m_budget;
+    size_t m_bytes;
+
+    std::map<std::vector<index_t>, Pass> m_passes;
+
+    // The patch bases of the last setBases() call, and their sizes
+    std::vector<std::pair<const gsBasis<T>*, index_t> > m_bases;
+};
+
+} // namespace gismo
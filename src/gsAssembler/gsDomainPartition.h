@@ -0,0 +1,124 @@
+/** @file gsDomainPartition.h
+
+    @brief Partition of the elements of a multipatch domain into parts,
+    eg. for the processes of a distributed assembly.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsCore/gsMultiBasis.h>
+#include <gsCore/gsDofMapper.h>
+
+namespace gismo
+{
+
+/**
+    @brief Partition of the elements of a multipatch domain into parts
+    of (almost) equal numbers of elements.
+
+    The patches are visited in breadth-first order of the patch
+    connectivity (gsBoxTopology), so that neighboring patches tend to
+    belong to the same part, and the elements are given to the parts
+    patch by patch. A patch is split only if it does not fit in the
+    current part (up to a tolerance of 10% of the mean part size): in
+    that case the part gets a range of elements of the patch, in the
+    order of the domain iterator.
+
+    The elements of a boundary side of a patch belong to the part of
+    the first element of the patch.
+
+    A dof is \em owned by the first part which has an element where
+    its basis function is active; it is a \em ghost of the other
+    parts which have such elements. The dofs of a part are computed
+    by dofs().
+
+    \ingroup Assembler
+*/
+template<class T>
+class gsDomainPartition
+{
+public:
+
+    /// Range [first, last) of the elements of patch \a patch
+    struct range
+    {
+        index_t patch, first, last;
+    };
+
+public:
+
+    /// Empty partition
+    gsDomainPartition() : m_numParts(0) { }
+
+    /// Partitions the elements of \a bases into \a numParts parts
+    gsDomainPartition(const gsMultiBasis<T> & bases, index_t numParts)
+    { compute(bases, numParts); }
+
+    /// Partitions the elements of \a bases into \a numParts parts
+    void compute(const gsMultiBasis<T> & bases, index_t numParts);
+
+    /// Number of parts
+    index_t numParts() const { return m_numParts; }
+
+    /// Element ranges of part \a part
+    const std::vector<range> & ranges(index_t part) const
+    { return m_ranges[part]; }
+
+    /// Number of elements of part \a part
+    index_t numElements(index_t part) const;
+
+    /// Part of element \a element of patch \a patch
+    index_t partOf(index_t patch, index_t element) const;
+
+    /// True if element \a element of patch \a patch (or of its side
+    /// \a side, if given) belongs to part \a part
+    bool contains(index_t part, index_t patch, index_t element,
+                  boxSide side = boundary::none) const
+    {
+        return part == partOf(patch, boundary::none == side ? element : 0);
+    }
+
+    /**
+       \brief Computes the free dofs of \a mapper (global indices)
+       which are active on the elements of part \a part: the dofs
+       owned by the part in \a owned and the other ones in \a ghost,
+       both sorted.
+
+       \a bases and \a mapper are the bases and the dof mapper of the
+       partitioned domain. All elements of the domain are visited.
+    */
+    void dofs(const gsMultiBasis<T> & bases, const gsDofMapper & mapper, index_t part,
+              std::vector<index_t> & owned, std::vector<index_t> & ghost) const;
+
+    /// Prints the partition
+    std::ostream & print(std::ostream & os) const;
+
+private:
+
+    index_t m_numParts;
+
+    // Element ranges of every part
+    std::vector<std::vector<range> > m_ranges;
+
+    // For every patch, the first element of every range and its part
+    std::vector<std::vector<std::pair<index_t,index_t> > > m_patchRanges;
+};
+
+/// Print (as string) operator
+template<class T>
+std::ostream & operator<<(std::ostream & os, const gsDomainPartition<T> & dp)
+{ return dp.print(os); }
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsDomainPartition.hpp)
+#endif
@@ -0,0 +1,185 @@
+/** @file gsDomainPartition.hpp
+
+    @brief Provides implementation of the partition of the elements of
+    a multipatch domain.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsCore/gsDomainIterator.h>
+
+#include <queue>
+
+namespace gismo
+{
+
+template<class T>
+void gsDomainPartition<T>::compute(const gsMultiBasis<T> & bases, index_t numParts)
+{
+    GISMO_ENSURE( numParts > 0, "gsDomainPartition: the number of parts must be positive");
+    const index_t nPatches = bases.nBases();
+    m_numParts = numParts;
+    m_ranges.clear();
+    m_ranges.resize(numParts);
+    m_patchRanges.clear();
+    m_patchRanges.resize(nPatches);
+
+    // Number of elements of the patches
+    std::vector<index_t> weight(nPatches);
+    index_t total = 0;
+    for (index_t k = 0; k != nPatches; ++k)
+        total += ( weight[k] = bases[k].numElements() );
+
+    // Neighbors of the patches
+    const gsBoxTopology & topology = bases.topology();
+    std::vector<std::vector<index_t> > nb(nPatches);
+    for (gsBoxTopology::const_iiterator it = topology.iBegin(); it != topology.iEnd(); ++it)
+    {
+        nb[it->first ().patch].push_back(it->second().patch);
+        nb[it->second().patch].push_back(it->first ().patch);
+    }
+    for (index_t k = 0; k != nPatches; ++k)
+        std::sort(nb[k].begin(), nb[k].end());
+
+    // Breadth-first order of the patches
+    std::vector<index_t> order;
+    order.reserve(nPatches);
+    std::vector<bool> visited(nPatches, false);
+    for (index_t k = 0; k != nPatches; ++k)
+    {
+        if ( visited[k] ) continue;
+        std::queue<index_t> queue;
+        queue.push(k);
+        visited[k] = true;
+        while ( !queue.empty() )
+        {
+            const index_t p = queue.front();
+            queue.pop();
+            order.push_back(p);
+            for (std::vector<index_t>::const_iterator it = nb[p].begin(); it != nb[p].end(); ++it)
+                if ( !visited[*it] )
+                {
+                    visited[*it] = true;
+                    queue.push(*it);
+                }
+        }
+    }
+
+    // Fill the parts up to their share of the elements, splitting
+    // the patches which do not fit
+    const index_t tol = total / (10 * numParts);
+    index_t part = 0, done = 0;
+    for (std::vector<index_t>::const_iterator it = order.begin(); it != order.end(); ++it)
+    {
+        index_t first = 0;
+        while ( first != weight[*it] )
+        {
+            // Last element (exclusive) of the share of the current part
+            const index_t bound = ( part + 1 == numParts ? total :
+                                    static_cast<index_t>( (static_cast<long long>(total) * (part + 1))
+                                                          / numParts ) );
+            index_t n = weight[*it] - first;
+            if ( done + n > bound + tol )
+                n = bound - done; // split the patch
+            if ( n > 0 )
+            {
+                const range r = {*it, first, first + n};
+                m_ranges[part].push_back(r);
+                m_patchRanges[*it].push_back(std::make_pair(first, part));
+                first += n;
+                done  += n;
+            }
+            if ( done + tol >= bound && part + 1 != numParts )
+                ++part;
+        }
+    }
+}
+
+template<class T>
+index_t gsDomainPartition<T>::numElements(index_t part) const
+{
+    index_t res = 0;
+    for (typename std::vector<range>::const_iterator it = m_ranges[part].begin();
+         it != m_ranges[part].end(); ++it)
+        res += it->last - it->first;
+    return res;
+}
+
+template<class T>
+index_t gsDomainPartition<T>::partOf(index_t patch, index_t element) const
+{
+    const std::vector<std::pair<index_t,index_t> > & pr = m_patchRanges[patch];
+    GISMO_ASSERT( !pr.empty(), "gsDomainPartition: patch "<< patch <<" has no elements");
+    // Last range which starts at or before the element
+    const std::pair<index_t,index_t> key(element, m_numParts);
+    return ( std::upper_bound(pr.begin(), pr.end(), key) - 1 )->second;
+}
+
+template<class T>
+void gsDomainPartition<T>::dofs(const gsMultiBasis<T> & bases, const gsDofMapper & mapper,
+                                index_t part, std::vector<index_t> & owned,
+                                std::vector<index_t> & ghost) const
+{
+    GISMO_ASSERT( bases.nBases() == m_patchRanges.size(),
+                  "gsDomainPartition: the bases do not match the partition");
+
+    // The first part of every dof, and the dofs of the part
+    const index_t shift = mapper.index(0, 0) - mapper.freeIndex(0, 0);
+    std::vector<index_t> owner(mapper.freeSize(), m_numParts);
+    std::vector<bool> active(mapper.freeSize(), false);
+
+    gsMatrix<unsigned> act;
+    for (size_t k = 0; k != bases.nBases(); ++k)
+    {
+        typename gsBasis<T>::domainIter domIt = bases[k].makeDomainIterator();
+        for (index_t el = 0; domIt->good(); domIt->next(), ++el)
+        {
+            const index_t p = partOf(k, el);
+            bases[k].active_into(domIt->centerPoint(), act);
+            for (index_t i = 0; i != act.rows(); ++i)
+            {
+                if ( !mapper.is_free(act(i,0), k) ) continue;
+                const index_t ii = mapper.freeIndex(act(i,0), k);
+                owner[ii] = math::min(owner[ii], p);
+                if ( p == part )
+                    active[ii] = true;
+            }
+        }
+    }
+
+    owned.clear();
+    ghost.clear();
+    for (index_t i = 0; i != mapper.freeSize(); ++i)
+    {
+        if ( !active[i] ) continue;
+        if ( owner[i] == part )
+            owned.push_back(i + shift);
+        else
+            ghost.push_back(i + shift);
+    }
+}
+
+template<class T>
+std::ostream & gsDomainPartition<T>::print(std::ostream & os) const
+{
+    os << "gsDomainPartition: "<< m_numParts <<" parts\n";
+    for (index_t p = 0; p != m_numParts; ++p)
+    {
+        os << "  part "<< p <<": "<< numElements(p) <<" elements, patches";
+        for (typename std::vector<range>::const_iterator it = m_ranges[p].begin();
+             it != m_ranges[p].end(); ++it)
+            os << " "<< it->patch <<"["<< it->first <<","<< it->last <<")";
+        os << "\n";
+    }
+    return os;
+}
+
+} // namespace gismo
@@ -0,0 +1,11 @@
+#include <gsCore/gsTemplateTools.h>
+
+#include <gsAssembler/gsDomainPartition.h>
+#include <gsAssembler/gsDomainPartition.hpp>
+
+namespace gismo
+{
+
+    CLASS_TEMPLATE_INST gsDomainPartition<real_t> ;
+
+}
@@ -15,7 +15,7 @@
 
 #include <gsAssembler/gsAssembler.h>
 #include <gsAssembler/gsVisitorMass.h>
-//#include <gsAssembler/gsVisitorTPmass.h>
+#include <gsAssembler/gsVisitorTPmass.h>
 #include <gsAssembler/gsVisitorGradGrad.h>
 #include <gsAssembler/gsVisitorMoments.h>
 
@@ -78,6 +78,7 @@ public:
                              m_options.intStrategy,
                              this->pde().bc(), mapper, 0);
         m_system = gsSparseSystem<T>(mapper);
+        m_plan.setBases(m_bases);
         //note: no allocation here
         //        const index_t nz = m_options.numColNz(m_bases[0][0]);
         //        m_system.reserve(nz, 1);
@@ -101,13 +102,19 @@ public:
         return m_system.matrix();
     }
 
-    /// Mass assembly routine
+    /// Mass assembly routine using sum-factorization (for
+    /// tensor-product bases, see gsVisitorTPmass)
     const gsSparseMatrix<T> & assembleMass2()
     {
         // Clean the sparse system
         gsGenericAssembler::refresh();
-        
-        //this->template push<gsVisitorTPmass<T> >();
+        const index_t nz = m_options.numColNz(m_bases[0][0]);
+        m_system.matrix().reservePerColumn(nz);
+
+        // Assemble mass integrals
+        this->template push<gsVisitorTPmass<T> >();
+
+        // Assembly is done, compress the matrix
         this->finalize();
         return m_system.matrix();
     }
@@ -192,6 +199,7 @@ private:
     using Base::m_ddof;
     using Base::m_options;
     using Base::m_system;
+    using Base::m_plan;
 
 private:
 
@@ -0,0 +1,335 @@
+/** @file gsMatrixFreeOp.h
+
+    @brief Provides a linear operator which applies an assembled
+    operator element by element, without storing its matrix.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsAssembler/gsAssembler.h>
+#include <gsAssembler/gsVisitorPoisson.h>
+#include <gsAssembler/gsVisitorNeumann.h>
+#include <gsPde/gsPoissonPde.h>
+#include <gsSolver/gsLinearOperator.h>
+
+namespace gismo
+{
+
+/** @brief Matrix-free version of the matrix assembled by the volume
+    visitor \a ElementVisitor (eg. gsVisitorPoisson, gsVisitorMass).
+
+    Every call of apply() runs an element loop over the domain of the
+    assembler with a sparse system in matrix-free mode (see
+    gsSparseSystem::setApplyTo()): the element matrices are computed
+    by the visitor, mapped by the same gsDofMapper, and applied to the
+    input vector instead of being stored. The memory used is that of
+    the dof mappers and of two vectors, instead of the \f$O(p^d)\f$
+    non-zero entries per row of the assembled matrix.
+
+    The application computes only the element matrices: the visitor
+    is constructed from a Poisson PDE with zero source, and pushes its
+    element matrix only. Therefore \a ElementVisitor is a visitor of
+    a scalar problem with the members \a localMat and \a actives, as
+    gsVisitorPoisson and gsVisitorMass. The assembly plan and the
+    partition of the assembler are not used.
+
+    Unless the threading strategy of the assembler is
+    threading::serial, the elements of every patch are distributed
+    over the OpenMP threads (round robin, as in
+    gsAssembler::applyParallel()). Every thread applies its element
+    matrices to its own output vector, and the vectors are summed in
+    thread order. The result is the same from run to run for a fixed
+    number of threads, for threading::parallel and
+    threading::deterministic alike, and differs from the serial one by
+    rounding only. An exception thrown by a thread is thrown again,
+    as std::runtime_error with its message, by apply().
+
+    The scalar type of the computations is \a T, the vectors of the
+    gsLinearOperator interface are converted if \a T is not real_t.
+
+    The right-hand side is assembled once, by the constructor: it
+    contains the volume terms of the visitor, the Neumann terms and
+    the contributions of the eliminated Dirichlet dofs. Dirichlet
+    conditions have to be eliminated; Nitsche's method, diagonal
+    penalization, Robin conditions and interface couplings which are
+    not element-local (eg. iFace::dg) add terms to the operator which
+    are not computed, and are rejected.
+
+    Example: solve the Poisson system without assembling its matrix
+    \code
+    gsPoissonAssembler<> assembler(patches, bases, bc, f);
+    assembler.computeDirichletDofs();
+    gsMatrixFreeOp<gsVisitorPoisson<real_t> > op(assembler);
+    gsConjugateGradient cg(op);
+    cg.solve(op.rhs(), x);
+    \endcode
+
+    \ingroup Assembler
+*/
+template <class ElementVisitor = gsVisitorPoisson<real_t>, class T = real_t>
+class gsMatrixFreeOp : public gsLinearOperator
+{
+public:
+
+    /// Shared pointer for gsMatrixFreeOp
+    typedef memory::shared_ptr<gsMatrixFreeOp> Ptr;
+
+    /// Unique pointer for gsMatrixFreeOp
+    typedef typename memory::unique<gsMatrixFreeOp>::ptr uPtr;
+
+    /// @brief Constructs the operator of the system of \a assembler.
+    ///
+    /// The matrix storage of \a assembler (eg. the sparsity pattern
+    /// allocated by refresh()) is released, its structure (blocks and
+    /// dof mappers) is kept. The right-hand side is assembled once by
+    /// a matrix-free pass and is available by rhs(). The assembler
+    /// is used by apply() and has to outlive the operator.
+    explicit gsMatrixFreeOp(gsAssembler<T> & assembler)
+    : m_assembler(&assembler),
+      m_zeroPde(assembler.patches(), assembler.pde().bc(),
+                gsConstantFunction<T>(0.0, assembler.patches().geoDim()))
+    {
+        GISMO_ENSURE( assembler.options().dirStrategy == dirichlet::elimination ||
+                      assembler.pde().bc().dirichletSides().empty(),
+                      "Dirichlet conditions have to be eliminated for the matrix-free operator "
+                      "(Nitsche's method and penalization are not supported).");
+        GISMO_ENSURE( assembler.options().intStrategy != iFace::dg,
+                      "DG couplings are not supported by the matrix-free operator.");
+        GISMO_ENSURE( assembler.pde().bc().robinSides().empty(),
+                      "Robin conditions are not supported by the matrix-free operator.");
+
+        // The eliminated dofs are needed by the visitors
+        if ( assembler.allFixedDofs().empty() )
+            assembler.computeDirichletDofs();
+
+        // Keep only the structure of the assembler's system
+        gsSparseSystem<T> empty;
+        empty.setStructure(assembler.system());
+        assembler.setSparseSystem(empty);
+        m_sys.setStructure(assembler.system());
+        if ( 0 == m_sys.rhs().size() )
+            m_sys.rhs().setZero(cols(), assembler.pde().numRhs());
+
+        // One pass of the assembler for the right-hand side, with
+        // the volume and the Neumann terms
+        gsMatrix<T> x, y;
+        x.setZero(cols(), 1);
+        y.setZero(rows(), 1);
+        m_sys.setApplyTo(&x, &y);
+        assembler.setSparseSystem(m_sys);  // swap in
+        assembler.template push<ElementVisitor>();
+        assembler.template push<gsVisitorNeumann<T> >(assembler.pde().bc().neumannSides());
+        assembler.setSparseSystem(m_sys);  // swap back
+        m_sys.setApplyTo(NULL, NULL);
+        m_rhs.swap(m_sys.rhs());
+    }
+
+    static Ptr make(gsAssembler<T> & assembler)
+    { return shared( new gsMatrixFreeOp(assembler) ); }
+
+    void apply(const gsMatrix<real_t> & input, gsMatrix<real_t> & x) const
+    { applyAs(input, x); }
+
+    /// @brief Applies the operator to \a input, in the scalar type \a T
+    void applyT(const gsMatrix<T> & input, gsMatrix<T> & x) const
+    {
+        GISMO_ASSERT( input.rows() == cols(), "Wrong input size.");
+        x.setZero(rows(), input.cols());
+
+#       ifdef _OPENMP
+        if ( threading::serial != m_assembler->options().thStrategy &&
+             1 < omp_get_max_threads() )
+        {
+            applyParallel(input, x);
+            return;
+        }
+#       endif
+
+        m_sys.setApplyTo(&input, &x);
+        for (size_t np = 0; np != m_assembler->patches().nPatches(); ++np)
+            applyPatch(np, m_sys);
+        m_sys.setApplyTo(NULL, NULL);
+    }
+
+    index_t rows() const { return m_sys.matrix().rows(); }
+
+    index_t cols() const { return m_sys.matrix().cols(); }
+
+    /// @brief Returns the right-hand side computed by the visitors
+    /// (including the Neumann terms and the contributions of the
+    /// eliminated dofs)
+    const gsMatrix<T> & rhs() const { return m_rhs; }
+
+    /// @brief Returns the memory used by the operator (in bytes)
+    size_t bytes() const
+    {
+        size_t res = sizeof(T) * m_rhs.size();
+        const std::vector<gsDofMapper> & maps = m_sys.dofMappers();
+        for (size_t i = 0; i != maps.size(); ++i)
+            res += sizeof(index_t) * maps[i].mapSize();
+        for (size_t t = 0; t != m_thOut.size(); ++t) // threads
+            res += sizeof(T) * m_thOut[t].size();
+        return res;
+    }
+
+private:
+
+    /// The element visitor, which pushes only the element matrix
+    struct MatrixVisitor : public ElementVisitor
+    {
+        explicit MatrixVisitor(const gsPde<T> & pde) : ElementVisitor(pde) { }
+
+        void localToGlobal(const int patchIndex,
+                           const std::vector<gsMatrix<T> > &,
+                           gsSparseSystem<T> & system)
+        {
+            system.mapColIndices(this->actives, patchIndex, this->actives);
+            system.pushToMatrix(this->localMat, this->actives, gsMatrix<T>());
+        }
+    };
+
+    // Application with the vectors of gsLinearOperator, converted if
+    // T is not real_t
+    template <class S>
+    void applyAs(const gsMatrix<S> & input, gsMatrix<S> & x) const
+    {
+        gsMatrix<T> y;
+        applyT(input.template cast<T>(), y);
+        x = y.template cast<S>();
+    }
+
+    void applyAs(const gsMatrix<T> & input, gsMatrix<T> & x) const
+    { applyT(input, x); }
+
+    /// Applies the element matrices of the patch \a np to \a sys,
+    /// the elements \a tid, \a tid + \a nt, .. only
+    void applyPatch(const index_t np, gsSparseSystem<T> & sys,
+                    const int tid = 0, const int nt = 1) const
+    {
+        std::vector<const gsBasis<T>*> ptr(m_assembler->numMultiBasis());
+        for (size_t c = 0; c != ptr.size(); ++c)
+            ptr[c] = &m_assembler->multiBasis(c)[np];
+        const gsBasisRefs<T> bases(ptr);
+
+        MatrixVisitor visitor(m_zeroPde);
+        gsQuadRule<T> QuRule;
+        gsMatrix<T> quNodes;
+        gsVector<T> quWeights;
+        unsigned evFlags(0);
+        visitor.initialize(bases, np, m_assembler->options(), QuRule, evFlags);
+
+        typename gsGeometry<T>::Evaluator geoEval(
+            m_assembler->patches()[np].evaluator(evFlags));
+
+        typename gsBasis<T>::domainIter domIt = bases[0].makeDomainIterator();
+        for (int count = 0; domIt->good(); domIt->next(), ++count )
+        {
+            if ( count % nt != tid ) continue;
+            QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
+            visitor.evaluate(bases, *geoEval, quNodes);
+            visitor.assemble(*domIt, *geoEval, quWeights);
+            visitor.localToGlobal(np, m_assembler->allFixedDofs(), sys);
+        }
+    }
+
+#ifdef _OPENMP
+    /// Multi-threaded application, every thread applies its elements
+    /// to its own system and output vector
+    void applyParallel(const gsMatrix<T> & input, gsMatrix<T> & x) const
+    {
+        const int maxThreads = omp_get_max_threads();
+        if ( static_cast<int>(m_thSys.size()) != maxThreads )
+        {
+            m_thSys.resize(maxThreads);
+            for (int t = 0; t != maxThreads; ++t)
+                m_thSys[t].setStructure(m_sys);
+        }
+        m_thOut.resize(maxThreads);
+
+        // Exceptions must not leave the parallel region: the message
+        // of the first one is kept and thrown again after the region
+        bool failed = false;
+        std::string error;
+
+#pragma omp parallel
+        {
+            const int tid = omp_get_thread_num();
+            const int nt  = omp_get_num_threads();
+            gsSparseSystem<T> & sys = m_thSys[tid];
+            m_thOut[tid].setZero(x.rows(), x.cols());
+            sys.setApplyTo(&input, &m_thOut[tid]);
+
+            for (size_t np = 0; np != m_assembler->patches().nPatches(); ++np)
+            {
+                try
+                {
+                    if ( !hasError(failed) )
+                        applyPatch(np, sys, tid, nt);
+                }
+                catch (std::exception & e) { keepError(e, failed, error); }
+            }
+            sys.setApplyTo(NULL, NULL);
+
+            // Sum of the outputs, in thread order
+#pragma omp barrier
+#pragma omp single
+            {
+                for (int t = 0; t != nt; ++t)
+                    x += m_thOut[t];
+            }
+        }//omp parallel
+
+        if ( failed )
+            throw std::runtime_error(error);
+    }
+
+    // Keeps the message of the first exception thrown by a thread of
+    // applyParallel()
+    static void keepError(const std::exception & e, bool & failed, std::string & error)
+    {
+#       pragma omp critical (gsMatrixFreeOp_error)
+        {
+            if ( !failed )
+                error = e.what();
+#           pragma omp atomic write
+            failed = true;
+        }
+    }
+
+    // True if a thread of applyParallel() failed
+    static bool hasError(const bool & failed)
+    {
+        bool res;
+#       pragma omp atomic read
+        res = failed;
+        return res;
+    }
+#endif
+
+private:
+
+    const gsAssembler<T> * m_assembler;
+
+    /// The PDE with zero source, from which the visitors of apply()
+    /// are constructed
+    gsPoissonPde<T> m_zeroPde;
+
+    /// The system applied by apply(), which has no matrix storage
+    mutable gsSparseSystem<T> m_sys;
+
+    /// Systems and output vectors of the threads
+    mutable std::vector<gsSparseSystem<T> > m_thSys;
+    mutable std::vector<gsMatrix<T> >       m_thOut;
+
+    gsMatrix<T> m_rhs;
+};
+
+} // namespace gismo
@@ -76,10 +76,29 @@ protected:
     /// uses multibasis m_cvar[i]. So this allows e.g. a single multibasis for several components.
     gsVector<index_t> m_cvar;
 
+    // -- Scatter cache
+
+    /// @brief positions (in the value array of the compressed matrix)
+    /// of the entries updated by the pushes of one assembly pass, in
+    /// the order of the pushes (see setScatterCache())
+    std::vector<index_t> m_scatter;
+
+    /// @brief the current position in \a m_scatter
+    size_t m_scPos;
+
+    /// @brief state of the scatter cache: 0 unused, 1 recording, 2 replaying
+    int m_scState;
+
+    // -- Matrix-free application
+
+    /// @brief input and output vectors of the matrix-free product
+    /// (see setApplyTo())
+    const gsMatrix<T> * m_mfIn;
+    gsMatrix<T>       * m_mfOut;
 
 public:
 
-    gsSparseSystem()
+    gsSparseSystem() : m_scPos(0), m_scState(0), m_mfIn(NULL), m_mfOut(NULL)
     { }
 
     /**
@@ -93,7 +112,11 @@ public:
           m_col    (1),
           m_rstr   (1),
           m_cstr   (1),
-          m_cvar   (1)
+          m_cvar   (1),
+          m_scPos  (0),
+          m_scState(0),
+          m_mfIn   (NULL),
+          m_mfOut  (NULL)
     {
         m_row [0] =  m_col [0] =
                 m_rstr[0] =  m_cstr[0] =
@@ -137,7 +160,11 @@ public:
         : m_row(dims.sum()),
           m_col(dims.sum()),
           m_rstr(dims.sum()),
-          m_cstr(dims.sum())
+          m_cstr(dims.sum()),
+          m_scPos(0),
+          m_scState(0),
+          m_mfIn   (NULL),
+          m_mfOut  (NULL)
     {
         const index_t d = dims.size();
         const index_t s = dims.sum();
@@ -203,7 +230,11 @@ public:
         : m_row (gsVector<size_t>::LinSpaced(rows,0,rows-1)),
           m_col (gsVector<size_t>::LinSpaced(cols,0,cols-1)),
           m_rstr(rows),
-          m_cstr(cols)
+          m_cstr(cols),
+          m_scPos(0),
+          m_scState(0),
+          m_mfIn   (NULL),
+          m_mfOut  (NULL)
     {
         GISMO_ASSERT( rows > 0 && cols > 0, "Block dimensions must be positive");
 
@@ -271,7 +302,11 @@ public:
         : m_row (rowInd),
           m_col (colInd),
           m_rstr((index_t)rowInd.size()),
-          m_cstr((index_t)colInd.size())
+          m_cstr((index_t)colInd.size()),
+          m_scPos(0),
+          m_scState(0),
+          m_mfIn   (NULL),
+          m_mfOut  (NULL)
         // ,m_cvar(colvar) //<< Bug
     {
         m_cvar = colvar;
@@ -306,6 +341,35 @@ public:
         m_rstr   .swap(other.m_rstr   );
         m_cstr   .swap(other.m_cstr   );
         m_cvar   .swap(other.m_cvar   );
+        m_scatter.swap(other.m_scatter);
+        std::swap(m_scPos  , other.m_scPos  );
+        std::swap(m_scState, other.m_scState);
+        std::swap(m_mfIn   , other.m_mfIn   );
+        std::swap(m_mfOut  , other.m_mfOut  );
+    }
+
+    /**
+     * @brief setStructure makes this an empty system (no matrix
+     * entries, zero right-hand side) with the same blocks and dof
+     * mappers as \a other
+     * @param[in] other the sparse system to take the structure from
+     */
+    void setStructure(const gsSparseSystem & other)
+    {
+        m_mappers = other.m_mappers;
+        m_row     = other.m_row;
+        m_col     = other.m_col;
+        m_rstr    = other.m_rstr;
+        m_cstr    = other.m_cstr;
+        m_cvar    = other.m_cvar;
+        m_matrix.resize(other.m_matrix.rows(), other.m_matrix.cols());
+        m_matrix.data().squeeze();
+        m_rhs.setZero(other.m_rhs.rows(), other.m_rhs.cols());
+        m_scatter.clear();
+        m_scPos   = 0;
+        m_scState = 0;
+        m_mfIn    = NULL;
+        m_mfOut   = NULL;
     }
     
     /**
@@ -328,6 +392,27 @@ public:
     {
         m_matrix.setZero();
         m_rhs   .setZero();
+        m_scatter.clear();
+        m_scState = 0;
+    }
+
+    /**
+     * @brief setValuesZero sets the values of the matrix and of the
+     * right-hand side to zero, keeping the sparsity pattern (and the
+     * memory) of the matrix. Use this before re-assembling the system,
+     * eg. in every Newton iteration or time step.
+     *
+     * If the scatter cache is recording, the recorded positions are
+     * used by all subsequent passes.
+     */
+    void setValuesZero()
+    {
+        std::fill(m_matrix.valuePtr(),
+                  m_matrix.valuePtr() + m_matrix.data().size(), T(0));
+        m_rhs.setZero();
+        if ( 1 == m_scState && !m_scatter.empty() )
+            m_scState = 2;
+        m_scPos = 0;
     }
 
     /// @brief the number of matrix columns
@@ -500,6 +585,241 @@ public: /* Accessors */
     */
     
 
+public: /* Sparsity pattern */
+
+    /**
+     * @brief computePattern sets up the matrix with its exact sparsity
+     * pattern (symbolic assembly). For every element of every patch,
+     * the couplings between the active basis functions of all row and
+     * column blocks are collected; the matrix is then allocated with
+     * exactly these entries (set to zero) and compressed. Pushing
+     * element contributions afterwards never triggers a reallocation.
+     *
+     * Row block \a i is assumed to be discretized by the same
+     * multi-basis as column block \a i (Galerkin setting). Couplings
+     * which are not due to a common element (eg. DG interface terms)
+     * are not included.
+     *
+     * If \a partition is given, only the elements of part \a part
+     * are visited, as assembled by gsAssembler::setPartition(): the
+     * matrix keeps its global size, but only the rows and columns of
+     * the owned and ghost dofs of the part (see
+     * gsDomainPartition::dofs()) have entries. Boundary terms which
+     * the part assembles on elements of other parts (eg. of
+     * dirichlet::nitsche) are inserted outside the pattern.
+     * @param[in] bases the multi-bases, indexed as given by colBasis()
+     * @param[in] partition partition of the elements of \a bases, or NULL
+     * @param[in] part the part of \a partition
+     */
+    void computePattern(const std::vector< gsMultiBasis<T> > & bases,
+                        const gsDomainPartition<T> * partition = NULL,
+                        index_t part = 0)
+    {
+        const index_t nr = m_row.size();
+        const index_t nc = m_col.size();
+        GISMO_ASSERT( 1 == m_cvar.size() || nr <= m_cvar.size(),
+                      "Cannot deduce the bases of the row blocks");
+
+        // Sorted row indices of the non-zero entries, for each column
+        std::vector< std::vector<index_t> > nzRows(m_matrix.cols());
+
+        std::vector< gsMatrix<unsigned> > rActives(nr), cActives(nc);
+        gsMatrix<unsigned> actives;
+
+        const size_t np = bases[m_cvar[0]].nBases();
+        for (size_t p = 0; p != np; ++p)
+        {
+            typename gsBasis<T>::domainIter domIt =
+                bases[m_cvar[0]][p].makeDomainIterator();
+
+            for (index_t k = 0; domIt->good(); domIt->next(), ++k )
+            {
+                if ( partition && !partition->contains(part, p, k) )
+                    continue;
+                elementPattern(bases, p, domIt->centerPoint(), rActives, cActives,
+                               actives, nzRows);
+            }
+
+        }
+
+        gsVector<index_t> nnz(m_matrix.cols());
+        for (index_t j = 0; j != nnz.size(); ++j)
+            nnz[j] = nzRows[j].size();
+
+        const index_t rows = m_matrix.rows();
+        m_matrix.resize(0,0);// release previous storage
+        m_matrix.resize(rows, nnz.size());
+        m_matrix.reserve(nnz);
+        for (index_t j = 0; j != nnz.size(); ++j)
+        {
+            const std::vector<index_t> & col = nzRows[j];
+            for (size_t k = 0; k != col.size(); ++k)
+                m_matrix.insert(col[k], j) = T(0);
+        }
+        m_matrix.makeCompressed();
+
+        m_scatter.clear();
+        m_scState = 0;
+    }
+
+    /**
+     * @brief setScatterCache enables (or disables) the scatter cache.
+     *
+     * When enabled, the next assembly pass records for every matrix
+     * entry that is pushed its position in the value array of the
+     * (compressed) matrix. After setValuesZero() is called, the
+     * following passes write the local contributions to these
+     * positions directly, without any search or allocation. This
+     * assumes that every pass pushes the same element contributions in
+     * the same order, which is the case for repeated serial (or
+     * threading::deterministic) assembly with a fixed discretization,
+     * eg. in Newton iterations or time stepping.
+     *
+     * The sparsity pattern must be complete (see computePattern());
+     * if an entry outside the pattern is pushed while recording, or
+     * if a later pass pushes an entry other than the recorded one,
+     * the cache is switched off and the entries are added by search
+     * again.
+     * @param[in] on whether to use the cache
+     */
+    void setScatterCache(bool on = true)
+    {
+        GISMO_ASSERT( !on || m_matrix.isCompressed(),
+                      "The sparsity pattern must be computed first.");
+        m_scatter.clear();
+        m_scPos   = 0;
+        m_scState = on ? 1 : 0;
+    }
+
+    /// @brief returns true if the scatter cache is used (see setScatterCache())
+    bool scatterCached() const { return 0 != m_scState; }
+
+    /**
+     * @brief setApplyTo switches the system to matrix-free
+     * application: while \a y is not NULL, the pushes to the matrix
+     * compute \f$ y \mathrel{+}= A x \f$ instead of storing \f$A\f$.
+     * The right-hand side is updated as usual. If only the lower part
+     * of the matrix is pushed (symm), the upper part is applied too.
+     * @param[in] x the vector(s) to apply the matrix to
+     * @param[in] y the result, or NULL to store the matrix again
+     */
+    void setApplyTo(const gsMatrix<T> * x, gsMatrix<T> * y)
+    {
+        GISMO_ASSERT( NULL == y || ( x->rows() == m_matrix.cols() &&
+                                     y->rows() == m_matrix.rows() &&
+                                     x->cols() == y->cols() ),
+                      "Vector dimensions do not match the system.");
+        m_mfIn  = x;
+        m_mfOut = y;
+    }
+
+protected:
+
+    // Adds to nzRows the couplings of the basis functions of patch p
+    // which are active at the point center
+    void elementPattern(const std::vector< gsMultiBasis<T> > & bases, size_t p,
+                        const gsVector<T> & center,
+                        std::vector< gsMatrix<unsigned> > & rActives,
+                        std::vector< gsMatrix<unsigned> > & cActives,
+                        gsMatrix<unsigned> & actives,
+                        std::vector< std::vector<index_t> > & nzRows)
+    {
+        const index_t nr = m_row.size();
+        const index_t nc = m_col.size();
+
+        for (index_t c = 0; c != nc; ++c) // for all col-blocks
+        {
+            bases[m_cvar.size() == 1 ? m_cvar[0] : m_cvar[c]][p]
+                .active_into(center, actives);
+            mapColIndices(actives, p, cActives[c], c);
+        }
+
+        for (index_t r = 0; r != nr; ++r) // for all row-blocks
+        {
+            bases[m_cvar.size() == 1 ? m_cvar[0] : m_cvar[r]][p]
+                .active_into(center, actives);
+            mapRowIndices(actives, p, rActives[r], r);
+
+            const gsDofMapper & rowMap = m_mappers[m_row[r]];
+            for (index_t c = 0; c != nc; ++c) // for all col-blocks
+            {
+                const gsDofMapper & colMap = m_mappers[m_col[c]];
+                for (index_t i = 0; i != rActives[r].rows(); ++i)
+                {
+                    if ( ! rowMap.is_free_index(rActives[r].at(i)) )
+                        continue;
+                    const index_t ii = m_rstr[r] + rActives[r].at(i);
+
+                    for (index_t j = 0; j != cActives[c].rows(); ++j)
+                    {
+                        if ( ! colMap.is_free_index(cActives[c].at(j)) )
+                            continue;
+                        const index_t jj = m_cstr[c] + cActives[c].at(j);
+
+                        // If matrix is symmetric, we store only lower
+                        // triangular part
+                        if ( (!symm) || jj <= ii )
+                        {
+                            std::vector<index_t> & col = nzRows[jj];
+                            typename std::vector<index_t>::iterator pos =
+                                std::lower_bound(col.begin(), col.end(), ii);
+                            if ( pos == col.end() || *pos != ii )
+                                col.insert(pos, ii);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /// @brief adds \a val to the matrix entry (\a ii, \a jj),
+    /// using the scatter cache if enabled, or applies it to the
+    /// input vector in matrix-free mode
+    inline void addToMatrix(const index_t ii, const index_t jj, const T val)
+    {
+        if ( NULL != m_mfOut )
+        {
+            m_mfOut->row(ii).noalias() += val * m_mfIn->row(jj);
+            if ( symm && ii != jj )
+                m_mfOut->row(jj).noalias() += val * m_mfIn->row(ii);
+        }
+        else if ( 2 == m_scState )
+        {
+            // The recorded position must hold the entry (ii,jj)
+            const index_t pos = m_scPos < m_scatter.size() ? m_scatter[m_scPos] : -1;
+            if ( -1 != pos && m_matrix.innerIndexPtr()[pos] == ii &&
+                 m_matrix.outerIndexPtr()[jj] <= pos && pos < m_matrix.outerIndexPtr()[jj+1] )
+            {
+                m_matrix.valuePtr()[pos] += val;
+                ++m_scPos;
+            }
+            else
+            {
+                gsWarn<< "The pushes do not match the recorded scatter cache "
+                    "at entry ("<<ii<<","<<jj<<"), disabling the cache.\n";
+                m_scatter.clear();
+                m_scState = 0;
+                m_matrix.coeffRef(ii, jj) += val;
+            }
+        }
+        else if ( 1 == m_scState )
+        {
+            T & entry = m_matrix.coeffRef(ii, jj);
+            entry += val;
+            if ( m_matrix.isCompressed() )
+                m_scatter.push_back( &entry - m_matrix.valuePtr() );
+            else
+            {
+                gsWarn<< "Entry ("<<ii<<","<<jj<<") is not in the sparsity "
+                    "pattern, disabling the scatter cache.\n";
+                m_scatter.clear();
+                m_scState = 0;
+            }
+        }
+        else
+            m_matrix.coeffRef(ii, jj) += val;
+    }
+
 public: /* mapping patch-local to global indices */
 
     /**
@@ -605,7 +925,7 @@ public: /* Add local contributions to system matrix */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            addToMatrix(ii, jj, localMat(i, j));
                     }
                     else if(0!=eliminatedDofs.size())
                     {
@@ -658,7 +978,7 @@ public: /* Add local contributions to system matrix */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            addToMatrix(ii, jj, localMat(i, j));
                     }
                     else
                     {
@@ -700,7 +1020,7 @@ public: /* Add local contributions to system matrix */
                 // If matrix is symmetric, we store only lower
                 // triangular part
                 if ( (!symm) || jj <= ii )
-                    m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                    addToMatrix(ii, jj, localMat(i, j));
 
 
             }
@@ -738,7 +1058,7 @@ public: /* Add local contributions to system matrix */
                 // If matrix is symmetric, we store only lower
                 // triangular part
                 if ( (!symm) || jj <= ii )
-                    m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                    addToMatrix(ii, jj, localMat(i, j));
             }
         }
     }
@@ -831,7 +1151,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            addToMatrix(ii, jj, localMat(i, j));
                     }
                     else // if ( mapper.is_boundary_index(jj) ) // Fixed DoF?
                     {
@@ -885,7 +1205,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            addToMatrix(ii, jj, localMat(i, j));
                     }
                     else // if ( mapper.is_boundary_index(jj) ) // Fixed DoF?
                     {
@@ -927,7 +1247,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                 // If matrix is symmetric, we store only lower
                 // triangular part
                 if ( (!symm) || jj <= ii )
-                    m_matrix( ii, jj ) += localMat(i,j);
+                    addToMatrix(ii, jj, localMat(i,j));
             }
         }
     }
@@ -977,7 +1297,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                                 // If matrix is symmetric, we store only lower
                                 // triangular part
                                 if ( (!symm) || jj <= ii )
-                                    m_matrix.coeffRef(ii, jj) += localMat(i, j); //  + c * ..
+                                    addToMatrix(ii, jj, localMat(i, j)); //  + c * ..
                             }
                             else // if ( mapper.is_boundary_index(jj) ) // Fixed DoF?
                             {
@@ -1054,7 +1374,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            addToMatrix(ii, jj, localMat(i, j));
                 }
             }
         }
@@ -1100,7 +1420,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            addToMatrix(ii, jj, localMat(i, j));
                 }
             }
         }
@@ -1142,7 +1462,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            addToMatrix(ii, jj, localMat(i, j));
                     }
                 }
             }
@@ -0,0 +1,329 @@
+/** @file gsSumFactorization.h
+
+    @brief Sum-factorization kernels for element integrals of
+    tensor-product bases
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsTensor/gsTensorBasis.h>
+#include <gsMatrix/gsAsMatrix.h>
+#include <gsUtils/gsCombinatorics.h>
+#include <gsAssembler/gsAssemblerOptions.h>
+
+namespace gismo
+{
+
+/**
+    @brief Sum-factorization kernels for element matrices and vectors
+    of tensor-product bases on tensor-product quadrature rules.
+
+    On an element, every active function of a \em d-variate tensor
+    basis is a product \f$N_i = \prod_k B^k_{i_k}\f$ of univariate
+    functions, and every quadrature node is a tuple of univariate
+    nodes. An integral
+    \f[ M_{ij} = \sum_q c_q \prod_k L^k_{i_k}(q_k) R^k_{j_k}(q_k) \f]
+    is computed by contracting one direction at a time, which costs
+    \f$O(p^{2d+1})\f$ operations for degree \em p instead of the
+    \f$O(p^{3d})\f$ of the point by point summation.
+
+    The univariate data are given as matrices with one row per active
+    function and one column per univariate node. The coefficients are
+    given at the tensor nodes, the first direction running fastest
+    (the order of gsQuadRule::computeTensorProductRule). The local
+    indices of the result follow the ordering of
+    gsTensorBasis::active_into.
+
+    An object keeps the univariate evaluations of the current element
+    and the work space of the contractions, therefore every element
+    visitor (or thread) uses its own instance.
+
+    \ingroup Assembler
+*/
+template <class T>
+class gsSumFactorization
+{
+public:
+
+    /// @brief Prepares the kernels for \a basis and the Gauss rule
+    /// defined by \a options (see gsGaussRule). Returns false if
+    /// \a basis is not a tensor-product basis, in which case the
+    /// kernels cannot be used.
+    bool setup(const gsBasis<T> & basis, const gsAssemblerOptions & options)
+    {
+        if ( ! tensorComponents(basis, m_comps) )
+            return false;
+
+        const index_t d = m_comps.size();
+        m_numNodes.resize(d);
+        for (index_t k = 0; k != d; ++k) // as in gsGaussRule
+            m_numNodes[k] = static_cast<index_t>(options.quA * basis.degree(k)
+                                                 + options.quB + 0.5);
+        m_vals.resize(d);
+        m_ders.resize(d);
+        return true;
+    }
+
+    /// @brief Returns true if setup() succeeded
+    bool enabled() const { return ! m_comps.empty(); }
+
+    /// @brief Evaluates the univariate components on the element
+    /// with tensor quadrature nodes \a quNodes; derivatives are
+    /// computed if \a n is one.
+    void evaluate(const gsMatrix<T> & quNodes, int n)
+    {
+        GISMO_ASSERT( m_numNodes.prod() == quNodes.cols(),
+                      "The quadrature rule is not the expected tensor Gauss rule.");
+
+        index_t stride = 1;
+        for (size_t k = 0; k != m_comps.size(); ++k)
+        {
+            m_nodes.resize(1, m_numNodes[k]);
+            for (index_t j = 0; j != m_numNodes[k]; ++j)
+                m_nodes(0, j) = quNodes(k, j*stride);
+            stride *= m_numNodes[k];
+
+            m_comps[k]->evalAllDers_into(m_nodes, n, m_data);
+            m_vals[k].swap(m_data[0]);
+            if ( n > 0 )
+                m_ders[k].swap(m_data[1]);
+        }
+    }
+
+    /// @brief Mass type matrix of the current element, see mass()
+    void mass(const gsVector<T> & coef, gsMatrix<T> & result)
+    { mass(m_vals, coef, result); }
+
+    /// @brief Stiffness type matrix of the current element, see stiffness()
+    void stiffness(const gsMatrix<T> & coefs, gsMatrix<T> & result)
+    { stiffness(m_vals, m_ders, coefs, result); }
+
+    /// @brief Moments of the current element, see moments()
+    void moments(const gsMatrix<T> & coef, gsMatrix<T> & result)
+    { moments(m_vals, coef, result); }
+
+public:
+
+    /// @brief Collects the univariate components of \a basis in \a
+    /// comps. Returns false if \a basis is not a tensor-product basis
+    /// of dimension 2, 3 or 4.
+    static bool tensorComponents(const gsBasis<T> & basis,
+                                 std::vector<const gsBasis<T>*> & comps)
+    {
+        comps.clear();
+        switch ( basis.dim() )
+        {
+        case 2: return getComponents<2>(basis, comps);
+        case 3: return getComponents<3>(basis, comps);
+        case 4: return getComponents<4>(basis, comps);
+        default: return false;
+        }
+    }
+
+    /// @brief Mass type matrix \f$\sum_q c_q N_i(q) N_j(q)\f$
+    /// \param[in] vals univariate values, one matrix per direction
+    /// \param[in] coef the coefficients at the tensor nodes
+    /// \param[out] result the element matrix
+    void mass(const std::vector<gsMatrix<T> > & vals,
+              const gsVector<T> & coef,
+              gsMatrix<T> & result)
+    {
+        std::vector<gsMatrix<T> > W(vals.size());
+        for (size_t k = 0; k != vals.size(); ++k)
+            pairProducts(vals[k], vals[k], W[k]);
+
+        contract(W, coef.data(), m_buf, m_tmp);
+        result.setZero(numFunctions(vals), numFunctions(vals));
+        scatterPairs(vals, m_buf, result, false);
+    }
+
+    /// @brief Stiffness type matrix \f$\sum_q \nabla N_i(q)^T C(q)
+    /// \nabla N_j(q)\f$ with symmetric \f$C\f$ acting on the
+    /// parametric gradients
+    /// \param[in] vals univariate values, one matrix per direction
+    /// \param[in] ders univariate derivatives, one matrix per direction
+    /// \param[in] coefs the d x d matrices \f$C(q)\f$ at the tensor
+    /// nodes, stored column-wise (one column per node)
+    /// \param[out] result the element matrix
+    void stiffness(const std::vector<gsMatrix<T> > & vals,
+                   const std::vector<gsMatrix<T> > & ders,
+                   const gsMatrix<T> & coefs,
+                   gsMatrix<T> & result)
+    {
+        const index_t d = vals.size();
+        GISMO_ASSERT( coefs.rows() == d*d, "Invalid coefficient size.");
+
+        const index_t n = numFunctions(vals);
+        result.setZero(n, n);
+
+        std::vector<gsMatrix<T> > W(d);
+        gsVector<T> c;
+        for (index_t r = 0; r != d; ++r)
+            for (index_t s = r; s != d; ++s)
+            {
+                // Directions with derivatives: r for N_i, s for N_j
+                for (index_t k = 0; k != d; ++k)
+                    pairProducts(k == r ? ders[k] : vals[k],
+                                 k == s ? ders[k] : vals[k], W[k]);
+
+                c = coefs.row(r + d*s).transpose();
+                contract(W, c.data(), m_buf, m_tmp);
+
+                // C is symmetric: the (s,r) term is the transposed (r,s) term
+                scatterPairs(vals, m_buf, result, false);
+                if ( r != s )
+                    scatterPairs(vals, m_buf, result, true);
+            }
+    }
+
+    /// @brief Moments \f$\sum_q c_q N_i(q)\f$, for one or more columns
+    /// of coefficients
+    /// \param[in] vals univariate values, one matrix per direction
+    /// \param[in] coef the coefficients at the tensor nodes, one row
+    /// per node
+    /// \param[out] result the element vector(s), one column per
+    /// column of \a coef
+    void moments(const std::vector<gsMatrix<T> > & vals,
+                 const gsMatrix<T> & coef,
+                 gsMatrix<T> & result)
+    {
+        std::vector<gsMatrix<T> > W(vals.size());
+        for (size_t k = 0; k != vals.size(); ++k)
+            W[k] = vals[k].transpose();
+
+        result.resize(numFunctions(vals), coef.cols());
+        gsMatrix<T> c;
+        for (index_t j = 0; j != coef.cols(); ++j)
+        {
+            c = coef.col(j);
+            contract(W, c.data(), m_buf, m_tmp);
+            result.col(j) = gsAsConstMatrix<T>(m_buf, result.rows(), 1);
+        }
+    }
+
+private:
+
+    template<int d>
+    static bool getComponents(const gsBasis<T> & basis,
+                              std::vector<const gsBasis<T>*> & comps)
+    {
+        const gsTensorBasis<d,T> * tb =
+            dynamic_cast<const gsTensorBasis<d,T>*>(&basis);
+        if ( NULL == tb )
+            return false;
+
+        comps.resize(d);
+        for (int k = 0; k != d; ++k)
+            comps[k] = &tb->component(k);
+        return true;
+    }
+
+    static index_t numFunctions(const std::vector<gsMatrix<T> > & vals)
+    {
+        index_t n = 1;
+        for (size_t k = 0; k != vals.size(); ++k)
+            n *= vals[k].rows();
+        return n;
+    }
+
+    // W(q, i + n*j) = L(i,q) * R(j,q)
+    static void pairProducts(const gsMatrix<T> & L, const gsMatrix<T> & R,
+                             gsMatrix<T> & W)
+    {
+        const index_t n = L.rows();
+        W.resize(L.cols(), n * R.rows());
+        for (index_t j = 0; j != R.rows(); ++j)
+            for (index_t i = 0; i != n; ++i)
+                W.col(i + n*j) = L.row(i).cwiseProduct(R.row(j)).transpose();
+    }
+
+    // Contracts the tensor \a coef (first direction fastest) with the
+    // matrices W[k], one direction at a time. The result is indexed
+    // by the column indices of W[0], W[1], ... (first fastest).
+    static void contract(const std::vector<gsMatrix<T> > & W,
+                         const T * coef, std::vector<T> & result,
+                         std::vector<T> & tmp)
+    {
+        index_t rest = 1;
+        for (size_t k = 0; k != W.size(); ++k)
+            rest *= W[k].rows();
+
+        const T * cur = coef;
+        index_t P = 1; // size of the contracted block
+        for (size_t k = 0; k != W.size(); ++k)
+        {
+            const index_t q = W[k].rows();
+            const index_t m = W[k].cols();
+            rest /= q;
+
+            tmp.resize(P * m * rest);
+            for (index_t r = 0; r != rest; ++r)
+                gsAsMatrix<T>(&tmp[0] + r*P*m, P, m).noalias() =
+                    gsAsConstMatrix<T>(cur + r*P*q, P, q) * W[k];
+
+            result.swap(tmp);
+            cur = &result[0];
+            P  *= m;
+        }
+    }
+
+    // Adds the contracted pairs (i1,j1,i2,j2,...) to the element
+    // matrix, or to its transpose if \a trans is true
+    static void scatterPairs(const std::vector<gsMatrix<T> > & vals,
+                             const std::vector<T> & pairs,
+                             gsMatrix<T> & result, bool trans)
+    {
+        const index_t d = vals.size();
+        gsVector<index_t> sz(2*d), v(2*d), stride(d);
+        index_t s = 1;
+        for (index_t k = 0; k != d; ++k)
+        {
+            sz[2*k] = sz[2*k+1] = vals[k].rows();
+            stride[k] = s;
+            s *= vals[k].rows();
+        }
+
+        v.setZero();
+        index_t c = 0;
+        do
+        {
+            index_t i = 0, j = 0;
+            for (index_t k = 0; k != d; ++k)
+            {
+                i += stride[k] * v[2*k  ];
+                j += stride[k] * v[2*k+1];
+            }
+            if ( trans )
+                result(j, i) += pairs[c++];
+            else
+                result(i, j) += pairs[c++];
+        }
+        while ( nextLexicographic(v, sz) );
+    }
+
+private:
+
+    // Univariate components of the basis
+    std::vector<const gsBasis<T>*> m_comps;
+
+    // Number of quadrature nodes per direction
+    gsVector<index_t> m_numNodes;
+
+    // Univariate values and derivatives on the current element
+    std::vector<gsMatrix<T> > m_vals, m_ders, m_data;
+    gsMatrix<T> m_nodes;
+
+    // Work space of the contractions
+    std::vector<T> m_buf;
+    std::vector<T> m_tmp;
+};
+
+} // namespace gismo
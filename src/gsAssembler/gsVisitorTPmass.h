@@ -0,0 +1,109 @@
+/** @file gsVisitorTPmass.h
+
+    @brief Mass visitor using sum-factorization for tensor-product bases
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsAssembler/gsVisitorMass.h>
+#include <gsAssembler/gsSumFactorization.h>
+
+namespace gismo
+{
+
+/**
+    @brief The visitor computes element mass integrals by
+    sum-factorization (see gsSumFactorization).
+
+    The result is the same as the one of gsVisitorMass. For bases
+    which are not tensor-product bases the visitor falls back to
+    gsVisitorMass.
+
+    \ingroup Assembler
+*/
+template <class T>
+class gsVisitorTPmass : public gsVisitorMass<T> // inherit to reuse functionality
+{
+public:
+    typedef gsVisitorMass<T> Base;
+
+public:
+
+    gsVisitorTPmass()
+    { }
+
+    gsVisitorTPmass(const gsPde<T> & pde)
+    { }
+
+    void initialize(const gsBasis<T> & basis,
+                    const index_t patchIndex,
+                    const gsAssemblerOptions & options,
+                    gsQuadRule<T>    & rule,
+                    unsigned         & evFlags )
+    {
+        Base::initialize(basis, patchIndex, options, rule, evFlags);
+        sumFact.setup(basis, options);
+    }
+
+    // Evaluate on element.
+    inline void evaluate(gsBasis<T> const       & basis,
+                         gsGeometryEvaluator<T> & geoEval,
+                         gsMatrix<T>            & quNodes)
+    {
+        if ( ! sumFact.enabled() )
+        {
+            Base::evaluate(basis, geoEval, quNodes);
+            return;
+        }
+
+        // Compute the active basis functions
+        basis.active_into(quNodes.col(0) , actives);
+
+        // Evaluate the univariate components on the element
+        sumFact.evaluate(quNodes, 0);
+
+        // Compute geometry related values
+        geoEval.evaluateAt(quNodes);
+    }
+
+    inline void assemble(gsDomainIterator<T>    & element,
+                         gsGeometryEvaluator<T> & geoEval,
+                         gsVector<T> const      & quWeights)
+    {
+        if ( ! sumFact.enabled() )
+        {
+            Base::assemble(element, geoEval, quWeights);
+            return;
+        }
+
+        coef = quWeights.cwiseProduct( geoEval.measures() );
+        sumFact.mass(coef, localMat);
+    }
+
+    //Inherited from gsVisitorMass
+    //void localToGlobal( ... )
+
+private:
+
+    // Sum-factorization kernels
+    gsSumFactorization<T> sumFact;
+
+    // Quadrature weights times the geometry measure
+    gsVector<T> coef;
+
+    using Base::actives;
+
+    // Local matrix
+    using Base::localMat;
+};
+
+
+} // namespace gismo
@@ -0,0 +1,136 @@
+/** @file gsVisitorTPpoisson.h
+
+    @brief Poisson equation element visitor using sum-factorization
+    for tensor-product bases
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsAssembler/gsVisitorPoisson.h>
+#include <gsAssembler/gsSumFactorization.h>
+
+namespace gismo
+{
+
+/** \brief Visitor for the Poisson equation, which computes the
+ * element integrals by sum-factorization (see gsSumFactorization).
+ *
+ * Assembles the same terms as gsVisitorPoisson,
+ * \f[ (\nabla u,\nabla v)_\Omega \text{ and } (f,v)_\Omega \f].
+ * The geometry enters through the matrices \f$ w\,|J|\,J^{-1}J^{-T}
+ * \f$ at the quadrature nodes, therefore the cost per element is
+ * \f$O(p^{2d+1})\f$ instead of \f$O(p^{3d})\f$. For bases which are
+ * not tensor-product bases the visitor falls back to
+ * gsVisitorPoisson.
+ *
+ * \ingroup Assembler
+ */
+template <class T, bool paramCoef = false>
+class gsVisitorTPpoisson : public gsVisitorPoisson<T,paramCoef>
+{
+public:
+    typedef gsVisitorPoisson<T,paramCoef> Base;
+
+public:
+
+    gsVisitorTPpoisson(const gsPde<T> & pde) : Base(pde)
+    { }
+
+    /// Constructor with the right hand side function of the Poisson equation
+    gsVisitorTPpoisson(const gsFunction<T> & rhs) : Base(rhs)
+    { }
+
+    void initialize(const gsBasis<T> & basis,
+                    const index_t patchIndex,
+                    const gsAssemblerOptions & options,
+                    gsQuadRule<T>    & rule,
+                    unsigned         & evFlags )
+    {
+        Base::initialize(basis, patchIndex, options, rule, evFlags);
+        sumFact.setup(basis, options);
+    }
+
+    // Evaluate on element.
+    inline void evaluate(gsBasis<T> const       & basis,
+                         gsGeometryEvaluator<T> & geoEval,
+                         gsMatrix<T> const      & quNodes)
+    {
+        if ( ! sumFact.enabled() )
+        {
+            Base::evaluate(basis, geoEval, quNodes);
+            return;
+        }
+
+        // Compute the active basis functions
+        basis.active_into(quNodes.col(0), actives);
+        numActive = actives.rows();
+
+        // Evaluate the univariate components and their derivatives
+        sumFact.evaluate(quNodes, 1);
+
+        // Compute image of Gauss nodes under geometry mapping as well as Jacobians
+        geoEval.evaluateAt(quNodes);
+
+        // Evaluate right-hand side at the geometry points
+        rhs_ptr->eval_into( (paramCoef ?  quNodes :  geoEval.values() ), rhsVals );
+    }
+
+    inline void assemble(gsDomainIterator<T>    & element,
+                         gsGeometryEvaluator<T> & geoEval,
+                         gsVector<T> const      & quWeights)
+    {
+        if ( ! sumFact.enabled() )
+        {
+            Base::assemble(element, geoEval, quWeights);
+            return;
+        }
+
+        const index_t nPts = quWeights.rows();
+        const index_t d    = geoEval.parDim();
+
+        // Coefficients w |J| J^{-1} J^{-T} acting on the parametric gradients
+        coefs.resize(d*d, nPts);
+        for (index_t k = 0; k < nPts; ++k) // loop over quadrature nodes
+        {
+            const T weight = quWeights[k] * geoEval.measure(k);
+            const typename gsMatrix<T>::constColumns A = geoEval.gradTransform(k);
+            gsAsMatrix<T>(coefs.col(k).data(), d, d).noalias() =
+                weight * (A.transpose() * A);
+        }
+        sumFact.stiffness(coefs, localMat);
+
+        // Load vector
+        rhsCoef.noalias() = (quWeights.cwiseProduct(geoEval.measures())).asDiagonal()
+            * rhsVals.transpose();
+        sumFact.moments(rhsCoef, localRhs);
+    }
+
+    //Inherited from gsVisitorPoisson
+    //void localToGlobal( ... )
+
+private:
+
+    // Sum-factorization kernels
+    gsSumFactorization<T> sumFact;
+
+    // Geometry coefficients and weighted right hand side values
+    gsMatrix<T> coefs, rhsCoef;
+
+    using Base::rhs_ptr;
+    using Base::actives;
+    using Base::numActive;
+    using Base::rhsVals;
+    using Base::localMat;
+    using Base::localRhs;
+};
+
+
+} // namespace gismo
@@ -38,6 +38,13 @@ public:
             m_refs.push_back( &(*it)[k] );
     }
 
+    /// Constructor from a list of basis pointers \a refs
+    inline explicit gsBasisRefs(const std::vector<const gsBasis<T>*> & refs)
+    : m_refs(refs)
+    {
+        GISMO_ASSERT(refs.size()>0, "Cannot construct empty list of gsBasis.");
+    }
+
     /// Accessor for a certain gsBasis
     inline const gsBasis<T> & operator[](std::size_t i) const 
     { return *m_refs[i]; }
@@ -301,6 +301,475 @@ index_t gsDofMapper::coupledSize() const
 }
 
 
+void gsDofMapper::permuteFreeDofs(const std::vector<index_t> & perm)
+{
+    GISMO_ENSURE(m_curElimId==0, "finalize() was not called on gsDofMapper");
+    GISMO_ASSERT(static_cast<index_t>(perm.size()) == m_numFreeDofs,
+                 "permuteFreeDofs: the permutation has wrong size");
+#ifndef NDEBUG
+    const index_t numStd = m_numFreeDofs - m_numCpldDofs;
+    for (index_t i = 0; i != m_numFreeDofs; ++i)
+        GISMO_ASSERT( (i < numStd) == (perm[i] < numStd),
+                      "permuteFreeDofs: standard and coupled dofs are mixed");
+#endif
+
+    for (std::vector<index_t>::iterator it = m_dofs.begin(); it != m_dofs.end(); ++it)
+        if ( *it < m_numFreeDofs )
+            *it = perm[*it];
+}
+
+void gsDofMapper::freeDofAnchors(std::vector<std::size_t> & anchor) const
+{
+    anchor.assign(m_numFreeDofs, m_dofs.size());
+    for (std::size_t k = 0; k != m_dofs.size(); ++k)
+    {
+        const index_t d = m_dofs[k];
+        if ( d < m_numFreeDofs && anchor[d] == m_dofs.size() )
+            anchor[d] = k;
+    }
+}
+
+void gsDofMapper::graphProfile(const std::vector<std::vector<index_t> > & adj,
+                               index_t & bandwidth, index_t & profile)
+{
+    bandwidth = profile = 0;
+    for (std::size_t i = 0; i != adj.size(); ++i)
+    {
+        index_t first = static_cast<index_t>(i);
+        for (std::vector<index_t>::const_iterator it = adj[i].begin(); it != adj[i].end(); ++it)
+            first = math::min(first, *it);
+        bandwidth = math::max(bandwidth, static_cast<index_t>(i) - first);
+        profile  += static_cast<index_t>(i) - first;
+    }
+}
+
+void gsDofMapper::orderProfile(const std::vector<std::vector<index_t> > & adj,
+                               const std::vector<index_t> & order,
+                               index_t & bandwidth, index_t & profile)
+{
+    std::vector<index_t> pos(order.size());
+    for (std::size_t i = 0; i != order.size(); ++i)
+        pos[order[i]] = static_cast<index_t>(i);
+
+    bandwidth = profile = 0;
+    for (std::size_t i = 0; i != adj.size(); ++i)
+    {
+        index_t first = pos[i];
+        for (std::vector<index_t>::const_iterator it = adj[i].begin(); it != adj[i].end(); ++it)
+            first = math::min(first, pos[*it]);
+        bandwidth = math::max(bandwidth, pos[i] - first);
+        profile  += pos[i] - first;
+    }
+}
+
+unsigned long long gsDofMapper::hilbertKey(std::vector<unsigned> x, int bits)
+{
+    // J. Skilling, Programming the Hilbert curve, AIP Conf. Proc. 707, 2004
+    const std::size_t n = x.size();
+    const unsigned M = 1u << (bits - 1);
+    for (unsigned Q = M; Q > 1; Q >>= 1) // inverse undo
+    {
+        const unsigned P = Q - 1;
+        for (std::size_t i = 0; i != n; ++i)
+            if ( x[i] & Q )
+                x[0] ^= P;
+            else
+            {
+                const unsigned t = (x[0] ^ x[i]) & P;
+                x[0] ^= t;
+                x[i] ^= t;
+            }
+    }
+    for (std::size_t i = 1; i != n; ++i) // Gray encode
+        x[i] ^= x[i-1];
+    unsigned t = 0;
+    for (unsigned Q = M; Q > 1; Q >>= 1)
+        if ( x[n-1] & Q )
+            t ^= Q - 1;
+    for (std::size_t i = 0; i != n; ++i)
+        x[i] ^= t;
+
+    // Interleave the bits of the transposed index
+    unsigned long long key = 0;
+    for (int b = bits - 1; b >= 0; --b)
+        for (std::size_t i = 0; i != n; ++i)
+            key = (key << 1) | ((x[i] >> b) & 1u);
+    return key;
+}
+
+// Searches in the subgraphs of the graph of the free dofs which
+// consist of the vertices with the same label
+class gsDofGraphSearch
+{
+public:
+    typedef std::vector<std::vector<index_t> > Graph;
+
+    explicit gsDofGraphSearch(const Graph & adj)
+    : label(adj.size(), -1), m_adj(adj), m_stamp(adj.size(), 0), m_curStamp(0),
+      m_done(adj.size(), false), m_numLabels(0)
+    { }
+
+    // Returns a new label
+    index_t newLabel() { return m_numLabels++; }
+
+    // Labels the vertices vert by a new label, which is returned
+    index_t setLabel(const std::vector<index_t> & vert)
+    {
+        const index_t id = newLabel();
+        for (std::vector<index_t>::const_iterator it = vert.begin(); it != vert.end(); ++it)
+            label[*it] = id;
+        return id;
+    }
+
+    // Number of neighbors of v with the same label
+    index_t degree(index_t v) const
+    {
+        index_t res = 0;
+        for (std::vector<index_t>::const_iterator it = m_adj[v].begin(); it != m_adj[v].end(); ++it)
+            res += ( label[*it] == label[v] );
+        return res;
+    }
+
+    // Level structure rooted at root: the vertices of its component,
+    // level by level, and the start of every level followed by the
+    // number of vertices
+    void levels(index_t root, std::vector<index_t> & vert, std::vector<std::size_t> & start)
+    {
+        ++m_curStamp;
+        vert.assign(1, root);
+        start.clear();
+        m_stamp[root] = m_curStamp;
+        std::size_t b = 0;
+        while ( b != vert.size() )
+        {
+            start.push_back(b);
+            const std::size_t e = vert.size();
+            for (std::size_t i = b; i != e; ++i)
+                for (std::vector<index_t>::const_iterator it = m_adj[vert[i]].begin();
+                     it != m_adj[vert[i]].end(); ++it)
+                    if ( label[*it] == label[root] && m_stamp[*it] != m_curStamp )
+                    {
+                        m_stamp[*it] = m_curStamp;
+                        vert.push_back(*it);
+                    }
+            b = e;
+        }
+        start.push_back(vert.size());
+    }
+
+    // Finds a pseudo-peripheral vertex of the component of root
+    // (George and Liu) and returns its level structure
+    index_t peripheral(index_t root, std::vector<index_t> & vert, std::vector<std::size_t> & start)
+    {
+        levels(root, vert, start);
+        std::vector<index_t> vert2;
+        std::vector<std::size_t> start2;
+        for (;;)
+        {
+            // Vertex of minimum degree in the last level
+            index_t cand = vert[start[start.size() - 2]];
+            for (std::size_t i = start[start.size() - 2] + 1; i != vert.size(); ++i)
+                if ( degree(vert[i]) < degree(cand) )
+                    cand = vert[i];
+
+            levels(cand, vert2, start2);
+            if ( start2.size() <= start.size() )
+                return root;
+            root = cand;
+            vert .swap(vert2);
+            start.swap(start2);
+        }
+    }
+
+    // Appends the vertices vert, which have the same label, to order
+    // in reverse Cuthill-McKee order
+    void rcm(const std::vector<index_t> & vert, std::vector<index_t> & order)
+    {
+        const std::size_t first = order.size();
+        std::vector<index_t> comp, next;
+        std::vector<std::size_t> start;
+        std::vector<std::pair<index_t,index_t> > nb;
+        for (std::vector<index_t>::const_iterator vt = vert.begin(); vt != vert.end(); ++vt)
+        {
+            if ( m_done[*vt] ) continue;
+
+            // Cuthill-McKee order of the component, starting at a
+            // pseudo-peripheral vertex, neighbors by increasing degree
+            std::size_t head = order.size();
+            const index_t root = peripheral(*vt, comp, start);
+            order.push_back(root);
+            m_done[root] = true;
+            for (; head != order.size(); ++head)
+            {
+                const index_t v = order[head];
+                nb.clear();
+                for (std::vector<index_t>::const_iterator it = m_adj[v].begin(); it != m_adj[v].end(); ++it)
+                    if ( label[*it] == label[v] && !m_done[*it] )
+                    {
+                        nb.push_back(std::make_pair(degree(*it), *it));
+                        m_done[*it] = true;
+                    }
+                std::sort(nb.begin(), nb.end());
+                for (std::size_t i = 0; i != nb.size(); ++i)
+                    order.push_back(nb[i].second);
+            }
+        }
+        std::reverse(order.begin() + first, order.end());
+    }
+
+    // Appends the vertices vert, which have the same label, to order
+    // in reverse Cuthill-McKee order of the level structure rooted at
+    // all vertices roots (a subset of vert) at once, so that the roots
+    // come last and the vertices next to them right before. The
+    // components of vert without roots precede, in rcm() order.
+    void rcmFrom(const std::vector<index_t> & roots, const std::vector<index_t> & vert,
+                 std::vector<index_t> & order)
+    {
+        std::vector<index_t> cm;
+        std::vector<std::pair<index_t,index_t> > nb;
+        for (std::vector<index_t>::const_iterator it = roots.begin(); it != roots.end(); ++it)
+        {
+            cm.push_back(*it);
+            m_done[*it] = true;
+        }
+        for (std::size_t head = 0; head != cm.size(); ++head)
+        {
+            const index_t v = cm[head];
+            nb.clear();
+            for (std::vector<index_t>::const_iterator it = m_adj[v].begin(); it != m_adj[v].end(); ++it)
+                if ( label[*it] == label[v] && !m_done[*it] )
+                {
+                    nb.push_back(std::make_pair(degree(*it), *it));
+                    m_done[*it] = true;
+                }
+            std::sort(nb.begin(), nb.end());
+            for (std::size_t i = 0; i != nb.size(); ++i)
+                cm.push_back(nb[i].second);
+        }
+
+        rcm(vert, order); // the vertices which were not reached
+        order.insert(order.end(), cm.rbegin(), cm.rend());
+    }
+
+    // Appends the vertices vert, which have the same label, to order
+    // in nested dissection order: the vertices are split by a level
+    // of a level structure into two parts, which are ordered
+    // recursively, followed by the separating level
+    void dissect(const std::vector<index_t> & vert, std::vector<index_t> & order)
+    {
+        if ( vert.size() <= 32 )
+        {
+            rcm(vert, order);
+            return;
+        }
+
+        std::vector<index_t> comp;
+        std::vector<std::size_t> start;
+        peripheral(vert.front(), comp, start);
+
+        if ( comp.size() != vert.size() ) // more than one component
+        {
+            std::vector<index_t> rest;
+            setLabel(comp);
+            for (std::vector<index_t>::const_iterator it = vert.begin(); it != vert.end(); ++it)
+                if ( label[*it] != label[comp.front()] )
+                    rest.push_back(*it);
+            setLabel(rest);
+            dissect(comp, order);
+            dissect(rest, order);
+            return;
+        }
+
+        const std::size_t numLevels = start.size() - 1;
+        if ( numLevels < 3 )
+        {
+            rcm(vert, order);
+            return;
+        }
+
+        // The middle level separates the first and the last levels
+        std::size_t mid = 1;
+        while ( mid + 2 < numLevels && start[mid + 1] <= comp.size() / 2 )
+            ++mid;
+        std::vector<index_t> part1(comp.begin(), comp.begin() + start[mid]),
+            sep  (comp.begin() + start[mid], comp.begin() + start[mid + 1]),
+            part2(comp.begin() + start[mid + 1], comp.end());
+        setLabel(part1);
+        setLabel(part2);
+        setLabel(sep);
+        dissect(part1, order);
+        dissect(part2, order);
+        rcm(sep, order);
+    }
+
+public:
+    std::vector<index_t> label;
+
+private:
+    const Graph & m_adj;
+    std::vector<unsigned> m_stamp;
+    unsigned m_curStamp;
+    std::vector<bool> m_done;
+    index_t m_numLabels;
+};
+
+void gsDofMapper::orderFreeDofs(const std::vector<std::vector<index_t> > & adj,
+                                dofOrdering::type ordering,
+                                const std::vector<unsigned long long> & key,
+                                std::vector<index_t> & perm) const
+{
+    // The standard and the coupled dofs, each in the order of finalize()
+    std::vector<std::size_t> anchor;
+    freeDofAnchors(anchor);
+    const index_t numStd = m_numFreeDofs - m_numCpldDofs;
+    std::vector<std::pair<std::size_t,index_t> > sorted;
+    std::vector<index_t> range[2];
+    for (int r = 0; r != 2; ++r)
+    {
+        const index_t lo = ( 0 == r ? 0 : numStd ), hi = ( 0 == r ? numStd : m_numFreeDofs );
+        sorted.clear();
+        for (index_t i = lo; i != hi; ++i)
+            sorted.push_back(std::make_pair(anchor[i], i));
+        std::sort(sorted.begin(), sorted.end());
+        for (std::size_t i = 0; i != sorted.size(); ++i)
+            range[r].push_back(sorted[i].second);
+    }
+
+    std::vector<index_t> order;
+    order.reserve(m_numFreeDofs);
+    switch (ordering)
+    {
+    case dofOrdering::natural:
+        order = range[0];
+        order.insert(order.end(), range[1].begin(), range[1].end());
+        break;
+    case dofOrdering::rcm:
+    {
+        // The coupled dofs stay at the end, and every coupled row
+        // reaches back to the first standard dof of its patches: a
+        // level structure rooted at the interfaces minimizes the
+        // bandwidth, but the wide levels of the standard dofs may
+        // increase the profile. Among the candidates, the numbering
+        // with the smallest profile is kept, the natural one included.
+        std::vector<index_t> cand[3];
+
+        // Whole graph, rooted at the coupled dofs
+        std::vector<index_t> all = range[0];
+        all.insert(all.end(), range[1].begin(), range[1].end());
+        gsDofGraphSearch search(adj);
+        search.setLabel(all);
+        search.rcmFrom(range[1], all, cand[0]);
+        std::stable_partition(cand[0].begin(), cand[0].end(),
+                              std::bind2nd(std::less<index_t>(), numStd));
+
+        // Patch by patch, rooted at the standard dofs coupled to the
+        // interfaces of later patches, so that they are next to the
+        // dofs of these patches
+        std::vector<std::size_t> patch(m_numFreeDofs);
+        for (index_t i = 0; i != m_numFreeDofs; ++i)
+            patch[i] = std::upper_bound(m_offset.begin(), m_offset.end(), anchor[i])
+                - m_offset.begin();
+        std::vector<std::size_t> lastPatch(m_numFreeDofs - numStd, 0);
+        for (index_t i = 0; i != numStd; ++i)
+            for (std::vector<index_t>::const_iterator it = adj[i].begin(); it != adj[i].end(); ++it)
+                if ( *it >= numStd )
+                    lastPatch[*it - numStd] = math::max(lastPatch[*it - numStd], patch[i]);
+        gsDofGraphSearch patchSearch(adj);
+        std::vector<index_t> part, roots;
+        for (std::size_t i = 0; i != range[0].size(); ++i)
+        {
+            const index_t v = range[0][i];
+            part.push_back(v);
+            for (std::vector<index_t>::const_iterator it = adj[v].begin(); it != adj[v].end(); ++it)
+                if ( *it >= numStd && lastPatch[*it - numStd] > patch[v] )
+                {
+                    roots.push_back(v);
+                    break;
+                }
+            if ( i + 1 == range[0].size() || patch[v] != patch[range[0][i+1]] )
+            {
+                if ( roots.empty() )
+                    cand[1].insert(cand[1].end(), part.begin(), part.end());
+                else
+                {
+                    patchSearch.setLabel(part);
+                    patchSearch.rcmFrom(roots, part, cand[1]);
+                }
+                part.clear();
+                roots.clear();
+            }
+        }
+        cand[1].insert(cand[1].end(), range[1].begin(), range[1].end());
+
+        // Numbering of finalize()
+        cand[2].swap(all);
+
+        index_t best = 2, bw, pr, bestBw = 0, bestPr = 0;
+        orderProfile(adj, cand[2], bestBw, bestPr);
+        for (index_t c = 0; c != 2; ++c)
+        {
+            orderProfile(adj, cand[c], bw, pr);
+            if ( pr < bestPr || (pr == bestPr && bw < bestBw) )
+            {
+                best   = c;
+                bestBw = bw;
+                bestPr = pr;
+            }
+        }
+        order.swap(cand[best]);
+        break;
+    }
+    case dofOrdering::nestedDissection:
+    {
+        // The standard dofs of different patches are not coupled:
+        // the patches are dissected one by one, and the coupled dofs
+        // follow as the separators of the patches
+        gsDofGraphSearch search(adj);
+        std::vector<index_t> patch;
+        for (std::size_t i = 0; i != range[0].size(); ++i)
+        {
+            patch.push_back(range[0][i]);
+            if ( i + 1 == range[0].size() || std::upper_bound(m_offset.begin(), m_offset.end(), anchor[range[0][i]])
+                 != std::upper_bound(m_offset.begin(), m_offset.end(), anchor[range[0][i+1]]) )
+            {
+                search.setLabel(patch);
+                search.dissect(patch, order);
+                patch.clear();
+            }
+        }
+        search.setLabel(range[1]);
+        search.dissect(range[1], order);
+        break;
+    }
+    case dofOrdering::spaceFillingCurve:
+    {
+        // Patch by patch, along the curve
+        std::vector<std::pair<std::pair<std::size_t,unsigned long long>,index_t> > curve;
+        for (int r = 0; r != 2; ++r)
+        {
+            curve.clear();
+            for (std::vector<index_t>::const_iterator it = range[r].begin(); it != range[r].end(); ++it)
+            {
+                const std::size_t k = std::upper_bound(m_offset.begin(), m_offset.end(), anchor[*it])
+                    - m_offset.begin();
+                curve.push_back(std::make_pair(std::make_pair(k, key[anchor[*it]]), *it));
+            }
+            std::sort(curve.begin(), curve.end());
+            for (std::size_t i = 0; i != curve.size(); ++i)
+                order.push_back(curve[i].second);
+        }
+        break;
+    }
+    default:
+        GISMO_ERROR("gsDofMapper: unknown ordering "<< ordering);
+    }
+
+    GISMO_ASSERT( static_cast<index_t>(order.size()) == m_numFreeDofs, "gsDofMapper: wrong ordering");
+    perm.resize(m_numFreeDofs);
+    for (index_t i = 0; i != m_numFreeDofs; ++i)
+        perm[order[i]] = i;
+}
+
 void gsDofMapper::setShift (index_t shift)
 {
     m_shift=shift;
@@ -22,6 +22,32 @@ namespace gismo
 
 #define MAPPER_PATCH_DOF(a,b) m_dofs[m_offset[b]+a]
 
+/// @brief Numberings of the free dofs, see gsDofMapper::reorder()
+///
+/// \ingroup Core
+struct dofOrdering
+{
+    enum type
+    {
+        natural = 0, ///< Patch by patch, in patch-local order (numbering of finalize())
+
+        /// Reverse Cuthill-McKee, rooted at the coupled dofs or, patch
+        /// by patch, at the dofs next to the interfaces of later
+        /// patches; the candidate with the smallest profile is used,
+        /// hence the profile never exceeds the one of natural
+        rcm     = 1,
+
+        /// Nested dissection of every patch, the coupled dofs of the
+        /// interfaces being the top level separators; reduces the
+        /// fill-in of direct solvers
+        nestedDissection = 2,
+
+        /// Hilbert curve through the tensor indices of the dofs of
+        /// every patch; improves the locality of matrix-vector products
+        spaceFillingCurve = 3
+    };
+};
+
 /** @brief Maintains a mapping from patch-local dofs to global dof indices
     and allows the elimination of individual dofs.
 
@@ -61,6 +87,9 @@ namespace gismo
 
     The object must be finalized before it is used,
     i.e. gsDofMapper::finalize() has to be called once before use.
+    After finalize(), the free dofs can be renumbered by reorder() to
+    reduce the bandwidth or the fill-in of the system matrix; the
+    standard, coupled and eliminated dofs keep their ranges.
     
     \ingroup Core
 
@@ -216,6 +245,37 @@ public:
     /// been marked to set up the dof numbering.
     void finalize();
 
+    /**
+     * \brief Renumbers the free dofs by the strategy \a ordering.
+     *
+     * The graph of the matrix is given by the bases \a bases,
+     * which are the bases used to initialize the mapper: two dofs
+     * are coupled if their basis functions are active on a common
+     * element. The standard dofs are permuted among themselves and
+     * so are the coupled dofs, therefore the ranges of the standard,
+     * coupled and eliminated dofs do not change.
+     *
+     * If \a verbose is true, the bandwidth and the profile of the
+     * matrix before and after the renumbering are printed.
+     *
+     * \note This method must be called after finalize().
+     */
+    template<class T>
+    void reorder(const gsMultiBasis<T> & bases, dofOrdering::type ordering,
+                 bool verbose = false);
+
+    /// \brief Computes the \a bandwidth and the \a profile (number of
+    /// entries of the lower envelope) of the matrix coupling the free
+    /// dofs of \a bases, in the current numbering.
+    template<class T>
+    void matrixProfile(const gsMultiBasis<T> & bases,
+                       index_t & bandwidth, index_t & profile) const;
+
+    /// \brief Renumbers the free dofs, free dof \a i getting the
+    /// index \a perm[i]. The permutation must map the standard and
+    /// the coupled dofs to themselves.
+    void permuteFreeDofs(const std::vector<index_t> & perm);
+
     /// \brief Print summary to cout
     void print() const;
 
@@ -368,6 +428,37 @@ private:
 
     void mergeDofsGlobally(index_t dof1, index_t dof2);
 
+    // Adjacency lists of the free dofs, coupled by the elements of bases
+    template<class T>
+    void freeDofGraph(const gsMultiBasis<T> & bases,
+                      std::vector<std::vector<index_t> > & adj) const;
+
+    // Sets anchor[i] to the first patch-local dof (offsetted) of free
+    // dof i
+    void freeDofAnchors(std::vector<std::size_t> & anchor) const;
+
+    // Bandwidth and profile of the lower part of the graph adj
+    static void graphProfile(const std::vector<std::vector<index_t> > & adj,
+                             index_t & bandwidth, index_t & profile);
+
+    // Bandwidth and profile of the lower part of the graph adj, free
+    // dof order[i] getting the index i
+    static void orderProfile(const std::vector<std::vector<index_t> > & adj,
+                             const std::vector<index_t> & order,
+                             index_t & bandwidth, index_t & profile);
+
+    // Computes the permutation of the free dofs for ordering, given
+    // the graph adj and, for spaceFillingCurve, the curve positions
+    // key of the patch-local dofs
+    void orderFreeDofs(const std::vector<std::vector<index_t> > & adj,
+                       dofOrdering::type ordering,
+                       const std::vector<unsigned long long> & key,
+                       std::vector<index_t> & perm) const;
+
+    // Position on the Hilbert curve of the point with integer
+    // coordinates x[0..dim-1] < 2^bits
+    static unsigned long long hilbertKey(std::vector<unsigned> x, int bits);
+
 // Data members
 private:
 
@@ -12,6 +12,7 @@
 **/
 
 #include <gsCore/gsMultiBasis.h>
+#include <gsCore/gsDomainIterator.h>
 
 namespace gismo 
 {
@@ -136,5 +137,131 @@ void gsDofMapper::initSingle( const gsBasis<T> & basis)
     m_dofs.resize( m_numFreeDofs, 0);
 }
 
+template<class T>
+void gsDofMapper::freeDofGraph(const gsMultiBasis<T> & bases,
+                               std::vector<std::vector<index_t> > & adj) const
+{
+    GISMO_ASSERT( bases.nBases() == numPatches(), "The bases do not match the mapper");
+
+    adj.clear();
+    adj.resize(m_numFreeDofs);
+
+    gsMatrix<unsigned> act;
+    std::vector<index_t> glob;
+    for (size_t k = 0; k != bases.nBases(); ++k)
+    {
+        GISMO_ASSERT( m_offset[k] + bases[k].size() ==
+                      ( k + 1 == numPatches() ? m_dofs.size() : m_offset[k+1] ),
+                      "The size of basis "<< k <<" does not match the mapper");
+
+        typename gsBasis<T>::domainIter domIt = bases[k].makeDomainIterator();
+        for (; domIt->good(); domIt->next() )
+        {
+            bases[k].active_into(domIt->centerPoint(), act);
+            glob.clear();
+            for (index_t i = 0; i != act.rows(); ++i)
+            {
+                const index_t ii = MAPPER_PATCH_DOF(act(i,0), k);
+                if ( ii < m_numFreeDofs )
+                    glob.push_back(ii);
+            }
+            for (std::vector<index_t>::const_iterator it = glob.begin(); it != glob.end(); ++it)
+                adj[*it].insert(adj[*it].end(), glob.begin(), glob.end());
+        }
+    }
+
+    for (index_t i = 0; i != m_numFreeDofs; ++i)
+    {
+        std::vector<index_t> & nb = adj[i];
+        std::sort(nb.begin(), nb.end());
+        nb.erase(std::unique(nb.begin(), nb.end()), nb.end());
+        nb.erase(std::remove(nb.begin(), nb.end(), i), nb.end());
+        std::vector<index_t>(nb).swap(nb);
+    }
+}
+
+template<class T>
+void gsDofMapper::matrixProfile(const gsMultiBasis<T> & bases,
+                                index_t & bandwidth, index_t & profile) const
+{
+    GISMO_ENSURE(m_curElimId==0, "finalize() was not called on gsDofMapper");
+    std::vector<std::vector<index_t> > adj;
+    freeDofGraph(bases, adj);
+    graphProfile(adj, bandwidth, profile);
+}
+
+template<class T>
+void gsDofMapper::reorder(const gsMultiBasis<T> & bases, dofOrdering::type ordering,
+                          bool verbose)
+{
+    GISMO_ENSURE(m_curElimId==0, "finalize() was not called on gsDofMapper");
+
+    std::vector<std::vector<index_t> > adj;
+    freeDofGraph(bases, adj);
+
+    // Positions of the patch-local dofs on the Hilbert curve through
+    // the anchors. The coordinates of the anchors are replaced by
+    // their rank in every direction, which is the tensor index of
+    // the dof for tensor-product bases.
+    std::vector<unsigned long long> key;
+    if ( dofOrdering::spaceFillingCurve == ordering )
+    {
+        key.resize(m_dofs.size());
+        gsMatrix<T> anch;
+        std::vector<T> coord;
+        std::vector<unsigned> x;
+        for (size_t k = 0; k != bases.nBases(); ++k)
+        {
+            bases[k].anchors_into(anch);
+            const index_t d = anch.rows();
+            gsMatrix<unsigned> rank(d, anch.cols());
+            int bits = 1;
+            for (index_t i = 0; i != d; ++i)
+            {
+                coord.assign(anch.cols(), 0);
+                for (index_t j = 0; j != anch.cols(); ++j)
+                    coord[j] = anch(i, j);
+                std::sort(coord.begin(), coord.end());
+                coord.erase(std::unique(coord.begin(), coord.end()), coord.end());
+                for (index_t j = 0; j != anch.cols(); ++j)
+                    rank(i, j) = std::lower_bound(coord.begin(), coord.end(), anch(i, j))
+                        - coord.begin();
+                while ( (std::size_t(1) << bits) < coord.size() )
+                    ++bits;
+            }
+            GISMO_ENSURE( d * bits <= 64, "gsDofMapper: too many dofs for the space filling curve");
+
+            x.resize(d);
+            for (index_t j = 0; j != anch.cols(); ++j)
+            {
+                for (index_t i = 0; i != d; ++i)
+                    x[i] = rank(i, j);
+                key[m_offset[k] + j] = hilbertKey(x, bits);
+            }
+        }
+    }
+
+    std::vector<index_t> perm;
+    orderFreeDofs(adj, ordering, key, perm);
+    permuteFreeDofs(perm);
+
+    if ( verbose )
+    {
+        index_t bw0, pr0, bw1, pr1;
+        graphProfile(adj, bw0, pr0);
+        std::vector<std::vector<index_t> > padj(adj.size());
+        for (size_t i = 0; i != adj.size(); ++i)
+        {
+            std::vector<index_t> & nb = padj[perm[i]];
+            nb.reserve(adj[i].size());
+            for (std::vector<index_t>::const_iterator it = adj[i].begin(); it != adj[i].end(); ++it)
+                nb.push_back(perm[*it]);
+        }
+        graphProfile(padj, bw1, pr1);
+        gsInfo << "gsDofMapper: bandwidth "<< bw0 <<" -> "<< bw1
+               <<", profile "<< pr0 <<" -> "<< pr1 <<"\n";
+    }
+}
+
 }
 
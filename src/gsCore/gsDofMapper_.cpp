@@ -32,6 +32,14 @@ namespace gismo {
 
     TEMPLATE_INST void gsDofMapper::initSingle(
         const gsBasis<real_t> & bases);
+
+    TEMPLATE_INST void gsDofMapper::reorder(
+        const gsMultiBasis<real_t> & bases, dofOrdering::type ordering,
+        bool verbose);
+
+    TEMPLATE_INST void gsDofMapper::matrixProfile(
+        const gsMultiBasis<real_t> & bases,
+        index_t & bandwidth, index_t & profile) const;
 }
 
 
@@ -164,6 +164,7 @@ template< class T = real_t>  class gsPoissonPde;
 template< class T = real_t>  class gsStokesAssembler;
 template< class T = real_t>  class gsGenericAssembler;
 template< class T = real_t>  class gsPoissonAssembler;
+template< class T = real_t>  class gsDomainPartition;
 template< class T = real_t>  class gsSolverUtils;
 template< class T = real_t, bool symm = false>  class gsSparseSystem;
 template< class T = real_t>  class gsConvDiffRePde;
@@ -173,6 +174,7 @@ template< class T = real_t>  class gsCurveLoop;
 template< class T = real_t>  class gsPlanarDomain;
 template< class T = real_t>  class gsField;
 template< class T = real_t>  class gsMesh;
+template< class T = real_t>  class gsIndexedMesh;
 template< class T = real_t>  class gsHeMesh;
 
 template< class T = real_t>  class gsFileData;
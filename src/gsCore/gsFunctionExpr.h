@@ -36,6 +36,13 @@ template<typename T> class gsFunctionExprPrivate;
 
     for more details.
 
+    The expressions are compiled once, when they are added. The
+    evaluation is reentrant: every OpenMP thread evaluates on its own
+    copy of the variables and of the compiled expressions, which is
+    created on the first call of the thread. The derivatives are
+    computed by automatic differentiation of the expressions, except
+    for multi-precision scalar types, which use finite differences.
+
     \ingroup function
     \ingroup Core
 */
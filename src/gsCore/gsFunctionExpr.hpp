@@ -15,6 +15,8 @@
 
 #include <gsCore/gsLinearAlgebra.h>
 
+#include <map>
+
 /* ExprTk options */
 
 //This define will enable printing of debug information to stdout during
@@ -49,16 +51,17 @@
 // in a compilation failure.
 #define exprtk_disable_string_capabilities
 
-#ifdef GISMO_WITH_ADIFF
-  /* Optional automatic differentiation */
-  #define DScalar gismo::ad::DScalar2<real_t,-1>
-  #include <exprtk_ad_adaptor.hpp>   // external file
-#elif defined(GISMO_WITH_MPFR)
+#if defined(GISMO_WITH_MPFR)
   #include <exprtk_mpfr_adaptor.hpp> // external file
 #elif defined(GISMO_WITH_MPQ)
   #include <exprtk_gmp_adaptor.hpp>  // external file
 #else
-  #include <exprtk.hpp>              // external file
+  /* Automatic differentiation: with GISMO_WITH_ADIFF all evaluations
+     use the autodiff type, otherwise the values use T and the
+     derivatives use a second compilation of the expressions */
+  #define DScalar gismo::ad::DScalar2<real_t,-1>
+  #define GISMO_FUNCTIONEXPR_AD
+  #include <exprtk_ad_adaptor.hpp>   // external file
 #endif
 
 #include <gsIO/gsXml.h>
@@ -157,6 +160,12 @@ public:
     typedef exprtk::expression<Numeric_t>    Expression_t;
     typedef exprtk::parser<Numeric_t>        Parser_t;
 
+#ifdef GISMO_FUNCTIONEXPR_AD
+    typedef DScalar                          AdNumeric_t;
+    typedef exprtk::symbol_table<DScalar>    AdSymbolTable_t;
+    typedef exprtk::expression<DScalar>      AdExpression_t;
+#endif
+
 public:
 
     gsFunctionExprPrivate(const int _dim)
@@ -178,8 +187,16 @@ public:
             addComponent(other.string[i]);
     }
 
+    ~gsFunctionExprPrivate()
+    {
+        freeContexts();
+    }
+
     void addComponent(const std::string & strExpression)
     { 
+        // The contexts of the threads have to be re-created
+        freeContexts();
+
         string.push_back( strExpression );// Keep string data
         std::string & str = string.back();
         str.erase(std::remove(str.begin(), str.end(),' '), str.end() );
@@ -225,7 +242,106 @@ public:
         //symbol_table.remove_variable("w",vars[3]);
         symbol_table.add_pi();
         //symbol_table.add_constant("C", 1);
+
+#       if defined(GISMO_FUNCTIONEXPR_AD) && !defined(GISMO_WITH_ADIFF)
+        ad_symbol_table.add_variable("x",ad_vars[0]);
+        ad_symbol_table.add_variable("y",ad_vars[1]);
+        ad_symbol_table.add_variable("z",ad_vars[2]);
+        ad_symbol_table.add_variable("w",ad_vars[3]);
+        ad_symbol_table.add_variable("u",ad_vars[4]);
+        ad_symbol_table.add_variable("v",ad_vars[5]);
+        ad_symbol_table.add_pi();
+        ad_compiled = false;
+#       endif
     }
+
+    /// Returns the evaluation context of the calling thread: the
+    /// object itself for the initial thread, otherwise a copy which
+    /// is created on the first call of the thread. The variables and
+    /// the compiled expressions of a context are used by one thread
+    /// only, therefore the evaluation is reentrant.
+    ///
+    /// An OpenMP thread is identified by its thread number in every
+    /// enclosing team, so the threads of nested teams get contexts of
+    /// their own as well. Threads which are not created by OpenMP
+    /// (eg. std::thread) cannot be told apart from the initial thread
+    /// and must evaluate on copies of the function.
+    const gsFunctionExprPrivate & context() const
+    {
+#       ifdef _OPENMP
+        const int level = omp_get_level();
+        std::vector<int> path(level);
+        bool initial = true;
+        for (int l = 1; l <= level; ++l)
+        {
+            path[l-1] = omp_get_ancestor_thread_num(l);
+            initial   = initial && 0 == path[l-1];
+        }
+        if ( !initial )
+        {
+            gsFunctionExprPrivate * res;
+#           pragma omp critical (gsFunctionExpr_context)
+            {
+                gsFunctionExprPrivate * & ctx = contexts[path];
+                if ( NULL == ctx )
+                    ctx = new gsFunctionExprPrivate(*this);
+                res = ctx;
+            }
+            return *res;
+        }
+#       endif
+        return *this;
+    }
+
+    void freeContexts()
+    {
+        for (typename std::map<std::vector<int>, gsFunctionExprPrivate*>::iterator
+                 it = contexts.begin(); it != contexts.end(); ++it)
+            delete it->second;
+        contexts.clear();
+    }
+
+#ifdef GISMO_FUNCTIONEXPR_AD
+    /// Returns the autodiff variables
+    AdNumeric_t * adVars() const
+    {
+#       ifdef GISMO_WITH_ADIFF
+        return vars;
+#       else
+        return ad_vars;
+#       endif
+    }
+
+    /// Returns the autodiff expressions, which are compiled on the
+    /// first call, or NULL if they do not compile (eg. for functions
+    /// which the autodiff type does not provide); then the
+    /// derivatives are computed by finite differences
+    const std::vector<AdExpression_t> * adExpression() const
+    {
+#       ifdef GISMO_WITH_ADIFF
+        return &expression;
+#       else
+        if ( ad_expression.size() != string.size() )
+        {
+            ad_expression.clear();
+            ad_expression.resize(string.size());
+            ad_compiled = true;
+            exprtk::parser<DScalar> parser;
+            for (std::size_t i = 0; i!= string.size(); ++i)
+            {
+                ad_expression[i].register_symbol_table(ad_symbol_table);
+                if ( ! parser.compile(string[i], ad_expression[i]) )
+                {
+                    gsWarn<<"gsFunctionExpr: "<<parser.error()<<" while compiling "
+                          <<string[i]<<" for differentiation, using finite differences.\n";
+                    ad_compiled = false;
+                }
+            }
+        }
+        return ad_compiled ? &ad_expression : NULL;
+#       endif
+    }
+#endif
     
 public:
     mutable Numeric_t         vars[6];
@@ -234,6 +350,18 @@ public:
     std::vector<std::string>  string; 
     index_t dim;
 
+#if defined(GISMO_FUNCTIONEXPR_AD) && !defined(GISMO_WITH_ADIFF)
+    // Compilation of the expressions for the derivatives
+    mutable AdNumeric_t                 ad_vars[6];
+    mutable AdSymbolTable_t             ad_symbol_table;
+    mutable std::vector<AdExpression_t> ad_expression;
+    mutable bool                        ad_compiled;
+#endif
+
+    // Evaluation contexts of the threads other than the initial one,
+    // by the thread numbers in the enclosing teams
+    mutable std::map<std::vector<int>, gsFunctionExprPrivate*> contexts;
+
 private:
     gsFunctionExprPrivate();
     gsFunctionExprPrivate operator= (const gsFunctionExprPrivate & other); 
@@ -479,11 +607,7 @@ void gsFunctionExpr<T>::eval_into(const gsMatrix<T>& u, gsMatrix<T>& result) con
     const int n = targetDim();
     result.resize(n, u.cols());
 
-    const gsFunctionExprPrivate<T> & expr = 
-#   ifdef _OPENMP
-        omp_in_parallel() ? gsFunctionExprPrivate<T>(*my) : 
-#   endif
-        *my;
+    const gsFunctionExprPrivate<T> & expr = my->context();
 
     for ( index_t p = 0; p!=u.cols(); p++ ) // for all evaluation points
     {
@@ -508,14 +632,17 @@ void gsFunctionExpr<T>::eval_component_into(const gsMatrix<T>& u, const index_t
                   "Given component number is higher then number of components");
 
     result.resize(1, u.cols());
+
+    const gsFunctionExprPrivate<T> & expr = my->context();
+
     for ( index_t p = 0; p!=u.cols(); ++p )
     {
-        copy_n(u.col(p).data(), my->dim, my->vars);
+        copy_n(u.col(p).data(), expr.dim, expr.vars);
 
 #           ifdef GISMO_WITH_ADIFF
-            result(0,p) = my->expression[comp].value().getValue();
+            result(0,p) = expr.expression[comp].value().getValue();
 #           else
-            result(0,p) = my->expression[comp].value();
+            result(0,p) = expr.expression[comp].value();
 #           endif
     }
 }
@@ -523,7 +650,6 @@ void gsFunctionExpr<T>::eval_component_into(const gsMatrix<T>& u, const index_t
 template<typename T>
 void gsFunctionExpr<T>::deriv_into(const gsMatrix<T>& u, gsMatrix<T>& result) const
 {
-    //gsDebug<< "Using finite differences (gsFunctionExpr::deriv_into) for derivatives.\n";
     const index_t d = domainDim();
     GISMO_ASSERT ( u.rows() == my->dim, "Inconsistent point dimension (expected: "
                    << my->dim <<", got "<< u.rows() <<")");
@@ -531,27 +657,36 @@ void gsFunctionExpr<T>::deriv_into(const gsMatrix<T>& u, gsMatrix<T>& result) co
     const int n = targetDim();
     result.resize(d*n, u.cols());
 
-    const gsFunctionExprPrivate<T> & expr = 
-#   ifdef _OPENMP
-        omp_in_parallel() ? gsFunctionExprPrivate<T>(*my) : 
-#   endif
-        *my;
+    const gsFunctionExprPrivate<T> & expr = my->context();
     
+#   ifdef GISMO_FUNCTIONEXPR_AD
+    const std::vector<typename gsFunctionExprPrivate<T>::AdExpression_t> * 
+        adExpr = expr.adExpression();
+    if ( adExpr )
+    {
+        DScalar * vars = expr.adVars();
+        for ( index_t p = 0; p!=u.cols(); p++ ) // for all evaluation points
+        {
+            for (index_t k = 0; k!=d; ++k)
+                vars[k].setVariable(k,d,u(k,p));
+            for (int c = 0; c!= n; ++c) // for all components
+                result.block(c*d,p,d,1) = (*adExpr)[c].value().getGradient();
+        }
+        return;
+    }
+#   endif
+
+#   ifndef GISMO_WITH_ADIFF
     for ( index_t p = 0; p!=u.cols(); p++ ) // for all evaluation points
     {
-#       ifdef GISMO_WITH_ADIFF
-        for (index_t k = 0; k!=d; ++k)
-            expr.vars[k].setVariable(k,d,u(k,p));
-        for (int c = 0; c!= n; ++c) // for all components
-            result.block(c*d,p,d,1) = expr.expression[c].value().getGradient();
-#       else
+        //gsDebug<< "Using finite differences (gsFunctionExpr::deriv_into) for derivatives.\n";
         copy_n(u.col(p).data(), expr.dim, expr.vars);
         for (int c = 0; c!= n; ++c) // for all components
             for ( int j = 0; j!=d; j++ ) // for all variables
                 result(c*d + j, p) = 
                     exprtk::derivative<T>(expr.expression[c], expr.vars[j], 0.00001 ) ;
-#       endif
     }
+#   endif
 }
 
 template<typename T>
@@ -565,59 +700,68 @@ void gsFunctionExpr<T>::deriv2_into(const gsMatrix<T>& u, gsMatrix<T>& result) c
     const unsigned stride = d + d*(d-1)/2;
     result.resize(stride*n, u.cols() );
 
-    const gsFunctionExprPrivate<T> & expr = 
-#   ifdef _OPENMP
-        omp_in_parallel() ? gsFunctionExprPrivate<T>(*my) : 
+    const gsFunctionExprPrivate<T> & expr = my->context();    
+
+#   ifdef GISMO_FUNCTIONEXPR_AD
+    const std::vector<typename gsFunctionExprPrivate<T>::AdExpression_t> * 
+        adExpr = expr.adExpression();
+    if ( adExpr )
+    {
+        DScalar * vars = expr.adVars();
+        for ( index_t p = 0; p!=u.cols(); p++ ) // for all evaluation points
+        {
+            for (index_t v = 0; v!=d; ++v)
+                vars[v].setVariable(v,d,u(v,p));
+
+            for (int c = 0; c!= n; ++c) // for all components
+            {
+                const DScalar              ads  = (*adExpr)[c].value();
+                const DScalar::Hessian_t & Hmat = ads.getHessian();
+
+                for ( index_t k=0; k!=d; ++k)
+                {
+                    result(c*stride+k,p) = Hmat(k,k);
+                    index_t m = d;
+                    for ( index_t l=k+1; l<d; ++l)
+                        result(c*stride+m++,p) = Hmat(k,l);
+                }
+            }
+        }
+        return;
+    }
 #   endif
-        *my;    
 
+#   ifndef GISMO_WITH_ADIFF
     for ( index_t p = 0; p!=u.cols(); p++ ) // for all evaluation points
     {
-#       ifndef GISMO_WITH_ADIFF
         copy_n(u.col(p).data(), expr.dim, expr.vars);
-#       endif
 
         for (int c = 0; c!= n; ++c) // for all components
         {
-#           ifdef GISMO_WITH_ADIFF
-            for (index_t v = 0; v!=d; ++v)
-                expr.vars[v].setVariable(v,d,u(v,p));
-            const DScalar &            ads  = expr.expression[c].value();
-            const DScalar::Hessian_t & Hmat = ads.getHessian();
-
-            for ( index_t k=0; k!=d; ++k)
-            {
-                result(k,p) = Hmat(k,k);
-                index_t m = d;
-                for ( index_t l=k+1; l<d; ++l)
-                    result(m++,p) = Hmat(k,l);
-            }
-#           else
             for (index_t k = 0; k!=d; ++k)
             {
                 // H_{k,k}
-                result(k,p) = exprtk::
+                result(c*stride+k,p) = exprtk::
                     second_derivative<T>(expr.expression[c], expr.vars[k], 0.00001);
                 
                 index_t m = d;
                 for (index_t l=k+1; l<d; ++l)
                 {
                     // H_{k,l}
-                    result(m++,p) =
+                    result(c*stride+m++,p) =
                         mixed_derivative<T>( expr.expression[c], expr.vars[k], 
                                              expr.vars[l], 0.00001 );
                 }
             }
-#           endif
         }
     }
+#   endif
 }
 
 template<typename T>
 typename gsFunction<T>::uMatrixPtr
 gsFunctionExpr<T>::hess(const gsMatrix<T>& u, unsigned coord) const 
 { 
-    //gsDebug<< "Using finite differences (gsFunctionExpr::hess) for Hessian.\n";
     GISMO_ENSURE(coord == 0, "Error, function is real");
     GISMO_ASSERT ( u.cols() == 1, "Need a single evaluation point." );
     const index_t d = u.rows();
@@ -626,17 +770,23 @@ gsFunctionExpr<T>::hess(const gsMatrix<T>& u, unsigned coord) const
     
     gsMatrix<T> * res = new gsMatrix<T>(d,d);
 
-    const gsFunctionExprPrivate<T> & expr = 
-#   ifdef _OPENMP
-        omp_in_parallel() ? gsFunctionExprPrivate<T>(*my) : 
+    const gsFunctionExprPrivate<T> & expr = my->context();
+
+#   ifdef GISMO_FUNCTIONEXPR_AD
+    const std::vector<typename gsFunctionExprPrivate<T>::AdExpression_t> * 
+        adExpr = expr.adExpression();
+    if ( adExpr )
+    {
+        DScalar * vars = expr.adVars();
+        for (index_t v = 0; v!=d; ++v)
+            vars[v].setVariable(v, d, u(v,0) );
+        *res = (*adExpr)[coord].value().getHessian();
+        return typename gsFunction<T>::uMatrixPtr(res); 
+    }
 #   endif
-        *my;
 
-#   ifdef GISMO_WITH_ADIFF
-    for (index_t v = 0; v!=d; ++v)
-        expr.vars[v].setVariable(v, d, u(v,0) );
-    *res = expr.expression[coord].value().getHessian();
-#   else
+#   ifndef GISMO_WITH_ADIFF
+    //gsDebug<< "Using finite differences (gsFunctionExpr::hess) for Hessian.\n";
     copy_n(u.data(), expr.dim, expr.vars);
     for( int j=0; j!=d; ++j )
     {
@@ -662,69 +812,79 @@ gsMatrix<T> * gsFunctionExpr<T>::mderiv(const gsMatrix<T> & u,
     const int n = targetDim();
     gsMatrix<T> * res= new gsMatrix<T>(n,u.cols()) ;
     
-    const gsFunctionExprPrivate<T> & expr = 
-#   ifdef _OPENMP
-        omp_in_parallel() ? gsFunctionExprPrivate<T>(*my) : 
+    const gsFunctionExprPrivate<T> & expr = my->context();
+
+#   ifdef GISMO_FUNCTIONEXPR_AD
+    const std::vector<typename gsFunctionExprPrivate<T>::AdExpression_t> * 
+        adExpr = expr.adExpression();
+    if ( adExpr )
+    {
+        DScalar * vars = expr.adVars();
+        for( index_t p=0; p!=res->cols(); ++p )
+        {
+            for (index_t v = 0; v!=expr.dim; ++v)
+                vars[v].setVariable(v, expr.dim, u(v,p) );
+            for (int c = 0; c!= n; ++c) // for all components
+                (*res)(c,p) = (*adExpr)[c].value().getHessian()(k,j);
+        }
+        return res;
+    }
 #   endif
-        *my;
 
+#   ifndef GISMO_WITH_ADIFF
     for( index_t p=0; p!=res->cols(); ++p )
     {
-#       ifndef GISMO_WITH_ADIFF
         copy_n(u.col(p).data(), expr.dim, expr.vars);
-#       endif
-
         for (int c = 0; c!= n; ++c) // for all components
-        {
-#           ifdef GISMO_WITH_ADIFF
-            for (index_t v = 0; v!=expr.dim; ++v)
-                expr.vars[v].setVariable(v, expr.dim, u(v,p) );
-            expr.expression[c].value().getHessian();
-            (*res)(c,p) = expr.expression[c].value().getHessian()(k,j);
-#           else
             (*res)(c,p) =
                 mixed_derivative<T>( expr.expression[c], expr.vars[k], expr.vars[j], 0.00001 ) ;
-#           endif
-        }
     }
+#   endif
     return res; 
 }
 
 template<typename T>
 gsMatrix<T> * gsFunctionExpr<T>::laplacian(const gsMatrix<T>& u) const
 {
-    //gsDebug<< "Using finite differences (gsFunction::laplacian) for Laplacian.\n";
     GISMO_ASSERT ( u.rows() == my->dim, "Inconsistent point size.");
     const int n = targetDim();
     gsMatrix<T> * res= new gsMatrix<T>(n,u.cols()) ;
     
-    const gsFunctionExprPrivate<T> & expr = 
-#   ifdef _OPENMP
-        omp_in_parallel() ? gsFunctionExprPrivate<T>(*my) : 
+    const gsFunctionExprPrivate<T> & expr = my->context();
+
+#   ifdef GISMO_FUNCTIONEXPR_AD
+    const std::vector<typename gsFunctionExprPrivate<T>::AdExpression_t> * 
+        adExpr = expr.adExpression();
+    if ( adExpr )
+    {
+        DScalar * vars = expr.adVars();
+        for( index_t p = 0; p != res->cols(); ++p )
+        {
+            for (index_t v = 0; v!=expr.dim; ++v)
+                vars[v].setVariable(v, expr.dim, u(v,p) );
+            for (int c = 0; c!= n; ++c) // for all components
+                (*res)(c,p) = (*adExpr)[c].value().getHessian().trace();
+        }
+        return res;
+    }
 #   endif
-        *my;
 
+#   ifndef GISMO_WITH_ADIFF
     for( index_t p = 0; p != res->cols(); ++p )
     {
-#       ifndef GISMO_WITH_ADIFF
         copy_n(u.col(p).data(), expr.dim, expr.vars);
-#       endif
-
         for (int c = 0; c!= n; ++c) // for all components
         {
-#           ifdef GISMO_WITH_ADIFF
-            for (index_t v = 0; v!=expr.dim; ++v)
-                expr.vars[v].setVariable(v, expr.dim, u(v,p) );
-            (*res)(c,p) = expr.expression[c].value().getHessian().trace();
-#           else
+            //gsDebug<< "Using finite differences (gsFunction::laplacian) for Laplacian.\n";
             T & val = (*res)(c,p);
+            val = 0;
             for ( index_t j = 0; j!=expr.dim; ++j )
                 val += exprtk::
                     second_derivative<T>( expr.expression[c], expr.vars[j], 0.00001 );
-#           endif
         }
     }
-        return  res;
+#   endif
+    return  res;
 }
 
 template<typename T>
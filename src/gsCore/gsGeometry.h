@@ -497,6 +497,27 @@ public:
     virtual void invertPoints(const gsMatrix<T> & points, gsMatrix<T> & result,
                               const T accuracy = 1e-6);
 
+    /// @brief Takes the physical \a points and computes the
+    /// corresponding parameter values \a result, by Newton's method
+    /// (Gauss-Newton if the geometry dimension is larger than the
+    /// parametric one, ie. closest points).
+    ///
+    /// Every Newton iteration is started from the closest of
+    /// approximately \a numSamples sampled points of the geometry
+    /// (by default 16 per coefficient, but at most 8 per point and
+    /// not less than 64), found in a gsKdTree. The
+    /// Newton steps are computed for all points which have not
+    /// converged at once, in blocks of points which are processed in
+    /// parallel. A point has converged when the distance of its
+    /// image to the physical point (for closest points, the tangential
+    /// part of the distance) is at most \a accuracy. \a status
+    /// contains for every point the number of iterations, or -1 if
+    /// the accuracy was not reached within \a maxIter iterations or
+    /// the Jacobian was singular at an iterate.
+    void invertPoints(const gsMatrix<T> & points, gsMatrix<T> & result,
+                      gsVector<index_t> & status, const T accuracy = 1e-6,
+                      const int maxIter = 100, int numSamples = 0) const;
+
     /// Sets the patch index for this patch
     void setId(const size_t i) { m_id = i; }
 
@@ -18,6 +18,8 @@
 //#include <gsCore/gsBoundary.h>
 
 #include <gsCore/gsGeometrySlice.h>
+#include <gsUtils/gsPointGrid.h>
+#include <gsUtils/gsKdTree.h>
 
 namespace gismo
 {
@@ -85,14 +87,109 @@ void gsGeometry<T>::invertPoints(const gsMatrix<T> & points,
                                  gsMatrix<T> & result, 
                                  const T accuracy)
 {
-    result.resize(parDim(), points.cols() );
-    gsVector<T> arg;
-    for ( index_t i = 0; i!= points.cols(); ++i)
-    {         
-        arg = parameterCenter();
-        // int iter = 
-        this->newtonRaphson(points.col(i), arg, true, accuracy, 100);
-        result.col(i) = arg;
+    gsVector<index_t> status;
+    invertPoints(points, result, status, accuracy);
+}
+
+template<class T>
+void gsGeometry<T>::invertPoints(const gsMatrix<T> & points,
+                                 gsMatrix<T> & result,
+                                 gsVector<index_t> & status,
+                                 const T accuracy,
+                                 const int maxIter,
+                                 int numSamples) const
+{
+    const index_t pd = parDim();
+    const index_t gd = geoDim();
+    const index_t np = points.cols();
+    GISMO_ASSERT( points.rows() == gd, "Invalid input points");
+    result.resize(pd, np);
+    status.setConstant(np, -1);
+    if ( 0 == np ) return;
+
+    // Initial guesses: closest points of a sampled grid. The grid
+    // is not finer than needed for the number of points, so that
+    // inverting a few points on a large patch stays cheap
+    const gsMatrix<T> supp = support();
+    if ( numSamples <= 0 )
+        numSamples = math::min( 16 * math::max(static_cast<int>(coefsSize()), 1),
+                                math::max(64, 8 * static_cast<int>(np)) );
+    const gsMatrix<T> samplePars = gsPointGrid(supp, numSamples);
+    gsMatrix<T> samplePts;
+    eval_into(samplePars, samplePts);
+    const gsKdTree<T> tree(samplePts);
+
+    // Blocks of points, one Newton iteration is computed for all
+    // active points of a block at once
+    const index_t blockSize = 256;
+    const index_t numBlocks = (np + blockSize - 1) / blockSize;
+
+#   pragma omp parallel for
+    for (index_t b = 0; b < numBlocks; ++b)
+    {
+        const index_t first = b * blockSize;
+        const index_t last  = math::min(first + blockSize, np);
+
+        // Points of the block which have not converged yet
+        std::vector<index_t> active;
+        for (index_t i = first; i != last; ++i)
+        {
+            result.col(i) = samplePars.col( tree.nearest(points.col(i)) );
+            active.push_back(i);
+        }
+
+        gsMatrix<T> u, val, der;
+        gsMatrix<T> delta;
+        gsVector<T> res;
+        for (int iter = 0; iter < maxIter && !active.empty(); ++iter)
+        {
+            const index_t na = active.size();
+            u.resize(pd, na);
+            for (index_t j = 0; j != na; ++j)
+                u.col(j) = result.col(active[j]);
+            eval_into (u, val);
+            deriv_into(u, der);
+
+            index_t k = 0; // active points kept
+            for (index_t j = 0; j != na; ++j)
+            {
+                const index_t i = active[j];
+                res = points.col(i) - val.col(j);
+
+                // Converged if the physical residual is small enough
+                if ( pd == gd && res.norm() <= accuracy )
+                {
+                    status[i] = iter;
+                    continue;
+                }
+
+                // Jacobian of the point, stored transposed in der
+                const gsAsConstMatrix<T> jacT(der.col(j).data(), pd, gd);
+                const typename gsMatrix<T>::Base jac = jacT.transpose();
+
+                // Solve for the update, least squares if gd > pd; a
+                // singular Jacobian gives no update, the point fails
+                const Eigen::ColPivHouseholderQR<typename gsMatrix<T>::Base> qr(jac);
+                if ( qr.rank() < pd )
+                    continue;
+                delta = qr.solve(res);
+
+                // For gd > pd (closest point), converged if the
+                // residual has no tangential part, ie. the step is
+                // small in physical space
+                if ( pd != gd && (jac * delta).norm() <= accuracy )
+                {
+                    status[i] = iter;
+                    continue;
+                }
+
+                // update and clamp to the support
+                result.col(i) = (result.col(i) + delta)
+                    .cwiseMax( supp.col(0) ).cwiseMin( supp.col(1) );
+                active[k++] = i;
+            }
+            active.resize(k);
+        }
     }
 }
 
@@ -15,6 +15,7 @@
 
 #include <gsCore/gsForwardDeclarations.h>
 #include <gsCore/gsBoundary.h>
+#include <gsCore/gsFuncData.h>
 
 namespace gismo
 {
@@ -53,7 +54,7 @@ public:
        See gismo::gsNeedEnum for available flags.
     */
     gsGeometryEvaluator(const gsGeometry<T> & geo, unsigned flags)
-    : m_geo(geo), m_flags(flags), m_parDim(geo.parDim())
+    : m_geo(geo), m_flags(flags), m_parDim(geo.parDim()), m_cache(NULL)
     {}
     
     virtual ~gsGeometryEvaluator() {}
@@ -98,6 +99,16 @@ public:
 
     inline size_t id() const {return m_geo.id();}
 
+    /**
+       \brief Attaches a cache record to the evaluator.
+
+       While a record is attached, evaluateAt(u) restores the computed
+       quantities from \a rec if it holds the results for the same
+       points \em u and flags; otherwise the quantities are computed
+       and stored in \a rec. Pass NULL to detach the record.
+    **/
+    void setCacheRecord(gsMapData<T> * rec) {m_cache = rec;}
+
 public:
 
     /**
@@ -560,6 +571,45 @@ protected:
     gsVector<T>        m_measures;
     gsMatrix<T>        m_2ndDers;
 
+    gsMapData<T> *     m_cache;
+
+protected:
+
+    /// Returns true if the attached cache record holds the results
+    /// for the points \a u, and restores them in that case
+    bool restoreFromCache(const gsMatrix<T> & u)
+    {
+        if ( NULL == m_cache || m_cache->flags != m_flags ||
+             m_cache->points.cols() != u.cols() ||
+             m_cache->points.rows() != u.rows() ||
+             m_cache->points != u )
+            return false;
+
+        m_numPts    = u.cols();
+        m_values    = m_cache->values[0];
+        m_jacobians = m_cache->values[1];
+        m_2ndDers   = m_cache->values[2];
+        m_measures  = m_cache->measures;
+        m_jacInvs   = m_cache->fundForms;
+        return true;
+    }
+
+    /// Stores the results for the points \a u in the attached cache
+    /// record, if any
+    void storeToCache(const gsMatrix<T> & u) const
+    {
+        if ( NULL == m_cache ) return;
+
+        m_cache->flags = m_flags;
+        m_cache->points = u;
+        m_cache->values.resize(3);
+        m_cache->values[0] = m_values;
+        m_cache->values[1] = m_jacobians;
+        m_cache->values[2] = m_2ndDers;
+        m_cache->measures  = m_measures;
+        m_cache->fundForms = m_jacInvs;
+    }
+
 /*
     gsVector<T>        m_div;
     gsMatrix<T>        m_curl;
@@ -335,6 +335,9 @@ gsGenericGeometryEvaluator<T,ParDim,codim>::evaluateAt(const gsMatrix<T>& u)
 {
     GISMO_ASSERT( m_maxDeriv != -1, "Error in evaluation flags. -1 not supported yet.");
 
+    if ( this->restoreFromCache(u) )
+        return;
+
     m_numPts = u.cols();
     m_geo.basis().evalAllDers_into(u, m_maxDeriv, m_basisVals);
 
@@ -352,6 +355,8 @@ gsGenericGeometryEvaluator<T,ParDim,codim>::evaluateAt(const gsMatrix<T>& u)
         gsGeoTransform<T,ParDim,GeoDim>::getGradTransform(m_jacobians, m_jacInvs);
     if (this->m_flags & NEED_2ND_DER)
         compute2ndDerivs();
+
+    this->storeToCache(u);
 /*
     if (this->m_flags & NEED_DIV)
         divergence(m_div);
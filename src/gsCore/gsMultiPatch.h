@@ -234,6 +234,21 @@ public:
     /// to two points: the lower and upper corner of the bounding box.
     void boundingBox(gsMatrix<T> & result) const;
 
+    /// @brief Finds, for every column of \a points, a patch which
+    /// contains the point and the parameters of the point on that
+    /// patch.
+    ///
+    /// \a pids(i) is the index of the patch, or -1 if the i-th point
+    /// is farther than \a accuracy from all patches, and the i-th
+    /// column of \a preim contains its parameters. The candidate
+    /// patches of every point are found in a gsBoxTree of the bounding
+    /// boxes of the control points of the patches, then the points are
+    /// inverted patch by patch by the batched
+    /// gsGeometry::invertPoints. Points on an interface are assigned
+    /// to the patch with the smallest index.
+    void locatePoints(const gsMatrix<T> & points, gsVector<index_t> & pids,
+                      gsMatrix<T> & preim, const T accuracy = 1e-6) const;
+
 
     /** @brief Checks if all patch-interfaces are fully matching, and if not, repairs them, i.e., makes them fully matching.
     *
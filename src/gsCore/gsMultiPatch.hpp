@@ -19,6 +19,7 @@
 #include <gsCore/gsAffineFunction.h>
 
 #include <gsUtils/gsCombinatorics.h>
+#include <gsUtils/gsBoxTree.h>
 
 namespace gismo
 {
@@ -233,39 +234,133 @@ void gsMultiPatch<T>::boundingBox(gsMatrix<T> & result) const
 }
 
 
+template<class T>
+void gsMultiPatch<T>::locatePoints(const gsMatrix<T> & points,
+                                   gsVector<index_t> & pids,
+                                   gsMatrix<T> & preim,
+                                   const T accuracy) const
+{
+    const index_t np = points.cols();
+    const index_t nP = m_patches.size();
+    pids.setConstant(np, -1);
+    preim.setZero(m_dim, np);
+    if ( 0 == nP || 0 == np ) return;
+    GISMO_ASSERT( points.rows() == geoDim(), "Invalid input points");
+
+    // Bounding boxes of the control points (convex hull property)
+    const index_t gd = geoDim();
+    gsMatrix<T> lower(gd, nP), upper(gd, nP);
+    for (index_t p = 0; p != nP; ++p)
+    {
+        const gsMatrix<T> & cc = m_patches[p]->coefs();
+        lower.col(p) = cc.colwise().minCoeff().transpose().array() - accuracy;
+        upper.col(p) = cc.colwise().maxCoeff().transpose().array() + accuracy;
+    }
+    const gsBoxTree<T> tree(lower, upper);
+
+    // Candidate patches of the points, as lists of points per patch
+    std::vector<std::vector<index_t> > cand(nP);
+    std::vector<index_t> boxes;
+    for (index_t i = 0; i != np; ++i)
+    {
+        boxes.clear();
+        tree.query(points.col(i), boxes);
+        for (size_t k = 0; k != boxes.size(); ++k)
+            cand[boxes[k]].push_back(i);
+    }
+
+    // Invert the points which are not located yet, patch by patch
+    gsMatrix<T> pts, pars, vals;
+    gsVector<index_t> status;
+    std::vector<index_t> left;
+    for (index_t p = 0; p != nP; ++p)
+    {
+        left.clear();
+        for (size_t k = 0; k != cand[p].size(); ++k)
+            if ( -1 == pids[cand[p][k]] )
+                left.push_back(cand[p][k]);
+        if ( left.empty() ) continue;
+
+        pts.resize(gd, left.size());
+        for (size_t k = 0; k != left.size(); ++k)
+            pts.col(k) = points.col(left[k]);
+        m_patches[p]->invertPoints(pts, pars, status, accuracy);
+
+        // The inversion is clamped to the parameter domain, accept
+        // the points which are reproduced
+        m_patches[p]->eval_into(pars, vals);
+        for (size_t k = 0; k != left.size(); ++k)
+            if ( (vals.col(k) - pts.col(k)).norm() <= accuracy )
+            {
+                pids[left[k]] = p;
+                preim.col(left[k]) = pars.col(k);
+            }
+    }
+}
+
+
 /*
   This is based on comparing a set of reference points of the patch
   side and thus it implicitly assumes that the patch faces match
 */
+namespace internal
+{
+
+/// Lexicographic order of the grid cells of the patch sides, used by
+/// gsMultiPatch::computeTopology. The cells are the columns of \a cells.
+template<class T>
+struct gsSideCellLess
+{
+    explicit gsSideCellLess(const gsMatrix<T> & cells) : m_cells(cells) { }
+
+    bool operator()(index_t a, index_t b) const
+    { return less(m_cells.col(a).data(), m_cells.col(b).data()); }
+
+    bool operator()(index_t a, const T * k) const
+    { return less(m_cells.col(a).data(), k); }
+
+    bool operator()(const T * k, index_t a) const
+    { return less(k, m_cells.col(a).data()); }
+
+private:
+    bool less(const T * a, const T * b) const
+    { return std::lexicographical_compare(a, a + m_cells.rows(), b, b + m_cells.rows()); }
+
+    const gsMatrix<T> & m_cells;
+};
+
+} // namespace internal
+
 template<class T>
 bool gsMultiPatch<T>::computeTopology( T tol, bool cornersOnly )
 {
     gsBoxTopology::clearTopology();
+    if ( m_patches.empty() )
+        return true;
 
-    const size_t   np    = m_patches.size();
+    const index_t  np    = m_patches.size();
     const index_t  nCorP = 1 << m_dim;     // corners per patch
     const index_t  nCorS = 1 << (m_dim-1); // corners per side
-
-    gsMatrix<T> supp, 
-    // Parametric coordinates of the reference points. These points
-    // are used to decide if two sides match.
-    // Currently these are the corner points and the side-centers
-    coor;
-    if (cornersOnly)
-        coor.resize(m_dim,nCorP);
-    else
-        coor.resize(m_dim,nCorP + 2*m_dim);
-    
-    gsVector<bool> boxPar(m_dim);
+    const index_t  nSid  = 2 * m_dim;      // sides per patch
 
     // each matrix contains the physical coordinates of the reference points
     std::vector<gsMatrix<T> > pCorners(np); 
 
-    std::vector<patchSide> pSide; // list of all candidate patchSides to compare
-    pSide.reserve(np * 2 * m_dim);
-
-    for (size_t p=0; p<np; ++p)
+#   pragma omp parallel for
+    for (index_t p=0; p<np; ++p)
     {
+        gsMatrix<T> supp, 
+        // Parametric coordinates of the reference points. These points
+        // are used to decide if two sides match.
+        // Currently these are the corner points and the side-centers
+        coor;
+        if (cornersOnly)
+            coor.resize(m_dim,nCorP);
+        else
+            coor.resize(m_dim,nCorP + nSid);
+    
+        gsVector<bool> boxPar(m_dim);
+
         supp = m_patches[p]->parameterRange(); // the parameter domain of patch i
 
         // Corners' parametric coordinates
@@ -294,49 +389,121 @@ bool gsMultiPatch<T>::computeTopology( T tol, bool cornersOnly )
 
         // Evaluate the patch on the reference points
         m_patches[p]->eval_into(coor,pCorners[p]);
+    }
 
-        // Add all the patchSides of this patch to the candidate list
+    // List of all candidate patchSides to compare
+    std::vector<patchSide> sides;
+    sides.reserve(np * nSid);
+    for (index_t p=0; p<np; ++p)
         for (boxSide bs=boxSide::getFirst(m_dim); bs<boxSide::getEnd(m_dim); ++bs)
-            pSide.push_back(patchSide(p,bs));
+            sides.push_back(patchSide(p,bs));
+    const index_t ns = sides.size();
+
+    // Hash every side into a grid of cell size tol, by its center
+    // (or the mean of its corners). Two matching sides lie in the
+    // same or in neighboring cells. Only the first three physical
+    // coordinates are used.
+    const index_t gd = math::min(static_cast<index_t>(this->geoDim()), static_cast<index_t>(3));
+    std::vector<boxCorner> cId1, cId2;
+    cId1.reserve(nCorS);
+    cId2.reserve(nCorS);
+    gsMatrix<T> cells(gd, ns);
+    for (index_t s=0; s<ns; ++s)
+    {
+        const gsMatrix<T> & pc = pCorners[sides[s].patch];
+        if (!cornersOnly)
+            cells.col(s) = pc.col(nCorP+sides[s]-1).topRows(gd);
+        else
+        {
+            sides[s].getContainedCorners(m_dim,cId1);
+            cells.col(s).setZero();
+            for (size_t c=0; c<cId1.size(); ++c)
+                cells.col(s) += pc.col(cId1[c]-1).topRows(gd);
+            cells.col(s) /= static_cast<T>(cId1.size());
+        }
     }
+    for (index_t s=0; s<ns; ++s)
+        for (index_t i=0; i<gd; ++i)
+            cells(i,s) = math::floor( cells(i,s) / tol );
+
+    internal::gsSideCellLess<T> cellLess(cells);
+    std::vector<index_t> order(ns);
+    for (index_t s=0; s<ns; ++s)
+        order[s] = s;
+    std::sort(order.begin(), order.end(), cellLess);
+
+    // The sides are processed as a stack; pos holds the position of
+    // every side in pSide, or -1 after it is processed
+    std::vector<index_t> pSide(order.size()), pos(ns);
+    for (index_t s=0; s<ns; ++s)
+        pSide[s] = pos[s] = s;
 
     gsVector<index_t>      dirMap(m_dim);
     gsVector<bool>         matched(nCorS), dirOr(m_dim);
-    std::vector<boxCorner> cId1, cId2;
-    cId1.reserve(nCorS);
-    cId2.reserve(nCorS);
+    gsVector<T>            cell(gd);
+    gsVector<index_t>      off(gd), offLow(gd), offUpp(gd);
+    offLow.setConstant(-1);
+    offUpp.setConstant( 1);
+    std::vector<index_t>   cand;
+    typedef std::vector<index_t>::const_iterator idxIter;
 
     while ( pSide.size() != 0 )
     {
         bool done = false;
-        const patchSide side = pSide.back();
+        const index_t sid = pSide.back();
+        const patchSide & side = sides[sid];
+        pos[sid] = -1;
         pSide.pop_back();
-        for (size_t other=0; other<pSide.size(); ++other)
+
+        // Remaining sides in the neighboring cells, in the order of pSide
+        cand.clear();
+        off = offLow;
+        do
+        {
+            for (index_t i=0; i<gd; ++i)
+                cell[i] = cells(i,sid) + static_cast<T>(off[i]);
+            std::pair<idxIter,idxIter> range =
+                std::equal_range(order.begin(), order.end(), cell.data(), cellLess);
+            for (idxIter it = range.first; it != range.second; ++it)
+                if ( -1 != pos[*it] )
+                    cand.push_back(pos[*it]);
+        }
+        while ( nextCubePoint(off, offLow, offUpp) );
+        std::sort(cand.begin(), cand.end());
+
+        side.getContainedCorners(m_dim,cId1);
+        for (size_t c=0; c<cand.size(); ++c)
         {
-            side        .getContainedCorners(m_dim,cId1);
-            pSide[other].getContainedCorners(m_dim,cId2);
+            const index_t other = cand[c];
+            const patchSide & oSide = sides[pSide[other]];
+            oSide.getContainedCorners(m_dim,cId2);
             matched.setConstant(false);
             
             // Check whether the side center matches
             if (!cornersOnly)
-                if ( ( pCorners[side.patch        ].col(nCorP+side-1        ) -
-                       pCorners[pSide[other].patch].col(nCorP+pSide[other]-1)
+                if ( ( pCorners[side.patch ].col(nCorP+side -1) -
+                       pCorners[oSide.patch].col(nCorP+oSide-1)
                          ).norm() >= tol )
                     continue;
             
             // Check whether the vertices match and compute direction map and orientation
-            if ( matchVerticesOnSide( pCorners[side.patch]        , cId1, 0, 
-                                      pCorners[pSide[other].patch], cId2, 
+            if ( matchVerticesOnSide( pCorners[side.patch] , cId1, 0, 
+                                      pCorners[oSide.patch], cId2, 
                                       matched, dirMap, dirOr, tol ) )
             {
-                dirMap(side.direction()) = pSide[other].direction();
-                dirOr (side.direction()) = !( side.parameter() == pSide[other].parameter() );
-                gsBoxTopology::addInterface( boundaryInterface(side, pSide[other], dirMap, dirOr));
-                // done with pSide[other], remove it from candidate list
-                std::swap( pSide[other], pSide.back() );
+                dirMap(side.direction()) = oSide.direction();
+                dirOr (side.direction()) = !( side.parameter() == oSide.parameter() );
+                gsBoxTopology::addInterface( boundaryInterface(side, oSide, dirMap, dirOr));
+                // done with oSide, remove it from candidate list
+                pos[pSide[other]] = -1;
+                if ( other + 1 != static_cast<index_t>(pSide.size()) )
+                {
+                    pSide[other] = pSide.back();
+                    pos[pSide[other]] = other;
+                }
                 pSide.pop_back();
                 done=true;
-                break;//for (size_t other=0..)
+                break;//for (size_t c=0..)
             }
         }
         if (!done) // not an interface ?
@@ -201,6 +201,7 @@ bool gsHFitting<d, T>::nextIteration(T tolerance, T err_threshold)
 	    
             gsHTensorBasis<d, T>* basis = static_cast<gsHTensorBasis<d,T> *> (this->m_basis);
             basis->refineElements(boxes);
+            this->resetSystem();
 	    
             gsInfo << "inserted " << boxes.size() / (2 * d + 1) << " boxes.\n";
         }
@@ -306,6 +306,25 @@ public:
     /// level \em k (i.e., those taken from \f$ B^k \f$) start.
     std::vector<unsigned> m_xmatrix_offset;
 
+    /// \brief Cache of the active functions of the visited leaf cells
+    ///
+    /// The key is the level of a leaf cell of the tree and the
+    /// lexicographic index of the cell on that level, the value is the
+    /// list of active functions on the cell (as returned by
+    /// active_into()). Filled by active_into() and cleared whenever the
+    /// characteristic matrices change. The cell of a point on a level
+    /// is computed from its cell on the finest level, assuming that
+    /// the levels are dyadic refinements of each other (as created
+    /// by initialize() and needLevel()).
+    ///
+    /// The cache holds at most s_activeCacheSize cells, the active
+    /// functions of the other cells are computed at every call.
+    typedef std::pair<int,unsigned long long> activeKey;
+    mutable std::map<activeKey, std::vector<unsigned> > m_activeCache;
+
+    /// \brief Maximum number of cells in m_activeCache
+    static const std::size_t s_activeCacheSize = 1 << 16;
+
     //------------------------------------
  
 public:
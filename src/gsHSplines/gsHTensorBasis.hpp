@@ -18,6 +18,9 @@
 #include <gsIO/gsXml.h>
 #include <gsIO/gsXmlGenericUtils.hpp>
 
+#include <deque>
+#include <limits>
+
 namespace gismo
 {
 
@@ -704,6 +707,7 @@ void gsHTensorBasis<d,T>::makeCompressed()
     // Compress the tree
     // m_tree.makeCompressed();
 
+    m_activeCache.clear();
     while ( ! m_xmatrix_offset[1] )
     {
         delete m_bases.front();
@@ -796,6 +800,7 @@ void gsHTensorBasis<d,T>::update_structure() // to do: rename as updateHook
 
     // Setup the characteristic matrices
     m_xmatrix.clear();
+    m_activeCache.clear();
     m_xmatrix.resize( m_bases.size() );
 
     // Compress the tree
@@ -875,65 +880,101 @@ void gsHTensorBasis<d,T>::initialize_class(gsBasis<T> const&  tbasis)
 template<unsigned d, class T>
 void gsHTensorBasis<d,T>::active_into(const gsMatrix<T> & u, gsMatrix<unsigned>& result) const
 {
-    point low, upp, cur;
+    point low, prev, upp, cur;
+    prev.setConstant(-1); // no cell has this index
     const int maxLevel = m_tree.getMaxInsLevel();
 
-    std::vector<std::vector<unsigned> > temp_output;//collects the outputs
-    temp_output.resize( u.cols() );
+    // Active functions of the cell of every point, taken from the
+    // cache, or from uncached, when the cache is full
+    std::vector<const std::vector<unsigned> *> actives(u.cols(), NULL);
+    std::deque<std::vector<unsigned> > uncached;
     std::size_t sz = 0;
 
-    //gsMatrix<unsigned> activesLvl;
-
     for(index_t p = 0; p < u.cols(); p++) //for all input points
     {
         const gsMatrix<T> & currPoint = u.col(p);
         for(unsigned i = 0; i != d; ++i)
             low[i] = m_bases[maxLevel]->knots(i).uFind( currPoint(i,0) ).uIndex();
 
-        // Identify the level of the point
+        // Same cell as the previous point (eg. quadrature nodes)
+        if ( low == prev )
+        {
+            actives[p] = actives[p-1];
+            continue;
+        }
+        prev = low;
+
+        // Identify the level of the point and its cell on that
+        // level: the levels are dyadic refinements of each other,
+        // so the cell on level lvl is low / 2^(maxLevel-lvl)
         const int lvl = m_tree.levelOf(low, maxLevel);
+        activeKey key(lvl, 0);
+        for(int i = d-1; i >= 0; --i)
+        {
+            const unsigned long long n = m_bases[lvl]->knots(i).uSize() - 1;
+            const unsigned long long c = low[i] >> (maxLevel - lvl);
+            GISMO_ASSERT( c < n, "The levels are not dyadic refinements.");
+            GISMO_ENSURE( key.second <= (std::numeric_limits<unsigned long long>::max() - c) / n,
+                          "Too many cells on level "<< lvl <<" for the active functions cache.");
+            key.second = key.second * n + c;
+        }
 
-        for(int i = 0; i <= lvl; i++)
+#       pragma omp critical (gsHTensorBasis_activeCache)
         {
-            /*
-              m_bases[i]->active_into(currPoint, activesLvl);
-              
-              std::set_intersection(m_xmatrix[i].begin(), m_xmatrix[i].end(),
-              activesLvl.data(), activesLvl.data() + activesLvl.size(),
-              std::back_inserter( temp_output[p] ) );
-              +++ Renumbering to H-basis indexing
-            // */                                 
-
-            // /*
-            m_bases[i]->active_cwise(currPoint, low, upp);
-            cur = low;
-            do
-            {
-                CMatrix::const_iterator it =
-                    m_xmatrix[i].find_it_or_fail( m_bases[i]->index(cur) );
+            typename std::map<activeKey, std::vector<unsigned> >::const_iterator
+                it = m_activeCache.find(key);
+            if ( it != m_activeCache.end() )
+                actives[p] = &it->second;
+        }
 
-                if( it != m_xmatrix[i].end() )// if index is found
+        if ( NULL == actives[p] )
+        {
+            std::vector<unsigned> act;
+            for(int i = 0; i <= lvl; i++)
+            {
+                m_bases[i]->active_cwise(currPoint, low, upp);
+                cur = low;
+                do
                 {
-                    temp_output[p].push_back(
-                        this->m_xmatrix_offset[i] + (it - m_xmatrix[i].begin() )
-                        );
+                    CMatrix::const_iterator it =
+                        m_xmatrix[i].find_it_or_fail( m_bases[i]->index(cur) );
+
+                    if( it != m_xmatrix[i].end() )// if index is found
+                    {
+                        act.push_back(
+                            this->m_xmatrix_offset[i] + (it - m_xmatrix[i].begin() )
+                            );
+                    }
                 }
+                while( nextCubePoint(cur,low,upp) );
+            }
+
+#           pragma omp critical (gsHTensorBasis_activeCache)
+            {
+                // map entries are not moved by later insertions
+                if ( m_activeCache.size() < s_activeCacheSize )
+                    actives[p] = &m_activeCache.insert(std::make_pair(key, act)).first->second;
+            }
+            if ( NULL == actives[p] )
+            {
+                // deque entries are not moved either
+                uncached.push_back(std::vector<unsigned>());
+                uncached.back().swap(act);
+                actives[p] = &uncached.back();
             }
-            while( nextCubePoint(cur,low,upp) );
-            //*/
         }
 
         // update result size
-        if ( temp_output[p].size() > sz )
-            sz = temp_output[p].size();
+        if ( actives[p]->size() > sz )
+            sz = actives[p]->size();
     }
 
     result.resize(sz, u.cols() );
     for(index_t i = 0; i < result.cols(); i++)
     {
-        result.col(i).topRows(temp_output[i].size())
-            = gsAsConstVector<unsigned>(temp_output[i]);
-        result.col(i).bottomRows(sz-temp_output[i].size()).setZero();
+        result.col(i).topRows(actives[i]->size())
+            = gsAsConstVector<unsigned>(*actives[i]);
+        result.col(i).bottomRows(sz-actives[i]->size()).setZero();
     }
 }
 
@@ -399,6 +399,23 @@ private:
         }
     }
 
+    /// Evaluates the derivatives of order \a n (0, 1 or 2) of all
+    /// active functions at the points \a u. The tensor basis of every
+    /// level which is needed is evaluated once for all points, and
+    /// the truncated functions are combined from these values.
+    void evalLevelwise_into(const gsMatrix<T> & u, int n,
+                            gsMatrix<T>& result) const;
+
+    /// Evaluates the derivatives of order \a n (0, 1 or 2) of all
+    /// active functions at the points \a u, which are expected to lie
+    /// in one element. The level-wise values are mapped to the active
+    /// functions by the dense operator of the element (see
+    /// m_elementCache), which is computed on the first visit of the
+    /// element. Falls back to evalLevelwise_into() if the points lie
+    /// in several elements.
+    void evalElementwise_into(const gsMatrix<T> & u, int n,
+                              gsMatrix<T>& result) const;
+
     /// @brief Computes and saves representation of all basis functions.
     void representBasis(); // rename: precompute coeffs
 
@@ -717,6 +734,17 @@ private:
     // m_presentation[j]
     std::map<unsigned, gsSparseVector<T> > m_presentation;
 
+    // Cache of the truncation operators of the visited elements.
+    //
+    // An element is identified by the highest representation level
+    // \em L of its active functions and the first active tensor
+    // function of level \em L. The value is the dense matrix which
+    // maps the active tensor functions of all representation levels
+    // (by increasing level) to the active THB-splines of the element.
+    //
+    // Filled by evalElementwise_into() and cleared by representBasis()
+    mutable std::map<std::pair<unsigned,unsigned>, gsMatrix<T> > m_elementCache;
+
     using gsHTensorBasis<d,T>::m_bases;
     using gsHTensorBasis<d,T>::m_xmatrix;
     using gsHTensorBasis<d,T>::m_xmatrix_offset;
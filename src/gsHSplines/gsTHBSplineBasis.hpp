@@ -54,6 +54,7 @@ void gsTHBSplineBasis<d,T>::representBasis()
     // Cleanup previous basis
     this->m_is_truncated.resize(this->size());
     m_presentation.clear();
+    m_elementCache.clear();
 
     for (unsigned j = 0; j < static_cast<unsigned>(this->size()); ++j)
     {
@@ -1058,79 +1059,230 @@ void gsTHBSplineBasis<d,T>::deriv2Single_into(unsigned i,
 }
 
 template<unsigned d, class T>
-void gsTHBSplineBasis<d,T>::eval_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
+void gsTHBSplineBasis<d,T>::evalLevelwise_into(const gsMatrix<T> & u, int n,
+                                               gsMatrix<T>& result) const
 {
+    GISMO_ASSERT(0<=n && n<=2, "Only derivatives up to order 2 are available");
+
     gsMatrix<unsigned> indices;
-    gsMatrix<T> res(1, 1);
     this->active_into(u, indices);
 
-    result.setZero(indices.rows(), u.cols());
+    // Number of components per function
+    const index_t nc = ( n==0 ? 1 : ( n==1 ? d : (d*(d+1))/2 ) );
+    result.setZero(indices.rows() * nc, u.cols());
+
+    // Values and active functions of the tensor bases at all points,
+    // computed once per level when needed
+    const size_t numLevels = this->m_bases.size();
+    std::vector<gsMatrix<T> >        values (numLevels);
+    std::vector<gsMatrix<unsigned> > actives(numLevels);
+    std::vector<gsVector<unsigned,d> > strides(numLevels);
+    std::vector<bool> done(numLevels, false);
 
-    for (index_t i = 0; i < indices.cols(); i++)
+    for (index_t pt = 0; pt != indices.cols(); ++pt)
     {
-        for (index_t j = 0; j < indices.rows(); j++)
+        for (index_t j = 0; j != indices.rows(); ++j)
         {
-            const unsigned index = indices(j, i);
+            const unsigned index = indices(j, pt);
             if (j != 0 && index == 0)
                 break;
-            
-            evalSingle_into(index, u.col(i), res);
-            result(j, i) = res.value();
+
+            const unsigned lvl = getPresLevelOfBasisFun(index);
+            const gsTensorBSplineBasis<d,T> & base = *this->m_bases[lvl];
+            if ( !done[lvl] )
+            {
+                switch (n)
+                {
+                case 0 : base.eval_into  (u, values[lvl]); break;
+                case 1 : base.deriv_into (u, values[lvl]); break;
+                default: base.deriv2_into(u, values[lvl]); break;
+                }
+                base.active_into(u, actives[lvl]);
+
+                // strides of the lexicographic numbering of the active functions
+                strides[lvl][0] = 1;
+                for (unsigned k = 1; k != d; ++k)
+                    strides[lvl][k] = strides[lvl][k-1] * (base.degree(k-1) + 1);
+                done[lvl] = true;
+            }
+
+            const gsMatrix<T> & val = values[lvl];
+            const gsMatrix<unsigned> & act = actives[lvl];
+
+            if (m_is_truncated[index] == -1)
+            {
+                // local index of the function among the active ones of its level
+                const unsigned flatTenIndx = flatTensorIndexOf(index, lvl);
+                const gsVector<unsigned,d> ti = base.tensorIndex(flatTenIndx)
+                    - base.tensorIndex(act(0, pt));
+                const index_t loc = ti.dot(strides[lvl]);
+                GISMO_ASSERT(act(loc, pt) == flatTenIndx, "Active function not found.");
+
+                result.block(j * nc, pt, nc, 1) = val.block(loc * nc, pt, nc, 1);
+            }
+            else // basis function is truncated
+            {
+                const gsSparseVector<T> & coefs = getCoefs(index);
+                for (index_t i = 0; i != act.rows(); ++i)
+                {
+                    const T c = coefs.coeff(act(i, pt));
+                    if ( 0 != c )
+                        result.block(j * nc, pt, nc, 1) += c * val.block(i * nc, pt, nc, 1);
+                }
+            }
         }
     }
 }
 
-
 template<unsigned d, class T>
-void gsTHBSplineBasis<d,T>::deriv2_into(const gsMatrix<T>& u, gsMatrix<T>& result)const
+void gsTHBSplineBasis<d,T>::evalElementwise_into(const gsMatrix<T> & u, int n,
+                                                 gsMatrix<T>& result) const
 {
+    GISMO_ASSERT(0<=n && n<=2, "Only derivatives up to order 2 are available");
+
+    if ( 0 == u.cols() )
+    {
+        evalLevelwise_into(u, n, result);
+        return;
+    }
+
     gsMatrix<unsigned> indices;
     this->active_into(u, indices);
 
-    static const unsigned numDers = (d * (d + 1)) / 2;
-    gsMatrix<T> res(numDers, 1); // result of deriv2Single_into
+    // All points must have the same active functions
+    for (index_t pt = 1; pt < indices.cols(); ++pt)
+        if ( indices.col(pt) != indices.col(0) )
+        {
+            evalLevelwise_into(u, n, result);
+            return;
+        }
 
-    result.setZero(indices.rows() * numDers, u.cols());
+    // Representation levels of the active functions
+    index_t na = 0;
+    std::vector<bool> used(this->m_bases.size(), false);
+    for (; na != indices.rows(); ++na)
+    {
+        const unsigned index = indices(na, 0);
+        if (na != 0 && index == 0)
+            break;
+        used[getPresLevelOfBasisFun(index)] = true;
+    }
 
-    for (int i = 0; i < indices.cols(); i++)
+    // Level-wise values and active functions, by increasing level
+    const index_t nc = ( n==0 ? 1 : ( n==1 ? d : (d*(d+1))/2 ) );
+    std::vector<unsigned> levels;
+    std::vector<gsMatrix<T> >        values;
+    std::vector<gsMatrix<unsigned> > actives;
+    std::vector<index_t> offset(1, 0);
+    for (unsigned lvl = 0; lvl != used.size(); ++lvl)
     {
-        for (int j = 0; j < indices.rows(); j++)
+        if ( !used[lvl] ) continue;
+        const gsTensorBSplineBasis<d,T> & base = *this->m_bases[lvl];
+        levels .push_back(lvl);
+        values .push_back(gsMatrix<T>());
+        actives.push_back(gsMatrix<unsigned>());
+        switch (n)
         {
-            const unsigned index = indices(j, i);
-            if (j != 0 && index == 0)
-                break;
+        case 0 : base.eval_into  (u, values.back()); break;
+        case 1 : base.deriv_into (u, values.back()); break;
+        default: base.deriv2_into(u, values.back()); break;
+        }
+        base.active_into(u, actives.back());
+
+        // The points must lie in the same cell of every level
+        for (index_t pt = 1; pt < u.cols(); ++pt)
+            if ( actives.back()(0, pt) != actives.back()(0, 0) )
+            {
+                evalLevelwise_into(u, n, result);
+                return;
+            }
+        offset.push_back(offset.back() + actives.back().rows());
+    }
+    const size_t nl = levels.size();
+    const std::pair<unsigned,unsigned> key(levels.back(), actives.back()(0, 0));
+
+    // Look up the operator of the element, or compute it
+    const gsMatrix<T> * op = NULL;
+#   pragma omp critical (gsTHBSplineBasis_elementCache)
+    {
+        typename std::map<std::pair<unsigned,unsigned>, gsMatrix<T> >::const_iterator
+            it = m_elementCache.find(key);
+        if ( it != m_elementCache.end() )
+            op = &it->second;
+    }
 
-            this->deriv2Single_into(index, u.col(i), res);
+    if ( NULL == op )
+    {
+        gsMatrix<T> elOp;
+        elOp.setZero(na, offset.back());
+        for (index_t j = 0; j != na; ++j)
+        {
+            const unsigned index = indices(j, 0);
+            const unsigned lvl   = getPresLevelOfBasisFun(index);
+            const size_t   l     = std::lower_bound(levels.begin(), levels.end(), lvl)
+                - levels.begin();
+            const gsMatrix<unsigned> & act = actives[l];
 
-            result.template block<numDers, 1>(j * numDers, i) = res;
+            if (m_is_truncated[index] == -1)
+            {
+                const unsigned flatTenIndx = flatTensorIndexOf(index, lvl);
+                for (index_t i = 0; i != act.rows(); ++i)
+                    if ( act(i, 0) == flatTenIndx )
+                    {
+                        elOp(j, offset[l] + i) = 1;
+                        break;
+                    }
+            }
+            else // basis function is truncated
+            {
+                const gsSparseVector<T> & coefs = getCoefs(index);
+                for (index_t i = 0; i != act.rows(); ++i)
+                    elOp(j, offset[l] + i) = coefs.coeff(act(i, 0));
+            }
+        }
+
+#       pragma omp critical (gsTHBSplineBasis_elementCache)
+        {
+            // map entries are not moved by later insertions
+            op = &m_elementCache.insert(std::make_pair(key, elOp)).first->second;
         }
     }
-}
 
+    // Stack the level-wise values and apply the operator
+    gsMatrix<T> vals(offset.back() * nc, u.cols());
+    for (size_t l = 0; l != nl; ++l)
+        vals.middleRows(offset[l] * nc, values[l].rows()) = values[l];
+
+    result.setZero(indices.rows() * nc, u.cols());
+    if ( 1 == nc )
+        result.topRows(na).noalias() = (*op) * vals;
+    else
+        for (index_t pt = 0; pt != u.cols(); ++pt)
+        {
+            gsAsMatrix<T> res(result.col(pt).data(), nc, na);
+            res.noalias() = gsAsConstMatrix<T>(vals.col(pt).data(), nc, offset.back())
+                * op->transpose();
+        }
+}
 
 template<unsigned d, class T>
-void gsTHBSplineBasis<d,T>::deriv_into(const gsMatrix<T>& u, gsMatrix<T>& result) const
+void gsTHBSplineBasis<d,T>::eval_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
 {
+    evalElementwise_into(u, 0, result);
+}
 
-    gsMatrix<unsigned> indices;
-    this->active_into(u, indices);
-    gsMatrix<T> res(d, 1);
-
-    result.setZero(indices.rows() * d, u.cols());
 
-    for (int i = 0; i < indices.cols(); i++)
-    {
-        for (int j = 0; j < indices.rows(); j++)
-        {
+template<unsigned d, class T>
+void gsTHBSplineBasis<d,T>::deriv2_into(const gsMatrix<T>& u, gsMatrix<T>& result)const
+{
+    evalElementwise_into(u, 2, result);
+}
 
-            const unsigned index = indices(j, i);
-            if (j != 0 && index == 0)
-                break;
 
-            this->derivSingle_into(index, u.col(i), res);
-            result.template block<d,1>(j * d, i) = res;
-        }
-    }
+template<unsigned d, class T>
+void gsTHBSplineBasis<d,T>::deriv_into(const gsMatrix<T>& u, gsMatrix<T>& result) const
+{
+    evalElementwise_into(u, 1, result);
 }
 
 
@@ -0,0 +1,453 @@
+/** @file gsBinaryContainer.cpp
+
+    @brief Provides implementation of the reader and writer of binary
+    container files.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <gsIO/gsBinaryContainer.h>
+
+#include <cstring>
+
+namespace gismo
+{
+
+namespace internal
+{
+
+typedef unsigned long long u64;
+
+static const char     s_magic[8] = {'G','S','M','O','B','I','N','\0'};
+static const unsigned s_version  = 1;
+static const size_t   s_header   = 32;
+
+// Values with fewer numbers are stored as text
+static const size_t   s_minArray = 8;
+
+// Kinds of the values of the nodes
+enum { valueNone = 0, valueText = 1, valueReal = 2, valueInt = 3 };
+
+/* Writing */
+
+static void putU32(std::vector<char> & buf, unsigned v)
+{
+    for ( int k = 0; k != 4; ++k, v >>= 8 )
+        buf.push_back( static_cast<char>(v & 255) );
+}
+
+static void putU64(std::vector<char> & buf, u64 v)
+{
+    for ( int k = 0; k != 8; ++k, v >>= 8 )
+        buf.push_back( static_cast<char>(v & 255) );
+}
+
+static void putString(std::vector<char> & buf, const char * str, size_t n)
+{
+    putU32(buf, static_cast<unsigned>(n));
+    buf.insert(buf.end(), str, str + n);
+}
+
+// Pads with zeros to a multiple of 8 bytes
+static void putPadding(std::vector<char> & buf)
+{
+    buf.resize( (buf.size() + 7) & ~static_cast<size_t>(7), '\0' );
+}
+
+static void putAttributes(std::vector<char> & buf, const gsXmlNode * node)
+{
+    unsigned n = 0;
+    for (gsXmlAttribute * at = node->first_attribute(); at; at = at->next_attribute())
+        ++n;
+    putU32(buf, n);
+    for (gsXmlAttribute * at = node->first_attribute(); at; at = at->next_attribute())
+    {
+        putString(buf, at->name() , at->name_size() );
+        putString(buf, at->value(), at->value_size());
+    }
+}
+
+static inline bool isSpace(const char c)
+{ return ' ' == c || '\n' == c || '\t' == c || '\r' == c || '\v' == c || '\f' == c; }
+
+// Reads the text str if it is a list of integers written in the
+// shortest form, which are restored exactly as text
+static bool readInts(const char * str, std::vector<u64> & result)
+{
+    result.clear();
+    for (;;)
+    {
+        while ( isSpace(*str) ) ++str;
+        if ( '\0' == *str )
+            return true;
+
+        const bool neg = ('-' == *str);
+        if ( neg ) ++str;
+        const char * first = str;
+        u64 v = 0;
+        for (; *str >= '0' && *str <= '9'; ++str)
+            v = 10 * v + static_cast<u64>(*str - '0');
+        const size_t nd = str - first;
+        if ( 0 == nd || nd > 18 || ( '0' == *first && (nd > 1 || neg) ) ||
+             ( '\0' != *str && !isSpace(*str) ) )
+            return false;
+        result.push_back( neg ? 0 - v : v );
+    }
+}
+
+// Reads the text str if it is a list of real numbers which are
+// written with FILE_PRECISION digits, which are restored exactly as
+// text
+static bool readReals(const char * str, std::vector<double> & result)
+{
+    result.clear();
+    std::string tmp;
+    for (double v; ; )
+    {
+        while ( isSpace(*str) ) ++str;
+        const char * first = str;
+        if ( !parseValue(str, v) )
+            return true;
+        tmp.clear();
+        formatValue(tmp, v, FILE_PRECISION);
+        if ( tmp.size() != static_cast<size_t>(str - first) ||
+             0 != memcmp(tmp.data(), first, tmp.size()) )
+            return false;
+        result.push_back(v);
+    }
+}
+
+static void putValue(std::vector<char> & buf, const gsXmlNode * node)
+{
+    if ( 0 == node->value_size() )
+    {
+        buf.push_back(valueNone);
+        return;
+    }
+
+    // Malformed base64 data are kept as text
+    std::vector<u64> ints;
+    std::vector<double> reals;
+    const bool base64 = isBase64(node);
+    if ( !base64 && readInts(node->value(), ints) && ints.size() >= s_minArray )
+    {
+        buf.push_back(valueInt);
+        putPadding(buf);
+        putU64(buf, ints.size());
+        for ( size_t i = 0; i != ints.size(); ++i )
+            putU64(buf, ints[i]);
+        return;
+    }
+    if ( base64 ? !decodeBase64(node->value(), reals)
+                : !readReals(node->value(), reals) || reals.size() < s_minArray )
+    {
+        buf.push_back(valueText);
+        putString(buf, node->value(), node->value_size());
+        return;
+    }
+
+    buf.push_back(valueReal);
+    putPadding(buf);
+    putU64(buf, reals.size());
+    u64 bits;
+    for ( size_t i = 0; i != reals.size(); ++i )
+    {
+        memcpy(&bits, &reals[i], 8);
+        putU64(buf, bits);
+    }
+}
+
+static void putNode(std::vector<char> & buf, const gsXmlNode * node, bool top)
+{
+    if ( !top ) // the tag and attributes of the objects are in the index
+    {
+        putString(buf, node->name(), node->name_size());
+        putAttributes(buf, node);
+    }
+    putValue(buf, node);
+
+    unsigned n = 0;
+    for (gsXmlNode * child = node->first_node(); child; child = child->next_sibling())
+        n += ( rapidxml::node_element == child->type() );
+    putU32(buf, n);
+    for (gsXmlNode * child = node->first_node(); child; child = child->next_sibling())
+        if ( rapidxml::node_element == child->type() )
+            putNode(buf, child, false);
+}
+
+bool gsBinaryContainer::write(const std::string & fn, const gsXmlTree & data)
+{
+    std::ofstream file(fn.c_str(), std::ios::out | std::ios::binary);
+    if ( file.fail() )
+        return false;
+
+    // Header, the offset of the index is written at the end
+    std::vector<char> buf(s_magic, s_magic + 8);
+    putU32(buf, s_version);
+    putU32(buf, 0);
+    putU64(buf, 0);
+    putU64(buf, 0);
+    file.write(&buf[0], buf.size());
+
+    // Chunks of the objects
+    std::vector<char> index;
+    unsigned numObjects = 0;
+    u64 offset = s_header;
+    for (gsXmlNode * obj = data.first_node("xml")->first_node(); obj; obj = obj->next_sibling())
+    {
+        if ( rapidxml::node_element != obj->type() )
+            continue;
+        buf.clear();
+        putNode(buf, obj, true);
+        putPadding(buf);
+        file.write(&buf[0], buf.size());
+
+        putU64(index, offset);
+        putU64(index, buf.size());
+        putString(index, obj->name(), obj->name_size());
+        putAttributes(index, obj);
+        offset += buf.size();
+        ++numObjects;
+    }
+    if ( !index.empty() )
+        file.write(&index[0], index.size());
+
+    // Number of objects and offset of the index
+    buf.clear();
+    putU32(buf, numObjects);
+    putU64(buf, offset);
+    file.seekp(12);
+    file.write(&buf[0], buf.size());
+    return !file.fail();
+}
+
+/* Reading */
+
+// Reads the numbers and strings of a chunk of a file
+class gsBinaryCursor
+{
+public:
+    gsBinaryCursor(const std::vector<char> & buf)
+    : m_first(buf.empty() ? NULL : &buf[0]), m_pos(m_first),
+      m_last(m_first + buf.size())
+    { }
+
+    unsigned uint8()
+    {
+        return *bytes(1);
+    }
+
+    unsigned uint32()
+    {
+        const unsigned char * b = bytes(4);
+        return b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<unsigned>(b[3]) << 24);
+    }
+
+    u64 uint64()
+    {
+        const unsigned char * b = bytes(8);
+        u64 v = 0;
+        for ( int k = 7; k >= 0; --k )
+            v = (v << 8) | b[k];
+        return v;
+    }
+
+    // Returns a string allocated in the XML tree
+    char * string(gsXmlTree & data, size_t & n)
+    {
+        n = uint32();
+        const char * s = reinterpret_cast<const char*>(bytes(n));
+        char * res = data.allocate_string(NULL, n + 1);
+        memcpy(res, s, n);
+        res[n] = '\0';
+        return res;
+    }
+
+    void padding()
+    {
+        bytes( (8 - (m_pos - m_first) % 8) % 8 );
+    }
+
+private:
+
+    const unsigned char * bytes(size_t n)
+    {
+        GISMO_ENSURE( static_cast<size_t>(m_last - m_pos) >= n,
+                      "gsBinaryContainer: corrupt file");
+        const char * res = m_pos;
+        m_pos += n;
+        return reinterpret_cast<const unsigned char*>(res);
+    }
+
+private:
+    const char * m_first, * m_pos, * m_last;
+};
+
+static void getAttributes(gsBinaryCursor & cur, gsXmlNode * node, gsXmlTree & data)
+{
+    const unsigned n = cur.uint32();
+    size_t ns, vs;
+    for ( unsigned k = 0; k != n; ++k )
+    {
+        char * name  = cur.string(data, ns);
+        char * value = cur.string(data, vs);
+        node->append_attribute( data.allocate_attribute(name, value, ns, vs) );
+    }
+}
+
+static void getValue(gsBinaryCursor & cur, gsXmlNode * node, gsXmlTree & data)
+{
+    std::string str;
+    size_t n;
+    switch ( cur.uint8() )
+    {
+    case valueNone:
+        return;
+    case valueText:
+    {
+        char * s = cur.string(data, n);
+        node->value(s, n);
+        return;
+    }
+    case valueInt:
+    {
+        cur.padding();
+        n = static_cast<size_t>( cur.uint64() );
+        char tmp[24];
+        for ( size_t i = 0; i != n; ++i )
+        {
+            u64 v = cur.uint64();
+            if ( v >> 63 )
+            {
+                str += '-';
+                v = 0 - v;
+            }
+            char * p = tmp + sizeof(tmp);
+            do { *--p = static_cast<char>('0' + v % 10); } while ( (v /= 10) != 0 );
+            str.append(p, tmp + sizeof(tmp));
+            str += ' ';
+        }
+        break;
+    }
+    case valueReal:
+    {
+        cur.padding();
+        n = static_cast<size_t>( cur.uint64() );
+        std::vector<double> v(n);
+        for ( size_t i = 0; i != n; ++i )
+        {
+            const u64 bits = cur.uint64();
+            memcpy(&v[i], &bits, 8);
+        }
+        if ( isBase64(node) )
+            str = encodeBase64(v.empty() ? NULL : &v[0], n);
+        else
+        {
+            str.reserve( n * (FILE_PRECISION + 8) );
+            for ( size_t i = 0; i != n; ++i )
+            {
+                formatValue(str, v[i], FILE_PRECISION);
+                str += ' ';
+            }
+        }
+        break;
+    }
+    default:
+        GISMO_ERROR("gsBinaryContainer: corrupt file");
+    }
+    node->value(data.allocate_string(str.c_str(), str.size() + 1), str.size());
+}
+
+static void getNode(gsBinaryCursor & cur, gsXmlNode * node, gsXmlTree & data, bool top)
+{
+    if ( !top )
+        getAttributes(cur, node, data);
+    getValue(cur, node, data);
+
+    const unsigned n = cur.uint32();
+    for ( unsigned k = 0; k != n; ++k )
+    {
+        size_t ns;
+        char * name = cur.string(data, ns);
+        gsXmlNode * child = data.allocate_node(rapidxml::node_element, name, NULL, ns);
+        getNode(cur, child, data, false);
+        node->append_node(child);
+    }
+
+    // A value next to child elements is printed as a data node
+    if ( 0 != node->value_size() && node->first_node() )
+        node->prepend_node( data.allocate_node(rapidxml::node_data, NULL,
+                                               node->value(), 0, node->value_size()) );
+}
+
+bool gsBinaryContainer::read(const std::string & fn, gsXmlTree & data)
+{
+    m_file.open(fn.c_str(), std::ios::in | std::ios::binary);
+    if ( m_file.fail() )
+        return false;
+
+    std::vector<char> buf(s_header);
+    m_file.read(&buf[0], s_header);
+    if ( m_file.fail() || 0 != memcmp(&buf[0], s_magic, 8) )
+        return false;
+    gsBinaryCursor head(buf);
+    head.uint64(); // magic
+    if ( s_version != head.uint32() )
+        return false;
+    const unsigned numObjects = head.uint32();
+    const u64 offset = head.uint64();
+
+    // Read the index
+    m_file.seekg(0, std::ios::end);
+    const u64 size = static_cast<u64>(m_file.tellg());
+    if ( offset > size )
+        return false;
+    buf.resize(size - offset);
+    m_file.seekg(offset);
+    if ( !buf.empty() )
+        m_file.read(&buf[0], buf.size());
+    if ( m_file.fail() )
+        return false;
+
+    m_data = &data;
+    gsBinaryCursor cur(buf);
+    for ( unsigned k = 0; k != numObjects; ++k )
+    {
+        const u64 first = cur.uint64();
+        const u64 bytes = cur.uint64();
+        size_t ns;
+        char * name = cur.string(data, ns);
+        gsXmlNode * node = data.allocate_node(rapidxml::node_element, name, NULL, ns);
+        getAttributes(cur, node, data);
+        data.first_node("xml")->append_node(node);
+        m_chunks[node] = std::make_pair(first, bytes);
+    }
+    return true;
+}
+
+void gsBinaryContainer::load(gsXmlNode * node)
+{
+    std::map<gsXmlNode*, std::pair<u64,u64> >::iterator it = m_chunks.find(node);
+    if ( it == m_chunks.end() )
+        return;
+
+    std::vector<char> buf( static_cast<size_t>(it->second.second) );
+    m_file.seekg(it->second.first);
+    if ( !buf.empty() )
+        m_file.read(&buf[0], buf.size());
+    GISMO_ENSURE( !m_file.fail(), "gsBinaryContainer: cannot read object "<< node->name() );
+    m_chunks.erase(it);
+
+    gsBinaryCursor cur(buf);
+    getNode(cur, node, *m_data, true);
+}
+
+} // namespace internal
+
+} // namespace gismo
@@ -0,0 +1,86 @@
+/** @file gsBinaryContainer.h
+
+    @brief Provides the reader and writer of binary container files
+    (.gsb), the binary peer of the XML files of gsFileData.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsIO/gsXml.h>
+
+#include <fstream>
+#include <map>
+
+namespace gismo {
+
+namespace internal {
+
+/**
+    \brief Reads and writes binary container files (.gsb), which hold
+    the same objects as the XML files of gsFileData.
+
+    Every top-level object of the XML tree is stored as a separate
+    chunk. The numeric values of its nodes (coefficients, knots,
+    boxes, indices, ...) are stored as arrays of 64 bit floats or
+    integers, other values as text. An index at the end of the file
+    holds the tag and the attributes (type, id, ...) of the objects
+    and the positions of their chunks. The file starts with a header
+    of 32 bytes:
+    \verbatim
+    "GSMOBIN" '\0'  magic number
+    uint32          version
+    uint32          number of objects
+    uint64          offset of the index
+    uint64          reserved
+    \endverbatim
+    All numbers are little-endian and the chunks and the arrays start
+    at multiples of 8 bytes, so the file can be memory-mapped.
+
+    Reading a file only reads the index: the objects are added to the
+    XML tree as nodes with attributes, and their contents are read
+    when they are accessed (see loadNode).
+
+    \ingroup IO
+*/
+class GISMO_EXPORT gsBinaryContainer : public gsXmlLoader
+{
+public:
+
+    gsBinaryContainer() : m_data(NULL) { }
+
+    /// Writes the objects of the XML tree \a data (the element
+    /// children of its root) to the file \a fn. Returns false if the
+    /// file cannot be written.
+    static bool write(const std::string & fn, const gsXmlTree & data);
+
+    /// Opens the file \a fn and appends its objects to the root of
+    /// \a data; their contents are read on demand. Returns false if
+    /// the file cannot be read.
+    bool read(const std::string & fn, gsXmlTree & data);
+
+    /// Reads the contents of \a node, if it is an object of the file
+    /// which is not read yet
+    void load(gsXmlNode * node);
+
+private:
+
+    // The file, which stays open until all objects are read
+    std::ifstream m_file;
+
+    gsXmlTree * m_data;
+
+    // Position and size of the chunks of the objects not read yet
+    std::map<gsXmlNode*, std::pair<unsigned long long, unsigned long long> > m_chunks;
+};
+
+} // namespace internal
+
+} // namespace gismo
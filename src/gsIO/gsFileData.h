@@ -51,8 +51,11 @@ public:
      * Loads the contents of a file into a gsFileData object
      * 
      * @param fn filename string
+     * @param onDemand for xml files: only index the objects of the
+     * file, and read each object when it is fetched (binary
+     * container files are always read on demand)
      */
-    void read(String const & fn) ;
+    void read(String const & fn, bool onDemand = false) ;
     
     ~gsFileData();
     
@@ -62,11 +65,20 @@ public:
     /// \brief Reports the number of objects which are held in the file data
     int numData() const { return data->numNodes();}
 
-    /// \brief Save file contents to an xml file
+    /// \brief Save file contents to an xml file (or to a binary
+    /// container file, if \a fname has the extension .gsb)
     void save(std::string const & fname = "dump", bool compress = false) const;
 
     /// \brief Save file contents to compressed xml file
     void saveCompressed(std::string const & fname = "dump") const;
+
+    /// \brief Save file contents to a binary container file (.gsb)
+    ///
+    /// The objects are stored as separate chunks with the numeric
+    /// data in binary form, see internal::gsBinaryContainer. Reading
+    /// such a file only reads its index, the objects are read when
+    /// they are fetched.
+    void saveBinary(std::string const & fname = "dump") const;
     
     /// \brief Dump file contents to an xml file
     void dump(std::string const & fname = "dump") const;
@@ -79,6 +91,9 @@ private:
     
     // Used to hold parsed data of native gismo XML files
     std::vector<char> m_buffer;
+
+    // Source of the objects which are read on demand
+    mutable internal::gsXmlLoader * m_loader;
     
 protected:
     
@@ -95,6 +110,12 @@ protected:
     /// Reads Gismo's native XML file
     bool readGismoXmlStream(std::istream & is);
 
+    /// Reads a binary container file (gsb extension)
+    bool readBinaryFile( String const & fn );
+
+    /// Indexes a file with xml extension, its objects are read on demand
+    bool readXmlFileOnDemand( String const & fn );
+
     /// Reads Axel file
     bool readAxelFile(String const & fn);
     bool readAxelSurface( gsXmlNode * node );
@@ -109,7 +130,7 @@ protected:
     /// Reads Off mesh file
     bool readOffFile(String const & fn);
 
-    /// Reads STL mesh file
+    /// Reads STL mesh file, binary or ASCII (see also gsReadStl)
     bool readStlFile(String const & fn);
 
     /// Reads Wavefront OBJ file
@@ -265,6 +286,7 @@ public:
                 internal::gsXml<Object>::tag() <<". Error.\n";
             return NULL;
         }           
+        internal::loadNode(node);
         return internal::gsXml<Object>::get(node);// Using gsXmlUtils
     }
 
@@ -279,6 +301,7 @@ public:
                 internal::gsXml<Object>::type()<<" "<< 
                 internal::gsXml<Object>::tag() <<". Error.\n";
         }           
+        internal::loadNode(node);
         internal::gsXml<Object>::get_into(node, result);// Using gsXmlUtils
     }
     
@@ -293,6 +316,7 @@ public:
              child; child = getNextSibling(child, internal::gsXml<Object>::tag(), 
                                            internal::gsXml<Object>::type() ))
         {
+            internal::loadNode(child);
             result.push_back( internal::gsXml<Object>::get(child) );
         }
         return result;
@@ -382,6 +406,14 @@ public:
 private:
 
     gsXmlNode * getXmlRoot() const;
+
+    // Replaces the contents by the objects of \a loader, which are
+    // read on demand; returns false if the file \a fn cannot be read
+    template<class Loader>
+    bool readOnDemand(Loader * loader, String const & fn);
+
+    // Reads all objects which are read on demand
+    void loadAll() const;
     static void deleteXmlSubtree (gsXmlNode* node);
 
     // getFirst ? (tag and or type)
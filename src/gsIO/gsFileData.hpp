@@ -40,18 +40,22 @@
 
 #include <zlib/gzstream.h>
 
+#include <gsIO/gsBinaryContainer.h>
+#include <gsIO/gsXmlIndexedFile.h>
+#include <gsIO/gsReadStl.h>
+
 
 namespace gismo {
 
 template<class T>
-gsFileData<T>::gsFileData()
+gsFileData<T>::gsFileData() : m_loader(NULL)
 { 
     data = new FileData; 
     data->makeRoot();
 }
 
 template<class T>
-gsFileData<T>::gsFileData(String const & fn)
+gsFileData<T>::gsFileData(String const & fn) : m_loader(NULL)
 { 
     data = new FileData; 
     data->makeRoot();
@@ -64,6 +68,7 @@ gsFileData<T>::~gsFileData()
 { 
     data->clear(); 
     delete data; 
+    delete m_loader;
 }
     
 
@@ -71,12 +76,16 @@ template<class T> void
 gsFileData<T>::clear() 
 {
     data->clear(); 
+    data->setLoader(NULL);
+    delete m_loader;
+    m_loader = NULL;
 }
 
 
 template<class T>
 std::ostream & gsFileData<T>::print(std::ostream &os) const
 { 
+    loadAll();
     //rapidxml::print_no_indenting
     os<< *data; 
     return os;
@@ -98,6 +107,13 @@ gsFileData<T>::addComment(std::string const & message)
 template<class T> void
 gsFileData<T>::save(std::string const & fname, bool compress)  const
 { 
+    String tmp = getExtension(fname);
+    if (tmp == "gsb" )
+    {
+        saveBinary(fname);
+        return;
+    }
+
     gsXmlNode * comment = internal::makeComment("This file was created by G+Smo " 
                                                 GISMO_VERSION, *data);
     data->prepend_node(comment);
@@ -108,7 +124,7 @@ gsFileData<T>::save(std::string const & fname, bool compress)  const
         return;
     }
     
-    String tmp = getExtension(fname);
+    loadAll();
     if (tmp != "xml" )
         tmp = fname + ".xml";
     else
@@ -136,6 +152,7 @@ gsFileData<T>::saveCompressed(std::string const & fname)  const
     else
         tmp = fname;
 
+    loadAll();
     ogzstream fn( tmp.c_str() ); 
     fn << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
     //rapidxml::print_no_indenting
@@ -143,6 +160,20 @@ gsFileData<T>::saveCompressed(std::string const & fname)  const
     fn.close(); 
 }
     
+template<class T> void
+gsFileData<T>::saveBinary(std::string const & fname)  const
+{ 
+    String tmp = getExtension(fname);
+    if (tmp != "gsb" )
+        tmp = fname + ".gsb";
+    else
+        tmp = fname;
+
+    loadAll();
+    if ( ! internal::gsBinaryContainer::write(tmp, *data) )
+        gsWarn<<"gsFileData: Cannot write file "<<tmp<<"\n";
+}
+
 template<class T> void
 gsFileData<T>::ioError(int lineNumber,const std::string& str)
 {
@@ -151,15 +182,19 @@ gsFileData<T>::ioError(int lineNumber,const std::string& str)
 }
 
 template<class T>
-void gsFileData<T>::read(String const & fn)  
+void gsFileData<T>::read(String const & fn, bool onDemand)  
 { 
     // Identify filetype by extension
     String ext = getExtension(fn);
 
-    if (ext== "xml") 
+    if (ext== "xml" && onDemand) 
+        readXmlFileOnDemand(fn);
+    else if (ext== "xml") 
         readXmlFile(fn);
     else if (ext== "gz" && ends_with(fn, ".xml.gz") )
         readXmlGzFile(fn);
+    else if (ext== "gsb") 
+        readBinaryFile(fn);
     else if (ext== "txt") 
         readGeompFile(fn);
     else if (ext== "g2") 
@@ -231,6 +266,9 @@ bool gsFileData<T>::readGismoXmlStream(std::istream & is)
     m_buffer.swap(buffer);
 
     // Load file contents 
+    data->setLoader(NULL);
+    delete m_loader;
+    m_loader = NULL;
     data->parse<0>(&m_buffer[0]);
 
     // TO DO: Check if it contains unknown tags... 
@@ -238,6 +276,44 @@ bool gsFileData<T>::readGismoXmlStream(std::istream & is)
 }
 
 
+template<class T>
+bool gsFileData<T>::readBinaryFile( String const & fn )
+{
+    if ( readOnDemand(new internal::gsBinaryContainer, fn) )
+        return true;
+    gsWarn<<"gsFileData: Input file Problem: "<<fn<<"\n";
+    return false;
+}
+
+template<class T>
+bool gsFileData<T>::readXmlFileOnDemand( String const & fn )
+{
+    // Files without the xml root element are read as a whole
+    return readOnDemand(new internal::gsXmlIndexedFile, fn) || readXmlFile(fn);
+}
+
+template<class T>
+template<class Loader>
+bool gsFileData<T>::readOnDemand(Loader * loader, String const & fn)
+{
+    data->setLoader(NULL);
+    delete m_loader;
+    m_loader = NULL;
+    data->remove_all_nodes();
+    data->makeRoot();
+
+    if ( ! loader->read(fn, *data) )
+    {
+        delete loader;
+        return false;
+    }
+
+    // The objects are read when they are fetched
+    m_loader = loader;
+    data->setLoader(m_loader);
+    return true;
+}
+
 ///////////////////////////////////////////////    
 // Axl file
 ///////////////////////////////////////////////    
@@ -1139,80 +1215,43 @@ bool gsFileData<T>::readOffFile( String const & fn )
 template<class T>
 bool gsFileData<T>::readStlFile( String const & fn )
 {    
-    bool solid(false),facet(false),loop(false);
-    //Input file
-    std::ifstream file(fn.c_str(),std::ios::in);
-    if ( !file.good() ) {std::cout<<"Input file Problem!\n";return false;} 
+    // Binary or ASCII facets, see also gsReadStl, which reads the
+    // file directly into a gsMesh
+    std::vector<double> coords;
+    std::vector<int>    sizes;
+    if ( ! internal::readStlFacets(fn, coords, sizes) )
+        return false;
 
     gsXmlNode* g = internal::makeNode("Mesh", *data);
     g->append_attribute( internal::makeAttribute("type", "off", *data) );
     data->appendToRoot(g);
 
-    std::ostringstream triangles;
-    triangles.unsetf(std::ios_base::skipws); 
-    std::ostringstream vertices;
-    vertices.unsetf(std::ios_base::skipws); 
-    unsigned nvert(0), nfaces(0), tmp(0);
-
-    unsigned lineNumber(0);
+    // Every facet has its own vertices
+    const unsigned nvert = coords.size() / 3, nfaces = sizes.size();
     std::string str;
-
-    while( !file.eof() && getline(file, str) )
+    str.reserve( 20 * coords.size() + 8 * nvert + 4 * nfaces );
+    for (unsigned i = 0; i != nvert; ++i)
     {
-        std::transform(str.begin(),str.end(),str.begin(),::tolower);
-        if(str.find("solid")!=String::npos && str.find("endsolid")==String::npos)
-        {
-            if(solid) ioError(lineNumber,"startSolid");
-            solid=true;
-        }
-        else if(str.find("endsolid")!=String::npos)
-        {
-            if(!solid || facet || loop) ioError(lineNumber,"endSolid");
-            solid=false;
-        }
-        else if(str.find("facet")!=String::npos && str.find("endfacet")==String::npos)
-        {
-            if(!solid || facet || loop) ioError(lineNumber,"startFacet");
-            facet=true;
-        }
-        else if(str.find("endfacet")!=String::npos)
-        {
-            if(!solid || !facet || loop) ioError(lineNumber,"endFacet");
-            facet=false;
-        }
-        else if(str.find("outer")!=String::npos)
-        {
-            if(!solid || !facet || loop) ioError(lineNumber,"startLoop");
-            loop=true;
-        }
-        else if(str.find("endloop")!=String::npos)
+        for (unsigned j = 0; j != 3; ++j)
         {
-            if(!solid || !facet || !loop ) 
-                ioError(lineNumber,"endLoop");
-            triangles<< tmp;
-            for (unsigned i= nvert-tmp; i!=nvert; ++i)
-                triangles<<" "<< i;	
-            triangles<<"\n";	
-            nfaces++;
-            loop=false;		
-            tmp = 0;
+            internal::formatValue(str, coords[3*i+j], FILE_PRECISION);
+            str += ( 2 == j ? '\n' : ' ' );
         }
-        else if(str.find("vertex")!=String::npos)
+    }
+    for (unsigned f = 0, i = 0; f != nfaces; ++f)
+    {
+        internal::formatValue(str, sizes[f], 0);
+        for (int j = 0; j != sizes[f]; ++j, ++i)
         {
-            if(!solid || !facet || !loop ) 
-                ioError(lineNumber,"vertex");
-            tmp++;
-            nvert++;
-            size_t pos=str.rfind("vertex")+7;
-            assert(pos!=String::npos);
-            vertices << str.substr(pos, str.size()-pos) <<"\n";
+            str += ' ';
+            internal::formatValue(str, i, 0);
         }
+        str += '\n';
     }
 
     g->append_attribute( internal::makeAttribute("vertices", nvert,  *data) );
     g->append_attribute( internal::makeAttribute("faces"   , nfaces, *data) );
-    vertices << triangles.str() ;
-    g->value( internal::makeValue( vertices.str(), *data) );
+    g->value( internal::makeValue( str, *data) );
 
     return true;
 }
@@ -1743,6 +1782,22 @@ gsFileData<T>::getXmlRoot() const
     return data->getRoot();
 } 
 
+template<class T>
+void gsFileData<T>::loadAll() const
+{ 
+    if ( ! m_loader )
+        return;
+
+    for (gsXmlNode * child = data->first_node("xml")->first_node();
+         child; child = child->next_sibling() )
+        m_loader->load(child);
+
+    // All objects are read, the file is not needed any more
+    data->setLoader(NULL);
+    delete m_loader;
+    m_loader = NULL;
+}
+
 template<class T> inline
 void gsFileData<T>::deleteXmlSubtree(gsXmlNode * node)
 { 
@@ -1785,6 +1840,7 @@ gsFileData<T>::getAnyFirstNode(const std::string & name, const std::string & typ
         for (gsXmlNode * child = root->first_node() ; 
              child; child = child->next_sibling() )
         {
+            internal::loadNode(child);
             if (!strcmp( child->name(), name.c_str() ) ) 
                 return child;
             // Level 2
@@ -1805,6 +1861,7 @@ gsFileData<T>::getAnyFirstNode(const std::string & name, const std::string & typ
         for (gsXmlNode * child = root->first_node() ; 
              child; child = child->next_sibling() )
         {
+            internal::loadNode(child);
             if (!strcmp( child->name(), name.c_str() ) &&
                 !strcmp( child->first_attribute("type")->value(), type.c_str() ) ) 
                 return child;
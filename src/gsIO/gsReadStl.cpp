@@ -0,0 +1,175 @@
+/** @file gsReadStl.cpp
+
+    @brief Provides implementation of the reader of STL files.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <gsIO/gsReadStl.h>
+#include <gsIO/gsXml.h>
+
+#include <fstream>
+#include <cstring>
+#include <cctype>
+
+namespace gismo
+{
+
+namespace internal
+{
+
+static unsigned getU32(const char * p)
+{
+    unsigned v = 0;
+    for ( int k = 3; k >= 0; --k )
+        v = v << 8 | static_cast<unsigned char>(p[k]);
+    return v;
+}
+
+static float getF32(const char * p)
+{
+    const unsigned v = getU32(p);
+    float f;
+    std::memcpy(&f, &v, 4);
+    return f;
+}
+
+static inline bool isSpace(const char c)
+{ return ' ' == c || '\n' == c || '\t' == c || '\r' == c || '\v' == c || '\f' == c; }
+
+// Moves str past the next word and returns it in lower case
+static std::string nextWord(const char * & str, const char * end)
+{
+    while ( str != end && isSpace(*str) ) ++str;
+    std::string word;
+    for ( ; str != end && !isSpace(*str); ++str )
+        word.push_back( static_cast<char>(std::tolower(static_cast<unsigned char>(*str))) );
+    return word;
+}
+
+// Reads the facets of a binary STL file: a header of 80 bytes, the
+// number of triangles (uint32) and 50 bytes per triangle, the normal
+// and the three vertices (float32) and an attribute (uint16)
+static void readBinaryFacets(const std::vector<char> & buf, std::vector<double> & coords,
+                             std::vector<int> & sizes)
+{
+    const size_t n = getU32(&buf[80]);
+    coords.reserve(coords.size() + 9 * n);
+    sizes.resize(sizes.size() + n, 3);
+    for ( const char * p = &buf[84], * end = p + 50 * n; p != end; p += 50 )
+        for ( int k = 3; k != 12; ++k )
+            coords.push_back( getF32(p + 4 * k) );
+}
+
+// Reads the facets of an ASCII STL file; all keywords but "vertex"
+// and "endloop" are skipped, after checking that the words of every
+// facet are in order
+static bool readAsciiFacets(const char * str, const char * end,
+                            std::vector<double> & coords, std::vector<int> & sizes)
+{
+    bool solid(false), facet(false), loop(false);
+    int nv = 0;
+    double val;
+    for ( std::string word = nextWord(str, end); !word.empty(); word = nextWord(str, end) )
+    {
+        if ( "vertex" == word )
+        {
+            if ( !loop )
+                return false;
+            for ( int i = 0; i != 3; ++i )
+            {
+                if ( !parseValue(str, val) )
+                    return false;
+                coords.push_back(val);
+            }
+            ++nv;
+        }
+        else if ( "endloop" == word )
+        {
+            if ( !loop || nv < 3 )
+                return false;
+            sizes.push_back(nv);
+            loop = false;
+        }
+        else if ( "outer" == word )
+        {
+            if ( !facet || loop )
+                return false;
+            loop = true;
+            nv = 0;
+        }
+        else if ( "facet" == word )
+        {
+            if ( !solid || facet )
+                return false;
+            facet = true;
+        }
+        else if ( "endfacet" == word )
+        {
+            if ( !facet || loop )
+                return false;
+            facet = false;
+        }
+        else if ( "solid" == word )
+        {
+            if ( solid )
+                return false;
+            solid = true;
+        }
+        else if ( "endsolid" == word )
+        {
+            if ( !solid || facet )
+                return false;
+            solid = false;
+        }
+        // else: the name of the solid, "loop", "normal" and its
+        // coordinates
+    }
+    return !solid && !facet;
+}
+
+bool readStlFacets(const std::string & fn, std::vector<double> & coords,
+                   std::vector<int> & sizes)
+{
+    std::ifstream file(fn.c_str(), std::ios::in | std::ios::binary);
+    if ( !file.good() )
+    {
+        gsWarn << "gsReadStl: Cannot open file " << fn << ".\n";
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    const size_t size = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    std::vector<char> buf(size + 1, '\0'); // parseValue stops at the terminator
+    file.read(&buf[0], size);
+    if ( !file )
+    {
+        gsWarn << "gsReadStl: Cannot read file " << fn << ".\n";
+        return false;
+    }
+
+    // A binary file can start with "solid" as well, so it is
+    // recognized by its size
+    if ( size >= 84 && size == 84 + 50 * static_cast<size_t>(getU32(&buf[80])) )
+    {
+        readBinaryFacets(buf, coords, sizes);
+        return true;
+    }
+
+    if ( ! readAsciiFacets(&buf[0], &buf[0] + size, coords, sizes) )
+    {
+        gsWarn << "gsReadStl: Malformed STL file " << fn << ".\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace internal
+
+} // namespace gismo
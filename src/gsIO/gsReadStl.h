@@ -0,0 +1,142 @@
+/** @file gsReadStl.h
+
+    @brief Provides the reader of STL files, binary and ASCII, into a
+    gsMesh.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsCore/gsConfig.h>
+#include <gsCore/gsExport.h>
+#include <gsUtils/gsMesh/gsIndexedMesh.h>
+
+#include <string>
+#include <vector>
+
+namespace gismo {
+
+namespace internal {
+
+/**
+   \brief Reads the facets of the STL file \a fn.
+
+   The coordinates of the vertices of all facets are appended to \a
+   coords, three per vertex, and the number of vertices of every facet
+   to \a sizes. A binary file is recognized by its size, which is 84
+   bytes plus 50 bytes per triangle, any other file is read as ASCII.
+   Returns false if the file cannot be read, or an ASCII file is
+   malformed.
+*/
+GISMO_EXPORT bool readStlFacets(const std::string & fn,
+                                std::vector<double> & coords,
+                                std::vector<int> & sizes);
+
+} // namespace internal
+
+/**
+   \brief Reads the STL file \a fn, binary or ASCII, into the mesh \a
+   mesh.
+
+   The facets are added to the mesh as faces. If \a weld is true, the
+   vertices which differ by at most \a tolerance in every coordinate
+   are added only once (see gsVertexWelder), as cleanStlMesh does
+   after reading, otherwise every facet gets its own vertices.
+   Returns false if the file cannot be read.
+
+   \ingroup IO
+*/
+template<class T>
+bool gsReadStl(const std::string & fn, gsMesh<T> & mesh,
+               bool weld = true, T tolerance = 0)
+{
+    std::vector<double> coords;
+    std::vector<int>    sizes;
+    if ( ! internal::readStlFacets(fn, coords, sizes) )
+        return false;
+    if ( sizes.empty() )
+        return true;
+
+    const size_t nv = coords.size() / 3;
+    const size_t first = mesh.vertex.size();
+    mesh.vertex.reserve(first + nv);
+    mesh.face.reserve(mesh.face.size() + sizes.size());
+
+    // A closed triangle mesh has about half as many vertices as
+    // triangles, ie. nv/6
+    gsVertexWelder<T> welder(tolerance, weld ? nv / 6 : 0);
+    std::vector<typename gsMesh<T>::VertexHandle> verts;
+    const double * c = &coords[0];
+    for (size_t f = 0; f != sizes.size(); ++f)
+    {
+        verts.resize(sizes[f]);
+        for (int j = 0; j != sizes[f]; ++j, c += 3)
+        {
+            const T x = static_cast<T>(c[0]), y = static_cast<T>(c[1]),
+                z = static_cast<T>(c[2]);
+            if ( weld )
+            {
+                const size_t k = first + welder.insert(x, y, z);
+                verts[j] = ( k < mesh.vertex.size() ? mesh.vertex[k]
+                             : mesh.addVertex(x, y, z) );
+            }
+            else
+                verts[j] = mesh.addVertex(x, y, z);
+        }
+        mesh.addFace(verts);
+    }
+    return true;
+}
+
+/**
+   \brief Reads the STL file \a fn, binary or ASCII, into the indexed
+   mesh \a mesh, see gsReadStl for gsMesh.
+
+   \ingroup IO
+*/
+template<class T>
+bool gsReadStl(const std::string & fn, gsIndexedMesh<T> & mesh,
+               bool weld = true, T tolerance = 0)
+{
+    std::vector<double> coords;
+    std::vector<int>    sizes;
+    if ( ! internal::readStlFacets(fn, coords, sizes) )
+        return false;
+
+    const size_t nv = coords.size() / 3;
+    const index_t first = mesh.numVertices();
+    mesh.reserve(first + (weld ? nv / 6 : nv), mesh.numFaces() + sizes.size(),
+                 mesh.faceIndices().size() + nv);
+
+    gsVertexWelder<T> welder(tolerance, weld ? nv / 6 : 0);
+    std::vector<index_t> verts;
+    const double * c = coords.empty() ? NULL : &coords[0];
+    for (size_t f = 0; f != sizes.size(); ++f)
+    {
+        verts.resize(sizes[f]);
+        for (int j = 0; j != sizes[f]; ++j, c += 3)
+        {
+            const T x = static_cast<T>(c[0]), y = static_cast<T>(c[1]),
+                z = static_cast<T>(c[2]);
+            if ( weld )
+            {
+                verts[j] = first + welder.insert(x, y, z);
+                if ( verts[j] == mesh.numVertices() )
+                    mesh.addVertex(x, y, z);
+            }
+            else
+                verts[j] = mesh.addVertex(x, y, z);
+        }
+        mesh.addFace(&verts[0], sizes[f]);
+    }
+    return true;
+}
+
+} // namespace gismo
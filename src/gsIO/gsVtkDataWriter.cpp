@@ -0,0 +1,117 @@
+/** @file gsVtkDataWriter.cpp
+
+    @brief Provides implementation of the writer of the data arrays of
+    Paraview files.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <gsIO/gsVtkDataWriter.h>
+
+#include <zlib/zlib.h>
+
+#include <cstring>
+
+namespace gismo
+{
+
+// Format of the gsWriteParaview calls with vtkFormat::automatic
+static vtkFormat::type s_defaultFormat = vtkFormat::ascii;
+
+// Size of the uncompressed blocks, as used by VTK
+static const unsigned s_blockSize = 32768;
+
+// Appends the bytes of the 64 bit integer v to buf, the headers of
+// the appended data are 64 bit (header_type="UInt64") so that arrays
+// larger than 4 GB keep valid sizes
+static void appendUInt64(std::vector<char> & buf, unsigned long long v)
+{
+    const char * b = reinterpret_cast<const char*>(&v);
+    buf.insert(buf.end(), b, b + 8);
+}
+
+void gsWriteParaviewSetFormat(vtkFormat::type fmt)
+{
+    GISMO_ENSURE( vtkFormat::automatic != fmt, "Invalid default format");
+    s_defaultFormat = fmt;
+}
+
+vtkFormat::type gsWriteParaviewFormat()
+{
+    return s_defaultFormat;
+}
+
+namespace internal
+{
+
+gsVtkDataWriter::gsVtkDataWriter(vtkFormat::type fmt)
+: m_format( vtkFormat::automatic == fmt ? s_defaultFormat : fmt )
+{ }
+
+std::string gsVtkDataWriter::fileAttributes() const
+{
+    const unsigned one = 1;
+    std::string res = ( 1 == *reinterpret_cast<const char*>(&one) ) ?
+        " byte_order=\"LittleEndian\"" : " byte_order=\"BigEndian\"";
+    res += " header_type=\"UInt64\"";
+    if ( vtkFormat::compressed == m_format )
+        res += " compressor=\"vtkZLibDataCompressor\"";
+    return res;
+}
+
+void gsVtkDataWriter::append(const char * bytes, size_t size)
+{
+    if ( vtkFormat::binary == m_format )
+    {
+        // Number of bytes, followed by the data
+        appendUInt64(m_data, size);
+        m_data.insert(m_data.end(), bytes, bytes + size);
+        return;
+    }
+
+    // Header: number of blocks, size of the blocks, size of the
+    // last block if it is partial, sizes of the compressed blocks
+    const size_t nb   = (size + s_blockSize - 1) / s_blockSize;
+    const size_t head = m_data.size();
+    appendUInt64(m_data, nb);
+    appendUInt64(m_data, s_blockSize);
+    appendUInt64(m_data, size % s_blockSize);
+    m_data.resize(head + 8 * (3 + nb) );
+
+    std::vector<Bytef> cbuf( compressBound(s_blockSize) );
+    for ( size_t k = 0; k != nb; ++k )
+    {
+        const size_t first = k * s_blockSize;
+        const uLong  len   = static_cast<uLong>( std::min<size_t>(s_blockSize, size - first) );
+        uLongf clen = static_cast<uLongf>(cbuf.size());
+        const int ok = compress2(&cbuf[0], &clen,
+                                 reinterpret_cast<const Bytef*>(bytes + first), len,
+                                 Z_BEST_SPEED);
+        GISMO_ENSURE( Z_OK == ok, "Data compression failed");
+
+        const unsigned long long csize = clen;
+        std::memcpy(&m_data[head + 8 * (3 + k)], &csize, 8);
+        m_data.insert(m_data.end(), reinterpret_cast<const char*>(&cbuf[0]),
+                      reinterpret_cast<const char*>(&cbuf[0]) + clen);
+    }
+}
+
+void gsVtkDataWriter::writeAppended(std::ostream & os)
+{
+    if ( m_data.empty() )
+        return;
+    os <<"<AppendedData encoding=\"raw\">\n_";
+    os.write(&m_data[0], m_data.size());
+    os <<"\n</AppendedData>\n";
+    m_data.clear();
+}
+
+} // namespace internal
+
+} // namespace gismo
@@ -0,0 +1,157 @@
+/** @file gsVtkDataWriter.h
+
+    @brief Provides a helper class which writes the data arrays of
+    Paraview (VTK XML) files, as text or as appended binary data.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsCore/gsForwardDeclarations.h>
+#include <gsCore/gsExport.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gismo {
+
+/**
+    \brief Encoding of the data arrays of the files written by
+    gsWriteParaview.
+
+    The binary formats store the arrays as an \em AppendedData
+    section at the end of the VTK file, in single precision.
+
+    \ingroup IO
+*/
+struct vtkFormat
+{
+    enum type
+    {
+        automatic  = -1, ///< the default format, see gsWriteParaviewSetFormat
+        ascii      =  0, ///< text
+        binary     =  1, ///< raw binary data
+        compressed =  2  ///< binary data compressed by zlib
+    };
+};
+
+/// \brief Sets the format which is used by the gsWriteParaview
+/// functions which are called with vtkFormat::automatic (the
+/// default is vtkFormat::ascii)
+///
+/// \ingroup IO
+GISMO_EXPORT void gsWriteParaviewSetFormat(vtkFormat::type fmt);
+
+/// \brief Returns the format which is used by the gsWriteParaview
+/// functions which are called with vtkFormat::automatic
+///
+/// \ingroup IO
+GISMO_EXPORT vtkFormat::type gsWriteParaviewFormat();
+
+namespace internal {
+
+/// Name of the VTK data type Z
+template<class Z> struct vtkTypeName;
+template<> struct vtkTypeName<float> { static const char * get() { return "Float32"; } };
+template<> struct vtkTypeName<int>   { static const char * get() { return "Int32"  ; } };
+
+/**
+    \brief Writes the DataArray elements of a VTK XML file.
+
+    In ascii format the values are written in the element, with the
+    formatting of the output stream. Otherwise the element refers to
+    an offset in the appended data, which are kept by the writer and
+    written by writeAppended() after the dataset element.
+
+    Typical usage is
+    \verbatim
+    gsVtkDataWriter vtk(fmt);
+    file << "<VTKFile type=\"StructuredGrid\" version=\"1.0\"" << vtk.fileAttributes() << ">\n";
+    ...
+    vtk.write<float>(file, "NumberOfComponents=\"3\"", points);
+    ...
+    file << "</StructuredGrid>\n";
+    vtk.writeAppended(file);
+    file << "</VTKFile>\n";
+    \endverbatim
+*/
+class GISMO_EXPORT gsVtkDataWriter
+{
+public:
+
+    /// Constructor, vtkFormat::automatic selects gsWriteParaviewFormat()
+    explicit gsVtkDataWriter(vtkFormat::type fmt = vtkFormat::automatic);
+
+    /// The format of the writer
+    vtkFormat::type format() const { return m_format; }
+
+    /// The attributes of the VTKFile element (byte order, header type
+    /// and compressor). The 64 bit headers need version="1.0" of the
+    /// file format
+    std::string fileAttributes() const;
+
+    /// Writes a DataArray of type \a Z with the \a n values starting
+    /// at \a data, the element has the additional \a attributes
+    template<class Z, class S>
+    void write(std::ostream & os, const std::string & attributes,
+               const S * data, size_t n)
+    {
+        os << "<DataArray type=\""<< vtkTypeName<Z>::get() <<"\" "<< attributes;
+        if ( vtkFormat::ascii == m_format )
+        {
+            os <<" format=\"ascii\">\n";
+            for ( size_t i = 0; i != n; ++i )
+                os << data[i] <<" ";
+            os <<"\n</DataArray>\n";
+        }
+        else
+        {
+            os <<" format=\"appended\" offset=\""<< m_data.size() <<"\"/>\n";
+            std::vector<Z> tmp(data, data + n);
+            append(tmp.empty() ? NULL : reinterpret_cast<const char*>(&tmp[0]),
+                   n * sizeof(Z));
+        }
+    }
+
+    /// Writes a DataArray of type \a Z with the values of \a data
+    template<class Z, class S>
+    void write(std::ostream & os, const std::string & attributes,
+               const std::vector<S> & data)
+    { write<Z>(os, attributes, data.empty() ? (const S*)NULL : &data[0], data.size()); }
+
+    /// Writes a DataArray of type \a Z with the values of \a data,
+    /// column by column
+    template<class Z, class S, int _Rows, int _Cols, int _Options>
+    void write(std::ostream & os, const std::string & attributes,
+               const gsMatrix<S,_Rows,_Cols,_Options> & data)
+    {
+        write<Z>(os, attributes, data.data(), static_cast<size_t>(data.size()) );
+    }
+
+    /// Writes the AppendedData element, if there are binary data
+    void writeAppended(std::ostream & os);
+
+private:
+
+    // Appends a block of the raw or compressed data
+    void append(const char * bytes, size_t size);
+
+private:
+
+    vtkFormat::type m_format;
+
+    // Appended data, with the headers of the blocks
+    std::vector<char> m_data;
+};
+
+} // namespace internal
+
+} // namespace gismo
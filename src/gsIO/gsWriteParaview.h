@@ -13,6 +13,7 @@
 
 #include <gsCore/gsForwardDeclarations.h>
 #include <gsCore/gsExport.h>
+#include <gsIO/gsVtkDataWriter.h>
 
 #include <sstream>
 #include <fstream>
@@ -32,19 +33,33 @@ namespace gismo {
 /// \param npts number of points used for sampling each patch
 /// \param mesh if true, the parameter mesh is plotted as well
 /// \param ctrlNet if true, the control net is plotted as well
+/// \param fmt encoding of the data arrays, see vtkFormat
 ///
 /// \ingroup IO
 template<class T>
 void gsWriteParaview(const gsGeometry<T> & Geo, std::string const & fn, 
-                     unsigned npts=NS, bool mesh = false, bool ctrlNet = false);
+                     unsigned npts=NS, bool mesh = false, bool ctrlNet = false,
+                     vtkFormat::type fmt = vtkFormat::automatic);
 
 /// \brief Export a mesh to paraview file
 ///
 /// \param sl a gsMesh obect
 /// \param fn filename where paraview file is written
 /// \param pvd if true, a .pvd file is generated (for compatibility)
+/// \param fmt encoding of the data arrays, see vtkFormat
 template <class T>
-void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd = true);
+void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd = true,
+                     vtkFormat::type fmt = vtkFormat::automatic);
+
+/// \brief Export an indexed mesh to paraview file
+///
+/// \param sl a gsIndexedMesh obect
+/// \param fn filename where paraview file is written
+/// \param pvd if true, a .pvd file is generated (for compatibility)
+/// \param fmt encoding of the data arrays, see vtkFormat
+template <class T>
+void gsWriteParaview(gsIndexedMesh<T> const& sl, std::string const & fn, bool pvd = true,
+                     vtkFormat::type fmt = vtkFormat::automatic);
 
 /// \brief Export a vector of meshes, each mesh in its own file.
 ///
@@ -56,13 +71,20 @@ void gsWriteParaview(const std::vector<gsMesh<T> >& meshes, std::string const& f
 
 /// \brief Write a file containing a solution field (as color on its geometry) to paraview file
 ///
+/// Every patch is written to its own file, and the files are
+/// collected in \a fn.pvd. The patches are sampled and written in
+/// parallel, one patch per thread at a time, therefore the sample
+/// grids of at most as many patches as threads are held in memory.
+///
 /// \param field a field object
 /// \param fn filename where paraview file is written
 /// \param npts number of points used for sampling each patch
 /// \param mesh if true, the parameter mesh is plotted as well
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
 void gsWriteParaview(const gsField<T> & field, std::string const & fn, 
-                     unsigned npts=NS, bool mesh = false);
+                     unsigned npts=NS, bool mesh = false,
+                     vtkFormat::type fmt = vtkFormat::automatic);
 
 /// \brief Export a multipatch Geometry (without scalar information) to paraview file
 ///
@@ -71,24 +93,31 @@ void gsWriteParaview(const gsField<T> & field, std::string const & fn,
 /// \param npts number of points used for sampling each patch
 /// \param mesh if true, the parameter mesh is plotted as well
 /// \param ctrlNet if true, the control net is plotted as well
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
 void gsWriteParaview(const gsMultiPatch<T> & Geo, std::string const & fn, 
-                     unsigned npts=NS, bool mesh = false, bool ctrlNet = false)
+                     unsigned npts=NS, bool mesh = false, bool ctrlNet = false,
+                     vtkFormat::type fmt = vtkFormat::automatic)
 {
-    gsWriteParaview( Geo.patches(), fn, npts, mesh, ctrlNet);
+    gsWriteParaview( Geo.patches(), fn, npts, mesh, ctrlNet, fmt);
 }
 
 /// \brief Export a multipatch Geometry (without scalar information) to paraview file
 ///
+/// The geometries are sampled and written in parallel, each to its
+/// own file, and the files are collected in \a fn.pvd.
+///
 /// \param Geo a vector of the geometries to be plotted
 /// \param fn filename where paraview file is written
 /// \param npts number of points used for sampling each geometry
 /// \param mesh if true, the parameter mesh is plotted as well
 /// \param ctrlNet if true, the control net is plotted as well
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
 void gsWriteParaview( std::vector<gsGeometry<T> *> const & Geo, 
                       std::string const & fn, unsigned npts=NS,
-                      bool mesh = false, bool ctrlNet = false);
+                      bool mesh = false, bool ctrlNet = false,
+                      vtkFormat::type fmt = vtkFormat::automatic);
 
 /// \brief Export a composite Geometry to paraview file
 ///
@@ -108,9 +137,11 @@ void gsWriteParaview( gsCompositeGeom<2,T> const & Geo,
 /// \param basis a basis object
 /// \param fn filename where paraview file is written
 /// \param npts number of points used for sampling each curve
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
 void gsWriteParaview_basisFnct(int i, gsBasis<T> const& basis, 
-                               std::string const & fn, unsigned npts =NS);
+                               std::string const & fn, unsigned npts =NS,
+                               vtkFormat::type fmt = vtkFormat::automatic);
 
 
 /// \brief Export a Geometry slice to paraview file
@@ -118,9 +149,11 @@ void gsWriteParaview_basisFnct(int i, gsBasis<T> const& basis,
 /// \param Geo a gsGeometrySlice
 /// \param fn filename where paraview file is written
 /// \param npts number of points used for sampling each curve
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
 void gsWriteParaview(const gsGeometrySlice<T> & Geo,
-                     std::string const & fn, unsigned npts =NS);
+                     std::string const & fn, unsigned npts =NS,
+                     vtkFormat::type fmt = vtkFormat::automatic);
 
 
 /// \brief Export a function plot to paraview file
@@ -131,11 +164,13 @@ void gsWriteParaview(const gsGeometrySlice<T> & Geo,
 /// the function, after sampling
 /// \param fn filename where paraview file is written
 /// \param npts number of points used for sampling the domain
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
 void gsWriteParaview(gsFunction<T> const& func, 
                      gsMatrix<T> const& supp, 
                      std::string const & fn, 
-                     unsigned npts =NS);
+                     unsigned npts =NS,
+                     vtkFormat::type fmt = vtkFormat::automatic);
 
 
 /// \brief Export Basis functions to paraview files
@@ -144,9 +179,11 @@ void gsWriteParaview(gsFunction<T> const& func,
 /// \param fn filename where paraview file is written
 /// \param npts number of points used for sampling each curve
 /// \param mesh if true, the parameter mesh is plotted as well
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
 void gsWriteParaview(gsBasis<T> const& basis, std::string const & fn, 
-                     unsigned npts =NS, bool mesh = false);
+                     unsigned npts =NS, bool mesh = false,
+                     vtkFormat::type fmt = vtkFormat::automatic);
 
 
 /// \brief Export 2D Point set to Paraview file
@@ -154,10 +191,12 @@ void gsWriteParaview(gsBasis<T> const& basis, std::string const & fn,
 /// \param X  1 times n matrix of values for x direction
 /// \param Y  1 times n matrix of values for y direction
 /// \param fn filename where paraview file is written
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
 void gsWriteParaviewPoints(gsMatrix<T> const& X, 
                            gsMatrix<T> const& Y, 
-                           std::string const & fn);
+                           std::string const & fn,
+                           vtkFormat::type fmt = vtkFormat::automatic);
 
 /// \brief Export 3D Point set to Paraview file
 ///
@@ -165,18 +204,22 @@ void gsWriteParaviewPoints(gsMatrix<T> const& X,
 /// \param Y  1 times n matrix of values for y direction
 /// \param Z  1 times n matrix of values for z-direction
 /// \param fn filename where paraview file is written
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
 void gsWriteParaviewPoints(gsMatrix<T> const& X,
                            gsMatrix<T> const& Y,
                            gsMatrix<T> const& Z,
-                           std::string const & fn);
+                           std::string const & fn,
+                           vtkFormat::type fmt = vtkFormat::automatic);
 
 /// \brief Export Point set to Paraview file
 ///
 /// \param points matrix that contain 2D or 3D points, points are columns
 /// \param fn filename where paraview file is written
+/// \param fmt encoding of the data arrays, see vtkFormat
 template<class T>
-void gsWriteParaviewPoints(gsMatrix<T> const& points, std::string const & fn);
+void gsWriteParaviewPoints(gsMatrix<T> const& points, std::string const & fn,
+                           vtkFormat::type fmt = vtkFormat::automatic);
 
 
 /// \brief Depicting edge graph of each volume of one gsSolid with a segmenting loop
@@ -256,7 +299,8 @@ template<class T>
 void writeSinglePatchField(const gsFunction<T> & geometry,
                            const gsFunction<T> & parField,
                            const bool isParam,
-                           std::string const & fn, unsigned npts);
+                           std::string const & fn, unsigned npts,
+                           vtkFormat::type fmt = vtkFormat::automatic);
 
 // Please document
 template <class T>
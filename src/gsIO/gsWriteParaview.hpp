@@ -25,6 +25,7 @@
 
 #include <gsModeling/gsTrimSurface.h>
 #include <gsModeling/gsSolid.h>
+#include <gsUtils/gsMesh/gsIndexedMesh.h>
 //#include <gsUtils/gsMesh/gsHeMesh.h>
 
 
@@ -33,23 +34,71 @@
 namespace gismo
 {
 
+namespace internal
+{
+
+// Returns the coordinates of the vertices of a mesh, as columns
+template<class T>
+gsMatrix<T> meshVertices(const gsMesh<T> & sl)
+{
+    gsMatrix<T> res(3, sl.vertex.size());
+    for (size_t i = 0; i != sl.vertex.size(); ++i)
+        res.col(i) = sl.vertex[i]->coords;
+    return res;
+}
+
+// Returns the n integers first, first+step, first+2*step, ..
+inline std::vector<int> vtkSequence(unsigned n, int first, int step)
+{
+    std::vector<int> res(n);
+    for (unsigned i = 0; i != n; ++i)
+        res[i] = first + static_cast<int>(i) * step;
+    return res;
+}
+
+// Keeps the message of the first exception thrown by a thread of
+// the parallel writers
+inline void vtkKeepError(const std::exception & e, bool & failed, std::string & error)
+{
+#   pragma omp critical (gsWriteParaview_error)
+    {
+        if ( !failed )
+            error = e.what();
+#       pragma omp atomic write
+        failed = true;
+    }
+}
+
+// True if a thread of the parallel writers failed
+inline bool vtkHasError(const bool & failed)
+{
+    bool res;
+#   pragma omp atomic read
+    res = failed;
+    return res;
+}
+
+} // namespace internal
+
 // Export a 3D parametric mesh
 template<class T>
 void writeSingleBasisMesh3D(const gsMesh<T> & sl,
-                            std::string const & fn)
+                            std::string const & fn,
+                            vtkFormat::type fmt = vtkFormat::automatic)
 {
     const unsigned numVer = sl.numVertices;
     const unsigned numEl  = numVer / 8;
     std::string mfn(fn);
     mfn.append(".vtu");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
     if ( ! file.is_open() )
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk(fmt);
     
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    file <<"<VTKFile type=\"UnstructuredGrid\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<UnstructuredGrid>\n";
     
     // Number of vertices and number of cells
@@ -57,59 +106,26 @@ void writeSingleBasisMesh3D(const gsMesh<T> & sl,
     
     // Coordinates of vertices
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); ++it)
-    {
-        file << ((*it)->coords)[0] << " " << ((*it)->coords)[1] << " " << ((*it)->coords)[2] << " \n";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "NumberOfComponents=\"3\"", internal::meshVertices(sl) );
     file <<"</Points>\n";
 
     // Point data
+    std::vector<T> data(sl.vertex.size());
+    for (size_t i = 0; i != data.size(); ++i)
+        data[i] = sl.vertex[i]->data;
     file <<"<PointData Scalars=\"CellVolume\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"CellVolume\" format=\"ascii\" NumberOfComponents=\"1\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); ++it)
-    {
-        file << (*it)->data <<" ";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "Name=\"CellVolume\" NumberOfComponents=\"1\"", data);
     file <<"</PointData>\n";
 
     // Cells
     file <<"<Cells>\n";
-
-    // Connectivity
-    file <<"<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
-    for (unsigned i = 0; i!= numVer;++i)
-    {
-        file << i << " ";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
-
-    // Offsets
-    file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-    for (unsigned i = 1; i<= numEl;++i)
-    {
-        file << 8*i << " ";
-    }
-    file << "\n";
-    file << "</DataArray>\n";
-
-    // Type
-    file << "<DataArray type=\"Int32\" Name=\"types\" format=\"ascii\">\n";
-    for (unsigned i = 1; i<= numEl;++i)
-    {
-        file << "11 ";
-    }
-    file << "\n";
-    file << "</DataArray>\n";
-
+    vtk.write<int>(file, "Name=\"connectivity\"", internal::vtkSequence(numVer, 0, 1) );
+    vtk.write<int>(file, "Name=\"offsets\""     , internal::vtkSequence(numEl , 8, 8) );
+    vtk.write<int>(file, "Name=\"types\""       , internal::vtkSequence(numEl ,11, 0) );
     file <<"</Cells>\n";
     file << "</Piece>\n";
     file <<"</UnstructuredGrid>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
     file.close();
     
@@ -121,84 +137,52 @@ void writeSingleBasisMesh3D(const gsMesh<T> & sl,
 // 
 template<class T>
 void writeSingleBasisMesh2D(const gsMesh<T> & sl,
-                            std::string const & fn)
+                            std::string const & fn,
+                            vtkFormat::type fmt = vtkFormat::automatic)
 {
     const unsigned numVer = sl.numVertices;
     const unsigned numEl  = numVer / 4; //(1<<dim)
     std::string mfn(fn);
     mfn.append(".vtu");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
     if ( ! file.is_open() )
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk(fmt);
     
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    file <<"<VTKFile type=\"UnstructuredGrid\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<UnstructuredGrid>\n";
     
     // Number of vertices and number of cells
     file <<"<Piece NumberOfPoints=\""<< numVer <<"\" NumberOfCells=\""<<numEl<<"\">\n";
     
     // Coordinates of vertices
+    gsMatrix<T> pts = internal::meshVertices(sl);
+    for (index_t i = 0; i + 3 < pts.cols(); i += 4)
+        pts.col(i+2).swap( pts.col(i+3) ); // order is important!
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); it+=4)
-    {
-        // order is important!
-        file << ((*it)->coords)[0] << " " << ((*it)->coords)[1] << " " << ((*it)->coords)[2] << " \n";
-        file << ((*(it+1))->coords)[0] << " " << ((*(it+1))->coords)[1] << " " << ((*(it+1))->coords)[2] << " \n";
-        file << ((*(it+3))->coords)[0] << " " << ((*(it+3))->coords)[1] << " " << ((*(it+3))->coords)[2] << " \n";
-        file << ((*(it+2))->coords)[0] << " " << ((*(it+2))->coords)[1] << " " << ((*(it+2))->coords)[2] << " \n";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "NumberOfComponents=\"3\"", pts);
     file <<"</Points>\n";
 
     // Point data
+    std::vector<T> data(sl.vertex.size());
+    for (size_t i = 0; i != data.size(); ++i)
+        data[i] = sl.vertex[i]->data;
     file <<"<PointData Scalars=\"CellArea\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"CellVolume\" format=\"ascii\" NumberOfComponents=\"1\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); ++it)
-    {
-        file << (*it)->data <<" ";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "Name=\"CellVolume\" NumberOfComponents=\"1\"", data);
     file <<"</PointData>\n";
 
     // Cells
     file <<"<Cells>\n";
-
-    // Connectivity
-    file <<"<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
-    for (unsigned i = 0; i!= numVer;++i)
-    {
-        file << i << " ";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
-
-    // Offsets
-    file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-    for (unsigned i = 1; i<= numEl;++i)
-    {
-        file << 4*i << " "; //step: (1<<dim) 
-    }
-    file << "\n";
-    file << "</DataArray>\n";
-
-    // Type
-    file << "<DataArray type=\"Int32\" Name=\"types\" format=\"ascii\">\n";
-    for (unsigned i = 1; i<= numEl;++i)
-    {
-        file << "9 ";// 11: 3D, 9: 2D
-    }
-    file << "\n";
-    file << "</DataArray>\n";
-
+    vtk.write<int>(file, "Name=\"connectivity\"", internal::vtkSequence(numVer, 0, 1) );
+    vtk.write<int>(file, "Name=\"offsets\""     , internal::vtkSequence(numEl , 4, 4) ); //step: (1<<dim) 
+    vtk.write<int>(file, "Name=\"types\""       , internal::vtkSequence(numEl , 9, 0) ); // 11: 3D, 9: 2D
     file <<"</Cells>\n";
     file << "</Piece>\n";
     file <<"</UnstructuredGrid>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
     file.close();
     
@@ -210,22 +194,24 @@ void writeSingleBasisMesh2D(const gsMesh<T> & sl,
 /// Export a parametric mesh
 template<class T>
 void writeSingleBasisMesh(const gsBasis<T> & basis,
-                         std::string const & fn)
+                          std::string const & fn,
+                          vtkFormat::type fmt = vtkFormat::automatic)
 {
     gsMesh<T> msh;
     makeMesh<T>(basis, msh);
     if ( basis.dim() == 3)
-        writeSingleBasisMesh3D(msh,fn);
+        writeSingleBasisMesh3D(msh,fn,fmt);
     else if ( basis.dim() == 2)
-        writeSingleBasisMesh2D(msh,fn);
+        writeSingleBasisMesh2D(msh,fn,fmt);
     else
-        gsWriteParaview(msh, fn, false);
+        gsWriteParaview(msh, fn, false, fmt);
 }
 
 /// Export a computational mesh
 template<class T>
 void writeSingleCompMesh(const gsBasis<T> & basis, const gsGeometry<T> & Geo, 
-                         std::string const & fn, unsigned resolution = 8)
+                         std::string const & fn, unsigned resolution = 8,
+                         vtkFormat::type fmt = vtkFormat::automatic)
 {
     gsMesh<T> msh;
     makeMesh<T>(basis, msh, resolution);
@@ -237,13 +223,14 @@ void writeSingleCompMesh(const gsBasis<T> & basis, const gsGeometry<T> & Geo,
     // else if ( basis.dim() == 2)
     //     writeSingleBasisMesh2D(msh,fn);
     // else
-        gsWriteParaview(msh, fn, false);
+        gsWriteParaview(msh, fn, false, fmt);
 }
 
 /// Export a control net
 template<class T>
 void writeSingleControlNet(const gsGeometry<T> & Geo, 
-                           std::string const & fn)
+                           std::string const & fn,
+                           vtkFormat::type fmt = vtkFormat::automatic)
 {
     const int d = Geo.parDim();
     gsMesh<T> msh;
@@ -261,14 +248,15 @@ void writeSingleControlNet(const gsGeometry<T> & Geo,
     }
 
 
-    gsWriteParaview(msh, fn, false);
+    gsWriteParaview(msh, fn, false, fmt);
 }
 
 template<class T>
 void writeSinglePatchField(const gsFunction<T> & geometry,
                            const gsFunction<T> & parField,
                            const bool isParam,
-                           std::string const & fn, unsigned npts)
+                           std::string const & fn, unsigned npts,
+                           vtkFormat::type fmt)
 {
     const int n = geometry.targetDim();
     const int d = geometry.domainDim();
@@ -302,6 +290,7 @@ void writeSinglePatchField(const gsFunction<T> & geometry,
     else if (n > 3)
     {
         gsWarn<< "Data is more than 3 dimensions.\n";
+        eval_geo.conservativeResize(3,eval_geo.cols() );
     }
 
     //GISMO_ASSERT( eval_field.rows() == field.dim(), "Error in field dimension");
@@ -313,30 +302,25 @@ void writeSinglePatchField(const gsFunction<T> & geometry,
     
     std::string mfn(fn);
     mfn.append(".vts");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk(fmt);
 
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    file <<"<VTKFile type=\"StructuredGrid\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<StructuredGrid WholeExtent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<PointData "<< ( eval_field.rows()==1 ?"Scalars":"Vectors")<<"=\"SolutionField\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<< eval_field.rows() <<"\">\n";
-    for ( index_t j=0; j<eval_field.cols(); ++j)
-        for ( index_t i=0; i<eval_field.rows(); ++i)
-            file<< eval_field(i,j) <<" ";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "Name=\"SolutionField\" NumberOfComponents=\""
+                     + internal::toString(eval_field.rows()) + "\"", eval_field);
     file <<"</PointData>\n";
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\">\n";
-    for ( index_t j=0; j<eval_geo.cols(); ++j)
-        for ( index_t i=0; i<3; ++i)
-            file<< eval_geo(i,j) <<" ";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "NumberOfComponents=\"3\"", eval_geo);
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
 
     file.close();
@@ -345,9 +329,10 @@ void writeSinglePatchField(const gsFunction<T> & geometry,
 /// Write a file containing a solution field over a single geometry
 template<class T>
 void writeSinglePatchField(const gsField<T> & field, int patchNr, 
-                           std::string const & fn, unsigned npts)
+                           std::string const & fn, unsigned npts,
+                           vtkFormat::type fmt = vtkFormat::automatic)
 {
-    writeSinglePatchField(field.patch(patchNr), field.function(patchNr), field.isParametrized(), fn, npts);
+    writeSinglePatchField(field.patch(patchNr), field.function(patchNr), field.isParametrized(), fn, npts, fmt);
 /*
     const int n = field.geoDim();
     const int d = field.parDim();
@@ -427,7 +412,8 @@ void writeSinglePatchField(const gsField<T> & field, int patchNr,
 template<class T>
 void writeSingleGeometry(gsFunction<T> const& func, 
                          gsMatrix<T> const& supp, 
-                         std::string const & fn, unsigned npts)
+                         std::string const & fn, unsigned npts,
+                         vtkFormat::type fmt = vtkFormat::automatic)
 {
     const int n = func.targetDim();
     const int d = func.domainDim();
@@ -465,13 +451,14 @@ void writeSingleGeometry(gsFunction<T> const& func,
 
     std::string mfn(fn);
     mfn.append(".vts");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
     if ( ! file.is_open() )
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk(fmt);
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    file <<"<VTKFile type=\"StructuredGrid\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<StructuredGrid WholeExtent=\"0 "<<np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     // Add norm of the point as data
@@ -483,14 +470,12 @@ void writeSingleGeometry(gsFunction<T> const& func,
     // file <<"</PointData>\n";
     // end norm
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<eval_func.rows()<<"\">\n";
-    for ( index_t j=0; j<eval_func.cols(); ++j)
-        for ( index_t i=0; i<eval_func.rows(); ++i)
-            file<< eval_func(i,j) <<" ";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "NumberOfComponents=\"" + internal::toString(eval_func.rows()) + "\"",
+                     eval_func);
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
     file.close();
 }
@@ -499,7 +484,8 @@ void writeSingleGeometry(gsFunction<T> const& func,
 template<class T>
 void writeSingleCurve(gsFunction<T> const& func, 
                       gsMatrix<T> const& supp, 
-                      std::string const & fn, unsigned npts)
+                      std::string const & fn, unsigned npts,
+                      vtkFormat::type fmt = vtkFormat::automatic)
 {
     const unsigned n = func.targetDim();
     const unsigned d = func.domainDim();
@@ -530,59 +516,53 @@ void writeSingleCurve(gsFunction<T> const& func,
 
     std::string mfn(fn);
     mfn.append(".vtp");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
     if ( ! file.is_open() )
         gsInfo<<"Problem opening "<<fn<<"\n";
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk(fmt);
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    file <<"<VTKFile type=\"PolyData\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<PolyData>\n";
     // Accounting
     file <<"<Piece NumberOfPoints=\""<< npts
          <<"\" NumberOfVerts=\"0\" NumberOfLines=\""<< npts-1
          <<"\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<eval_func.rows()<<"\">\n";
-    for ( index_t j=0; j<eval_func.cols(); ++j)
-        for ( index_t i=0; i<eval_func.rows(); ++i)
-            file<< eval_func(i,j) <<" ";
-    file <<"\n</DataArray>\n";
+    vtk.write<float>(file, "NumberOfComponents=\"" + internal::toString(eval_func.rows()) + "\"",
+                     eval_func);
     file <<"</Points>\n";
     // Lines
-    file <<"<Lines>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<npts-1<<"\">\n";
-    for (unsigned i=0; i< npts-1; ++i )
-    {
-        file << i << " " << i+1 << " ";
-    }
-    // offsets
-    file <<"\n</DataArray>\n";
-    unsigned offset(0);
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<npts-1<<"\">\n";
+    std::vector<int> conn(2*(npts-1));
     for (unsigned i=0; i< npts-1; ++i )
     {
-        offset +=2;
-        file << offset << " ";
+        conn[2*i  ] = i;
+        conn[2*i+1] = i+1;
     }
-    file <<"\n</DataArray>\n";
+    file <<"<Lines>\n";
+    vtk.write<int>(file, "Name=\"connectivity\"", conn);
+    vtk.write<int>(file, "Name=\"offsets\"", internal::vtkSequence(npts-1, 2, 2) );
     file <<"</Lines>\n";
     // Closing 
     file <<"</Piece>\n";
     file <<"</PolyData>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
     file.close();
 }
 
 template<class T>
-void writeSingleCurve(const gsGeometry<T> & Geo, std::string const & fn, unsigned npts)
+void writeSingleCurve(const gsGeometry<T> & Geo, std::string const & fn, unsigned npts,
+                      vtkFormat::type fmt = vtkFormat::automatic)
 {
     gsMatrix<T> ab = Geo.parameterRange();
-    writeSingleCurve( Geo, ab, fn, npts);
+    writeSingleCurve( Geo, ab, fn, npts, fmt);
 }
 
 template<class T>
-void writeSingleGeometry(const gsGeometry<T> & Geo, std::string const & fn, unsigned npts)
+void writeSingleGeometry(const gsGeometry<T> & Geo, std::string const & fn, unsigned npts,
+                         vtkFormat::type fmt = vtkFormat::automatic)
 {
     /*
       gsMesh<T> msh;
@@ -591,7 +571,7 @@ void writeSingleGeometry(const gsGeometry<T> & Geo, std::string const & fn, unsi
       return;
     //*/
     gsMatrix<T> ab = Geo.parameterRange();
-    writeSingleGeometry( Geo, ab, fn, npts);
+    writeSingleGeometry( Geo, ab, fn, npts, fmt);
 }
 
 template<class T>
@@ -608,7 +588,7 @@ void writeSingleTrimSurface(const gsTrimSurface<T> & surf,
 template<class T>
 void gsWriteParaview(const gsField<T> & field, 
                      std::string const & fn, 
-                     unsigned npts, bool mesh)
+                     unsigned npts, bool mesh, vtkFormat::type fmt)
 {
     if (mesh && (!field.isParametrized()) )
     {
@@ -616,23 +596,37 @@ void gsWriteParaview(const gsField<T> & field,
         mesh = false;
     }
 
-    const unsigned n = field.nPatches();
-    gsParaviewCollection collection(fn);
+    const index_t n = field.nPatches();
 
-    for ( unsigned i=0; i < n; ++i )
+    // Every thread samples and writes one patch at a time. An
+    // exception stops the remaining patches and is thrown again
+    // after the loop
+    bool failed = false;
+    std::string error;
+#   pragma omp parallel for schedule(dynamic, 1)
+    for ( index_t i=0; i < n; ++i )
     {
-        std::string fileName = fn + internal::toString<unsigned>(i);
-        writeSinglePatchField( field, i, fileName, npts );
-        collection.addPart(fileName, ".vts");
-        if ( mesh ) 
+        if ( internal::vtkHasError(failed) ) continue;
+        try
         {
-            fileName+= "_mesh";
-            writeSingleCompMesh(field.igaFunction(i).basis(), 
-                                field.patch(i), fileName);
-
-            collection.addPart(fileName, ".vtp");
+            const std::string fileName = fn + internal::toString<index_t>(i);
+            writeSinglePatchField( field, i, fileName, npts, fmt );
+            if ( mesh ) 
+                writeSingleCompMesh(field.igaFunction(i).basis(), 
+                                    field.patch(i), fileName + "_mesh", 8, fmt);
         }
+        catch (std::exception & e) { internal::vtkKeepError(e, failed, error); }
+    }
+    if ( failed )
+        throw std::runtime_error(error);
 
+    gsParaviewCollection collection(fn);
+    for ( index_t i=0; i < n; ++i )
+    {
+        const std::string fileName = fn + internal::toString<index_t>(i);
+        collection.addPart(fileName, ".vts");
+        if ( mesh ) 
+            collection.addPart(fileName + "_mesh", ".vtp");
     }
     collection.save();
 }
@@ -641,7 +635,7 @@ void gsWriteParaview(const gsField<T> & field,
 /// Export a Geometry without scalar information
 template<class T>
 void gsWriteParaview(const gsGeometry<T> & Geo, std::string const & fn, 
-                     unsigned npts, bool mesh, bool ctrlNet)
+                     unsigned npts, bool mesh, bool ctrlNet, vtkFormat::type fmt)
 {
     const bool curve = ( Geo.domainDim() == 1 );
 
@@ -649,26 +643,26 @@ void gsWriteParaview(const gsGeometry<T> & Geo, std::string const & fn,
 
     if ( curve )
     {
-        writeSingleCurve(Geo, fn, npts);
+        writeSingleCurve(Geo, fn, npts, fmt);
         collection.addPart(fn, ".vtp");
     }
     else
     {
-        writeSingleGeometry(Geo, fn, npts);
+        writeSingleGeometry(Geo, fn, npts, fmt);
         collection.addPart(fn, ".vts");
     }
 
     if ( mesh ) // Output the underlying mesh
     {
         const std::string fileName = fn + "_mesh";
-        writeSingleCompMesh(Geo.basis(), Geo, fileName, npts);
+        writeSingleCompMesh(Geo.basis(), Geo, fileName, npts, fmt);
         collection.addPart(fileName, ".vtp");
     }
 
     if ( ctrlNet ) // Output the control net
     {
         const std::string fileName = fn + "_cnet";
-        writeSingleControlNet(Geo, fileName);
+        writeSingleControlNet(Geo, fileName, fmt);
         collection.addPart(fileName, ".vtp");
     }
 
@@ -680,10 +674,10 @@ void gsWriteParaview(const gsGeometry<T> & Geo, std::string const & fn,
 template<class T>
 void gsWriteParaview(const gsGeometrySlice<T> & Geo, 
                      std::string const & fn, 
-                     unsigned npts)
+                     unsigned npts, vtkFormat::type fmt)
 {
     const gsMatrix<T> supp = Geo.parameterRange();
-    writeSingleGeometry(Geo, supp, fn, npts);
+    writeSingleGeometry(Geo, supp, fn, npts, fmt);
     // Write out a pvd file
     makeCollection(fn, ".vts"); // make also a pvd file
 }
@@ -692,47 +686,56 @@ void gsWriteParaview(const gsGeometrySlice<T> & Geo,
 /// Export a multipatch Geometry without scalar information
 template<class T>
 void gsWriteParaview( std::vector<gsGeometry<T> *> const & Geo, std::string const & fn, 
-                      unsigned npts, bool mesh, bool ctrlNet)
+                      unsigned npts, bool mesh, bool ctrlNet, vtkFormat::type fmt)
 {
-    const size_t n = Geo.size();
-
-    gsParaviewCollection collection(fn);
-
-    for ( size_t i=0; i<n ; i++)
+    const index_t n = Geo.size();
+
+    // Every thread samples and writes one patch at a time. An
+    // exception stops the remaining patches and is thrown again
+    // after the loop
+    bool failed = false;
+    std::string error;
+#   pragma omp parallel for schedule(dynamic, 1)
+    for ( index_t i=0; i<n ; i++)
     {
-        std::string fnBase = fn + internal::toString<index_t>(i);
-        
-        if ( Geo.at(i)->domainDim() == 1 )
-        {
-            writeSingleCurve(*Geo[i], fnBase, npts);
-            collection.addPart(fnBase, ".vtp");
-        }
-        else
+        if ( internal::vtkHasError(failed) ) continue;
+        try
         {
-            writeSingleGeometry( *Geo[i], fnBase, npts ) ;
-            collection.addPart(fnBase, ".vts");
-        }
+            const std::string fnBase = fn + internal::toString<index_t>(i);
         
-        if ( mesh ) 
-        {
-            const std::string fileName = fnBase + "_mesh";
-            writeSingleCompMesh(Geo[i]->basis(), *Geo[i], fileName);
-            collection.addPart(fileName, ".vtp");
-        }
+            if ( Geo[i]->domainDim() == 1 )
+                writeSingleCurve(*Geo[i], fnBase, npts, fmt);
+            else
+                writeSingleGeometry( *Geo[i], fnBase, npts, fmt ) ;
         
-        if ( ctrlNet ) // Output the control net
-        {
-            const std::string fileName = fnBase + "_cnet";
-            writeSingleControlNet(*Geo[i], fileName);
-            collection.addPart(fileName, ".vtp");
+            if ( mesh ) 
+                writeSingleCompMesh(Geo[i]->basis(), *Geo[i], fnBase + "_mesh", 8, fmt);
+        
+            if ( ctrlNet ) // Output the control net
+                writeSingleControlNet(*Geo[i], fnBase + "_cnet", fmt);
         }
+        catch (std::exception & e) { internal::vtkKeepError(e, failed, error); }
+    }
+    if ( failed )
+        throw std::runtime_error(error);
+
+    gsParaviewCollection collection(fn);
+    for ( index_t i=0; i<n ; i++)
+    {
+        const std::string fnBase = fn + internal::toString<index_t>(i);
+        collection.addPart(fnBase, Geo[i]->domainDim() == 1 ? ".vtp" : ".vts");
+        if ( mesh ) 
+            collection.addPart(fnBase + "_mesh", ".vtp");
+        if ( ctrlNet )
+            collection.addPart(fnBase + "_cnet", ".vtp");
     }
     collection.save();
 }
 
 /// Export i-th Basis function
 template<class T>
-void gsWriteParaview_basisFnct(int i, gsBasis<T> const& basis, std::string const & fn, unsigned npts)
+void gsWriteParaview_basisFnct(int i, gsBasis<T> const& basis, std::string const & fn, 
+                               unsigned npts, vtkFormat::type fmt)
 {
     // basis.support(i) --> returns a (tight) bounding box for the
     // supp. of i-th basis func.
@@ -772,39 +775,36 @@ void gsWriteParaview_basisFnct(int i, gsBasis<T> const& basis, std::string const
         eval_geo.bottomRows(3-n).setZero();
     }
 
+    // Lift the points to the graph of the function
+    gsMatrix<T> graph(3, eval_geo.cols());
+    graph.topRows(d) = pts.topRows(d);
+    graph.row(d)     = eval_geo.row(0);
+    graph.bottomRows(pts.rows() - d) = pts.bottomRows(pts.rows() - d);
+
     std::string mfn(fn);
     mfn.append(".vts");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
     if ( ! file.is_open() )
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk(fmt);
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    file <<"<VTKFile type=\"StructuredGrid\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<StructuredGrid WholeExtent=\"0 "<<np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     // Scalar information
     file <<"<PointData "<< "Scalars"<<"=\"SolutionField\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<<1<<"\">\n";
-    for ( index_t j=0; j<eval_geo.cols(); ++j)
-            file<< eval_geo(0,j) <<" ";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "Name=\"SolutionField\" NumberOfComponents=\"1\"",
+                     gsMatrix<T>(eval_geo.row(0)) );
     file <<"</PointData>\n";
     //
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<3<<"\">\n";
-    for ( index_t j=0; j<eval_geo.cols(); ++j)
-    {
-        for ( int l=0; l!=d; ++l)
-            file<< pts(l,j) <<" ";
-        file<< eval_geo(0,j) <<" ";
-         for ( index_t l=d; l!=pts.rows(); ++l)
-             file<< pts(l,j) <<" ";
-    }
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "NumberOfComponents=\"3\"", graph);
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
     file.close();
 }
@@ -812,7 +812,8 @@ void gsWriteParaview_basisFnct(int i, gsBasis<T> const& basis, std::string const
 
 /// Export a function
 template<class T>
-void gsWriteParaview(gsFunction<T> const& func, gsMatrix<T> const& supp, std::string const & fn, unsigned npts)
+void gsWriteParaview(gsFunction<T> const& func, gsMatrix<T> const& supp, std::string const & fn, 
+                     unsigned npts, vtkFormat::type fmt)
 {
     int d = func.domainDim(); // tested for d==2
     //int n= d+1;
@@ -831,39 +832,37 @@ void gsWriteParaview(gsFunction<T> const& func, gsMatrix<T> const& supp, std::st
         np.bottomRows(3-d).setOnes();
     }
 
+    // Graph of the function over the first (at most two) coordinates
+    const int dd = math::min(d, 2);
+    gsMatrix<T> graph(3, ev.cols());
+    graph.setZero();
+    graph.topRows(dd) = pts.topRows(dd);
+    graph.row(dd)     = ev.row(0);
+
     std::string mfn(fn);
     mfn.append(".vts");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
     if ( ! file.is_open() )
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk(fmt);
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    file <<"<VTKFile type=\"StructuredGrid\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<StructuredGrid WholeExtent=\"0 "<<np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     // Scalar information
     file <<"<PointData "<< "Scalars"<<"=\"SolutionField\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<<1<<"\">\n";
-    for ( index_t j=0; j<ev.cols(); ++j)
-            file<< ev(0,j) <<" ";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "Name=\"SolutionField\" NumberOfComponents=\"1\"",
+                     gsMatrix<T>(ev.row(0)) );
     file <<"</PointData>\n";
     //
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<3<<"\">\n";
-    for ( index_t j=0; j<ev.cols(); ++j)
-    {
-        for ( int i=0; i< d; ++i)
-            file<< pts(i,j) <<" ";
-        file<< ev(0,j) <<" ";
-//         for ( index_t i=d; i< pts.rows(); ++i)
-//             file<< pts(i,j) <<" ";
-    }
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "NumberOfComponents=\"3\"", graph);
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
     file.close();
 }
@@ -872,7 +871,7 @@ void gsWriteParaview(gsFunction<T> const& func, gsMatrix<T> const& supp, std::st
 /// Export Basis functions
 template<class T>
 void gsWriteParaview(gsBasis<T> const& basis, std::string const & fn, 
-                     unsigned npts, bool mesh)
+                     unsigned npts, bool mesh, vtkFormat::type fmt)
 {
     const index_t n = basis.size();
     gsParaviewCollection collection(fn);
@@ -880,14 +879,14 @@ void gsWriteParaview(gsBasis<T> const& basis, std::string const & fn,
     for ( index_t i=0; i< n; i++)
     {
         std::string fileName = fn + internal::toString<index_t>(i);
-        gsWriteParaview_basisFnct<T>(i, basis, fileName, npts ) ;
+        gsWriteParaview_basisFnct<T>(i, basis, fileName, npts, fmt ) ;
         collection.addPart(fileName, ".vts");
     }
 
     if ( mesh )
     {
         std::string fileName = fn + "_mesh";
-        writeSingleBasisMesh(basis, fileName);
+        writeSingleBasisMesh(basis, fileName, fmt);
         //collection.addPart(fileName, ".vtp");
         collection.addPart(fileName, ".vtu");
     }
@@ -898,72 +897,18 @@ void gsWriteParaview(gsBasis<T> const& basis, std::string const & fn,
 
 /// Export Point set to Paraview
 template<class T>
-void gsWriteParaviewPoints(gsMatrix<T> const& X, gsMatrix<T> const& Y, std::string const & fn)
+void gsWriteParaviewPoints(gsMatrix<T> const& X, gsMatrix<T> const& Y, std::string const & fn,
+                           vtkFormat::type fmt)
 {
-    assert( X.cols() == Y.cols() );
-    assert( X.rows() == 1 && Y.rows() == 1 );
-    index_t np = X.cols();
-
-    std::string mfn(fn);
-    mfn.append(".vtp");
-    std::ofstream file(mfn.c_str());
-    if ( ! file.is_open() )
-        std::cout<<"Problem opening "<<fn<<std::endl;
-    file << std::fixed; // no exponents
-    file << std::setprecision (PLOT_PRECISION);
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
-    file <<"<PolyData>\n";
-    file <<"<Piece NumberOfPoints=\""<<np<<"\" NumberOfVerts=\"1\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
-    file <<"<PointData>\n";
-    file <<"</PointData>\n";
-    file <<"<CellData>\n";
-    file <<"</CellData>\n";
-    file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" Name=\"Points\" NumberOfComponents=\"3\" format=\"ascii\" RangeMin=\""<<X.minCoeff()<<"\" RangeMax=\""<<X.maxCoeff()<<"\">\n";
-    for (index_t i=0; i< np; ++i )
-        file << X(0,i) <<" "<<Y(0,i)<<" "<< 0.0 <<"\n";
-    file <<"\n</DataArray>\n";
-    file <<"</Points>\n";
-    file <<"<Verts>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\""<<0<<"\" RangeMax=\""<<np-1<<"\">\n";
-    for (index_t i=0; i< np; ++i )
-        file << i<<" ";
-    file <<"\n</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n"<<np<<"\n";
-    file <<"</DataArray>\n";
-    file <<"</Verts>\n";
-    file <<"<Lines>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Lines>\n";
-    file <<"<Strips>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Strips>\n";
-    file <<"<Polys>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Polys>\n";
-    file <<"</Piece>\n";
-    file <<"</PolyData>\n";
-    file <<"</VTKFile>\n";
-    file.close();
-
-    makeCollection(fn, ".vtp"); // make also a pvd file
+    gsWriteParaviewPoints<T>(X, Y, gsMatrix<T>::Zero(1, X.cols()), fn, fmt);
 }
 
 template<class T>
 void gsWriteParaviewPoints(gsMatrix<T> const& X,
                            gsMatrix<T> const& Y,
                            gsMatrix<T> const& Z,
-                           std::string const & fn)
+                           std::string const & fn,
+                           vtkFormat::type fmt)
 {
     GISMO_ASSERT(X.cols() == Y.cols() && X.cols() == Z.cols(),
                  "X, Y and Z must have the same size of columns!");
@@ -973,7 +918,7 @@ void gsWriteParaviewPoints(gsMatrix<T> const& X,
 
     std::string mfn(fn);
     mfn.append(".vtp");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
 
     if (!file.is_open())
     {
@@ -983,9 +928,18 @@ void gsWriteParaviewPoints(gsMatrix<T> const& X,
 
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk(fmt);
+
+    gsMatrix<T> pts(3, np);
+    pts.row(0) = X;
+    pts.row(1) = Y;
+    pts.row(2) = Z;
+
+    const std::vector<int> none;
+    const std::string range = " RangeMin=\"0\" RangeMax=\"" + internal::toString(np-1) + "\"";
 
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    file <<"<VTKFile type=\"PolyData\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<PolyData>\n";
     file <<"<Piece NumberOfPoints=\""<<np<<"\" NumberOfVerts=\"1\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
     file <<"<PointData>\n";
@@ -993,47 +947,29 @@ void gsWriteParaviewPoints(gsMatrix<T> const& X,
     file <<"<CellData>\n";
     file <<"</CellData>\n";
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" Name=\"Points\" NumberOfComponents=\"3\" format=\"ascii\" RangeMin=\""<<X.minCoeff()<<"\" RangeMax=\""<<X.maxCoeff()<<"\">\n";
-
-    for (index_t i = 0; i < np; ++i)
-    {
-        file << X(0, i) << " " << Y(0, i) << " " << Z(0, i) << "\n";
-    }
-
-    file <<"\n</DataArray>\n";
+    vtk.write<float>(file, "Name=\"Points\" NumberOfComponents=\"3\" RangeMin=\""
+                     + internal::toString(X.minCoeff()) + "\" RangeMax=\""
+                     + internal::toString(X.maxCoeff()) + "\"", pts);
     file <<"</Points>\n";
     file <<"<Verts>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\""<<0<<"\" RangeMax=\""<<np-1<<"\">\n";
-
-    for (index_t i=0; i< np; ++i )
-    {
-        file << i << " ";
-    }
-
-    file <<"\n</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n"<<np<<"\n";
-    file <<"</DataArray>\n";
+    vtk.write<int>(file, "Name=\"connectivity\"" + range, internal::vtkSequence(np, 0, 1) );
+    vtk.write<int>(file, "Name=\"offsets\"", internal::vtkSequence(1, np, 0) );
     file <<"</Verts>\n";
     file <<"<Lines>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
+    vtk.write<int>(file, "Name=\"connectivity\"", none);
+    vtk.write<int>(file, "Name=\"offsets\"", none);
     file <<"</Lines>\n";
     file <<"<Strips>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
+    vtk.write<int>(file, "Name=\"connectivity\"", none);
+    vtk.write<int>(file, "Name=\"offsets\"", none);
     file <<"</Strips>\n";
     file <<"<Polys>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
+    vtk.write<int>(file, "Name=\"connectivity\"", none);
+    vtk.write<int>(file, "Name=\"offsets\"", none);
     file <<"</Polys>\n";
     file <<"</Piece>\n";
     file <<"</PolyData>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
     file.close();
 
@@ -1041,19 +977,20 @@ void gsWriteParaviewPoints(gsMatrix<T> const& X,
 }
 
 template<class T>
-void gsWriteParaviewPoints(gsMatrix<T> const& points, std::string const & fn)
+void gsWriteParaviewPoints(gsMatrix<T> const& points, std::string const & fn,
+                           vtkFormat::type fmt)
 {
     const index_t rows = points.rows();
     switch (rows)
     {
     case 1:
-        gsWriteParaviewPoints<T>(points.row(0), gsMatrix<T>::Zero(1, points.cols()), fn);
+        gsWriteParaviewPoints<T>(points.row(0), gsMatrix<T>::Zero(1, points.cols()), fn, fmt);
         break;
     case 2:
-        gsWriteParaviewPoints<T>(points.row(0), points.row(1), fn);        
+        gsWriteParaviewPoints<T>(points.row(0), points.row(1), fn, fmt);        
         break;
     case 3:
-        gsWriteParaviewPoints<T>(points.row(0), points.row(1), points.row(2), fn);
+        gsWriteParaviewPoints<T>(points.row(0), points.row(1), points.row(2), fn, fmt);
         break;
     default:
         GISMO_ERROR("Point plotting is implemented just for 2D and 3D (rows== 1, 2 or 3).");
@@ -1082,13 +1019,14 @@ void gsWriteParaview(gsSolid<T> const& sl, std::string const & fn, unsigned numP
 
     std::string mfn(fn);
     mfn.append(".vtp");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
     if ( ! file.is_open() )
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk;
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    file <<"<VTKFile type=\"PolyData\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<PolyData>\n";
 
 
@@ -1140,52 +1078,38 @@ void gsWriteParaview(gsSolid<T> const& sl, std::string const & fn, unsigned numP
                     <<"\" NumberOfStrips=\"0\" NumberOfPolys=\""<< numOfPoints-1 << "\">\n";
 
                 /// Coordinates of vertices
-                file <<"<Points>\n";
-                file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-                // translate the volume towards the *translate* vector
+                // translate the volume towards the *translate* vector, and
+                // the second vertex about along the vector (faceThick,0,0)
+                gsMatrix<T> pts(3, 2*curvePoints.cols());
                 for (index_t iCol = 0;iCol!=curvePoints.cols();iCol++)
                 {
-                    file << curvePoints(0,iCol) + translate(0) << " " << curvePoints(1,iCol) + translate(1) << " " << curvePoints(2,iCol) + translate(2) << " \n";
-                    // translate the vertex about along the vector (faceThick,0,0)
-                    file << curvePoints(0,iCol) + faceThick + translate(0) << " " << curvePoints(1,iCol) + faceThick + translate(1)
-                         << " " << curvePoints(2,iCol) +faceThick + translate(2) << " \n";
-                };
-                file << "\n";
-                file <<"</DataArray>\n";
+                    pts.col(2*iCol  ) = curvePoints.col(iCol) + translate;
+                    pts.col(2*iCol+1) = ( pts.col(2*iCol).array() + faceThick ).matrix();
+                }
+                file <<"<Points>\n";
+                vtk.write<float>(file, "NumberOfComponents=\"3\"", pts);
                 file <<"</Points>\n";
 
                 /// Scalar field attached to each degenerate face on the "edge"
                 file << "<CellData Scalars=\"cell_scalars\">\n";
-                file << "<DataArray type=\"Int32\" Name=\"cell_scalars\" format=\"ascii\">\n";
                 /// limit: for now, assign all scalars to 0
-                for (index_t iCol = 0;iCol!=curvePoints.cols()-1;iCol++)
-                {
-                    file << color << " ";
-                }
-                file << "\n";
-                file << "</DataArray>\n";
+                vtk.write<int>(file, "Name=\"cell_scalars\"",
+                               internal::vtkSequence(curvePoints.cols()-1, color, 0) );
                 file << "</CellData>\n";
 
                 /// Which vertices belong to which faces
-                file << "<Polys>\n";
-                file << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
+                std::vector<int> conn;
                 for (index_t iCol = 0;iCol<=curvePoints.cols()-2;iCol++)
                 {
-                    //file << iCol << " " << iCol+1 << " "<< iCol+1 << " " << iCol << " ";
-                    file << 2*iCol << " " << 2*iCol+1 << " "<< 2*iCol+3 << " " << 2*iCol+2 << " ";
-                }
-                //file << curvePoints.cols()-1 << " " << 0 << " "<< 0 << " "<< curvePoints.cols()-1 << " ";
-                file << "\n";
-                file << "</DataArray>\n";
-                file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-                unsigned offsets(0);
-                for (index_t iCol = 0;iCol!=curvePoints.cols()-1;iCol++)
-                {
-                    offsets +=4;
-                    file << offsets << " ";
+                    conn.push_back(2*iCol  );
+                    conn.push_back(2*iCol+1);
+                    conn.push_back(2*iCol+3);
+                    conn.push_back(2*iCol+2);
                 }
-                file << "\n";
-                file << "</DataArray>\n";
+                file << "<Polys>\n";
+                vtk.write<int>(file, "Name=\"connectivity\"", conn);
+                vtk.write<int>(file, "Name=\"offsets\"",
+                               internal::vtkSequence(curvePoints.cols()-1, 4, 4) );
                 file << "</Polys>\n";
 
                 file << "</Piece>\n";
@@ -1199,6 +1123,7 @@ void gsWriteParaview(gsSolid<T> const& sl, std::string const & fn, unsigned numP
 
     ///////////////////////////////
     file <<"</PolyData>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
     file.close();
 
@@ -1230,111 +1155,55 @@ void gsWriteParaviewSolid(gsSolid<T> const& sl,
 
 /// Visualizing a mesh
 template <class T>
-void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd)
+void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd,
+                     vtkFormat::type fmt)
+{
+    gsWriteParaview(gsIndexedMesh<T>(sl), fn, pvd, fmt);
+}
+
+/// Visualizing an indexed mesh
+template <class T>
+void gsWriteParaview(gsIndexedMesh<T> const& sl, std::string const & fn, bool pvd,
+                     vtkFormat::type fmt)
 {
     std::string mfn(fn);
     mfn.append(".vtp");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), std::ios::out | std::ios::binary);
     if ( ! file.is_open() )
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk(fmt);
     
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    file <<"<VTKFile type=\"PolyData\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file <<"<PolyData>\n";
     
     /// Number of vertices and number of faces
-    file <<"<Piece NumberOfPoints=\""<< sl.numVertices <<"\" NumberOfVerts=\"0\" NumberOfLines=\""
-         << sl.numEdges<<"\" NumberOfStrips=\"0\" NumberOfPolys=\""<< sl.numFaces << "\">\n";
+    file <<"<Piece NumberOfPoints=\""<< sl.numVertices() <<"\" NumberOfVerts=\"0\" NumberOfLines=\""
+         << sl.numEdges()<<"\" NumberOfStrips=\"0\" NumberOfPolys=\""<< sl.numFaces() << "\">\n";
     
     /// Coordinates of vertices
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); ++it)
-    {
-        file << ((*it)->coords)[0] << " ";
-        file << ((*it)->coords)[1] << " ";
-        file << ((*it)->coords)[2] << " \n";
-    }
-    
-    file << "\n";
-    file <<"</DataArray>\n";
+    vtk.write<float>(file, "NumberOfComponents=\"3\"", sl.coordinates() );
     file <<"</Points>\n";
 
-    // Scalar field attached to each face
-    // file << "<PointData Scalars=\"point_scalars\">\n";
-    // file << "<DataArray type=\"Int32\" Name=\"point_scalars\" format=\"ascii\">\n";
-    // for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); 
-    //      it!=sl.vertex.end(); ++it)
-    // {
-    //     file << 0 << " ";
-    // }
-    // file << "\n";
-    // file << "</DataArray>\n";
-    // file << "</PointData>\n";
-    
     // Write out edges
     file << "<Lines>\n";
-    file << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
-    for (typename std::vector< gsEdge<T> >::const_iterator it=sl.edge.begin();
-         it!=sl.edge.end(); ++it)
-    {
-            file << it->source->getId() << " " << it->target->getId() << "\n";
-    }
-    file << "</DataArray>\n";
-    file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-    int count=0;
-    for (typename std::vector< gsEdge<T> >::const_iterator it=sl.edge.begin();
-         it!=sl.edge.end(); ++it)
-    {
-        count+=2;
-        file << count << " ";
-    }
-    file << "\n";
-    file << "</DataArray>\n";
+    vtk.write<int>(file, "Name=\"connectivity\"", sl.edges());
+    vtk.write<int>(file, "Name=\"offsets\"", internal::vtkSequence(sl.numEdges(), 2, 2) );
     file << "</Lines>\n";
     
-    // Scalar field attached to each face (* if edges exists, this has a problem)
-    // file << "<CellData Scalars=\"cell_scalars\">\n";
-    // file << "<DataArray type=\"Int32\" Name=\"cell_scalars\" format=\"ascii\">\n";
-    // for (typename std::vector< gsFace<T>* >::const_iterator it=sl.face.begin();
-    //      it!=sl.face.end(); ++it)
-    // {
-    //     file << 1 << " ";
-    // }
-    // file << "\n";
-    // file << "</DataArray>\n";
-    // file << "</CellData>\n";
-    
     /// Which vertices belong to which faces
+    const std::vector<index_t> & offsets = sl.faceOffsets();
     file << "<Polys>\n";
-    file << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
-    for (typename std::vector< gsFace<T>* >::const_iterator it=sl.face.begin();
-         it!=sl.face.end(); ++it)
-    {
-        for (typename std::vector< gsVertex<T>* >::const_iterator vit= (*it)->vertices.begin();
-             vit!=(*it)->vertices.end(); ++vit)
-        {
-            file << (*vit)->getId() << " ";
-        }
-        file << "\n";
-    }
-    file << "</DataArray>\n";
-    file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-    count=0;
-    for (typename std::vector< gsFace<T>* >::const_iterator it=sl.face.begin();
-         it!=sl.face.end(); ++it)
-    {
-        count += (*it)->vertices.size();
-        file << count << " ";
-    }
-    file << "\n";
-    file << "</DataArray>\n";
+    vtk.write<int>(file, "Name=\"connectivity\"", sl.faceIndices());
+    vtk.write<int>(file, "Name=\"offsets\"", &offsets[0] + 1, offsets.size() - 1);
     file << "</Polys>\n";
 
     file << "</Piece>\n";
     file <<"</PolyData>\n";
+    vtk.writeAppended(file);
     file <<"</VTKFile>\n";
     file.close();
     
@@ -1459,7 +1328,7 @@ void gsWriteParaviewTrimmedCurve(const gsTrimSurface<T>& surf,
     std::string myFile(fn);
     myFile.append(".vts");
 
-    std::ofstream file(myFile.c_str());
+    std::ofstream file(myFile.c_str(), std::ios::out | std::ios::binary);
     if (!file.is_open())
     {
         gsWarn << "Problem opening " << fn << " Aborting..." << std::endl;
@@ -1468,9 +1337,10 @@ void gsWriteParaviewTrimmedCurve(const gsTrimSurface<T>& surf,
 
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
+    internal::gsVtkDataWriter vtk;
 
     file << "<?xml version=\"1.0\"?>\n";
-    file << "<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    file << "<VTKFile type=\"StructuredGrid\" version=\"1.0\""<< vtk.fileAttributes() <<">\n";
     file << "<StructuredGrid WholeExtent=\"0 "<< np(0) - 1 <<
             " 0 " << np(1) - 1 << " 0 " << np(2) - 1 << "\">\n";
 
@@ -1478,22 +1348,12 @@ void gsWriteParaviewTrimmedCurve(const gsTrimSurface<T>& surf,
          << np(2) - 1 << "\">\n";
 
     file << "<Points>\n";
-    file << "<DataArray type=\"Float32\" NumberOfComponents=\"" << points.rows()
-         << "\">\n";
-
-    for (index_t j = 0; j < points.cols(); ++j)
-    {
-        for (index_t i = 0; i < points.rows(); ++i)
-        {
-            file << points(i, j) << " ";
-        }
-        file << "\n";
-    }
-
-    file << "</DataArray>\n";
+    vtk.write<float>(file, "NumberOfComponents=\"" + internal::toString(points.rows()) + "\"",
+                     points);
     file << "</Points>\n";
     file << "</Piece>\n";
     file << "</StructuredGrid>\n";
+    vtk.writeAppended(file);
     file << "</VTKFile>\n";
     file.close();
 
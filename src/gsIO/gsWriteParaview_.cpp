@@ -12,38 +12,43 @@ namespace gismo
   
 TEMPLATE_INST
 void gsWriteParaview(const gsField<T> & field, std::string const & fn, 
-                     unsigned npts, bool mesh);
+                     unsigned npts, bool mesh, vtkFormat::type fmt);
 
 TEMPLATE_INST
 void gsWriteParaview(const gsGeometry<T> & Geo, std::string const & fn, 
-                     unsigned npts, bool mesh, bool ctrlNet);
+                     unsigned npts, bool mesh, bool ctrlNet, vtkFormat::type fmt);
 
 TEMPLATE_INST
 void gsWriteParaview( std::vector<gsGeometry<T> *> const & Geo, std::string const & fn, 
-                      unsigned npts, bool mesh, bool ctrlNet);
+                      unsigned npts, bool mesh, bool ctrlNet, vtkFormat::type fmt);
 
 TEMPLATE_INST
 void gsWriteParaview_basisFnct(int i, gsBasis<T> const& basis, std::string const & fn, 
-                               unsigned npts );
+                               unsigned npts, vtkFormat::type fmt );
 
 TEMPLATE_INST
-void gsWriteParaview(gsGeometrySlice<T> const& Geo, std::string const & fn, unsigned npts );
+void gsWriteParaview(gsGeometrySlice<T> const& Geo, std::string const & fn, unsigned npts,
+                     vtkFormat::type fmt );
 
 TEMPLATE_INST
-void gsWriteParaview(gsFunction<T> const& func, gsMatrix<T> const& supp, std::string const & fn, unsigned npts );
+void gsWriteParaview(gsFunction<T> const& func, gsMatrix<T> const& supp, std::string const & fn, unsigned npts,
+                     vtkFormat::type fmt );
 
 TEMPLATE_INST
 void gsWriteParaview(gsBasis<T> const& basis, std::string const & fn, 
-                     unsigned npts, bool mesh);
+                     unsigned npts, bool mesh, vtkFormat::type fmt);
 
 TEMPLATE_INST
-void gsWriteParaviewPoints(gsMatrix<T> const& X, gsMatrix<T> const& Y, std::string const & fn);
+void gsWriteParaviewPoints(gsMatrix<T> const& X, gsMatrix<T> const& Y, std::string const & fn,
+                           vtkFormat::type fmt);
 
 TEMPLATE_INST
-void gsWriteParaviewPoints(gsMatrix<T> const& X, gsMatrix<T> const& Y, gsMatrix<T> const& z, std::string const & fn);
+void gsWriteParaviewPoints(gsMatrix<T> const& X, gsMatrix<T> const& Y, gsMatrix<T> const& z, std::string const & fn,
+                           vtkFormat::type fmt);
 
 TEMPLATE_INST
-void gsWriteParaviewPoints(gsMatrix<T> const& points, std::string const & fn);
+void gsWriteParaviewPoints(gsMatrix<T> const& points, std::string const & fn,
+                           vtkFormat::type fmt);
 
 TEMPLATE_INST
 void gsWriteParaview(gsSolid<T> const& sl, std::string const & fn, unsigned numPoints_for_eachCurve, int vol_Num,
@@ -56,7 +61,12 @@ void gsWriteParaviewSolid(gsSolid<T> const  & sl,
                      unsigned numSamples );
 
 TEMPLATE_INST
-void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd);
+void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd,
+                     vtkFormat::type fmt);
+
+TEMPLATE_INST
+void gsWriteParaview(gsIndexedMesh<T> const& sl, std::string const & fn, bool pvd,
+                     vtkFormat::type fmt);
 
 TEMPLATE_INST
 void gsWriteParaview(const std::vector<gsMesh<T> >& sl, std::string const & fn);
@@ -88,7 +98,8 @@ TEMPLATE_INST
 void writeSinglePatchField(const gsFunction<T> & geometry,
                            const gsFunction<T> & parField,
                            const bool isParam,
-                           std::string const & fn, unsigned npts);
+                           std::string const & fn, unsigned npts,
+                           vtkFormat::type fmt);
 
 
 } // namespace gismo
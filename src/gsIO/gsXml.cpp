@@ -13,6 +13,8 @@
 
 #include <fstream>
 #include <iomanip>      // std::setprecision
+#include <algorithm>
+#include <cstring>
 
 #include <gsCore/gsLinearAlgebra.h>
 #include <gsCore/gsBoxTopology.h>
@@ -24,6 +26,19 @@
 
 namespace gismo {
 
+// Whether coefficients and knot vectors are written as binary data
+static bool s_xmlBinary = false;
+
+void gsXmlSetBinary(bool binary)
+{
+    s_xmlBinary = binary;
+}
+
+bool gsXmlBinary()
+{
+    return s_xmlBinary;
+}
+
 namespace internal {
 
 
@@ -73,11 +88,279 @@ gsXmlNode * makeComment(const std::string & comment, gsXmlTree & data)
     
 std::string to_string(const unsigned & i)
 {
-    char tmp[4];
+    char tmp[16];
     sprintf (tmp,"%d",i);
     return tmp;
 }
 
+/* Parsing and formatting of numbers */
+
+// Powers of ten which are exact in double precision
+static const double s_pow10[] =
+{ 1e0 , 1e1 , 1e2 , 1e3 , 1e4 , 1e5 , 1e6 , 1e7 , 1e8 , 1e9 , 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static inline bool isSpace(const char c)
+{ return ' ' == c || '\n' == c || '\t' == c || '\r' == c || '\v' == c || '\f' == c; }
+
+static inline bool isDigit(const char c)
+{ return c >= '0' && c <= '9'; }
+
+// Reads the decimal number [first,last) if it has at most 19
+// significant digits and the result is exact, i.e. the digits fit
+// in the mantissa and the power of ten is exact. Then the one
+// rounding of the division or multiplication gives the correctly
+// rounded value. Otherwise returns false.
+static bool fastReal(const char * p, const char * last, double & val)
+{
+    const bool neg = ('-' == *p);
+    if ( neg || '+' == *p ) ++p;
+
+    unsigned long long m = 0;
+    int nd = 0, e10 = 0;
+    const char * first = p;
+    for (; p != last && isDigit(*p); ++p)
+        if ( 0 != ( m = 10 * m + (*p - '0') ) ) ++nd;
+    bool any = (p != first);
+
+    if ( p != last && '.' == *p )
+    {
+        first = ++p;
+        for (; p != last && isDigit(*p); ++p)
+            if ( 0 != ( m = 10 * m + (*p - '0') ) ) ++nd;
+        e10 -= static_cast<int>(p - first);
+        any = any || (p != first);
+    }
+    if ( !any || nd > 19 )
+        return false;
+
+    if ( p != last && ( 'e' == *p || 'E' == *p ) )
+    {
+        ++p;
+        const bool eneg = ('-' == *p);
+        if ( eneg || '+' == *p ) ++p;
+        int x = 0;
+        first = p;
+        for (; p != last && isDigit(*p) && x < 10000; ++p)
+            x = 10 * x + (*p - '0');
+        if ( p == first )
+            return false;
+        e10 += eneg ? -x : x;
+    }
+
+    if ( p != last || m > (1ULL << 53) || e10 < -22 || e10 > 22 )
+        return false;
+
+    const double v = static_cast<double>(m);
+    val = ( e10 < 0 ? v / s_pow10[-e10] : v * s_pow10[e10] );
+    if ( neg ) val = -val;
+    return true;
+}
+
+// Reads the number [first,last)
+static double readReal(const char * first, const char * last)
+{
+    double val;
+    if ( fastReal(first, last, val) )
+        return val;
+    return strtod(std::string(first, last).c_str(), NULL);
+}
+
+bool parseValue(const char * & str, double & val)
+{
+    while ( isSpace(*str) ) ++str;
+    if ( '\0' == *str )
+        return false;
+
+    const char * first = str, * slh = NULL;
+    for (; '\0' != *str && !isSpace(*str); ++str)
+        if ( '/' == *str ) slh = str;
+
+    // integer, decimal or fraction
+    val = ( NULL == slh ? readReal(first, str) :
+            readReal(first, slh) / readReal(slh + 1, str) );
+    return true;
+}
+
+bool parseValue(const char * & str, float & val)
+{
+    double tmp;
+    if ( !parseValue(str, tmp) )
+        return false;
+    val = static_cast<float>(tmp);
+    return true;
+}
+
+// Reads an integer like the stream extraction operator does
+template<class Z>
+static bool parseInt(const char * & str, Z & val)
+{
+    while ( isSpace(*str) ) ++str;
+    const bool neg = ('-' == *str);
+    if ( neg || '+' == *str ) ++str;
+    if ( !isDigit(*str) )
+        return false;
+
+    Z v = 0;
+    for (; isDigit(*str); ++str)
+        v = 10 * v + static_cast<Z>(*str - '0');
+    val = ( neg ? static_cast<Z>(0 - v) : v );
+    return true;
+}
+
+bool parseValue(const char * & str, int & val)
+{ return parseInt(str, val); }
+
+bool parseValue(const char * & str, long & val)
+{ return parseInt(str, val); }
+
+bool parseValue(const char * & str, unsigned & val)
+{ return parseInt(str, val); }
+
+// Appends the decimal digits of v
+static void formatUInt(std::string & str, unsigned long long v)
+{
+    char buf[24];
+    char * p = buf + sizeof(buf);
+    do { *--p = static_cast<char>('0' + v % 10); } while ( (v /= 10) != 0 );
+    str.append(p, buf + sizeof(buf));
+}
+
+void formatValue(std::string & str, double val, int prec)
+{
+    // Integral values are written as integers, which is what %g does
+    // when the digits fit in the precision (and not for -0)
+    const double a = math::abs(val);
+    if ( a == std::floor(a) && a < s_pow10[ math::min(prec, 15) ] &&
+         ( 0 != val || 1 / val > 0 ) )
+    {
+        if ( val < 0 ) str += '-';
+        formatUInt(str, static_cast<unsigned long long>(a));
+        return;
+    }
+
+    char buf[40];
+    const int n = snprintf(buf, sizeof(buf), "%.*g", prec, val);
+    str.append(buf, n);
+}
+
+void formatValue(std::string & str, float val, int prec)
+{ formatValue(str, static_cast<double>(val), prec); }
+
+void formatValue(std::string & str, long val, int)
+{
+    if ( val < 0 ) str += '-';
+    formatUInt(str, val < 0 ? 0ULL - static_cast<unsigned long long>(val)
+                            : static_cast<unsigned long long>(val) );
+}
+
+void formatValue(std::string & str, int val, int prec)
+{ formatValue(str, static_cast<long>(val), prec); }
+
+void formatValue(std::string & str, unsigned val, int)
+{ formatUInt(str, val); }
+
+/* Base64-encoded binary data */
+
+static const char s_base64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Returns true if the bytes of the numbers have to be reversed to
+// be little-endian
+static bool bigEndian()
+{
+    const unsigned one = 1;
+    return 1 != *reinterpret_cast<const char*>(&one);
+}
+
+std::string encodeBase64(const double * data, size_t n)
+{
+    const size_t nb = 8 * n;
+    const unsigned char * b = reinterpret_cast<const unsigned char*>(data);
+    std::vector<unsigned char> tmp;
+    if ( bigEndian() )
+    {
+        tmp.assign(b, b + nb);
+        for ( size_t i = 0; i < nb; i += 8 )
+            std::reverse(tmp.begin() + i, tmp.begin() + i + 8);
+        b = tmp.empty() ? NULL : &tmp[0];
+    }
+
+    std::string res;
+    res.reserve( 4 * ((nb + 2) / 3) );
+    size_t i = 0;
+    for (; i + 3 <= nb; i += 3)
+    {
+        const unsigned v = (b[i] << 16) | (b[i+1] << 8) | b[i+2];
+        res += s_base64[ v >> 18      ];
+        res += s_base64[(v >> 12) & 63];
+        res += s_base64[(v >>  6) & 63];
+        res += s_base64[ v        & 63];
+    }
+    if ( i != nb ) // one or two bytes left
+    {
+        const unsigned v = (b[i] << 16) | ( i + 1 != nb ? b[i+1] << 8 : 0 );
+        res += s_base64[ v >> 18      ];
+        res += s_base64[(v >> 12) & 63];
+        res += ( i + 1 != nb ? s_base64[(v >> 6) & 63] : '=' );
+        res += '=';
+    }
+    return res;
+}
+
+// Value of the base64 digit c, or -1
+static int base64Digit(const char c)
+{
+    if ( c >= 'A' && c <= 'Z' ) return c - 'A';
+    if ( c >= 'a' && c <= 'z' ) return c - 'a' + 26;
+    if ( c >= '0' && c <= '9' ) return c - '0' + 52;
+    if ( '+' == c ) return 62;
+    if ( '/' == c ) return 63;
+    return -1;
+}
+
+bool decodeBase64(const char * str, std::vector<double> & result)
+{
+    std::vector<unsigned char> bytes;
+    bytes.reserve( 3 * strlen(str) / 4 );
+    unsigned v = 0;
+    int nbits = 0;
+    for (; '\0' != *str && '=' != *str; ++str)
+    {
+        if ( isSpace(*str) ) continue;
+        const int d = base64Digit(*str);
+        if ( d < 0 )
+            return false;
+        v = (v << 6) | d;
+        if ( (nbits += 6) >= 8 )
+        {
+            nbits -= 8;
+            bytes.push_back( static_cast<unsigned char>( (v >> nbits) & 255 ) );
+        }
+    }
+    if ( 0 != bytes.size() % 8 )
+        return false;
+
+    if ( bigEndian() )
+        for ( size_t i = 0; i < bytes.size(); i += 8 )
+            std::reverse(bytes.begin() + i, bytes.begin() + i + 8);
+    result.resize( bytes.size() / 8 );
+    if ( !bytes.empty() )
+        memcpy(&result[0], &bytes[0], bytes.size());
+    return true;
+}
+
+bool isBase64(const gsXmlNode * node)
+{
+    const gsXmlAttribute * at = node->first_attribute("encoding");
+    return at && !strcmp(at->value(), "base64");
+}
+
+void setBase64(gsXmlNode * node, gsXmlTree & data)
+{
+    node->append_attribute( makeAttribute("encoding", "base64", data) );
+}
+
 int countByTag(const std::string & tag, 
                       gsXmlNode * root )
 {
@@ -126,7 +409,9 @@ gsXmlNode *  firstByTag(const std::string & tag,
     }
     else
     {
-        return root->first_node( tag.c_str() );
+        gsXmlNode * node = root->first_node( tag.c_str() );
+        loadNode(node);
+        return node;
     }
 }
 
@@ -140,14 +425,17 @@ gsXmlNode *  firstByTagType(const std::string & tag,
         return NULL;
     }
     if ( type == "" )
-        return root->first_node( tag.c_str() );
+        return firstByTag(tag, root);
     else
     {
         for (gsXmlNode * child = root->first_node( tag.c_str() ) ; 
              child;   child = child->next_sibling( tag.c_str() ) )
             if ( !strcmp( child->first_attribute("type")->value(), 
                           type.c_str() ) )
+            {
+                loadNode(child);
                 return child;
+            }
         return NULL;
     }   
 }
@@ -164,6 +452,7 @@ gsXmlNode *  anyByTag(const std::string & tag,
     for (gsXmlNode * child = root->first_node() ; 
          child; child = child->next_sibling() )
     {
+        loadNode(child);
         if (!strcmp( child->name(), tag.c_str() ) ) 
             return child;
         // Level 2
@@ -25,6 +25,10 @@
 //#include <rapidxml/rapidxml_utils.hpp>     // External file
 //#include <rapidxml/rapidxml_iterators.hpp> // External file
 
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
 
 /*
 // Forward declare rapidxml structures
@@ -178,11 +182,35 @@ typename enable_if<!std::numeric_limits<T>::is_integer, bool>::type
 gsGetValue(std::istream & is, T & var)
 { return gsGetReal<T>(is,var); }
 
+/// \brief Sets whether the coefficients of geometries and the knot
+/// vectors are written to XML files as base64-encoded binary data
+/// (the default is text). The setting applies to the objects which
+/// are added to a gsFileData afterwards; binary data is recognized
+/// when reading in any case.
+///
+/// \ingroup IO
+GISMO_EXPORT void gsXmlSetBinary(bool binary);
+
+/// \brief Returns true if the coefficients of geometries and the
+/// knot vectors are written to XML files as binary data
+///
+/// \ingroup IO
+GISMO_EXPORT bool gsXmlBinary();
+
 namespace internal {
 
 typedef rapidxml::xml_node<char>        gsXmlNode;
 typedef rapidxml::xml_attribute<char>   gsXmlAttribute;
 typedef rapidxml::xml_document<char>    gsXmlTree;
+typedef rapidxml::xml_node_loader<char> gsXmlLoader;
+
+/// Reads the contents of \a node, if it belongs to a file which is
+/// read on demand (see gsFileData)
+inline void loadNode(gsXmlNode * node)
+{
+    if ( node && node->document() )
+        node->document()->load(node);
+}
 
 
 /// Generic get XML class: specializations provide implementation
@@ -228,7 +256,10 @@ Object * getById(gsXmlNode * node, const int & id)
     {
         const gsXmlAttribute * id_at = child->first_attribute("id");
         if (id_at && atoi(id_at->value()) == id )
+        {
+            loadNode(child);
             return internal::gsXml<Object>::get(child);
+        }
     }
     std::cerr<<"gsXmlUtils Warning: "<< internal::gsXml<Object>::tag() 
              <<" with id="<<id<<" not found.\n";
@@ -275,6 +306,67 @@ GISMO_EXPORT gsXmlNode *  makeComment(const std::string &, gsXmlTree & data);
 /// Helper to convert small unsigned to string
 GISMO_EXPORT std::string to_string(const unsigned & i);
 
+/// Reads the next number of the text \a str into \a val and moves
+/// \a str past it. Returns false if there is no number left.
+GISMO_EXPORT bool parseValue(const char * & str, double & val);
+GISMO_EXPORT bool parseValue(const char * & str, float & val);
+GISMO_EXPORT bool parseValue(const char * & str, int & val);
+GISMO_EXPORT bool parseValue(const char * & str, long & val);
+GISMO_EXPORT bool parseValue(const char * & str, unsigned & val);
+
+/// Reads the next number of the text \a str into \a val, for number
+/// types without a dedicated parser
+template<class T>
+bool parseValue(const char * & str, T & val)
+{
+    while ( std::isspace(static_cast<unsigned char>(*str)) ) ++str;
+    const char * first = str;
+    while ( '\0' != *str && !std::isspace(static_cast<unsigned char>(*str)) ) ++str;
+    std::istringstream is( std::string(first, str) );
+    return first != str && gsGetValue(is, val);
+}
+
+/// Appends the number \a val to the text \a str, with \a prec
+/// significant digits
+GISMO_EXPORT void formatValue(std::string & str, double val, int prec);
+GISMO_EXPORT void formatValue(std::string & str, float val, int prec);
+GISMO_EXPORT void formatValue(std::string & str, int val, int prec);
+GISMO_EXPORT void formatValue(std::string & str, long val, int prec);
+GISMO_EXPORT void formatValue(std::string & str, unsigned val, int prec);
+
+/// Appends the number \a val to the text \a str, for number types
+/// without a dedicated formatter
+template<class T>
+void formatValue(std::string & str, const T & val, int prec)
+{
+    std::ostringstream os;
+    os << std::setprecision(prec) << val;
+    str += os.str();
+}
+
+/// Converts \a val to double, for the binary encoding
+template<class T>
+inline double toDouble(const T & val) { return static_cast<double>(val); }
+
+#ifdef GISMO_WITH_MPQ
+inline double toDouble(const mpq_class & val) { return val.get_d(); }
+#endif
+
+/// Returns the base64 encoding of the \a n numbers starting at \a
+/// data, stored as little-endian 64 bit floats
+GISMO_EXPORT std::string encodeBase64(const double * data, size_t n);
+
+/// Decodes the base64 text \a str of little-endian 64 bit floats
+/// into \a result. Returns false if the text is not valid.
+GISMO_EXPORT bool decodeBase64(const char * str, std::vector<double> & result);
+
+/// Returns true if the value of \a node is base64-encoded binary
+/// data (attribute encoding="base64")
+GISMO_EXPORT bool isBase64(const gsXmlNode * node);
+
+/// Marks the value of \a node as base64-encoded binary data
+GISMO_EXPORT void setBase64(gsXmlNode * node, gsXmlTree & data);
+
 /// Helper to count the number of Objects (by tag) that exist in the
 /// XML tree
 GISMO_EXPORT int countByTag(const std::string & tag, gsXmlNode * root );
@@ -337,10 +429,12 @@ void getMatrixFromXml ( gsXmlNode * node,
                         unsigned const & cols, 
                         gsMatrix<T> & result );
 
-/// Helper to insert matrices into XML
+/// Helper to insert matrices into XML, as text or as base64-encoded
+/// binary data if \a binary is true
 template<class T>
 gsXmlNode * putMatrixToXml ( gsMatrix<T> const & mat, 
-                             gsXmlTree & data, std::string name = "Matrix");
+                             gsXmlTree & data, std::string name = "Matrix",
+                             bool binary = false);
 
 /// Helper to fetch sparse entries
 template<class T>
@@ -35,26 +35,29 @@ gsXmlNode * makeNode( const std::string & name,
                       const gsMatrix<T> & value, gsXmlTree & data,
                       bool transposed)
 {
-    std::ostringstream oss;
-    // Set precision
-    oss << std::setprecision(FILE_PRECISION);
+    std::string str;
+    str.reserve( value.size() * (FILE_PRECISION + 8) );
   
     if ( transposed )
         for ( index_t j = 0; j< value.rows(); ++j)
         {
             for ( index_t i = 0; i< value.cols(); ++i)
-                oss << value(j,i) <<" ";
-            //oss << "\n";
+            {
+                formatValue(str, value(j,i), FILE_PRECISION);
+                str += ' ';
+            }
         }
     else
         for ( index_t j = 0; j< value.cols(); ++j)
         {
             for ( index_t i = 0; i< value.rows(); ++i)
-                oss << value(i,j) <<" ";
-            //oss << "\n";
+            {
+                formatValue(str, value(i,j), FILE_PRECISION);
+                str += ' ';
+            }
         }
   
-    return makeNode(name, oss.str(), data);
+    return makeNode(name, str, data);
 }
 
 template<class T>
@@ -85,14 +88,28 @@ void getMatrixFromXml ( gsXmlNode * node, unsigned const & rows,
                         unsigned const & cols, gsMatrix<T> & result ) 
 {
     //gsWarn<<"Reading "<< node->name() <<" matrix of size "<<rows<<"x"<<cols<<"Geometry..\n";
-    std::istringstream str;
-    str.str( node->value() );
     result.resize(rows,cols);
- 
+
+    if ( isBase64(node) )
+    {
+        std::vector<double> tmp;
+        if ( !decodeBase64(node->value(), tmp) || tmp.size() != rows*cols )
+        {
+            gsWarn<<"XML Warning: Reading binary matrix of size "<<rows<<"x"<<cols<<" failed.\n";
+            gsWarn<<"Tag: "<< node->name() <<".\n";
+            return;
+        }
+        for (unsigned i=0; i<rows; ++i)
+            for (unsigned j=0; j<cols; ++j)
+                result(i,j) = static_cast<T>(tmp[i*cols+j]);
+        return;
+    }
+
+    // Read the numbers in place, from the buffer of the XML tree
+    const char * str = node->value();
     for (unsigned i=0; i<rows; ++i)
         for (unsigned j=0; j<cols; ++j)
-            //if ( !(str >> result(i,j) ) )
-              if (! gsGetValue(str,result(i,j)) )
+            if (! parseValue(str,result(i,j)) )
             {
                 gsWarn<<"XML Warning: Reading matrix of size "<<rows<<"x"<<cols<<" failed.\n";
                 gsWarn<<"Tag: "<< node->name() <<", Matrix entry: ("<<i<<", "<<j<<").\n";
@@ -106,31 +123,49 @@ void getSparseEntriesFromXml ( gsXmlNode * node,
 {
     result.clear();
 
-    std::istringstream str;
-    str.str( node->value() );
+    const char * str = node->value();
     index_t r,c;
     T val;
 
-    while( (str >> r) && (str >> c) && (str >> val) ) 
+    while( parseValue(str, r) && parseValue(str, c) && parseValue(str, val) ) 
         result.add(r,c,val);
 }
 
 
 template<class T>
-gsXmlNode * putMatrixToXml ( gsMatrix<T> const & mat, gsXmlTree & data, std::string name) 
+gsXmlNode * putMatrixToXml ( gsMatrix<T> const & mat, gsXmlTree & data,
+                             std::string name, bool binary) 
 {
-    std::ostringstream str;
-    str << std::setprecision(FILE_PRECISION);
+    if ( binary )
+    {
+        // Entries row by row, as in the text format
+        std::vector<double> tmp;
+        tmp.reserve( mat.size() );
+        for (index_t i=0; i< mat.rows(); ++i)
+            for (index_t j=0; j<mat.cols(); ++j)
+                tmp.push_back( toDouble(mat(i,j)) );
+
+        gsXmlNode* new_node = internal::makeNode(name,
+          encodeBase64(tmp.empty() ? NULL : &tmp[0], tmp.size()), data);
+        setBase64(new_node, data);
+        return new_node;
+    }
+
+    std::string str;
+    str.reserve( mat.size() * (FILE_PRECISION + 8) );
     // Write the matrix entries
     for (index_t i=0; i< mat.rows(); ++i)
     {
         for (index_t j=0; j<mat.cols(); ++j)
-            str << mat(i,j)<< " ";
-        str << "\n";
+        {
+            formatValue(str, mat(i,j), FILE_PRECISION);
+            str += ' ';
+        }
+        str += '\n';
     }
 
     // Create XML tree node
-    gsXmlNode* new_node = internal::makeNode(name, str.str(), data);        
+    gsXmlNode* new_node = internal::makeNode(name, str, data);        
     return new_node;
 }
 
@@ -140,19 +175,23 @@ gsXmlNode * putSparseMatrixToXml ( gsSparseMatrix<T> const & mat,
 {
     typedef typename gsSparseMatrix<T>::InnerIterator cIter;
 
-    std::ostringstream str;
-    str << std::setprecision(FILE_PRECISION);
+    std::string str;
     const index_t nCol = mat.cols();
 
     for (index_t j=0; j != nCol; ++j) // for all columns
         for ( cIter it(mat,j); it; ++it ) // for all non-zeros in column
         {
             // Write the matrix entry
-            str <<it.index() <<" "<<j<<" " << it.value() << "\n";
+            formatValue(str, it.index(), FILE_PRECISION);
+            str += ' ';
+            formatValue(str, j, FILE_PRECISION);
+            str += ' ';
+            formatValue(str, it.value(), FILE_PRECISION);
+            str += '\n';
         }
     
     // Create XML tree node
-    gsXmlNode* new_node = internal::makeNode(name, str.str(), data);        
+    gsXmlNode* new_node = internal::makeNode(name, str, data);        
     return new_node;
 }
 
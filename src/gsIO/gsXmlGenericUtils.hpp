@@ -215,7 +215,7 @@ gsXmlNode * putRationalBasisToXml ( Object const & obj, gsXmlTree & data)
     rat_node->append_node(tmp);
     
     // Write the weights
-    tmp = putMatrixToXml( obj.weights(), data, "weights" );
+    tmp = putMatrixToXml( obj.weights(), data, "weights", gsXmlBinary() );
     rat_node->append_node(tmp);
 	
 	// All done, return the node
@@ -348,7 +348,7 @@ gsXmlNode * putGeometryToXml ( Object const & obj, gsXmlTree & data)
     bs->append_node(tmp);
 
     // Write the coefficient matrix
-    tmp = putMatrixToXml( obj.coefs(), data, "coefs" );
+    tmp = putMatrixToXml( obj.coefs(), data, "coefs", gsXmlBinary() );
     tmp->append_attribute( makeAttribute("geoDim", obj.geoDim(), data) );
     bs->append_node(tmp);
 
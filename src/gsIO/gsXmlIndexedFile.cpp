@@ -0,0 +1,220 @@
+/** @file gsXmlIndexedFile.cpp
+
+    @brief Provides implementation of the reader of XML files which
+    reads the objects on demand.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#include <gsIO/gsXmlIndexedFile.h>
+
+#include <cstring>
+
+namespace gismo
+{
+
+namespace internal
+{
+
+// Reads a file character by character, in blocks
+class gsXmlScanner
+{
+public:
+    explicit gsXmlScanner(std::istream & is)
+    : m_is(is), m_buf(1 << 16), m_cur(0), m_end(0), m_offset(0)
+    { }
+
+    // Returns the next character, or -1 at the end of the file
+    int get()
+    {
+        if ( m_cur == m_end && !fill() )
+            return -1;
+        return static_cast<unsigned char>(m_buf[m_cur++]);
+    }
+
+    // Offset of the next character in the file
+    std::streamoff position() const { return m_offset + static_cast<std::streamoff>(m_cur); }
+
+    // Skips the characters up to and including the string s
+    bool skipPast(const char * s)
+    {
+        const size_t n = strlen(s);
+        std::string last;
+        for (int c = get(); c != -1; c = get())
+        {
+            last += static_cast<char>(c);
+            if ( last.size() > n )
+                last.erase(0, 1);
+            if ( last == s )
+                return true;
+        }
+        return false;
+    }
+
+    // Reads the rest of a tag up to and including '>', skipping
+    // quoted attribute values, and appends it to str
+    bool readTag(std::string & str)
+    {
+        char quote = 0;
+        for (int c = get(); c != -1; c = get())
+        {
+            str += static_cast<char>(c);
+            if ( quote )
+            {
+                if ( c == quote ) quote = 0;
+            }
+            else if ( '"' == c || '\'' == c )
+                quote = static_cast<char>(c);
+            else if ( '>' == c )
+                return true;
+        }
+        return false;
+    }
+
+private:
+
+    bool fill()
+    {
+        m_offset += static_cast<std::streamoff>(m_end);
+        m_is.read(&m_buf[0], m_buf.size());
+        m_end = static_cast<size_t>(m_is.gcount());
+        m_cur = 0;
+        return m_end != 0;
+    }
+
+private:
+    std::istream & m_is;
+    std::vector<char> m_buf;
+    size_t m_cur, m_end;
+    std::streamoff m_offset;
+};
+
+// Appends to root a node with the name and attributes of the start
+// tag str, allocated in data
+static gsXmlNode * makeIndexNode(std::string & str, gsXmlTree & data, gsXmlNode * root)
+{
+    // Parse the start tag as an empty element
+    if ( '/' != str[str.size() - 2] )
+        str.insert(str.size() - 1, "/");
+    char * text = data.allocate_string(str.c_str(), str.size() + 1);
+    gsXmlTree tmp;
+    tmp.parse<0>(text);
+    gsXmlNode * node = data.clone_node( tmp.first_node() );
+    root->append_node(node);
+    return node;
+}
+
+bool gsXmlIndexedFile::read(const std::string & fn, gsXmlTree & data)
+{
+    m_file.open(fn.c_str(), std::ios::in | std::ios::binary);
+    if ( m_file.fail() )
+        return false;
+
+    gsXmlNode * root = data.first_node("xml");
+    gsXmlScanner scan(m_file);
+    std::string tag;
+    std::streamoff first = 0;
+    gsXmlNode * node = NULL;
+    int depth = 0;
+    for (int c = scan.get(); c != -1; c = scan.get())
+    {
+        if ( '<' != c )
+            continue;
+
+        const std::streamoff start = scan.position() - 1;
+        c = scan.get();
+        if ( '?' == c ) // declaration or processing instruction
+            scan.skipPast("?>");
+        else if ( '!' == c ) // comment, CDATA or DOCTYPE
+        {
+            tag = "<!";
+            while ( tag.size() < 9 && tag != "<!--" && tag != "<![CDATA[" )
+            {
+                c = scan.get();
+                if ( -1 == c || '>' == c )
+                    break;
+                tag += static_cast<char>(c);
+            }
+            if ( tag == "<!--" )
+                scan.skipPast("-->");
+            else if ( tag == "<![CDATA[" )
+                scan.skipPast("]]>");
+            else if ( '>' != c )
+                scan.skipPast(">");
+        }
+        else if ( '/' == c ) // end tag
+        {
+            tag.clear();
+            scan.readTag(tag);
+            if ( 2 == depth-- && node )
+            {
+                m_ranges[node] = std::make_pair(first, scan.position());
+                node = NULL;
+            }
+        }
+        else if ( -1 != c ) // start tag
+        {
+            tag = "<";
+            tag += static_cast<char>(c);
+            if ( !scan.readTag(tag) )
+                break;
+            const bool empty = ( '/' == tag[tag.size() - 2] );
+
+            if ( 0 == depth ) // root element
+            {
+                if ( 0 != tag.compare(0, 4, "<xml") ||
+                     !( '>' == tag[4] || '/' == tag[4] ||
+                        std::isspace(static_cast<unsigned char>(tag[4])) ) )
+                    return false;
+            }
+            else if ( 1 == depth ) // object
+            {
+                first = start;
+                node  = makeIndexNode(tag, data, root);
+                if ( empty )
+                {
+                    m_ranges[node] = std::make_pair(first, scan.position());
+                    node = NULL;
+                }
+            }
+            if ( !empty )
+                ++depth;
+        }
+    }
+
+    m_file.clear();
+    m_data = &data;
+    return true;
+}
+
+void gsXmlIndexedFile::load(gsXmlNode * node)
+{
+    std::map<gsXmlNode*, std::pair<std::streamoff, std::streamoff> >::iterator
+        it = m_ranges.find(node);
+    if ( it == m_ranges.end() )
+        return;
+
+    // The text of the element is kept by the XML tree, since the
+    // parsed names and values point into it
+    const size_t n = static_cast<size_t>(it->second.second - it->second.first);
+    char * text = m_data->allocate_string(NULL, n + 1);
+    m_file.seekg(it->second.first);
+    m_file.read(text, n);
+    GISMO_ENSURE( !m_file.fail(), "gsXmlIndexedFile: cannot read object "<< node->name() );
+    text[n] = '\0';
+    m_ranges.erase(it);
+
+    gsXmlTree tmp;
+    tmp.parse<0>(text);
+    m_data->clone_node(tmp.first_node(), node);
+}
+
+} // namespace internal
+
+} // namespace gismo
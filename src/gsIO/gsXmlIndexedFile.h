@@ -0,0 +1,70 @@
+/** @file gsXmlIndexedFile.h
+
+    @brief Provides a reader of XML files which indexes the objects of
+    the file and reads them on demand.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsIO/gsXml.h>
+
+#include <fstream>
+#include <map>
+
+namespace gismo {
+
+namespace internal {
+
+/**
+    \brief Reads the objects of a G+Smo XML file on demand.
+
+    The file is scanned once, in blocks, to find the top-level
+    elements (the children of the \em xml root) with their start
+    tags and byte ranges. These are added to the XML tree as nodes
+    with the tag and attributes only. When a node is accessed (see
+    loadNode), the bytes of the element are read from the file and
+    parsed into the node.
+
+    The memory used is proportional to the number of objects and to
+    the size of the objects that are read, not to the size of the
+    file.
+
+    \ingroup IO
+*/
+class GISMO_EXPORT gsXmlIndexedFile : public gsXmlLoader
+{
+public:
+
+    gsXmlIndexedFile() : m_data(NULL) { }
+
+    /// Scans the file \a fn and appends its objects to the root of
+    /// \a data; their contents are read on demand. Returns false if
+    /// the file cannot be read or has no \em xml root element.
+    bool read(const std::string & fn, gsXmlTree & data);
+
+    /// Reads the contents of \a node, if it is an object of the file
+    /// which is not read yet
+    void load(gsXmlNode * node);
+
+private:
+
+    // The file, which stays open until all objects are read
+    std::ifstream m_file;
+
+    gsXmlTree * m_data;
+
+    // Byte ranges of the objects not read yet
+    std::map<gsXmlNode*, std::pair<std::streamoff, std::streamoff> > m_ranges;
+};
+
+} // namespace internal
+
+} // namespace gismo
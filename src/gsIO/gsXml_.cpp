@@ -29,11 +29,13 @@ void getFunctionFromXml ( gsXmlNode * node, gsFunctionExpr<T> & result);
 
 TEMPLATE_INST
 gsXmlNode * putMatrixToXml ( gsMatrix<T> const & mat, 
-                             gsXmlTree & data, std::string name);
+                             gsXmlTree & data, std::string name,
+                             bool binary);
 
 TEMPLATE_INST // used in gsXmlGenericUtils.hpp
 gsXmlNode * putMatrixToXml ( gsMatrix<unsigned> const & mat, 
-                             gsXmlTree & data, std::string name);
+                             gsXmlTree & data, std::string name,
+                             bool binary);
 
 TEMPLATE_INST
 void getSparseEntriesFromXml ( gsXmlNode * node, 
@@ -58,7 +60,8 @@ void getMatrixFromXml ( gsXmlNode * node,
 
 TEMPLATE_INST
 gsXmlNode * putMatrixToXml ( gsMatrix<int> const & mat,
-                             gsXmlTree & data, std::string name);
+                             gsXmlTree & data, std::string name,
+                             bool binary);
 
 TEMPLATE_INST
 void getSparseEntriesFromXml ( gsXmlNode * node,
@@ -95,6 +95,39 @@ public:
     /// Assembles system for the least square fit.
     void assembleSystem(gsSparseMatrix<T>& A_mat, gsMatrix<T>& B);
 
+    /**
+       \brief Adds to the least squares system \a A_mat, \a B the
+       terms of the points with parameters \a param_values (one per
+       column) and coordinates \a points (one per row).
+
+       The points are sorted by element and the basis is evaluated
+       for all the points of an element at once; the contributions of
+       an element are summed in dense blocks. The sparsity pattern of
+       \a A_mat is extended by exactly the entries coupled by the
+       points, and the blocks are added to the values of the pattern.
+       With OpenMP, blocks of points are assembled in parallel, every
+       thread summing into its own copy of the values, which are
+       added up in a fixed order.
+    */
+    void assembleSystem(gsMatrix<T> const & param_values,
+                        gsMatrix<T> const & points,
+                        gsSparseMatrix<T>& A_mat, gsMatrix<T>& B) const;
+
+    /// Adds the points \a points (one per column) with parameter
+    /// values \a param_values to the data. If the system of the
+    /// points is already assembled (by compute()), only the terms of
+    /// the new points are added to it, so that the next call of
+    /// compute() does not assemble the system again.
+    void addPoints(gsMatrix<T> const & param_values, gsMatrix<T> const & points);
+
+    /// Discards the assembled system of the points; to be called
+    /// when the basis is modified.
+    void resetSystem()
+    {
+        m_A.resize(0, 0);
+        m_B.resize(0, 0);
+    }
+
 
 public:
 
@@ -104,11 +137,20 @@ public:
     /// Returns the basis of the approximation
     const gsBasis<T> & getBasis() const {return *m_basis;}
 
-    void setBasis(gsBasis<T> & basis) {m_basis=&basis;}
+    void setBasis(gsBasis<T> & basis) {m_basis=&basis; resetSystem();}
 
     /// returns the parameter values
-    gsMatrix<T> & getreturnParamValues() {return m_param_values;}
-    gsMatrix<T> & returnParamValues() {return m_param_values;}
+    const gsMatrix<T> & getreturnParamValues() const {return m_param_values;}
+    const gsMatrix<T> & returnParamValues() const {return m_param_values;}
+
+    /// Sets the parameter values of the points (eg. after parameter
+    /// correction) and discards the assembled system
+    void setParamValues(gsMatrix<T> const & param_values)
+    {
+        GISMO_ASSERT( param_values.cols() == m_points.rows(), "Invalid number of parameters");
+        m_param_values = param_values;
+        resetSystem();
+    }
 
     /// returns the points
     gsMatrix<T> returnPoints() const {return m_points;}
@@ -136,6 +178,11 @@ protected:
     /// Minimum point-wise error
     T m_min_error;
 
+    /// Least squares system of the points (without smoothing), kept
+    /// for adding points incrementally
+    gsSparseMatrix<T> m_A;
+    gsMatrix<T>       m_B;
+
 private:
     //void applySmoothing(T lambda, gsMatrix<T> & A_mat);
 
@@ -17,6 +17,10 @@
 #include <gsCore/gsLinearAlgebra.h>
 #include <gsTensor/gsTensorDomainIterator.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 namespace gismo
 {
@@ -50,28 +54,18 @@ void gsFitting<T>::compute(T lambda)
     const int num_basis=m_basis->size();
     const int dimension=m_points.cols();
 
-    //left side matrix
-    //gsMatrix<T> A_mat(num_basis,num_basis);
-    gsSparseMatrix<T> A_mat(num_basis, num_basis);
-    //gsMatrix<T>A_mat(num_basis,num_basis);
-    //To optimize sparse matrix an estimation of nonzero elements per
-    //column can be given here
-    int nonZerosPerCol = 1;
-    for (int i = 0; i < m_basis->dim(); ++i) // to do: improve
-        //nonZerosPerCol *= 2 * m_basis->degree(i) + 1;
-        nonZerosPerCol *= ( 2 * m_basis->degree(i) + 1 ) * 4;//AM: Related to bandwidth of basis
-    A_mat.reserve( gsVector<index_t>::Constant(num_basis, nonZerosPerCol ) );
-    //gsDebugVar( nonZerosPerCol );
-
-    A_mat.setZero(); // ensure that all entries are zero in the beginning
-    //right side vector (more dimensional!)
-    gsMatrix<T> m_B(num_basis, dimension);
-    // enusure that all entries are zero in the beginning
-    m_B.setZero(); 
     // building the matrix A and the vector b of the system of linear
-    // equations A*x==b
-    
-    assembleSystem(A_mat, m_B);
+    // equations A*x==b, unless it is assembled already for the
+    // current basis (see addPoints)
+    if ( m_A.rows() != num_basis )
+    {
+        m_A.resize(num_basis, num_basis);
+        m_B.setZero(num_basis, dimension);
+        assembleSystem(m_param_values, m_points, m_A, m_B);
+    }
+
+    //left side matrix
+    gsSparseMatrix<T> A_mat = m_A;
 
     // --- Smoothing matrix computation
     //test degree >=3
@@ -105,37 +99,237 @@ void gsFitting<T>::compute(T lambda)
 
 template <class T>
 void gsFitting<T>::assembleSystem(gsSparseMatrix<T>& A_mat,
-				  gsMatrix<T>& m_B)
+                                  gsMatrix<T>& m_B)
 {
-    const int num_points = m_points.rows();    
+    assembleSystem(m_param_values, m_points, A_mat, m_B);
+}
 
-    //for computing the value of the basis function
-    gsMatrix<T> value;
-    gsMatrix<unsigned> actives;
+namespace internal
+{
+
+// Number of active functions in a column of the result of
+// active_into, which is padded with zeros at the bottom
+inline index_t numActive(const gsMatrix<unsigned> & actives, index_t col)
+{
+    index_t n = 1;
+    while ( n != actives.rows() && 0 != actives(n, col) )
+        ++n;
+    return n;
+}
 
+// Orders the points by their active functions, so that the points
+// of an element are consecutive
+struct gsActiveColumnLess
+{
+    explicit gsActiveColumnLess(const gsMatrix<unsigned> & actives)
+    : m_actives(actives) { }
 
-    for(index_t k = 0; k < num_points; k++)
+    bool operator()(index_t a, index_t b) const
     {
-        const gsMatrix<T>& curr_point = m_param_values.col(k);
+        for (index_t i = 0; i != m_actives.rows(); ++i)
+            if ( m_actives(i, a) != m_actives(i, b) )
+                return m_actives(i, a) < m_actives(i, b);
+        return false;
+    }
 
-        //computing the values of the basis functions at the current point
-        m_basis->eval_into(curr_point, value);
+    const gsMatrix<unsigned> & m_actives;
+};
 
-        // which functions have been computed i.e. which are active
-        m_basis->active_into(curr_point, actives);
-        
-	const index_t numActive = actives.rows();
+// Sorts the points of a block by element and returns in
+// elements the first position of every element in order, followed
+// by the number of points
+inline void sortByElement(const gsMatrix<unsigned> & actives,
+                          std::vector<index_t> & order,
+                          std::vector<index_t> & elements)
+{
+    const index_t n = actives.cols();
+    order.resize(n);
+    for (index_t k = 0; k != n; ++k)
+        order[k] = k;
+    std::sort(order.begin(), order.end(), gsActiveColumnLess(actives));
+
+    elements.clear();
+    for (index_t k = 0; k != n; ++k)
+        if ( 0 == k || actives.col(order[k]) != actives.col(order[k-1]) )
+            elements.push_back(k);
+    elements.push_back(n);
+}
+
+} // namespace internal
+
+template <class T>
+void gsFitting<T>::assembleSystem(gsMatrix<T> const & param_values,
+                                  gsMatrix<T> const & points,
+                                  gsSparseMatrix<T>& A_mat,
+                                  gsMatrix<T>& B) const
+{
+    const index_t num_points = param_values.cols();
+    GISMO_ASSERT( points.rows() == num_points, "Wrong number of points");
+    GISMO_ASSERT( A_mat.rows() == m_basis->size() && B.rows() == m_basis->size()
+                  && B.cols() == points.cols(), "Wrong size of the system");
+    if ( 0 == num_points )
+        return;
+
+    // The points are processed in blocks, so that the active
+    // functions of all points are not stored at once
+    const index_t blockSize = 16384;
+    const int numBlocks = static_cast<int>( (num_points + blockSize - 1) / blockSize );
+
+    // 1. The active functions of the elements which contain points
+    std::vector<std::vector<gsVector<unsigned> > > blockElements(numBlocks);
+#   pragma omp parallel for schedule(dynamic, 1)
+    for (int b = 0; b < numBlocks; ++b)
+    {
+        const index_t first = b * blockSize;
+        const index_t n = math::min(blockSize, num_points - first);
+        gsMatrix<unsigned> actives;
+        std::vector<index_t> order, elements;
+        m_basis->active_into(param_values.middleCols(first, n), actives);
+        internal::sortByElement(actives, order, elements);
+
+        blockElements[b].resize(elements.size() - 1);
+        for (size_t e = 0; e + 1 != elements.size(); ++e)
+        {
+            const index_t k = order[elements[e]];
+            blockElements[b][e] = actives.col(k).topRows(internal::numActive(actives, k));
+        }
+    }
+
+    std::vector<gsVector<unsigned> > allElements;
+    for (int b = 0; b < numBlocks; ++b)
+        allElements.insert(allElements.end(), blockElements[b].begin(), blockElements[b].end());
+    std::vector<std::vector<gsVector<unsigned> > >().swap(blockElements);
 
-        for (index_t i = 0; i != numActive; ++i)
+    // 2. The sparsity pattern: the entries of A_mat and the entries
+    // coupled by the elements
+    A_mat.makeCompressed();
+    bool complete = true;
+    for (size_t e = 0; complete && e != allElements.size(); ++e)
+    {
+        const gsVector<unsigned> & act = allElements[e];
+        for (index_t j = 0; complete && j != act.size(); ++j)
+        {
+            const index_t * first = A_mat.innerIndexPtr() + A_mat.outerIndexPtr()[act[j]];
+            const index_t * last  = A_mat.innerIndexPtr() + A_mat.outerIndexPtr()[act[j]+1];
+            for (index_t i = 0; complete && i != act.size(); ++i)
+                complete = std::binary_search(first, last, static_cast<index_t>(act[i]));
+        }
+    }
+
+    if ( !complete )
+    {
+        std::vector<Eigen::Triplet<T,index_t> > entries;
+        entries.reserve(A_mat.nonZeros());
+        for (index_t j = 0; j < A_mat.outerSize(); ++j)
+            for (typename gsSparseMatrix<T>::InnerIterator it(A_mat, j); it; ++it)
+                entries.push_back(Eigen::Triplet<T,index_t>(it.row(), it.col(), it.value()));
+        for (size_t e = 0; e != allElements.size(); ++e)
+        {
+            const gsVector<unsigned> & act = allElements[e];
+            for (index_t j = 0; j != act.size(); ++j)
+                for (index_t i = 0; i != act.size(); ++i)
+                    entries.push_back(Eigen::Triplet<T,index_t>(act[i], act[j], 0));
+        }
+        A_mat.setFromTriplets(entries.begin(), entries.end());
+        A_mat.makeCompressed();
+    }
+    std::vector<gsVector<unsigned> >().swap(allElements);
+
+    // 3. The element blocks, summed per thread
+    const index_t nnz = A_mat.nonZeros();
+    int numThreads = 1;
+#   ifdef _OPENMP
+    numThreads = omp_get_max_threads();
+#   endif
+    std::vector<gsVector<T> > values(numThreads);
+    std::vector<gsMatrix<T> > rhs(numThreads);
+
+#   pragma omp parallel
+    {
+        int tid = 0;
+#       ifdef _OPENMP
+        tid = omp_get_thread_num();
+#       endif
+        gsVector<T> & val = values[tid];
+        gsMatrix<T> & rhsT = rhs[tid];
+        val.setZero(nnz);
+        rhsT.setZero(B.rows(), B.cols());
+
+        gsMatrix<unsigned> actives;
+        std::vector<index_t> order, elements;
+        gsMatrix<T> pars, basisVals, localA;
+
+#       pragma omp for schedule(static)
+        for (int b = 0; b < numBlocks; ++b)
         {
-            const int ii = actives(i, 0);
-            m_B.row(ii) += value(i, 0) * m_points.row(k);
-            for (index_t j = 0; j != numActive; ++j)
-                A_mat(ii, actives(j, 0)) += value(i, 0) * value(j, 0);
+            const index_t first = b * blockSize;
+            const index_t n = math::min(blockSize, num_points - first);
+            m_basis->active_into(param_values.middleCols(first, n), actives);
+            internal::sortByElement(actives, order, elements);
+
+            for (size_t e = 0; e + 1 != elements.size(); ++e)
+            {
+                // Evaluate the basis at all points of the element
+                const index_t np = elements[e+1] - elements[e];
+                const index_t k0 = order[elements[e]];
+                const index_t na = internal::numActive(actives, k0);
+                pars.resize(param_values.rows(), np);
+                for (index_t k = 0; k != np; ++k)
+                    pars.col(k) = param_values.col(first + order[elements[e] + k]);
+                m_basis->eval_into(pars, basisVals);
+
+                localA.noalias() = basisVals.topRows(na) * basisVals.topRows(na).transpose();
+                for (index_t k = 0; k != np; ++k)
+                {
+                    const index_t pt = first + order[elements[e] + k];
+                    for (index_t i = 0; i != na; ++i)
+                        rhsT.row(actives(i, k0)) += basisVals(i, k) * points.row(pt);
+                }
+
+                // Add the block to the values of the pattern
+                for (index_t j = 0; j != na; ++j)
+                {
+                    const index_t start = A_mat.outerIndexPtr()[actives(j, k0)];
+                    const index_t * firstI = A_mat.innerIndexPtr() + start;
+                    const index_t * lastI  = A_mat.innerIndexPtr() +
+                        A_mat.outerIndexPtr()[actives(j, k0) + 1];
+                    for (index_t i = 0; i != na; ++i)
+                        val[start + (std::lower_bound(firstI, lastI, static_cast<index_t>(actives(i, k0))) - firstI)]
+                            += localA(i, j);
+                }
+            }
         }
+    }//omp parallel
+
+    gsAsVector<T> A_values(A_mat.valuePtr(), nnz);
+    for (int t = 0; t != numThreads; ++t)
+    {
+        if ( 0 == values[t].size() ) // thread did not run
+            continue;
+        A_values += values[t];
+        B        += rhs[t];
     }
 }
 
+template<class T>
+void gsFitting<T>::addPoints(gsMatrix<T> const & param_values,
+                             gsMatrix<T> const & points)
+{
+    GISMO_ASSERT( param_values.cols() == points.cols() &&
+                  param_values.rows() == m_param_values.rows() &&
+                  points.rows() == m_points.cols(), "Wrong input");
+
+    const index_t n0 = m_param_values.cols();
+    m_param_values.conservativeResize(Eigen::NoChange, n0 + param_values.cols());
+    m_param_values.rightCols(param_values.cols()) = param_values;
+    m_points.conservativeResize(n0 + points.cols(), Eigen::NoChange);
+    m_points.bottomRows(points.cols()) = points.transpose();
+
+    // Update the system, if it is assembled
+    if ( m_A.rows() == m_basis->size() )
+        assembleSystem(param_values, points.transpose(), m_A, m_B);
+}
+
 
 template<class T>
 void gsFitting<T>::applySmoothing(T lambda, gsSparseMatrix<T> & A_mat)
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <gsUtils/gsMesh/gsMesh.h>
+#include <gsUtils/gsMesh/gsIndexedMesh.h>
 
 namespace gismo
 {
@@ -24,6 +25,13 @@ namespace gismo
 
     Construct an instance of this class from a gsMesh, and then use it
     to perform "CAD model reconstruction" to produce a gsSolid.
+
+    The algorithms work on the vertex, edge and face objects of the
+    gsMesh. A mesh read into a gsIndexedMesh has to be converted by
+    gsIndexedMesh::toMesh, which allocates these objects, so the
+    indexed storage saves no memory here; only the edges and their
+    neighboring faces can be computed from the half-edges of the
+    indexed mesh, see getFeatures(const gsIndexedMesh<T>&,T,bool&,bool&).
     
     \ingroup Modeling
 */
@@ -135,6 +143,21 @@ public:
      */
     void getFeatures(T angleGrad,bool& bWarnNonManifold,bool& bWarnBorders);
 
+    /** \brief Same as getFeatures(T,bool&,bool&), the edges and their
+     *         neighboring faces being given by the half-edges of \a
+     *         source instead of searched by the vertices.
+     *  \param source - an indexed triangle mesh with half-edges (see
+     *                  gsIndexedMesh::computeHalfEdges). The mesh of
+     *                  this object must be filled by source.toMesh(),
+     *                  without edges, so that the vertices and faces
+     *                  have the same indices.
+     *  \param angleGrad - see getFeatures(T,bool&,bool&).
+     *  \param[out] bWarnNonManifold - see getFeatures(T,bool&,bool&).
+     *  \param[out] bWarnBorders - see getFeatures(T,bool&,bool&).
+     */
+    void getFeatures(const gsIndexedMesh<T> & source, T angleGrad,
+                     bool& bWarnNonManifold, bool& bWarnBorders);
+
     /** \brief Each face obtains a patch number, faces of the same number belong to the same patch.
      */
     void calcPatchNumbers();
@@ -331,6 +354,14 @@ public:
     void readEdges( std::string const & fn, std::vector<gsEdge <T> > & edges );
     
     
+private:
+
+    // Marks the edges as sharp by the angle between their faces and
+    // stores the neighboring faces of the faces
+    void markSharpEdges(T angleGrad,bool& bWarnNonManifold,bool& bWarnBorders);
+
+public:
+
     // public members
     gsMesh<> *mesh;
     
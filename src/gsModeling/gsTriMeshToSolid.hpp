@@ -123,6 +123,88 @@ void gsTriMeshToSolid<T>::getFeatures(T angleGrad,bool& bWarnNonManifold,bool& b
         }
     }
 
+    markSharpEdges(angleGrad, bWarnNonManifold, bWarnBorders);
+}
+
+template <class T>
+void gsTriMeshToSolid<T>::getFeatures(const gsIndexedMesh<T> & source, T angleGrad,
+                                      bool& bWarnNonManifold, bool& bWarnBorders)
+{
+    GISMO_ENSURE( source.hasHalfEdges(), "gsTriMeshToSolid: the half-edges are not computed");
+    GISMO_ENSURE( static_cast<index_t>(vertex.size()) == source.numVertices() &&
+                  static_cast<index_t>(face.size()) == source.numFaces() && edge.empty(),
+                  "gsTriMeshToSolid: the mesh is not a copy of the indexed mesh");
+
+    gsInfo<<"Getting the features..."<<"\n";
+    bWarnNonManifold=false;
+    bWarnBorders=false;
+
+    // One edge per pair of twin half-edges, the other half-edges
+    // (boundary and non-manifold edges) are grouped by their vertices
+    const index_t nh = source.numHalfEdges();
+    std::vector<index_t> heEdge(nh, -1);
+    std::vector<std::pair<std::pair<index_t,index_t>,index_t> > loose;
+    for (index_t h = 0; h != nh; ++h)
+    {
+        const index_t a = source.origin(h), b = source.origin(source.next(h));
+        if (*vertex[a]==*vertex[b])
+        {
+            gsWarn<<"face "<<source.face(h)<<" has 2 common vertices"<<"\n"<<*vertex[a]<<*vertex[b]<<"\n";
+            continue;
+        }
+        const index_t t = source.twin(h);
+        if (t == -1)
+            loose.push_back(std::make_pair(std::make_pair(math::min(a,b), math::max(a,b)), h));
+        else if (t > h)
+        {
+            heEdge[h] = heEdge[t] = static_cast<index_t>(edge.size());
+            edge.push_back(Edge(vertex[a], vertex[b]));
+        }
+    }
+    std::sort(loose.begin(), loose.end());
+    for (std::size_t i = 0; i != loose.size(); ++i)
+    {
+        if (i == 0 || loose[i].first != loose[i-1].first)
+            edge.push_back(Edge(vertex[loose[i].first.first], vertex[loose[i].first.second]));
+        heEdge[loose[i].second] = static_cast<index_t>(edge.size()) - 1;
+    }
+
+    // Sort the edges as getFeatures() does, and number them
+    for (std::size_t i = 0; i != edge.size(); ++i)
+    {
+        edge[i].orderVertices();
+        edge[i].setId(static_cast<int>(i));
+    }
+    std::sort(edge.begin(), edge.end());
+    std::vector<index_t> pos(edge.size());
+    for (std::size_t i = 0; i != edge.size(); ++i)
+    {
+        pos[edge[i].getId()] = i;
+        edge[i].setId(static_cast<int>(i));
+    }
+    numEdges=edge.size();
+
+    // Neighboring faces of each edge, the half-edges are ordered
+    // face by face
+    for (index_t h = 0; h != nh; ++h)
+    {
+        const FaceHandle f = face[source.face(h)];
+        if (*(f->vertices[0])!=*(f->vertices[1])&&
+            *(f->vertices[2])!=*(f->vertices[1])&&
+            *(f->vertices[0])!=*(f->vertices[2]))
+        {
+            Edge * eit = &edge[pos[heEdge[h]]];
+            eit->nFaces.push_back(f);
+            f->nEdges.push_back(eit);
+        }
+    }
+
+    markSharpEdges(angleGrad, bWarnNonManifold, bWarnBorders);
+}
+
+template <class T>
+void gsTriMeshToSolid<T>::markSharpEdges(T angleGrad,bool& bWarnNonManifold,bool& bWarnBorders)
+{
     // Extract those edges whose adjacent triangles form a large angle
     for(typename std::vector<Edge>::iterator iter(edge.begin());iter!=edge.end();++iter)
     {
@@ -67,37 +67,158 @@ namespace bspline
         }
     }
 
-    /// Evaluation for degree 1 B-spline basis
-    template <class T, typename KnotIterator, typename Derived>
-    void evalDeg1Basis(  const T & u,
-                         const KnotIterator knot,
-                         Eigen::MatrixBase<Derived> const & result )
-    {
-        result(0,0) =  u       - (*knot+1);
-        result(1,0) =  (*knot) - u        ;
-        const T dn  = (*knot)  - (*knot+1) ;
-        if( dn !=  0.0 )
-            result.array /= dn;
-    }
-    
-    /// Evaluation for degree 2 B-spline basis
-    template <class T, typename KnotIterator, typename Derived>
-    void evalDeg2Basis(  const T & u,
-                         const KnotIterator knot,
-                         Eigen::MatrixBase<Derived> const & result )
+    /// Input: an iterator \a knot pointing to the first knot of a
+    /// non-empty knot span and \a m evaluation points \a u in this
+    /// span. Output: the values (and the derivatives up to order \a n)
+    /// of all basis functions of degree \a deg which are active on the
+    /// span, written to the columns \a col, ..., \a col + \a m - 1 of
+    /// \a result[0] (\a result[k] for the \a k-th derivatives).
+    ///
+    /// The B-spline recursion is carried out for all points at once,
+    /// every step being a vectorized operation on the whole batch. The
+    /// knot differences are inverted once per span. The derivatives
+    /// are linear combinations of the lower degree values, whose
+    /// coefficients depend on the knots only, so they are computed
+    /// once per span and applied to the batch as a matrix product.
+    ///
+    /// \a P is the degree if it is known at compile time, or -1. The
+    /// buffer \a work must hold (\a n + 2)(\a deg + 1)\a m entries.
+    template <int P, class T, typename KnotIterator>
+    void evalBasisBatchDeg( const T * u,
+                         const index_t m,
+                         KnotIterator knot,
+                         const int deg,
+                         const int n,
+                         T * work,
+                         gsMatrix<T> * result,
+                         const index_t col )
     {
-        
+        typedef Eigen::Array<T,1,Dynamic>                 Row;
+        typedef Eigen::Array<T,Dynamic,Dynamic,RowMajor> Table;
+
+        const int p  = ( P < 0 ? deg : P );
+        const int p1 = p + 1;
+        const int nd = math::min(n, p);
+
+        const Eigen::Map<const Row> x(u, m);
+        Eigen::Map<Row>   tmp(work, m);
+        Eigen::Map<Table> N  (work + m, p1, m); // values of the current degree
+        T * level = work + (p1 + 1) * m;        // values of degree p-1, p-2, ..
+
+        // idiff[j*p1+r] = 1 / ( t_{s+r+1} - t_{s+r+1-j} )
+        STACK_ARRAY(T, idiff, p1 * p1);
+
+        N.row(0).setOnes();
+        for (int j = 1; j <= p; ++j) // for all degrees
+        {
+            // Keep the values of degree p-k, needed for the k-th derivative
+            if ( p - j < nd )
+            {
+                Eigen::Map<Table>(level + (p - j) * p1 * m, j, m) = N.topRows(j);
+            }
+
+            for (int r = 0; r < j; ++r)
+                idiff[j*p1 + r] = T(1) / ( *(knot+r+1) - *(knot+r+1-j) );
+
+            // Row j holds the left part of the recursion ("saved")
+            N.row(j).setZero();
+            for (int r = 0; r < j; ++r)
+            {
+                tmp      = N.row(r) * idiff[j*p1 + r];
+                N.row(r) = N.row(j) - (x - *(knot+r+1)) * tmp;
+                N.row(j) = (x - *(knot+r+1-j)) * tmp;
+            }
+        }
+        result[0].middleCols(col, m) = N.matrix();
+
+        if ( 0 == n )
+            return;
+
+        // Coefficients of the derivatives w.r.t. the lower degree
+        // values, see Algorithm A2.3 in the NURBS book
+        STACK_ARRAY(T, coef, nd * p1 * p1);
+        STACK_ARRAY(T, a, 2 * p1);
+        std::fill(coef, coef + nd * p1 * p1, T(0));
+        for (int r = 0; r <= p; ++r)
+        {
+            T * a1 = a;
+            T * a2 = a + p1;
+            a1[0] = T(1);
+            for (int k = 1; k <= nd; ++k)
+            {
+                const int rk = r - k, pk = p - k;
+                const T * id = idiff + (pk+1) * p1;
+                T * c = coef + (k-1) * p1 * p1 + r; // row r of a (p+1)x(pk+1) matrix
+
+                if ( r >= k )
+                {
+                    a2[0] = a1[0] * id[rk];
+                    c[rk*p1] = a2[0];
+                }
+
+                const int j1 = ( rk >= -1  ? 1   : -rk );
+                const int j2 = ( r-1 <= pk ? k-1 : p - r );
+                for (int j = j1; j <= j2; ++j)
+                {
+                    a2[j] = (a1[j] - a1[j-1]) * id[rk+j];
+                    c[(rk+j)*p1] = a2[j];
+                }
+
+                if ( r <= pk )
+                {
+                    a2[k] = - a1[k-1] * id[r];
+                    c[r*p1] = a2[k];
+                }
+
+                std::swap(a1, a2);
+            }
+        }
+
+        T fac = T(p);
+        for (int k = 1; k <= nd; ++k)
+        {
+            const Eigen::Map<const Eigen::Matrix<T,Dynamic,Dynamic> > C(coef + (k-1) * p1 * p1, p1, p-k+1);
+            const Eigen::Map<const Table> L(level + (k-1) * p1 * m, p-k+1, m);
+            result[k].middleCols(col, m).noalias() = fac * C.lazyProduct(L.matrix());
+            fac *= T(p-k);
+        }
+        for (int k = nd + 1; k <= n; ++k)
+            result[k].middleCols(col, m).setZero();
     }
-    
-    /// Evaluation for degree 3 B-spline basis
-    template <class T, typename KnotIterator, typename MatrixType>
-    void evalDeg3Basis(  const T & u,
-                         const KnotIterator knot,
-                         MatrixType & result )
+
+    /// Same as evalBasisBatchDeg, with compile-time specializations
+    /// for degrees up to 4.
+    template <class T, typename KnotIterator>
+    void evalBasisBatch( const T * u,
+                         const index_t m,
+                         KnotIterator knot,
+                         const int deg,
+                         const int n,
+                         T * work,
+                         gsMatrix<T> * result,
+                         const index_t col )
     {
-        
+        switch (deg)
+        {
+        case 0:
+            evalBasisBatchDeg<0>(u, m, knot, deg, n, work, result, col);
+            break;
+        case 1:
+            evalBasisBatchDeg<1>(u, m, knot, deg, n, work, result, col);
+            break;
+        case 2:
+            evalBasisBatchDeg<2>(u, m, knot, deg, n, work, result, col);
+            break;
+        case 3:
+            evalBasisBatchDeg<3>(u, m, knot, deg, n, work, result, col);
+            break;
+        case 4:
+            evalBasisBatchDeg<4>(u, m, knot, deg, n, work, result, col);
+            break;
+        default:
+            evalBasisBatchDeg<-1>(u, m, knot, deg, n, work, result, col);
+        };
     }
-    
 
     /// Input: parameter position \a u, KnotIterator \a knot identifying the active interval,
     /// degree \a deg, Output: table \a N.
@@ -553,6 +553,18 @@ public:
 
 protected:
 
+    /// Evaluates the basis functions and their derivatives up to
+    /// order \a n at \a u into \a result[0], ..., \a result[n], which
+    /// must have the right size. Consecutive points lying in the same
+    /// knot span are evaluated together (see bspline::evalBasisBatch).
+    void evalBatch_into(const gsMatrix<T> & u, int n, gsMatrix<T> * result) const;
+
+    /// Helper for evalBatch_into() for points which are not grouped by
+    /// knot span: the points are sorted by span (\a spanInd), gathered
+    /// in batches of \a maxBatch and the results are scattered back.
+    void evalBucketed_into(const gsMatrix<T> & u, const std::vector<index_t> & spanInd,
+                           int n, T * work, index_t maxBatch, gsMatrix<T> * result) const;
+
     /// Tries to convert the basis into periodic
     void _convertToPeriodic();
 
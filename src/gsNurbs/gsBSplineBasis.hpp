@@ -26,6 +26,8 @@
 
 #include <gsIO/gsXml.h>
 
+#include <numeric>
+
 namespace gismo
 {
 
@@ -237,117 +239,130 @@ unsigned gsTensorBSplineBasis<1,T>::twin(unsigned i) const
 template <class T> 
 void gsTensorBSplineBasis<1,T>::eval_into(const gsMatrix<T> & u, gsMatrix<T>& result) const 
 {
+    GISMO_ASSERT( u.rows() == 1 , "gsBSplineBasis accepts points with one coordinate.");
     result.resize(m_p+1, u.cols() );
+    evalBatch_into(u, 0, &result);
+}
+
+template <class T>
+void gsTensorBSplineBasis<1,T>::evalBatch_into(const gsMatrix<T> & u, int n,
+                                               gsMatrix<T> * result) const
+{
+    // Maximum number of points evaluated together, this bounds the
+    // size of the work array
+    static const index_t maxBatch = 64;
 
-#if (FALSE)
+    const index_t np = u.cols();
+    STACK_ARRAY(T, work, (n + 2) * (m_p + 1) * maxBatch);
 
-    typename KnotVectorType::const_iterator kspan;
-  
-    // Low degree specializations
-    switch (m_p)
+    if ( np > maxBatch )
     {
-    case 0: // constant B-splines
-        result.setOnes();
-        return;
-        
-    case 1:
-        for (index_t v = 0; v < u.cols(); ++v) // for all columns of u
-            if ( ! inDomain( u(0,v) ) )
-                result.col(v).setZero();
-            else
+        // Locate all points, and count the runs of points in the same span
+        std::vector<index_t> spanInd(np);
+        index_t runs = 0;
+        T a = 1, b = 0; // current span [a,b)
+        for (index_t v = 0; v < np; ++v)
+        {
+            if ( a <= u(0,v) && u(0,v) < b )
             {
-                kspan = m_knots.findspanIter ( u(0,v) );
-                bspline::evalDeg1Basis( u(0,v), kspan, m_p, result.col(v) );
+                spanInd[v] = spanInd[v-1];
+                continue;
             }
-        return;           
-    case 2:
-        for (index_t v = 0; v < u.cols(); ++v) // for all columns of u
-            if ( ! inDomain( u(0,v) ) )
-                result.col(v).setZero();
-            else
+            ++runs;
+            if ( inDomain( u(0,v) ) )
             {
-                kspan = m_knots.findspanIter ( u(0,v) );
-                bspline::evalDeg2Basis( u(0,v), kspan, m_p, result.col(v) );
+                typename KnotVectorType::iterator span = m_knots.iFind( u(0,v) );
+                spanInd[v] = span - m_knots.begin();
+                a = *span;
+                b = *(span+1);
             }
-        return;     
-    case 3:
-        for (index_t v = 0; v < u.cols(); ++v) // for all columns of u
-            if ( ! inDomain( u(0,v) ) )
-                result.col(v).setZero();
             else
             {
-                kspan = m_knots.findspanIter ( u(0,v) );
-                bspline::evalDeg3Basis( u(0,v), kspan, m_p, result.col(v) );
+                spanInd[v] = -1;
+                a = 1; b = 0;
             }
-        return;
-    };
-
-    STACK_ARRAY(T, left, m_p + 1);
-    STACK_ARRAY(T, right, m_p + 1);
+        }
 
-    for (index_t v = 0; v < u.cols(); ++v) // for all columns of u
-    {
-        // Check if the point is in the domain
-        if ( ! inDomain( u(0,v) ) )
+        // If the points are scattered over the knot spans, evaluate
+        // them bucketed by span
+        if ( 4 * runs > np )
         {
-            // gsWarn<< "Point "<< u(0,v) <<" not in the BSpline domain.\n";
-            result.col(v).setZero();
-        }
-        else
-        {   // Locate the point in the knot-vector
-            kspan = m_knots.findspanIter ( u(0,v) );
-            // Run evaluation algorithm
-            bspline::evalBasis( u(0,v), kspan, m_p, left, right, result.col(v) );
+            evalBucketed_into(u, spanInd, n, work, maxBatch, result);
+            return;
         }
     }
 
-#endif
-//#if (FALSE)
-    STACK_ARRAY(T, left, m_p + 1);
-    STACK_ARRAY(T, right, m_p + 1);
-
-    for (index_t v = 0; v < u.cols(); ++v) // for all columns of u
+    index_t v = 0;
+    while ( v < np )
     {
         // Check if the point is in the domain
         if ( ! inDomain( u(0,v) ) )
         {
             // gsWarn<< "Point "<< u(0,v) <<" not in the BSpline domain.\n";
-            result.col(v).setZero();
+            for(int k=0; k<=n; k++)
+                result[k].col(v).setZero();
+            ++v;
             continue;
         }
 
-        // Run evaluation algorithm
-    
-        // Get span of absissae
-        unsigned span = m_knots.iFind( u(0,v) ) - m_knots.begin() ;
+        // Locate the point, and group the following points of the same span
+        typename KnotVectorType::iterator span = m_knots.iFind( u(0,v) );
+        const T a = *span, b = *(span+1);
+        index_t e = v + 1;
+        while ( e < np && e - v < maxBatch && a <= u(0,e) && u(0,e) < b )
+            ++e;
 
-        //ndu[0]   = T(1);  // 0-th degree function value
-        result(0,v)= T(1);  // 0-th degree function value
+        bspline::evalBasisBatch(&u(0,v), e-v, span, m_p, n, work, result, v);
+        v = e;
+    }
+}
 
-        for(int j=1; j<= m_p; j++) // For all degrees ( ndu column)
-        {
-            left[j]  = u(0,v) - m_knots[span+1-j];
-            right[j] = m_knots[span+j] - u(0,v);
-            T saved = T(0) ;
+template <class T>
+void gsTensorBSplineBasis<1,T>::evalBucketed_into(const gsMatrix<T> & u,
+                                                  const std::vector<index_t> & spanInd,
+                                                  int n, T * work, index_t maxBatch,
+                                                  gsMatrix<T> * result) const
+{
+    const index_t np = u.cols();
 
-            for(int r=0; r<j ; r++) // For all (except the last)  basis functions of degree j ( ndu row)
-            {
-                // Strictly lower triangular part: Knot differences of distance j
-                //ndu[j*p1 + r] = right[r+1]+left[j-r] ;
-
-                //const T temp = ndu[r*p1 + j-1] / ndu[j*p1 + r] ;
-                const T temp = result(r,v) / ( right[r+1] + left[j-r] );
-                // Upper triangular part: Basis functions of degree j
-                //ndu[r*p1 + j] = saved + right[r+1] * temp ;// r-th function value of degree j
-                result(r,v)     = saved + right[r+1] * temp ;// r-th function value of degree j
-                saved = left[j-r] * temp ;
-            }  
-            //ndu[j*p1 + j] = saved ;// Diagonal: j-th (last) function value of degree j
-            result(j,v)     = saved;
+    // Counting sort of the points by span
+    std::vector<index_t> start(m_knots.size() + 1, 0), order(np);
+    for (index_t v = 0; v < np; ++v)
+    {
+        if ( spanInd[v] < 0 )
+        {
+            for(int k=0; k<=n; k++)
+                result[k].col(v).setZero();
         }
-
-    }// end for all columns v
-//#endif
+        else
+            ++start[spanInd[v] + 1];
+    }
+    std::partial_sum(start.begin(), start.end(), start.begin());
+    const index_t nin = start.back();
+    for (index_t v = 0; v < np; ++v)
+        if ( spanInd[v] >= 0 )
+            order[ start[spanInd[v]]++ ] = v;
+
+    // Gather the points of every span, evaluate, and scatter the results
+    gsMatrix<T> ub(1, maxBatch);
+    std::vector<gsMatrix<T> > tmp(n+1, gsMatrix<T>(m_p+1, maxBatch));
+    index_t i = 0;
+    while ( i < nin )
+    {
+        const index_t s = spanInd[order[i]];
+        index_t e = i + 1;
+        while ( e < nin && e - i < maxBatch && spanInd[order[e]] == s )
+            ++e;
+
+        for (index_t j = i; j < e; ++j)
+            ub(0, j-i) = u(0, order[j]);
+        bspline::evalBasisBatch(ub.data(), e-i, m_knots.begin() + s, m_p, n,
+                                work, &tmp.front(), 0);
+        for(int k=0; k<=n; k++)
+            for (index_t j = i; j < e; ++j)
+                result[k].col(order[j]) = tmp[k].col(j-i);
+        i = e;
+    }
 }
 
 
@@ -877,168 +892,13 @@ void gsTensorBSplineBasis<1,T>::
 evalAllDers_into(const gsMatrix<T> & u, int n, 
                  std::vector<gsMatrix<T> >& result) const
 {
-    // TO DO : Use less memory proportionally to n
-    // Only last n+1 columns and last n rows of ndu are needed
-    // Also a's size is proportional to n
     GISMO_ASSERT( u.rows() == 1 , "gsBSplineBasis accepts points with one coordinate.");
 
-    const int p1 = m_p + 1;       // degree plus one
-
-    STACK_ARRAY(T, ndu,  p1 * p1 );
-    STACK_ARRAY(T, left, p1);
-    STACK_ARRAY(T, right, p1);
-    STACK_ARRAY(T, a, 2 * p1);
-
     result.resize(n+1);
     for(int k=0; k<=n; k++)
         result[k].resize(m_p + 1, u.cols());
 
-#if FALSE
-
-    const int pn = m_p - n;
-
-    for (index_t v = 0; v < u.cols(); ++v) // for all columns of u
-    {
-        // Check if the point is in the domain
-        if ( ! inDomain( u(0,v) ) )
-        {
-            // gsWarn<< "Point "<< u(0,v) <<" not in the BSpline domain.\n";
-            for(int k=0; k<=n; k++)
-                result[k].col(v).setZero();
-            continue;
-        }
-
-        // Run evaluation algorithm and keep the function values triangle & the knot differences
-        unsigned span = m_knots.findspan( u(0,v) ) ;     // Get span of absissae
-    
-        for(int j=1; j<= m_p; j++) // For all degrees ( ndu column)
-        {
-            // Compute knot splits
-            left[j]  = u(0,v) - m_knots[span+1-j];
-            right[j] = m_knots[span+j] - u(0,v);
-        }
-
-        ndu[0] = T(1) ; // 0-th degree function value
-        T saved = T(0) ;
-        // Compute Basis functions of degree m_p-n ( ndu[] )
-        for(int r=0; r<pn ; r++) // For all (except the last) basis functions of degree m_p-n
-        {
-            const T temp = ndu[r*p1 + pn -1] / ( right[r+1] + left[pn-r] ) ;
-            ndu[r*p1 + pn] = saved + right[r+1] * temp ;// r-th function value of degree j
-            saved = left[pn-r] * temp ;
-        }  
-        ndu[pn*p1 + pn] = saved ;
-
-        // Compute n-th derivative and continue to n-1 ... 0
-
-        for(int r=0; r<pn ; r++) // For all (except the last)  basis functions of degree j ( ndu row)
-        {
-            // Strictly lower triangular part: Knot differences of distance j
-            ndu[j*p1 + r] = right[r+1]+left[j-r] ;
-            const T temp = ndu[r*p1 + j-1] / ndu[j*p1 + r] ;
-            // Upper triangular part: Basis functions of degree j
-            ndu[r*p1 + j] = saved + right[r+1] * temp ;// r-th function value of degree j
-            saved = left[j-r] * temp ;
-        }  
-        // Diagonal: j-th (last) function value of degree j
-        ndu[j*p1 + j] = saved ;
-    }
-    
-#endif
-
-    for (index_t v = 0; v < u.cols(); ++v) // for all columns of u
-    {
-
-        // Check if the point is in the domain
-        if ( ! inDomain( u(0,v) ) )
-        {
-            // gsWarn<< "Point "<< u(0,s) <<" not in the BSpline domain.\n";
-            for(int k=0; k<=n; k++)
-                result[k].col(v).setZero();
-            continue;
-        }
-
-        // Run evaluation algorithm and keep the function values triangle & the knot differences
-        typename KnotVectorType::iterator span = m_knots.iFind( u(0,v) );
-    
-        ndu[0] = T(1) ; // 0-th degree function value
-        for(int j=1; j<= m_p; j++) // For all degrees ( ndu column)
-        {
-            // Compute knot splits
-            left[j] = u(0,v) - *(span+1-j);
-            right[j] = *(span+j) - u(0,v);
-
-            T saved = T(0) ;
-
-            for(int r=0; r<j ; r++) // For all (except the last)  basis functions of degree j ( ndu row)
-            {
-                // Strictly lower triangular part: Knot differences of distance j
-                ndu[j*p1 + r] = right[r+1]+left[j-r] ;
-                const T temp = ndu[r*p1 + j-1] / ndu[j*p1 + r] ;
-                // Upper triangular part: Basis functions of degree j
-                ndu[r*p1 + j] = saved + right[r+1] * temp ;// r-th function value of degree j
-                saved = left[j-r] * temp ;
-            }  
-            // Diagonal: j-th (last) function value of degree j
-            ndu[j*p1 + j] = saved ;
-        }
-    
-        // Assign 0-derivative equal to function values
-        //result.front().block(0,v, p1,1) = ndu.col(m_p);
-        for (int j=0; j <= m_p ; ++j )
-            result.front()(j,v) = ndu[j*p1 + m_p];
-    
-        // Compute the derivatives
-        for(int r = 0; r <= m_p; r++)
-        {
-            // alternate rows in array a
-            T* a1 = &a[0];
-            T* a2 = &a[p1];
-
-            a1[0] = T(1) ;
-
-            // Compute the k-th derivative of the r-th basis function
-            for(int k=1; k<=n; k++)
-            {
-                int rk,pk,j1,j2 ;
-                T d(0) ;
-                rk = r-k ; pk = m_p-k ;
-        
-                if(r >= k)
-                {
-                    a2[0] = a1[0] / ndu[ (pk+1)*p1 + rk] ;
-                    d = a2[0] * ndu[rk*p1 + pk] ;
-                }
-        
-                j1 = ( rk >= -1  ? 1   : -rk     ); 
-                j2 = ( r-1 <= pk ? k-1 : m_p - r );
-	    
-                for(int j = j1; j <= j2; j++)
-                {
-                    a2[j] = (a1[j] - a1[j-1]) / ndu[(pk+1)*p1 + rk+j] ;
-                    d += a2[j] * ndu[(rk+j)*p1 + pk] ;
-                }
-        
-                if(r <= pk)
-                {
-                    a2[k] = -a1[k-1] / ndu[(pk+1)*p1 + r] ;
-                    d += a2[k] * ndu[r*p1 + pk] ;
-                }
-
-                result[k](r, v) = d;
-
-                std::swap(a1, a2);              // Switch rows
-            }
-        }
-    }// end for all columns v
-
-    // Multiply through by the factor factorial(m_p)/factorial(m_p-k)
-    int r = m_p ;
-    for(int k=1; k<=n; k++)
-    {
-        result[k].array() *= T(r) ;
-        r *= m_p - k ;
-    }
+    evalBatch_into(u, n, &result.front());
 }
 
 
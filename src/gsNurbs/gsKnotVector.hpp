@@ -48,10 +48,20 @@ public:
 
         typename gsKnotVector<T>::knotContainer knotValues;
 
-        std::istringstream str;
-        str.str( node->value() );
-        for (T knot; gsGetReal(str, knot);)
-            knotValues.push_back(knot);
+        if ( isBase64(node) )
+        {
+            std::vector<double> tmp;
+            GISMO_ENSURE( decodeBase64(node->value(), tmp),
+                          "Invalid binary data in KnotVector");
+            knotValues.assign(tmp.begin(), tmp.end());
+        }
+        else
+        {
+            // Read the numbers in place, from the buffer of the XML tree
+            const char * str = node->value();
+            for (T knot; parseValue(str, knot);)
+                knotValues.push_back(knot);
+        }
 
         result = gsKnotVector<T>(give(knotValues), p);
     }
@@ -59,21 +69,37 @@ public:
     static gsXmlNode * put (const gsKnotVector<T> & obj, gsXmlTree & data)
     {
         // Write the knot values (for now WITH multiplicities)
-        std::ostringstream str;
-        str << std::setprecision(REAL_DIG+1);
-
-        for ( typename gsKnotVector<T>::iterator it = obj.begin();
-              it != obj.end(); ++it )
+        gsXmlNode * tmp;
+        if ( gsXmlBinary() )
         {
-            str << *it <<" ";
+            std::vector<double> kv;
+            kv.reserve( obj.size() );
+            for ( typename gsKnotVector<T>::iterator it = obj.begin();
+                  it != obj.end(); ++it )
+                kv.push_back( toDouble(*it) );
+
+            // Make a new XML KnotVector node
+            tmp = internal::makeNode("KnotVector",
+                    encodeBase64(kv.empty() ? NULL : &kv[0], kv.size()), data);
+            setBase64(tmp, data);
+        }
+        else
+        {
+            std::string str;
+            str.reserve( obj.size() * (REAL_DIG + 8) );
+            for ( typename gsKnotVector<T>::iterator it = obj.begin();
+                  it != obj.end(); ++it )
+            {
+                formatValue(str, *it, REAL_DIG+1);
+                str += ' ';
+            }
+
+            // Make a new XML KnotVector node
+            tmp = internal::makeNode("KnotVector", str, data);
         }
 
-        // Make a new XML KnotVector node
-        gsXmlNode * tmp = internal::makeNode("KnotVector", str.str(), data);
         // Append the degree attribure
-        str.str(std::string());// clean the ostream
-        str<< obj.m_deg;
-        tmp->append_attribute( makeAttribute("degree", str.str(),data) );
+        tmp->append_attribute( makeAttribute("degree", obj.m_deg, data) );
 
         return tmp;
     }
@@ -94,6 +94,12 @@ public:
     /// \brief Set the tolerance for convergence
     void setTolerance(T tol) {m_tolerance = tol;}
 
+    /// \brief Keeps the basis and geometry evaluations of the first
+    /// iteration and reuses them in the following ones (see
+    /// gsAssembler::setAssemblyPlan)
+    void setAssemblyPlan(bool on, size_t memBudget = 0)
+    { m_assembler.setAssemblyPlan(on, memBudget); }
+
 protected:
 
     virtual void solveLinearProblem(gsMatrix<T> &updateVector);
@@ -244,6 +244,19 @@ public:
     virtual void evalAllDers_into(const gsMatrix<T> & u, int n,
                                   std::vector<gsMatrix<T> >& result) const;
 
+    /// @brief Evaluates the values (\a n=0), gradients (\a n=1) and
+    /// Hessians (\a n=2) of the non-zero basis functions at the
+    /// columns of \a u in one pass over the tensor functions.
+    ///
+    /// By default the layout is that of evalAllDers_into(): one column
+    /// per point (points-major). If \a funcMajor is true, the
+    /// transposed matrices are computed: one row per point and one
+    /// column per function (and derivative component), so that the
+    /// values of every function at all points are contiguous.
+    void evalAllDersFused_into(const gsMatrix<T> & u, int n,
+                               std::vector<gsMatrix<T> >& result,
+                               bool funcMajor = false) const;
+
     // see gsBasis for doxygen documentation
     // Evaluates the gradient the non-zero basis functions at value u.
     virtual void deriv_into(const gsMatrix<T> & u, gsMatrix<T>& result ) const;
@@ -267,6 +280,16 @@ private:
                    const gsVector<unsigned, d> & size,
                    gsMatrix<T>& result);
 
+    // Internal function
+    //
+    // Writes the value, the gradient (n>0) and the Hessian (n>1) of
+    // the tensor function number r at the point number j, given the
+    // univariate values, first and second derivatives b[0..2][i] of
+    // its factors. Entry (row) of out[m] is at row*sr[m] + j*sp[m].
+    static inline void tensorDers_into(const T b[][d], int n,
+                                       T * const out[], index_t r, index_t j,
+                                       const index_t sr[], const index_t sp[]);
+
 public:
     // see gsBasis for doxygen documentation
     // Evaluate the i-th basis function derivative at all columns of
@@ -665,6 +665,12 @@ void gsTensorBasis<d,T>::evalAllDers_into(const gsMatrix<T> & u, int n,
         return;
     }
 
+    if (n<=2)
+    {
+        evalAllDersFused_into(u, n, result);
+        return;
+    }
+
     std::vector< gsMatrix<T> >values[d];
     gsVector<unsigned, d> v, nb_cwise;
     result.resize(n+1);
@@ -750,6 +756,124 @@ void gsTensorBasis<d,T>::evalAllDers_into(const gsMatrix<T> & u, int n,
 
 }
 
+template<unsigned d, class T>
+void gsTensorBasis<d,T>::evalAllDersFused_into(const gsMatrix<T> & u, int n,
+                                               std::vector<gsMatrix<T> >& result,
+                                               bool funcMajor) const
+{
+    GISMO_ASSERT(0<=n && n<=2, "Fused evaluation is implemented only for 0<=n<=2");
+
+    std::vector< gsMatrix<T> >values[d];
+    gsVector<unsigned, d> v, nb_cwise;
+    for (unsigned i = 0; i < d; ++i)
+    {
+        // evaluate basis functions/derivatives
+        m_bases[i]->evalAllDers_into( u.row(i), n, values[i] );
+        nb_cwise[i] = values[i].front().rows();
+    }
+    const index_t nb = nb_cwise.prod();
+    const index_t np = u.cols();
+
+    // Number of components per function, row stride and point stride
+    const index_t nc[3] = { 1, d, d*(d+1)/2 };
+    index_t sr[3], sp[3];
+    T * out[3];
+    result.resize(n+1);
+    for (int m = 0; m <= n; ++m)
+    {
+        if ( funcMajor )
+        {
+            result[m].resize(np, nc[m]*nb);
+            sr[m] = np;
+            sp[m] = 1;
+        }
+        else
+        {
+            result[m].resize(nc[m]*nb, np);
+            sr[m] = 1;
+            sp[m] = nc[m]*nb;
+        }
+        out[m] = result[m].data();
+    }
+
+    // Factors of the current function at the current point
+    T b[3][d];
+
+    if ( funcMajor ) // for all functions, for all points
+    {
+        v.setZero();
+        index_t r = 0;
+        do
+        {
+            for (index_t j = 0; j != np; ++j)
+            {
+                for (int m = 0; m <= n; ++m)
+                    for (unsigned i = 0; i != d; ++i)
+                        b[m][i] = values[i][m](v[i], j);
+                tensorDers_into(b, n, out, r, j, sr, sp);
+            }
+            ++r;
+        } while (nextLexicographic(v, nb_cwise));
+    }
+    else // for all points, for all functions
+    {
+        for (index_t j = 0; j != np; ++j)
+        {
+            v.setZero();
+            index_t r = 0;
+            do
+            {
+                for (int m = 0; m <= n; ++m)
+                    for (unsigned i = 0; i != d; ++i)
+                        b[m][i] = values[i][m](v[i], j);
+                tensorDers_into(b, n, out, r, j, sr, sp);
+                ++r;
+            } while (nextLexicographic(v, nb_cwise));
+        }
+    }
+}
+
+template<unsigned d, class T>
+inline void gsTensorBasis<d,T>::tensorDers_into(const T b[][d], int n,
+                                                T * const out[], index_t r, index_t j,
+                                                const index_t sr[], const index_t sp[])
+{
+    // pre[k]: product of the values in the directions before k,
+    // suf[k]: product of the values in the directions k and after
+    T pre[d+1], suf[d+1];
+    pre[0] = suf[d] = T(1);
+    for (unsigned i = 0; i != d; ++i)
+    {
+        pre[i+1]   = pre[i]   * b[0][i];
+        suf[d-i-1] = suf[d-i] * b[0][d-i-1];
+    }
+
+    out[0][r*sr[0] + j*sp[0]] = pre[d];
+    if ( n < 1 ) return;
+
+    T * grad = out[1] + j*sp[1];
+    for (unsigned k = 0; k != d; ++k)
+        grad[(r*d+k)*sr[1]] = b[1][k] * pre[k] * suf[k+1];
+    if ( n < 2 ) return;
+
+    // Pure second derivatives first, then the mixed ones in lex order
+    const index_t stride = d + d*(d-1)/2;
+    T * hess = out[2] + j*sp[2];
+    index_t m = d;
+    for (unsigned k = 0; k != d; ++k)
+    {
+        hess[(r*stride+k)*sr[2]] = b[2][k] * pre[k] * suf[k+1];
+
+        T mid = T(1); // product of the values between k and l
+        for (unsigned l = k+1; l < d; ++l)
+        {
+            hess[(r*stride+m)*sr[2]] = b[1][k] * b[1][l] * pre[k] * mid * suf[l+1];
+            mid *= b[0][l];
+            ++m;
+        }
+    }
+}
+
 template<unsigned d, class T>
 void gsTensorBasis<d,T>::deriv2_into(const gsMatrix<T> & u, 
                                            gsMatrix<T>& result ) const 
@@ -0,0 +1,144 @@
+/** @file gsBoxTree.h
+
+    @brief Provides a bounding volume hierarchy of axis-aligned boxes
+    for point containment queries.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsCore/gsLinearAlgebra.h>
+
+namespace gismo
+{
+
+/** @brief A bounding volume hierarchy over a static set of
+    axis-aligned boxes.
+
+    Like gsKdTree, the tree is stored implicitly in a permutation of
+    the box indices: the node of the range <em>[lo,hi)</em> is the box
+    at position <em>mid=(lo+hi)/2</em>, and the bounding box of all
+    the boxes of the range is stored at the same position. The boxes
+    are split at the median of their centers along the direction of
+    largest extent. Queries are const and can be run concurrently.
+
+    Example:
+    \code
+    gsBoxTree<> tree(lower, upper); // corners of the boxes, d x n each
+    std::vector<index_t> boxes;
+    tree.query(point, boxes);       // indices of the boxes which contain point
+    \endcode
+
+    \ingroup Utils
+*/
+template<class T = real_t>
+class gsBoxTree
+{
+public:
+
+    /// Builds the tree of the boxes with lower corners the columns
+    /// of \a lower and upper corners the columns of \a upper
+    gsBoxTree(const gsMatrix<T> & lower, const gsMatrix<T> & upper)
+    : m_lower(lower), m_upper(upper), m_index(lower.cols()),
+      m_nodeLower(lower.rows(), lower.cols()), m_nodeUpper(lower.rows(), lower.cols())
+    {
+        GISMO_ASSERT( lower.rows() == upper.rows() && lower.cols() == upper.cols(),
+                      "Invalid box corners");
+        for (index_t i = 0; i != m_lower.cols(); ++i)
+            m_index[i] = i;
+        build(0, m_lower.cols());
+    }
+
+    /// Returns the number of boxes in the tree
+    index_t size() const { return m_lower.cols(); }
+
+    /// Appends to \a result the indices of the boxes which contain \a x
+    template<class Derived>
+    void query(const Eigen::MatrixBase<Derived> & x, std::vector<index_t> & result) const
+    {
+        GISMO_ASSERT( x.size() == m_lower.rows(), "Wrong point dimension");
+        const gsVector<T> p = x;
+        search(p, 0, m_lower.cols(), result);
+    }
+
+private:
+
+    void build(index_t lo, index_t hi)
+    {
+        if ( lo >= hi ) return;
+
+        const index_t mid = (lo + hi) / 2;
+
+        // Bounding box of the range
+        m_nodeLower.col(mid) = m_lower.col(m_index[lo]);
+        m_nodeUpper.col(mid) = m_upper.col(m_index[lo]);
+        for (index_t i = lo + 1; i != hi; ++i)
+        {
+            m_nodeLower.col(mid) = m_nodeLower.col(mid).cwiseMin( m_lower.col(m_index[i]) );
+            m_nodeUpper.col(mid) = m_nodeUpper.col(mid).cwiseMax( m_upper.col(m_index[i]) );
+        }
+        if ( hi - lo == 1 ) return;
+
+        // Split at the median center along the direction of largest extent
+        index_t dir = 0;
+        for (index_t k = 1; k != m_lower.rows(); ++k)
+            if ( m_nodeUpper(k, mid) - m_nodeLower(k, mid) >
+                 m_nodeUpper(dir, mid) - m_nodeLower(dir, mid) )
+                dir = k;
+        std::nth_element(m_index.begin() + lo, m_index.begin() + mid,
+                         m_index.begin() + hi, centerLess(*this, dir));
+        build(lo, mid);
+        build(mid + 1, hi);
+    }
+
+    void search(const gsVector<T> & x, index_t lo, index_t hi,
+                std::vector<index_t> & result) const
+    {
+        if ( lo >= hi ) return;
+
+        const index_t mid = (lo + hi) / 2;
+        if ( (x.array() < m_nodeLower.col(mid).array()).any() ||
+             (x.array() > m_nodeUpper.col(mid).array()).any() )
+            return;
+
+        const index_t cur = m_index[mid];
+        if ( (x.array() >= m_lower.col(cur).array()).all() &&
+             (x.array() <= m_upper.col(cur).array()).all() )
+            result.push_back(cur);
+
+        search(x, lo, mid, result);
+        search(x, mid + 1, hi, result);
+    }
+
+    struct centerLess
+    {
+        centerLess(const gsBoxTree & tree, index_t dir) : m_tree(tree), m_d(dir) { }
+        bool operator()(index_t a, index_t b) const
+        {
+            return m_tree.m_lower(m_d, a) + m_tree.m_upper(m_d, a)
+                <  m_tree.m_lower(m_d, b) + m_tree.m_upper(m_d, b);
+        }
+        const gsBoxTree & m_tree;
+        index_t m_d;
+    };
+
+private:
+
+    // Corners of the boxes
+    gsMatrix<T> m_lower, m_upper;
+
+    // Permutation of the boxes, which stores the tree
+    std::vector<index_t> m_index;
+
+    // Bounding boxes of the ranges, at the position of their nodes
+    gsMatrix<T> m_nodeLower, m_nodeUpper;
+};
+
+} // namespace gismo
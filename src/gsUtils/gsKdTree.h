@@ -0,0 +1,156 @@
+/** @file gsKdTree.h
+
+    @brief Provides a k-d tree for nearest neighbor queries on a
+    static set of points.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsCore/gsLinearAlgebra.h>
+
+namespace gismo
+{
+
+/** @brief A balanced k-d tree over the columns of a matrix of points.
+
+    The tree is stored implicitly in a permutation of the point
+    indices: the node of the range <em>[lo,hi)</em> is the point at
+    position <em>mid=(lo+hi)/2</em>, which splits the range along the
+    direction of largest extent. Construction is \f$O(n\log n)\f$,
+    a nearest point query is \f$O(\log n)\f$ on average. Queries are
+    const and can be run concurrently.
+
+    Example:
+    \code
+    gsKdTree<> tree(samples);             // samples: d x n
+    index_t k = tree.nearest(point);      // column of the closest sample
+    \endcode
+
+    \ingroup Utils
+*/
+template<class T = real_t>
+class gsKdTree
+{
+public:
+
+    /// Builds the tree of the columns of \a points
+    explicit gsKdTree(const gsMatrix<T> & points)
+    : m_points(points), m_index(points.cols()), m_dir(points.cols(), 0)
+    {
+        for (index_t i = 0; i != m_points.cols(); ++i)
+            m_index[i] = i;
+        build(0, m_points.cols());
+    }
+
+    /// Returns the number of points in the tree
+    index_t size() const { return m_points.cols(); }
+
+    /// Returns the points of the tree (as columns)
+    const gsMatrix<T> & points() const { return m_points; }
+
+    /// Returns the column index of the point of the tree which is
+    /// closest to \a x, or -1 if the tree is empty
+    template<class Derived>
+    index_t nearest(const Eigen::MatrixBase<Derived> & x) const
+    {
+        GISMO_ASSERT( x.size() == m_points.rows(), "Wrong point dimension");
+        index_t best = -1;
+        T bestDist = std::numeric_limits<T>::max();
+        const gsVector<T> p = x;
+        search(p, 0, m_points.cols(), best, bestDist);
+        return best;
+    }
+
+private:
+
+    void build(index_t lo, index_t hi)
+    {
+        if ( hi - lo < 2 ) return;
+
+        // Split along the direction of largest extent
+        index_t dir = 0;
+        T ext = -1;
+        for (index_t k = 0; k != m_points.rows(); ++k)
+        {
+            T lower = m_points(k, m_index[lo]), upper = lower;
+            for (index_t i = lo + 1; i != hi; ++i)
+            {
+                lower = math::min(lower, m_points(k, m_index[i]));
+                upper = math::max(upper, m_points(k, m_index[i]));
+            }
+            if ( upper - lower > ext )
+            {
+                ext = upper - lower;
+                dir = k;
+            }
+        }
+
+        const index_t mid = (lo + hi) / 2;
+        std::nth_element(m_index.begin() + lo, m_index.begin() + mid,
+                         m_index.begin() + hi, coordLess(m_points, dir));
+        m_dir[mid] = dir;
+        build(lo, mid);
+        build(mid + 1, hi);
+    }
+
+    void search(const gsVector<T> & x, index_t lo, index_t hi,
+                index_t & best, T & bestDist) const
+    {
+        if ( lo >= hi ) return;
+
+        const index_t mid = (lo + hi) / 2;
+        const index_t cur = m_index[mid];
+        const T dist = (m_points.col(cur) - x).squaredNorm();
+        if ( dist < bestDist )
+        {
+            bestDist = dist;
+            best     = cur;
+        }
+        if ( hi - lo == 1 ) return;
+
+        // Descend on the side of x first, then on the other side if
+        // the splitting plane is closer than the best point so far
+        const T diff = x[m_dir[mid]] - m_points(m_dir[mid], cur);
+        if ( diff < 0 )
+        {
+            search(x, lo, mid, best, bestDist);
+            if ( diff * diff < bestDist )
+                search(x, mid + 1, hi, best, bestDist);
+        }
+        else
+        {
+            search(x, mid + 1, hi, best, bestDist);
+            if ( diff * diff < bestDist )
+                search(x, lo, mid, best, bestDist);
+        }
+    }
+
+    struct coordLess
+    {
+        coordLess(const gsMatrix<T> & pts, index_t dir) : m_pts(pts), m_d(dir) { }
+        bool operator()(index_t a, index_t b) const
+        { return m_pts(m_d, a) < m_pts(m_d, b); }
+        const gsMatrix<T> & m_pts;
+        index_t m_d;
+    };
+
+private:
+
+    gsMatrix<T> m_points;
+
+    // Permutation of the points, which stores the tree
+    std::vector<index_t> m_index;
+
+    // Splitting direction of the node at every position of m_index
+    std::vector<index_t> m_dir;
+};
+
+} // namespace gismo
@@ -0,0 +1,185 @@
+/** @file gsIndexedMesh.h
+
+    @brief Provides declaration of the gsIndexedMesh class, a mesh
+    stored in flat arrays.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsUtils/gsMesh/gsMesh.h>
+#include <gsMatrix/gsAsMatrix.h>
+
+namespace gismo {
+
+/**
+   \brief Class Representing a polygonal mesh with 3D vertices, stored
+   in flat arrays.
+
+   The coordinates of the vertices are stored one after the other in
+   a single array, and the faces as lists of vertex indices, one after
+   the other in a single index array together with the position of the
+   first index of every face (as the rows of a compressed sparse
+   matrix). The edges are pairs of vertex indices. Compared to gsMesh,
+   there is no object per vertex or face, so large meshes, eg. read
+   from STL files, take a few bytes per triangle and are traversed
+   linearly in memory.
+
+   Optionally, half-edge adjacency is stored in arrays as well (see
+   computeHalfEdges): the half-edge \a h is the side of a face from
+   its vertex faceIndices()[h] to the next vertex of the face.
+
+   gsMesh can be converted to and from an indexed mesh, eg. to use
+   the algorithms which modify the mesh elements in place, such as
+   gsTriMeshToSolid. The converted gsMesh has one object per vertex,
+   edge and face again, so these algorithms need as much memory as
+   without the indexed mesh; gsTriMeshToSolid can only use the
+   half-edges for the adjacency of the faces.
+
+   \ingroup Utils
+*/
+template <class T>
+class gsIndexedMesh
+{
+public:
+
+    gsIndexedMesh() : m_faceStart(1, 0) { }
+
+    /// Copies the mesh \a mesh, whose vertices are numbered by their
+    /// position
+    explicit gsIndexedMesh(const gsMesh<T> & mesh);
+
+public:
+
+    /// Number of vertices
+    index_t numVertices() const { return static_cast<index_t>(m_coords.size() / 3); }
+
+    /// Number of faces
+    index_t numFaces() const { return static_cast<index_t>(m_faceStart.size() - 1); }
+
+    /// Number of edges
+    index_t numEdges() const { return static_cast<index_t>(m_edges.size() / 2); }
+
+    /// Prepares the arrays for \a nv vertices, \a nf faces with \a
+    /// ni vertex indices in total, and \a ne edges
+    void reserve(size_t nv, size_t nf, size_t ni, size_t ne = 0);
+
+    /// Removes all vertices, faces, edges and half-edges
+    void clear();
+
+    /// Adds a vertex and returns its index
+    index_t addVertex(T x, T y, T z = 0)
+    {
+        m_coords.push_back(x);
+        m_coords.push_back(y);
+        m_coords.push_back(z);
+        return numVertices() - 1;
+    }
+
+    /// Adds a face with the \a n vertices \a vert and returns its index
+    index_t addFace(const index_t * vert, index_t n);
+
+    /// Adds a triangle and returns its index
+    index_t addFace(index_t v0, index_t v1, index_t v2)
+    {
+        const index_t v[3] = {v0, v1, v2};
+        return addFace(v, 3);
+    }
+
+    /// Adds an edge between the vertices \a v0 and \a v1
+    void addEdge(index_t v0, index_t v1)
+    {
+        m_edges.push_back(v0);
+        m_edges.push_back(v1);
+    }
+
+    /// Coordinate \a i of the vertex \a v
+    T coord(index_t v, int i) const { return m_coords[3*v+i]; }
+
+    /// The coordinates of the vertices, three per vertex
+    const std::vector<T> & coordinates() const { return m_coords; }
+
+    /// The coordinates of the vertices as a 3 x numVertices() matrix
+    gsAsConstMatrix<T> vertices() const
+    { return gsAsConstMatrix<T>(m_coords, 3, numVertices()); }
+
+    /// Number of vertices of the face \a f
+    index_t faceSize(index_t f) const { return m_faceStart[f+1] - m_faceStart[f]; }
+
+    /// The vertices of the face \a f
+    const index_t * faceVertices(index_t f) const { return &m_faceIndex[m_faceStart[f]]; }
+
+    /// The position of the first vertex of every face in
+    /// faceIndices(), and the number of indices at the end
+    const std::vector<index_t> & faceOffsets() const { return m_faceStart; }
+
+    /// The vertices of all faces, one face after the other
+    const std::vector<index_t> & faceIndices() const { return m_faceIndex; }
+
+    /// The end points of all edges, two per edge
+    const std::vector<index_t> & edges() const { return m_edges; }
+
+    /// Appends the vertices, faces and edges to \a mesh
+    void toMesh(gsMesh<T> & mesh) const;
+
+    std::ostream &print(std::ostream &os) const;
+
+public: // Half-edges
+
+    /// Computes the half-edge adjacency of the faces; the
+    /// adjacency is dropped when faces are added
+    void computeHalfEdges();
+
+    /// Returns true if the half-edge adjacency is computed
+    bool hasHalfEdges() const { return !m_faceIndex.empty() && m_twin.size() == m_faceIndex.size(); }
+
+    /// Number of half-edges, one per vertex of every face
+    index_t numHalfEdges() const { return static_cast<index_t>(m_faceIndex.size()); }
+
+    /// The vertex where the half-edge \a h starts
+    index_t origin(index_t h) const { return m_faceIndex[h]; }
+
+    /// The face of the half-edge \a h
+    index_t face(index_t h) const { return m_heFace[h]; }
+
+    /// The next half-edge of the face of \a h
+    index_t next(index_t h) const
+    { return h + 1 == m_faceStart[m_heFace[h]+1] ? m_faceStart[m_heFace[h]] : h + 1; }
+
+    /// The half-edge of the neighbouring face, in opposite direction,
+    /// or -1 if \a h is on the boundary. If more than two faces meet
+    /// at an edge (non-manifold edge), the edge is treated as
+    /// boundary edge for all of them
+    index_t twin(index_t h) const { return m_twin[h]; }
+
+private:
+
+    std::vector<T>       m_coords;
+
+    std::vector<index_t> m_faceStart;
+    std::vector<index_t> m_faceIndex;
+
+    std::vector<index_t> m_edges;
+
+    // Half-edge adjacency
+    std::vector<index_t> m_twin;
+    std::vector<index_t> m_heFace;
+};
+
+/// Print (as string) operator
+template<class T>
+std::ostream &operator<<(std::ostream &os, const gsIndexedMesh<T>& m)
+{ return m.print(os); }
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsIndexedMesh.hpp)
+#endif
@@ -0,0 +1,155 @@
+/** @file gsIndexedMesh.hpp
+
+    @brief Provides implementation of the gsIndexedMesh class.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <algorithm>
+
+namespace gismo {
+
+template<class T>
+gsIndexedMesh<T>::gsIndexedMesh(const gsMesh<T> & mesh)
+: m_faceStart(1, 0)
+{
+    size_t ni = 0;
+    for (size_t i = 0; i != mesh.face.size(); ++i)
+        ni += mesh.face[i]->vertices.size();
+    reserve(mesh.vertex.size(), mesh.face.size(), ni, mesh.edge.size());
+
+    for (size_t i = 0; i != mesh.vertex.size(); ++i)
+    {
+        GISMO_ASSERT( mesh.vertex[i]->getId() == static_cast<int>(i),
+                      "Vertex "<< i <<" has the id "<< mesh.vertex[i]->getId() );
+        const gsVector3d<T> & c = mesh.vertex[i]->coords;
+        addVertex(c.x(), c.y(), c.z());
+    }
+
+    for (size_t i = 0; i != mesh.face.size(); ++i)
+    {
+        const std::vector<typename gsMesh<T>::VertexHandle> & v = mesh.face[i]->vertices;
+        for (size_t j = 0; j != v.size(); ++j)
+            m_faceIndex.push_back( v[j]->getId() );
+        m_faceStart.push_back( static_cast<index_t>(m_faceIndex.size()) );
+    }
+
+    for (size_t i = 0; i != mesh.edge.size(); ++i)
+        addEdge(mesh.edge[i].source->getId(), mesh.edge[i].target->getId());
+}
+
+template<class T>
+void gsIndexedMesh<T>::reserve(size_t nv, size_t nf, size_t ni, size_t ne)
+{
+    m_coords.reserve(3 * nv);
+    m_faceStart.reserve(nf + 1);
+    m_faceIndex.reserve(ni);
+    m_edges.reserve(2 * ne);
+}
+
+template<class T>
+void gsIndexedMesh<T>::clear()
+{
+    m_coords.clear();
+    m_faceStart.assign(1, 0);
+    m_faceIndex.clear();
+    m_edges.clear();
+    m_twin.clear();
+    m_heFace.clear();
+}
+
+template<class T>
+index_t gsIndexedMesh<T>::addFace(const index_t * vert, index_t n)
+{
+    GISMO_ASSERT( n >= 3, "A face needs at least three vertices");
+    for (index_t j = 0; j != n; ++j)
+    {
+        GISMO_ASSERT( vert[j] >= 0 && vert[j] < numVertices(),
+                      "Invalid vertex index "<< vert[j] <<" (numVertices="
+                      << numVertices() <<")." );
+        m_faceIndex.push_back(vert[j]);
+    }
+    m_faceStart.push_back( static_cast<index_t>(m_faceIndex.size()) );
+    m_twin.clear();
+    m_heFace.clear();
+    return numFaces() - 1;
+}
+
+template<class T>
+void gsIndexedMesh<T>::toMesh(gsMesh<T> & mesh) const
+{
+    const size_t first = mesh.vertex.size();
+    mesh.vertex.reserve(first + numVertices());
+    mesh.face.reserve(mesh.face.size() + numFaces());
+    for (index_t v = 0; v != numVertices(); ++v)
+        mesh.addVertex(coord(v,0), coord(v,1), coord(v,2));
+
+    std::vector<typename gsMesh<T>::VertexHandle> verts;
+    for (index_t f = 0; f != numFaces(); ++f)
+    {
+        verts.resize(faceSize(f));
+        const index_t * fv = faceVertices(f);
+        for (index_t j = 0; j != faceSize(f); ++j)
+            verts[j] = mesh.vertex[first + fv[j]];
+        mesh.addFace(verts);
+    }
+
+    for (index_t e = 0; e != numEdges(); ++e)
+        mesh.addEdge(mesh.vertex[first + m_edges[2*e]], mesh.vertex[first + m_edges[2*e+1]]);
+}
+
+template<class T>
+void gsIndexedMesh<T>::computeHalfEdges()
+{
+    const index_t nh = numHalfEdges();
+    m_heFace.resize(nh);
+    for (index_t f = 0; f != numFaces(); ++f)
+        std::fill(m_heFace.begin() + m_faceStart[f], m_heFace.begin() + m_faceStart[f+1], f);
+
+    // Sort the half-edges by their end points, the smaller first, so
+    // that the half-edges of every edge are next to each other
+    std::vector<std::pair<std::pair<index_t,index_t>, index_t> > key(nh);
+    for (index_t h = 0; h != nh; ++h)
+    {
+        const index_t a = origin(h), b = origin(next(h));
+        key[h] = std::make_pair(std::make_pair(math::min(a,b), math::max(a,b)), h);
+    }
+    std::sort(key.begin(), key.end());
+
+    // Edges with exactly two half-edges in opposite directions
+    // are interior edges
+    m_twin.assign(nh, -1);
+    for (index_t i = 0; i != nh; )
+    {
+        index_t j = i + 1;
+        while ( j != nh && key[j].first == key[i].first ) ++j;
+        if ( j == i + 2 )
+        {
+            const index_t h = key[i].second, g = key[i+1].second;
+            if ( origin(h) != origin(g) )
+            {
+                m_twin[h] = g;
+                m_twin[g] = h;
+            }
+        }
+        i = j;
+    }
+}
+
+template<class T>
+std::ostream & gsIndexedMesh<T>::print(std::ostream &os) const
+{
+    os<<"gsIndexedMesh with "<<numVertices()<<" vertices, "<<numEdges()<<
+        " edges and "<<numFaces()<<" faces.\n";
+    return os;
+}
+
+} // namespace gismo
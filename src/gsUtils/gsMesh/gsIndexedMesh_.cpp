@@ -0,0 +1,11 @@
+#include <gsCore/gsTemplateTools.h>
+
+#include <gsUtils/gsMesh/gsIndexedMesh.h>
+#include <gsUtils/gsMesh/gsIndexedMesh.hpp>
+
+namespace gismo
+{
+
+    CLASS_TEMPLATE_INST gsIndexedMesh<real_t> ;
+
+}
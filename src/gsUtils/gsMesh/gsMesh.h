@@ -18,6 +18,7 @@
 #include <gsUtils/gsMesh/gsFace.h>
 #include <gsUtils/gsMesh/gsEdge.h>
 #include <gsUtils/gsSortedVector.h>
+#include <gsUtils/gsMesh/gsVertexWelder.h>
 
 
 namespace gismo {
@@ -135,8 +136,14 @@ public:
 //    }
 
     /** \brief reorders the vertices of all faces of an .stl mesh, such that only 1 vertex is used instead of #(adjacent triangles) vertices
+
+        The vertices which differ by at most \a tolerance in every
+        coordinate are welded to the first one of them; they are
+        found by hashing in linear expected time. If \a compact is
+        true, the duplicate vertices are deleted and the remaining
+        ones renumbered, otherwise they stay unused in the mesh.
      */
-    void cleanStlMesh();
+    void cleanStlMesh(T tolerance = 0, bool compact = false);
 
 
 public:
@@ -163,7 +163,7 @@ std::ostream &gsMesh<T>::print(std::ostream &os) const
 
 
 template <class T>
-void gsMesh<T>::cleanStlMesh()
+void gsMesh<T>::cleanStlMesh(T tolerance, bool compact)
 {
     gsWarn<<"Cleaning the stl mesh..."<<"\n";
     
@@ -173,25 +173,26 @@ void gsMesh<T>::cleanStlMesh()
     // vertices. The old way was more efficient but did not work for
     // non-manifold solids.
     
-    // build up the unique map
-    std::vector<int> uniquemap;
+    // build up the unique map: the duplicates are found by hashing
+    // the coordinates, and the first vertex of every point is chosen
+    gsVertexWelder<T> welder(tolerance, vertex.size());
+    std::vector<int> uniquemap(vertex.size());
+    std::vector<int> chosen;
+    chosen.reserve(vertex.size());
     for(std::size_t i = 0; i < vertex.size(); i++)
     {
-        std::size_t buddy = i;
-        for(std::size_t j = 0; j < i; j++)
-        {
-            if(*(vertex[i]) == *(vertex[j])) // overload compares coords
-            {
-                buddy = j;
-                break;
-            }
-        }
-        uniquemap.push_back(buddy);
+        GISMO_ASSERT( vertex[i]->getId() == static_cast<int>(i),
+                      "Vertex "<< i <<" has the id "<< vertex[i]->getId() );
+        const gsVector3d<T> & c = vertex[i]->coords;
+        const std::size_t k = welder.insert(c.x(), c.y(), c.z());
+        if ( k == chosen.size() )
+            chosen.push_back(i);
+        uniquemap[i] = chosen[k];
     }
     
     for(std::size_t i = 0; i < face.size(); i++)
     {
-        for(std::size_t j = 0; j < 3; j++)
+        for(std::size_t j = 0; j < face[i]->vertices.size(); j++)
         {
             face[i]->vertices[j] = vertex[uniquemap[face[i]->vertices[j]->getId()]];
         }
@@ -202,7 +203,41 @@ void gsMesh<T>::cleanStlMesh()
         edge[i].source = vertex[uniquemap[edge[i].source->getId()]];
         edge[i].target = vertex[uniquemap[edge[i].target->getId()]];
     }
+    if ( 0 != tolerance ) // the coordinates of the end points changed
+    {
+        edge.SetSorted(false);
+        edge.sort();
+    }
 
+    if ( !compact || chosen.size() == vertex.size() )
+        return;
+
+    // Move the adjacency of the duplicates to the chosen vertices,
+    // delete the duplicates and renumber the remaining ones
+    for(std::size_t i = 0; i < vertex.size(); i++)
+    {
+        VertexHandle v = vertex[i];
+        for(std::size_t j = 0; j < v->nVertices.size(); j++)
+            v->nVertices[j] = vertex[uniquemap[v->nVertices[j]->getId()]];
+        if ( uniquemap[i] != static_cast<int>(i) )
+        {
+            VertexHandle u = vertex[uniquemap[i]];
+            u->faces    .insert(u->faces    .end(), v->faces    .begin(), v->faces    .end());
+            u->nVertices.insert(u->nVertices.end(), v->nVertices.begin(), v->nVertices.end());
+        }
+    }
+    for(std::size_t i = 0; i < vertex.size(); i++)
+    {
+        if ( uniquemap[i] != static_cast<int>(i) )
+            delete vertex[i];
+    }
+    for(std::size_t k = 0; k < chosen.size(); k++)
+    {
+        vertex[k] = vertex[chosen[k]]; // chosen[k] >= k
+        vertex[k]->setId(k);
+    }
+    vertex.resize(chosen.size());
+    numVertices = vertex.size();
 }
 
 
@@ -0,0 +1,214 @@
+/** @file gsVertexWelder.h
+
+    @brief Provides the gsVertexWelder class, which finds duplicate
+    points of a point cloud by hashing.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): A. Mantzaflaris
+*/
+
+#pragma once
+
+#include <gsCore/gsConfig.h>
+#include <gsCore/gsDebug.h>
+#include <gsCore/gsMath.h>
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace gismo {
+
+/**
+   \brief Numbers the distinct points of a sequence of 3D points, eg.
+   to weld the duplicate vertices of a triangle soup (STL mesh).
+
+   Every point inserted gets the index of the first point inserted
+   before which is equal to it, or a new index if there is none. With
+   a positive tolerance, two points are equal if they differ by at
+   most the tolerance in every coordinate.
+
+   The points found so far are kept in a hash table: with zero
+   tolerance, it is keyed on the coordinates, otherwise on the cell of
+   a grid of cell size equal to the tolerance, and the 27 cells around
+   a point are searched. Inserting a point takes constant expected
+   time. T is a built-in floating point type.
+
+   \ingroup Utils
+*/
+template <class T>
+class gsVertexWelder
+{
+public:
+
+    /// Welder of the points which differ by at most \a tolerance in
+    /// every coordinate, for about \a sizeHint distinct points
+    explicit gsVertexWelder(T tolerance = 0, size_t sizeHint = 0)
+    : m_tol(tolerance), m_mask(0)
+    {
+        GISMO_ASSERT( tolerance >= 0, "gsVertexWelder: negative tolerance");
+        reserve(sizeHint);
+    }
+
+    /// Number of distinct points inserted
+    size_t size() const { return m_next.size(); }
+
+    /// Coordinate \a i of the distinct point \a k
+    T coord(size_t k, int i) const { return m_coords[3*k+i]; }
+
+    /// Prepares the table for \a n distinct points
+    void reserve(size_t n)
+    {
+        m_coords.reserve(3*n);
+        m_next.reserve(n);
+        if ( m_table.empty() || 2 * n > m_table.size() )
+            rehash(2 * n);
+    }
+
+    /// Returns the index of the first point inserted before which is
+    /// equal to (\a x, \a y, \a z), if any, otherwise adds the point
+    /// and returns its index, size()-1
+    index_t insert(T x, T y, T z)
+    {
+        // -0 and 0 are equal, but their bits are not
+        if ( 0 == x ) x = 0;
+        if ( 0 == y ) y = 0;
+        if ( 0 == z ) z = 0;
+        const T p[3] = {x, y, z};
+
+        long long c[3];
+        index_t found = -1;
+        if ( 0 == m_tol )
+        {
+            // The first point with the same coordinates
+            for (index_t k = m_table[slot(p, c)]; k != -1; k = m_next[k])
+                if ( x == m_coords[3*k] && y == m_coords[3*k+1] && z == m_coords[3*k+2] )
+                {
+                    found = k;
+                    break;
+                }
+        }
+        else
+        {
+            // The first point within the tolerance, in the cells
+            // around the point
+            cell(p, c);
+            long long d[3];
+            for (d[0] = c[0] - 1; d[0] <= c[0] + 1; ++d[0])
+                for (d[1] = c[1] - 1; d[1] <= c[1] + 1; ++d[1])
+                    for (d[2] = c[2] - 1; d[2] <= c[2] + 1; ++d[2])
+                        for (index_t k = m_table[slot(d)]; k != -1; k = m_next[k])
+                            if ( ( -1 == found || k < found ) &&
+                                 math::abs(x - m_coords[3*k  ]) <= m_tol &&
+                                 math::abs(y - m_coords[3*k+1]) <= m_tol &&
+                                 math::abs(z - m_coords[3*k+2]) <= m_tol )
+                                found = k;
+        }
+        if ( -1 != found )
+            return found;
+
+        // New point, appended to the list of its slot
+        if ( 2 * (m_next.size() + 1) > m_table.size() )
+            rehash(4 * (m_next.size() + 1));
+        const index_t k = static_cast<index_t>(m_next.size());
+        m_coords.insert(m_coords.end(), p, p + 3);
+        m_cells .insert(m_cells .end(), c, c + 3);
+        m_next.push_back(-1);
+        link(k);
+        return k;
+    }
+
+private:
+
+    // Grid cell of the point p (with positive tolerance)
+    void cell(const T p[3], long long c[3]) const
+    {
+        for (int i = 0; i != 3; ++i)
+            c[i] = static_cast<long long>( math::floor(p[i] / m_tol) );
+    }
+
+    // Slot of the point p (with zero tolerance), which has the key c
+    size_t slot(const T p[3], long long c[3]) const
+    {
+        // The key of a point is its bits, folded to 64 bits
+        for (int i = 0; i != 3; ++i)
+        {
+            unsigned char b[sizeof(T)];
+            std::memcpy(b, p + i, sizeof(T));
+            unsigned long long h = 0;
+            for (size_t j = 0; j != sizeof(T); ++j)
+                h = (h << 8 | h >> 56) ^ b[j];
+            c[i] = static_cast<long long>(h);
+        }
+        return slot(c);
+    }
+
+    // Slot of the key c: the slot holding the first point with this
+    // key, or the empty slot where it goes
+    size_t slot(const long long c[3]) const
+    {
+        size_t s = hash(c) & m_mask;
+        for (index_t k = m_table[s]; k != -1; k = m_table[s = (s + 1) & m_mask])
+            if ( c[0] == m_cells[3*k] && c[1] == m_cells[3*k+1] && c[2] == m_cells[3*k+2] )
+                break;
+        return s;
+    }
+
+    static size_t hash(const long long c[3])
+    {
+        unsigned long long h = 14695981039346656037ULL; // FNV-1a
+        for (int i = 0; i != 3; ++i)
+        {
+            h ^= static_cast<unsigned long long>(c[i]);
+            h *= 1099511628211ULL;
+            h ^= h >> 29;
+        }
+        return static_cast<size_t>(h);
+    }
+
+    // Appends the point k to the list of its slot
+    void link(index_t k)
+    {
+        const size_t s = slot(&m_cells[3*k]);
+        if ( -1 == m_table[s] )
+            m_table[s] = k;
+        else
+            m_next[m_tail[s]] = k;
+        m_tail[s] = k;
+    }
+
+    // Resizes the table to at least n slots and re-inserts the points
+    void rehash(size_t n)
+    {
+        size_t sz = 16;
+        while ( sz < n ) sz <<= 1;
+        m_table.assign(sz, -1);
+        m_tail .assign(sz, -1);
+        m_mask = sz - 1;
+        std::fill(m_next.begin(), m_next.end(), -1);
+        for (size_t k = 0; k != m_next.size(); ++k)
+            link(static_cast<index_t>(k));
+    }
+
+private:
+
+    T m_tol;
+
+    // Coordinates and keys of the distinct points
+    std::vector<T> m_coords;
+    std::vector<long long> m_cells;
+
+    // Open addressing table of the first and the last point of every
+    // key, and the next point with the same key
+    std::vector<index_t> m_table, m_tail;
+    std::vector<index_t> m_next;
+    size_t m_mask;
+};
+
+} // namespace gismo